@@ -36,8 +36,15 @@ class Application
 public:
 	virtual ~Application() {}
 	
+	// Called before the EGL context is created, when only the context parameters are set
+	virtual EGLConfigRequest getEGLConfigRequest( const ApplicationContext& /*context*/ ) { return EGLConfigRequest(); }
+
 	virtual bool initialize( const ApplicationContext& /*context*/ ) { return false; };
 	virtual void draw( const ApplicationContext& /*context*/ ) {};
+
+	// The runners stop drawing once the application is done. The process then exits with its status
+	virtual bool isDone() const { return false; }
+	virtual int getExitStatus() const { return 0; }
 };
 
 }
\ No newline at end of file
@@ -23,6 +23,9 @@
 */
 #include "OGLESApplicationContext.h"
 
+#include "OGLESUpscalePass.h"
+#include "OGLESTrace.h"
+
 namespace OGLESSandbox
 {
 
@@ -30,9 +33,26 @@ ApplicationContext::ApplicationContext()
 	: context(0),
 	  display(0),
 	  surface(0),
+	  config(0),
+	  configInfo(),
 	  width(0),
-	  height(0)
+	  height(0),
+	  outputWidth(0),
+	  outputHeight(0),
+	  frameBuffer(0),
+	  upscalePass(NULL)
+{
+}
+
+void ApplicationContext::swapBuffers() const
 {
+	if ( upscalePass )
+	{
+		OGLES_TRACE_SCOPE("upscalePass");
+		upscalePass->draw();
+	}
+	OGLES_TRACE_SCOPE("eglSwapBuffers");
+	eglSwapBuffers( display, surface );
 }
 
 }
\ No newline at end of file
@@ -26,23 +26,36 @@
 #include <EGL/egl.h>
 #include <GLES2/gl2.h>
 
+#include "OGLESEGLConfig.h"
+
 #include <string>
 #include <vector>
 
 namespace OGLESSandbox
 {
 
+class UpscalePass;
+
 class ApplicationContext
 {
 public:
 	ApplicationContext();
 
+	// Present the render surface: upscale it to the output size if the runner does it with GL, then swap
+	void			swapBuffers() const;
+
 	std::vector< std::pair<std::string, std::string> > parameters;		// Command line parameters stored as name-value string pairs
 	EGLContext		context;
 	EGLDisplay		display;
 	EGLSurface		surface;
-	int				width;
+	EGLConfig		config;
+	EGLConfigInfo	configInfo;		// What the runner got from EGL for the request made by the application
+	int				width;			// Size of the render surface the application draws into...
 	int				height;
+	int				outputWidth;	// ... and size of the image on the display. When they differ, the runner scales the render surface up
+	int				outputHeight;	// (with the display hardware when possible, with an UpscalePass otherwise)
+	GLuint			frameBuffer;	// Frame buffer standing for the render surface. 0 unless the runner upscales with GL
+	UpscalePass*	upscalePass;	// Owned by the runner. NULL when there's no GL upscaling
 };
 
 }
\ No newline at end of file
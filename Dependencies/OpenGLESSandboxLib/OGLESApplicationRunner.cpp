@@ -25,11 +25,17 @@
 
 #ifdef _WIN32
 	#include "OGLESApplicationRunner_AMDEmulator.h"
+#elif defined(OGLES_SOFTWARE_GL_ENABLED)
+	#include "OGLESApplicationRunner_Headless.h"
 #else
 	#include "OGLESApplicationRunner_RaspberryPi.h"
 #endif
 
 #include <sstream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "OGLESGLCapture.h"
 
 namespace OGLESSandbox
 {
@@ -61,11 +67,70 @@ void ApplicationRunner::parseCommandLineParameters( int argc, char** argv, std::
 	}
 }
 
+std::string ApplicationRunner::findParameter( const std::vector< std::pair<std::string, std::string> >& parameters, const std::string& name, const std::string& defaultValue )
+{
+	for ( std::size_t i=0; i<parameters.size(); ++i )
+		if ( parameters[i].first==name )
+			return parameters[i].second;
+	return defaultValue;
+}
+
+std::vector< std::pair<std::string, std::string> > ApplicationRunner::getApplicationParameters( const std::vector< std::pair<std::string, std::string> >& parameters )
+{
+	static const char* runnerParameterNames[] = 
+	{
+		"--RenderScale",
+		"--GLCaptureFile",
+		"--GLCaptureFrame",
+		"--GLCaptureFrameCount",
+		"--HeadlessWidth",
+		"--HeadlessHeight",
+		"--FrameCount",
+		"--GoldenFile",
+		"--GoldenFrame"
+	};
+	const std::size_t runnerParameterCount = sizeof(runnerParameterNames) / sizeof(runnerParameterNames[0]);
+
+	std::vector< std::pair<std::string, std::string> > applicationParameters;
+	for ( std::size_t i=0; i<parameters.size(); ++i )
+	{
+		bool runnerParameter = false;
+		for ( std::size_t j=0; j<runnerParameterCount && !runnerParameter; ++j )
+			runnerParameter = parameters[i].first==runnerParameterNames[j];
+		if ( !runnerParameter )
+			applicationParameters.push_back( parameters[i] );
+	}
+	return applicationParameters;
+}
+
+float ApplicationRunner::getRenderScale( const std::vector< std::pair<std::string, std::string> >& parameters )
+{
+	float renderScale = static_cast<float>( atof( findParameter( parameters, "--RenderScale", "1" ).c_str() ) );
+	if ( renderScale<=0.f || renderScale>1.f )
+	{
+		printf("RenderScale %f is out of the ]0,1] range, using 1\n", renderScale );
+		renderScale = 1.f;
+	}
+	return renderScale;
+}
+
+void ApplicationRunner::startGLCapture( const std::vector< std::pair<std::string, std::string> >& parameters )
+{
+	std::string path = findParameter( parameters, "--GLCaptureFile", "" );
+	if ( path.empty() )
+		return;
+	int firstFrame = atoi( findParameter( parameters, "--GLCaptureFrame", "100" ).c_str() );
+	int frameCount = atoi( findParameter( parameters, "--GLCaptureFrameCount", "1" ).c_str() );
+	GLCapture::start( path, firstFrame, frameCount );
+}
+
 ApplicationRunner* ApplicationRunner::create()
 {
 	ApplicationRunner* runner = 0;
 #ifdef _WIN32
 	runner = new AMDEmulatorApplicationRunner();
+#elif defined(OGLES_SOFTWARE_GL_ENABLED)
+	runner = new HeadlessApplicationRunner();
 #else
 	runner = new RaspberryPiApplicationRunner();
 #endif
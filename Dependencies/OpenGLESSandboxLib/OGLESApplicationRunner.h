@@ -46,12 +46,26 @@ public:
 	
 	virtual void run( Application* application, int argc, char** argv ) = 0;
 
+	// Non-zero when the run failed a check of the runner's own, combined by main() with the application's
+	virtual int getExitStatus() const { return 0; }
+
 	// Create a platform-specific application runner
 	static ApplicationRunner* create();
 
 protected:
 	static void	splitString( const std::string& text, char delim, std::vector<std::string>& tokens );
 	static void	parseCommandLineParameters( int argc, char** argv, std::vector< std::pair<std::string, std::string> >& parameters );
+	static std::string findParameter( const std::vector< std::pair<std::string, std::string> >& parameters, const std::string& name, const std::string& defaultValue );
+
+	// The parameters without the ones only the runners read (--RenderScale, --GLCapture..., --Headless...), 
+	// to be given to the application so that it doesn't report them as unsupported
+	static std::vector< std::pair<std::string, std::string> > getApplicationParameters( const std::vector< std::pair<std::string, std::string> >& parameters );
+	
+	// Ratio between the render surface size and the output size, given by the --RenderScale parameter
+	static float getRenderScale( const std::vector< std::pair<std::string, std::string> >& parameters );
+
+	// Starts the GL command capture if --GLCaptureFile is given (see GLCapture), before the context is created
+	static void startGLCapture( const std::vector< std::pair<std::string, std::string> >& parameters );
 
 	ApplicationContext mApplicationContext;
 };
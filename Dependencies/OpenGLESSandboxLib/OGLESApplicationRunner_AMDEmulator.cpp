@@ -50,18 +50,26 @@ void AMDEmulatorApplicationRunner::run( Application* application, int argc, char
 	QApplication* app = NULL;
 	app = new QApplication( argc, argv );
 
+	std::vector< std::pair<std::string, std::string> > parameters;
+	parseCommandLineParameters( argc, argv, parameters );
+	startGLCapture( parameters );
+
 	QOGLESWidget* widget = new QOGLESWidget(application, NULL);
 	widget->resize(1280, 800);
 	int windowSystemId = reinterpret_cast<int>( widget->winId() );
 
 	ApplicationContext applicationContext; 
-	if ( !createEGLContext( windowSystemId, applicationContext ) )
+	applicationContext.parameters = getApplicationParameters( parameters );
+	EGLConfigRequest configRequest;
+	if ( application )
+		configRequest = application->getEGLConfigRequest( applicationContext );
+	if ( !createEGLContext( windowSystemId, configRequest, applicationContext ) )
 		return;
 
-	std::vector< std::pair<std::string, std::string> > parameters;
-	parseCommandLineParameters( argc, argv, parameters );
-	applicationContext.parameters = parameters;
+	applicationContext.parameters = getApplicationParameters( parameters );
 
+	// There's no hardware scaler here, so a smaller render surface is upscaled with GL
+	widget->setRenderScale( getRenderScale(parameters) );
 	widget->setApplicationContext( applicationContext );
 	widget->setAutoUpdate(true);
 
@@ -76,7 +84,7 @@ void AMDEmulatorApplicationRunner::run( Application* application, int argc, char
 	}
 }
 
-bool AMDEmulatorApplicationRunner::createEGLContext( int windowSystemId, ApplicationContext& applicationContext )
+bool AMDEmulatorApplicationRunner::createEGLContext( int windowSystemId, const EGLConfigRequest& configRequest, ApplicationContext& applicationContext )
 {
 	applicationContext = ApplicationContext();
 
@@ -119,22 +127,10 @@ bool AMDEmulatorApplicationRunner::createEGLContext( int windowSystemId, Applica
         return GL_FALSE;
     }
 
-    // Obtain the first configuration with a depth buffer
-    EGLint attrs[] = 
-		{ 
-			EGL_DEPTH_SIZE, 16,
-
-			EGL_RED_SIZE, 8,
-			EGL_GREEN_SIZE, 8,
-			EGL_BLUE_SIZE, 8,
-			EGL_ALPHA_SIZE, 8,
-			EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-			EGL_NONE
-		};
-    EGLint numConfig =0;
+    // Obtain the best configuration for what the application asked
     EGLConfig eglConfig = 0;
-    bsuccess = eglChooseConfig(eglDisplay, attrs, &eglConfig, 1, &numConfig);
-    if (!bsuccess)
+    EGLConfigInfo eglConfigInfo;
+    if (!EGLConfigChooser::choose(eglDisplay, configRequest, eglConfig, eglConfigInfo))
     {
         printf("Could not find valid EGL config\n");
         //CloseNativeDisplay(nativeDisplay);
@@ -196,6 +192,8 @@ bool AMDEmulatorApplicationRunner::createEGLContext( int windowSystemId, Applica
     applicationContext.context = eglContext;
 	applicationContext.display = eglDisplay;
 	applicationContext.surface = eglSurface;
+	applicationContext.config = eglConfig;
+	applicationContext.configInfo = eglConfigInfo;
 
 	return GL_TRUE;
 }
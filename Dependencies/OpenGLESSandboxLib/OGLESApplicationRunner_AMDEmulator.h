@@ -34,7 +34,7 @@ public:
 	virtual void run( Application* application, int argc, char** argv );
 
 private:
-	static bool createEGLContext( int windowSystemId, ApplicationContext& applicationContext );
+	static bool createEGLContext( int windowSystemId, const EGLConfigRequest& configRequest, ApplicationContext& applicationContext );
 };
 
 }
\ No newline at end of file
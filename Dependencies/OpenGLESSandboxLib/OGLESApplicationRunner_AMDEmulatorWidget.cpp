@@ -25,6 +25,8 @@
 
 #include <assert.h>
 
+#include <QtGui/QApplication>
+
 namespace OGLESSandbox
 {
 
@@ -32,7 +34,9 @@ QOGLESWidget::QOGLESWidget( Application* application, QWidget* parent, Qt::Windo
 	:	QWidget(parent, flags | Qt::MSWindowsOwnDC ),
 		mApplication(application),
 		mApplicationContext(),
-		mUpdateTimer(NULL)
+		mUpdateTimer(NULL),
+		mRenderScale(1.f),
+		mUpscalePass(NULL)
 {
 	setAttribute(Qt::WA_PaintOnScreen);
     setAttribute(Qt::WA_NoSystemBackground);
@@ -47,6 +51,8 @@ QOGLESWidget::QOGLESWidget( Application* application, QWidget* parent, Qt::Windo
 
 QOGLESWidget::~QOGLESWidget()
 {
+	delete mUpscalePass;
+	mUpscalePass = NULL;
 }
 
 void QOGLESWidget::keyPressEvent( QKeyEvent* event )
@@ -67,8 +73,41 @@ void QOGLESWidget::keyReleaseEvent( QKeyEvent* /*event*/ )
 void QOGLESWidget::setApplicationContext( const ApplicationContext& applicationContext )
 {
 	mApplicationContext = applicationContext;
-	mApplicationContext.width = width();
-	mApplicationContext.height = height();
+	setOutputSize( width(), height() );
+}
+
+void QOGLESWidget::setRenderScale( float renderScale )
+{
+	mRenderScale = renderScale;
+	setOutputSize( width(), height() );
+}
+
+void QOGLESWidget::setOutputSize( int width, int height )
+{
+	mApplicationContext.outputWidth = width;
+	mApplicationContext.outputHeight = height;
+	mApplicationContext.width = static_cast<int>( width * mRenderScale + 0.5f );
+	mApplicationContext.height = static_cast<int>( height * mRenderScale + 0.5f );
+	mApplicationContext.frameBuffer = 0;
+	mApplicationContext.upscalePass = NULL;
+
+	// The upscale pass needs the EGL context which only exists once setApplicationContext() is called
+	if ( mRenderScale==1.f || mApplicationContext.context==0 )
+		return;
+	
+	if ( !mUpscalePass )
+		mUpscalePass = new UpscalePass();
+	if ( mUpscalePass->setSizes( mApplicationContext.width, mApplicationContext.height, width, height ) )
+	{
+		mApplicationContext.frameBuffer = mUpscalePass->getFrameBuffer();
+		mApplicationContext.upscalePass = mUpscalePass;
+	}
+	else
+	{
+		// Fall back to rendering straight to the window at full size
+		mApplicationContext.width = width;
+		mApplicationContext.height = height;
+	}
 }
 
 void QOGLESWidget::setAutoUpdate( bool value )
@@ -81,8 +120,7 @@ void QOGLESWidget::setAutoUpdate( bool value )
 
 void QOGLESWidget::resizeEvent( QResizeEvent* evt )
 {
-	mApplicationContext.width = evt->size().width();
-	mApplicationContext.height = evt->size().height();
+	setOutputSize( evt->size().width(), evt->size().height() );
 }
 	
 QPaintEngine* QOGLESWidget:: paintEngine() const
@@ -92,8 +130,14 @@ QPaintEngine* QOGLESWidget:: paintEngine() const
 	
 void QOGLESWidget::paintEvent( QPaintEvent* /*evt*/ )
 {
-	if ( mApplication )
-		mApplication->draw( mApplicationContext );
+	if ( !mApplication )
+		return;
+	mApplication->draw( mApplicationContext );
+	if ( mApplication->isDone() )
+	{
+		setAutoUpdate( false );
+		QApplication::quit();
+	}
 }
 
 }
\ No newline at end of file
@@ -45,6 +45,7 @@
 #include <GLES2/gl2.h>
 
 #include "OGLESApplication.h"
+#include "OGLESUpscalePass.h"
 
 namespace OGLESSandbox
 {
@@ -58,6 +59,7 @@ public:
 	virtual ~QOGLESWidget();
 	
 	void setApplicationContext( const ApplicationContext& applicationContext );
+	void setRenderScale( float renderScale );
 
 	void setAutoUpdate( bool value );
 
@@ -71,9 +73,13 @@ protected:
 	virtual void			keyReleaseEvent( QKeyEvent* event );
 
 private:
+	void					setOutputSize( int width, int height );
+
 	Application*			mApplication;
 	ApplicationContext		mApplicationContext;
 	QTimer*					mUpdateTimer;
+	float					mRenderScale;
+	UpscalePass*			mUpscalePass;
 };
 
 
@@ -0,0 +1,189 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESApplicationRunner_Headless.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "OGLESGLCheck.h"
+#include "OGLESTrace.h"
+
+#define check() OGLES_GL_CHECK()
+
+namespace OGLESSandbox
+{
+
+HeadlessApplicationRunner::HeadlessApplicationRunner()
+	: mGoldenMatched(true)
+{
+}
+
+void HeadlessApplicationRunner::run( Application* application, int argc, char** argv )
+{
+	std::vector< std::pair<std::string, std::string> > parameters;
+	parseCommandLineParameters( argc, argv, parameters );
+
+	int width = atoi( findParameter( parameters, "--HeadlessWidth", "1280" ).c_str() );
+	int height = atoi( findParameter( parameters, "--HeadlessHeight", "800" ).c_str() );
+	int frameCount = atoi( findParameter( parameters, "--FrameCount", "0" ).c_str() );
+	std::string goldenFile = findParameter( parameters, "--GoldenFile", "" );
+	int goldenFrame = atoi( findParameter( parameters, "--GoldenFrame", "0" ).c_str() );
+
+	ApplicationContext applicationContext;
+	applicationContext.parameters = getApplicationParameters( parameters );
+	EGLConfigRequest configRequest;
+	if ( application )
+		configRequest = application->getEGLConfigRequest( applicationContext );
+	configRequest.surfaceType = EGL_PBUFFER_BIT;
+	createEGLContext( applicationContext, configRequest, width, height );
+
+	const ApplicationContext& ac = applicationContext;
+	printf("Headless surface w:%d h:%d\n", ac.width, ac.height );
+
+	if ( !application || !application->initialize( applicationContext ) )
+		return;
+
+	mGoldenMatched = true;
+	unsigned long long startTime = Trace::getTime();
+	int frameIndex = 0;
+	for ( ; (frameCount==0 || frameIndex<frameCount) && !application->isDone(); ++frameIndex )
+	{
+		application->draw( applicationContext );
+		if ( !goldenFile.empty() && frameIndex==goldenFrame )
+			mGoldenMatched = checkGoldenFrame( applicationContext, goldenFile );
+	}
+	double seconds = static_cast<double>( Trace::getTime() - startTime ) / 1000000.0;
+	printf("Headless: %d frames in %.2fs (%.2f fps)\n", frameIndex, seconds, seconds>0 ? frameIndex / seconds : 0.0 );
+}
+
+void HeadlessApplicationRunner::createEGLContext( ApplicationContext& applicationContext, const EGLConfigRequest& configRequest, int width, int height )
+{
+	EGLBoolean result;
+	bool chosen;
+
+	static const EGLint context_attributes[] = 
+	{
+		EGL_CONTEXT_CLIENT_VERSION, 2,
+		EGL_NONE
+	};
+	EGLConfig config;
+
+	applicationContext.display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	assert(applicationContext.display!=EGL_NO_DISPLAY);
+
+	result = eglInitialize(applicationContext.display, NULL, NULL);
+	assert(EGL_FALSE != result);
+
+	chosen = EGLConfigChooser::choose(applicationContext.display, configRequest, config, applicationContext.configInfo);
+	assert(chosen);
+	applicationContext.config = config;
+
+	result = eglBindAPI(EGL_OPENGL_ES_API);
+	assert(EGL_FALSE != result);
+
+	applicationContext.context = eglCreateContext(applicationContext.display, config, EGL_NO_CONTEXT, context_attributes);
+	assert(applicationContext.context!=EGL_NO_CONTEXT);
+
+	const EGLint surface_attributes[] = 
+	{
+		EGL_WIDTH, width,
+		EGL_HEIGHT, height,
+		EGL_NONE
+	};
+	applicationContext.surface = eglCreatePbufferSurface( applicationContext.display, config, surface_attributes );
+	assert(applicationContext.surface != EGL_NO_SURFACE);
+
+	applicationContext.width = width;
+	applicationContext.height = height;
+	applicationContext.outputWidth = width;
+	applicationContext.outputHeight = height;
+
+	result = eglMakeCurrent(applicationContext.display, applicationContext.surface, applicationContext.surface, applicationContext.context);
+	assert(EGL_FALSE != result);
+	check();
+}
+
+// The image is stored as a binary PPM, top row first
+bool HeadlessApplicationRunner::checkGoldenFrame( const ApplicationContext& applicationContext, const std::string& path )
+{
+	int width = applicationContext.width;
+	int height = applicationContext.height;
+	std::vector<unsigned char> pixels( width * height * 4 );
+	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+	glReadPixels( 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0] );
+	check();
+
+	std::vector<unsigned char> image( width * height * 3 );
+	for ( int y=0; y<height; ++y )
+	{
+		const unsigned char* source = &pixels[(height - 1 - y) * width * 4];
+		unsigned char* destination = &image[y * width * 3];
+		for ( int x=0; x<width; ++x )
+			memcpy( destination + x*3, source + x*4, 3 );
+	}
+
+	FILE* file = fopen( path.c_str(), "rb" );
+	if ( !file )
+	{
+		file = fopen( path.c_str(), "wb" );
+		if ( !file )
+		{
+			printf("Golden frame: can't write %s\n", path.c_str() );
+			return false;
+		}
+		fprintf( file, "P6\n%d %d\n255\n", width, height );
+		fwrite( &image[0], 1, image.size(), file );
+		fclose( file );
+		printf("Golden frame: %s written\n", path.c_str() );
+		return true;
+	}
+
+	int goldenWidth = 0;
+	int goldenHeight = 0;
+	int maxValue = 0;
+	bool valid = fscanf( file, "P6 %d %d %d", &goldenWidth, &goldenHeight, &maxValue )==3 && fgetc( file )!=EOF;
+	std::vector<unsigned char> golden( image.size() );
+	valid = valid && goldenWidth==width && goldenHeight==height && maxValue==255 && 
+			fread( &golden[0], 1, golden.size(), file )==golden.size();
+	fclose( file );
+	if ( !valid )
+	{
+		printf("Golden frame: %s isn't a %dx%d PPM image\n", path.c_str(), width, height );
+		return false;
+	}
+
+	std::size_t differences = 0;
+	for ( std::size_t i=0; i<image.size(); ++i )
+		if ( image[i]!=golden[i] )
+			++differences;
+	if ( differences==0 )
+		printf("Golden frame: matches %s\n", path.c_str() );
+	else
+		printf("Golden frame: %u of %u bytes differ from %s\n", static_cast<unsigned int>(differences), static_cast<unsigned int>(image.size()), path.c_str() );
+	return differences==0;
+}
+
+}
@@ -0,0 +1,59 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OGLESApplicationRunner.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	HeadlessApplicationRunner
+
+	Runs the application on an off-screen pbuffer, used with the software GL (see SoftwareGL) 
+	where there's no display. The surface size is given by --HeadlessWidth and --HeadlessHeight.
+	The run stops after --FrameCount frames (endless when 0), or once the application is done, 
+	and prints the frame rate.
+
+	One frame can be compared to a golden image: after the draw of frame --GoldenFrame, the 
+	surface is read back and compared byte for byte with the --GoldenFile PPM image. If the 
+	file doesn't exist yet, it's written instead. The run goes on to its end when the comparison 
+	fails, getExitStatus() then tells it.
+*/
+class HeadlessApplicationRunner : public ApplicationRunner
+{
+public:
+	HeadlessApplicationRunner();
+
+	virtual void run( Application* application, int argc, char** argv );
+	virtual int getExitStatus() const { return mGoldenMatched ? 0 : 1; }
+
+private:
+	static void createEGLContext( ApplicationContext& applicationContext, const EGLConfigRequest& configRequest, int width, int height );
+	static bool checkGoldenFrame( const ApplicationContext& applicationContext, const std::string& path );
+
+	bool	mGoldenMatched;
+};
+
+}
@@ -36,28 +36,34 @@
 #include <assert.h>
 #include <unistd.h>
 
-#define check() assert(glGetError() == 0)
+#include "OGLESGLCheck.h"
+
+#define check() OGLES_GL_CHECK()
 
 namespace OGLESSandbox
 {
 
 void RaspberryPiApplicationRunner::run( Application* application, int argc, char** argv )
 {
-	ApplicationContext applicationContext;
-	createEGLContext( applicationContext );
-
 	std::vector< std::pair<std::string, std::string> > parameters;
 	parseCommandLineParameters( argc, argv, parameters );
-	applicationContext.parameters = parameters;
+	startGLCapture( parameters );
+
+	ApplicationContext applicationContext;
+	applicationContext.parameters = getApplicationParameters( parameters );
+	EGLConfigRequest configRequest;
+	if ( application )
+		configRequest = application->getEGLConfigRequest( applicationContext );
+	createEGLContext( applicationContext, configRequest, getRenderScale(parameters) );
 
 	const ApplicationContext& ac = applicationContext;
-	printf("ctx:%d disp:%d surf:%d w:%d h:%d\n", (int)ac.context, (int)ac.display, (int)ac.surface, ac.width, ac.height );
+	printf("ctx:%d disp:%d surf:%d w:%d h:%d output w:%d h:%d\n", (int)ac.context, (int)ac.display, (int)ac.surface, ac.width, ac.height, ac.outputWidth, ac.outputHeight );
 
 	if ( application ) 
 	{
 		if ( application->initialize( applicationContext ) )
 		{
-			while ( true )
+			while ( !application->isDone() )
 			{
 				application->draw( applicationContext );
 				usleep( 1 * 1000 );
@@ -96,14 +102,14 @@ void RaspberryPiApplicationRunner::run( Application* application, int argc, char
 	(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
 	SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
-void RaspberryPiApplicationRunner::createEGLContext( ApplicationContext& applicationContext )
+void RaspberryPiApplicationRunner::createEGLContext( ApplicationContext& applicationContext, const EGLConfigRequest& configRequest, float renderScale )
 {
 	// Don't forget to this at startup otherwise bcm function will fail like graphics_get_display_size 
 	bcm_host_init();
 
 	int32_t success = 0;
 	EGLBoolean result;
-	EGLint num_config;
+	bool chosen;
 
 	static EGL_DISPMANX_WINDOW_T nativewindow;
 
@@ -113,16 +119,6 @@ void RaspberryPiApplicationRunner::createEGLContext( ApplicationContext& applica
 	VC_RECT_T dst_rect;
 	VC_RECT_T src_rect;
 
-	static const EGLint attribute_list[] =
-	{
-		EGL_RED_SIZE, 8,
-		EGL_GREEN_SIZE, 8,
-		EGL_BLUE_SIZE, 8,
-		EGL_ALPHA_SIZE, 8,
-		EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
-		EGL_NONE
-	};
-
 	static const EGLint context_attributes[] = 
 	{
 		EGL_CONTEXT_CLIENT_VERSION, 2,
@@ -141,8 +137,9 @@ void RaspberryPiApplicationRunner::createEGLContext( ApplicationContext& applica
 	check();
 
 	// get an appropriate EGL frame buffer configuration
-	result = eglChooseConfig(applicationContext.display, attribute_list, &config, 1, &num_config);
-	assert(EGL_FALSE != result);
+	chosen = EGLConfigChooser::choose(applicationContext.display, configRequest, config, applicationContext.configInfo);
+	assert(chosen);
+	applicationContext.config = config;
 	check();
 
 	// get an appropriate EGL frame buffer configuration
@@ -156,19 +153,25 @@ void RaspberryPiApplicationRunner::createEGLContext( ApplicationContext& applica
 	check();
 
 	// create an EGL window surface
-	uint32_t width = 0;
-	uint32_t height = 0;
-	success = graphics_get_display_size(0 /* LCD */, &width, &height );
+	uint32_t outputWidth = 0;
+	uint32_t outputHeight = 0;
+	success = graphics_get_display_size(0 /* LCD */, &outputWidth, &outputHeight );
 	assert( success >= 0 );
 
+	// The surface can be smaller than the display: dispmanx then scales it up to the 
+	// destination rectangle in hardware, at no cost for the GPU
+	uint32_t width = static_cast<uint32_t>( outputWidth * renderScale + 0.5f );
+	uint32_t height = static_cast<uint32_t>( outputHeight * renderScale + 0.5f );
+
 	applicationContext.width = width;
 	applicationContext.height = height;
-
+	applicationContext.outputWidth = outputWidth;
+	applicationContext.outputHeight = outputHeight;
 
 	dst_rect.x = 0;
 	dst_rect.y = 0;
-	dst_rect.width = width;
-	dst_rect.height = height;
+	dst_rect.width = outputWidth;
+	dst_rect.height = outputHeight;
 
 	src_rect.x = 0;
 	src_rect.y = 0;
@@ -34,7 +34,7 @@ public:
 	virtual void run( Application* application, int argc, char** argv );
 
 private:
-	static void createEGLContext( ApplicationContext& applicationContext );
+	static void createEGLContext( ApplicationContext& applicationContext, const EGLConfigRequest& configRequest, float renderScale );
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,168 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESEGLConfig.h"
+
+#include <stdio.h>
+#include <algorithm>
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+EGLConfigRequest::EGLConfigRequest()
+	: surfaceType(EGL_WINDOW_BIT),
+	  minRedSize(5),
+	  minGreenSize(6),
+	  minBlueSize(5),
+	  minAlphaSize(0),
+	  minDepthSize(0),
+	  minStencilSize(0),
+	  preferredRedSize(5),
+	  preferredGreenSize(6),
+	  preferredBlueSize(5),
+	  preferredAlphaSize(0),
+	  preferredDepthSize(0),
+	  preferredStencilSize(0),
+	  preferredSamples(0)
+{
+}
+
+EGLConfigInfo::EGLConfigInfo()
+	: configId(0),
+	  redSize(0),
+	  greenSize(0),
+	  blueSize(0),
+	  alphaSize(0),
+	  depthSize(0),
+	  stencilSize(0),
+	  samples(0),
+	  surfaceType(0),
+	  renderableType(0),
+	  caveat(EGL_NONE)
+{
+}
+
+std::string EGLConfigInfo::toString() const
+{
+	char text[128];
+	sprintf( text, "id:%d RGBA:%d%d%d%d depth:%d stencil:%d samples:%d%s", 
+		configId, redSize, greenSize, blueSize, alphaSize, depthSize, stencilSize, samples,
+		caveat==EGL_NONE ? "" : " (slow/non-conformant)" );
+	return text;
+}
+
+EGLConfigInfo EGLConfigChooser::getConfigInfo( EGLDisplay display, EGLConfig config )
+{
+	EGLConfigInfo info;
+	eglGetConfigAttrib( display, config, EGL_CONFIG_ID, &info.configId );
+	eglGetConfigAttrib( display, config, EGL_RED_SIZE, &info.redSize );
+	eglGetConfigAttrib( display, config, EGL_GREEN_SIZE, &info.greenSize );
+	eglGetConfigAttrib( display, config, EGL_BLUE_SIZE, &info.blueSize );
+	eglGetConfigAttrib( display, config, EGL_ALPHA_SIZE, &info.alphaSize );
+	eglGetConfigAttrib( display, config, EGL_DEPTH_SIZE, &info.depthSize );
+	eglGetConfigAttrib( display, config, EGL_STENCIL_SIZE, &info.stencilSize );
+	eglGetConfigAttrib( display, config, EGL_SAMPLES, &info.samples );
+	eglGetConfigAttrib( display, config, EGL_SURFACE_TYPE, &info.surfaceType );
+	eglGetConfigAttrib( display, config, EGL_RENDERABLE_TYPE, &info.renderableType );
+	eglGetConfigAttrib( display, config, EGL_CONFIG_CAVEAT, &info.caveat );
+	return info;
+}
+
+bool EGLConfigChooser::meetsRequirements( const EGLConfigInfo& info, const EGLConfigRequest& request )
+{
+	return	(info.surfaceType & request.surfaceType)==request.surfaceType &&
+			(info.renderableType & EGL_OPENGL_ES2_BIT)!=0 &&
+			info.redSize>=request.minRedSize &&
+			info.greenSize>=request.minGreenSize &&
+			info.blueSize>=request.minBlueSize &&
+			info.alphaSize>=request.minAlphaSize &&
+			info.depthSize>=request.minDepthSize &&
+			info.stencilSize>=request.minStencilSize;
+}
+
+// The cost is roughly the number of bits per pixel away from the preferences. 
+// Extra bits are what costs bandwidth so they weigh more than missing ones,
+// multisampling multiplies everything and slow configs come last
+int EGLConfigChooser::computeCost( const EGLConfigInfo& info, const EGLConfigRequest& request )
+{
+	struct Local
+	{
+		static int distance( EGLint value, EGLint preferred )
+		{
+			return value>preferred ? (value-preferred)*2 : (preferred-value);
+		}
+	};
+
+	int cost = 0;
+	cost += Local::distance( info.redSize, request.preferredRedSize );
+	cost += Local::distance( info.greenSize, request.preferredGreenSize );
+	cost += Local::distance( info.blueSize, request.preferredBlueSize );
+	cost += Local::distance( info.alphaSize, request.preferredAlphaSize );
+	cost += Local::distance( info.depthSize, request.preferredDepthSize );
+	cost += Local::distance( info.stencilSize, request.preferredStencilSize );
+	cost += Local::distance( info.samples, request.preferredSamples ) * 32;
+	if ( info.caveat!=EGL_NONE )
+		cost += 1000;
+	return cost;
+}
+
+bool EGLConfigChooser::choose( EGLDisplay display, const EGLConfigRequest& request, EGLConfig& config, EGLConfigInfo& info )
+{
+	EGLint numConfigs = 0;
+	if ( !eglGetConfigs( display, NULL, 0, &numConfigs ) || numConfigs<=0 )
+	{
+		printf("EGLConfigChooser: no EGL config available\n");
+		return false;
+	}
+	std::vector<EGLConfig> configs( numConfigs );
+	if ( !eglGetConfigs( display, &configs[0], numConfigs, &numConfigs ) )
+	{
+		printf("EGLConfigChooser: eglGetConfigs failed\n");
+		return false;
+	}
+
+	// Rank the candidates by cost then by id so the result doesn't depend on the driver enumeration order
+	std::vector< std::pair< std::pair<int, EGLint>, int > > candidates;
+	std::vector<EGLConfigInfo> infos( numConfigs );
+	for ( int i=0; i<numConfigs; ++i )
+	{
+		infos[i] = getConfigInfo( display, configs[i] );
+		if ( meetsRequirements( infos[i], request ) )
+			candidates.push_back( std::make_pair( std::make_pair( computeCost(infos[i], request), infos[i].configId ), i ) );
+	}
+	std::sort( candidates.begin(), candidates.end() );
+
+	printf("EGLConfigChooser: %d configs, %d meet the requirements\n", numConfigs, static_cast<int>(candidates.size()) );
+	for ( std::size_t i=0; i<candidates.size(); ++i )
+		printf("  #%d cost:%d %s\n", static_cast<int>(i), candidates[i].first.first, infos[candidates[i].second].toString().c_str() );
+	if ( candidates.empty() )
+		return false;
+
+	config = configs[candidates[0].second];
+	info = infos[candidates[0].second];
+	printf("EGLConfigChooser: chose %s\n", info.toString().c_str() );
+	return true;
+}
+
+}
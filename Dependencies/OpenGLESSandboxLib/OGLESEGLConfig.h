@@ -0,0 +1,105 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <EGL/egl.h>
+
+#include <string>
+
+namespace OGLESSandbox
+{
+
+/*
+	EGLConfigRequest
+
+	What an application wants from the EGL frame buffer configuration of its window.
+	The min values are hard requirements, the preferred values drive the ranking of 
+	the configurations that meet them. 
+	
+	The defaults are chosen to save memory bandwidth: a window that only receives
+	a final full-screen pass needs neither alpha, depth, stencil nor multisampling,
+	and RGB565 halves the scan-out and write traffic compared to RGBA8888.
+*/
+struct EGLConfigRequest
+{
+	EGLConfigRequest();
+
+	EGLint	surfaceType;				// EGL_SURFACE_TYPE bits that must all be supported
+
+	EGLint	minRedSize;
+	EGLint	minGreenSize;
+	EGLint	minBlueSize;
+	EGLint	minAlphaSize;
+	EGLint	minDepthSize;
+	EGLint	minStencilSize;
+
+	EGLint	preferredRedSize;
+	EGLint	preferredGreenSize;
+	EGLint	preferredBlueSize;
+	EGLint	preferredAlphaSize;
+	EGLint	preferredDepthSize;
+	EGLint	preferredStencilSize;
+	EGLint	preferredSamples;
+};
+
+/*
+	EGLConfigInfo
+
+	The attributes of an EGL frame buffer configuration, as reported by EGL 
+*/
+struct EGLConfigInfo
+{
+	EGLConfigInfo();
+	
+	std::string	toString() const;
+	int			getBitsPerPixel() const { return redSize + greenSize + blueSize + alphaSize; }
+
+	EGLint	configId;
+	EGLint	redSize;
+	EGLint	greenSize;
+	EGLint	blueSize;
+	EGLint	alphaSize;
+	EGLint	depthSize;
+	EGLint	stencilSize;
+	EGLint	samples;
+	EGLint	surfaceType;
+	EGLint	renderableType;
+	EGLint	caveat;
+};
+
+class EGLConfigChooser
+{
+public:
+	// Rank all the configurations of the display meeting the request and return the best one.
+	// The ranking is printed out so it's easy to see what else was available
+	static bool				choose( EGLDisplay display, const EGLConfigRequest& request, EGLConfig& config, EGLConfigInfo& info );
+	
+	static EGLConfigInfo	getConfigInfo( EGLDisplay display, EGLConfig config );
+
+private:
+	static bool				meetsRequirements( const EGLConfigInfo& info, const EGLConfigRequest& request );
+	static int				computeCost( const EGLConfigInfo& info, const EGLConfigRequest& request );
+};
+
+}
@@ -0,0 +1,924 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESGLCapture.h"
+
+#include <stdio.h>
+
+#if defined(OGLES_GL_CAPTURE_ENABLED) && defined(__linux__)
+	#define OGLES_GL_CAPTURE_INTERPOSE
+#endif
+
+#ifdef OGLES_GL_CAPTURE_INTERPOSE
+
+#ifndef _GNU_SOURCE
+	#define _GNU_SOURCE			// RTLD_NEXT
+#endif
+#include <dlfcn.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The GL and EGL headers aren't included: their prototypes differ between versions (the 
+// Raspberry Pi gl2.h has no const in glShaderSource for example) and the definitions below 
+// would conflict with some of them. All the linker looks at is the names
+typedef unsigned int	GLenum;
+typedef unsigned char	GLboolean;
+typedef unsigned int	GLbitfield;
+typedef int				GLint;
+typedef int				GLsizei;
+typedef unsigned int	GLuint;
+typedef float			GLfloat;
+typedef float			GLclampf;
+typedef char			GLchar;
+typedef void			GLvoid;
+typedef ptrdiff_t		GLintptr;
+typedef ptrdiff_t		GLsizeiptr;
+typedef unsigned int	EGLBoolean;
+typedef void*			EGLDisplay;
+typedef void*			EGLSurface;
+
+enum
+{
+	GL_UNPACK_ALIGNMENT			= 0x0CF5,
+	GL_ALPHA					= 0x1906,
+	GL_RGB						= 0x1907,
+	GL_LUMINANCE				= 0x1909,
+	GL_LUMINANCE_ALPHA			= 0x190A,
+	GL_UNSIGNED_SHORT_4_4_4_4	= 0x8033,
+	GL_UNSIGNED_SHORT_5_5_5_1	= 0x8034,
+	GL_UNSIGNED_SHORT_5_6_5		= 0x8363
+};
+
+using OGLESSandbox::GLCapture;
+
+namespace
+{
+
+// Whether a command is written before the first captured frame
+enum CommandKind
+{
+	StateCommand,				// Changes the GL state, always written
+	FrameCommand				// Draws or queries, only written in the captured frames
+};
+
+FILE*			gFile = NULL;
+int				gFrame = 0;				// Frames swapped since the capture started
+int				gFirstFrame = 0;
+int				gEndFrame = 0;
+unsigned int	gCommandCount = 0;
+GLint			gUnpackAlignment = 4;
+
+void* getRealFunction( const char* name )
+{
+	void* function = dlsym( RTLD_NEXT, name );
+	if ( !function )
+	{
+		printf("GLCapture: %s not found in the GL libraries\n", name );
+		abort();
+	}
+	return function;
+}
+
+// The function the call is forwarded to, looked up on the first call
+#define OGLES_GL_CAPTURE_REAL( name, returnType, parameterTypes ) \
+	typedef returnType (*RealFunction) parameterTypes; \
+	static RealFunction real = reinterpret_cast<RealFunction>( getRealFunction( #name ) )
+
+bool beginCommand( GLCapture::Command command, CommandKind kind )
+{
+	if ( !gFile )
+		return false;
+	if ( kind==FrameCommand && gFrame<gFirstFrame )
+		return false;
+	unsigned int word = command;
+	fwrite( &word, sizeof(word), 1, gFile );
+	gCommandCount++;
+	return true;
+}
+
+void writeUInt( unsigned int value )
+{
+	fwrite( &value, sizeof(value), 1, gFile );
+}
+
+void writeInt( int value )
+{
+	fwrite( &value, sizeof(value), 1, gFile );
+}
+
+void writeFloat( float value )
+{
+	fwrite( &value, sizeof(value), 1, gFile );
+}
+
+void writeData( const void* data, unsigned int size )
+{
+	if ( !data )
+	{
+		writeUInt( GLCapture::NullData );
+		return;
+	}
+	writeUInt( size );
+	fwrite( data, 1, size, gFile );
+	static const char padding[3] = { 0, 0, 0 };
+	if ( size%4!=0 )
+		fwrite( padding, 1, 4 - size%4, gFile );
+}
+
+void writeString( const char* text )
+{
+	writeData( text, text ? static_cast<unsigned int>(strlen(text)) : 0 );
+}
+
+void writeNames( GLsizei n, const GLuint* names )
+{
+	writeInt( n );
+	for ( GLsizei i=0; i<n; ++i )
+		writeUInt( names[i] );
+}
+
+// Size of the pixels given to glTexImage2D, rows being padded to the unpack alignment
+unsigned int getImageSize( GLsizei width, GLsizei height, GLenum format, GLenum type )
+{
+	unsigned int pixelSize = 4;
+	if ( type==GL_UNSIGNED_SHORT_5_6_5 || type==GL_UNSIGNED_SHORT_4_4_4_4 || type==GL_UNSIGNED_SHORT_5_5_5_1 )
+		pixelSize = 2;
+	else if ( format==GL_RGB )
+		pixelSize = 3;
+	else if ( format==GL_LUMINANCE_ALPHA )
+		pixelSize = 2;
+	else if ( format==GL_LUMINANCE || format==GL_ALPHA )
+		pixelSize = 1;
+	if ( width<=0 || height<=0 )
+		return 0;
+	unsigned int rowSize = width * pixelSize;
+	unsigned int alignment = static_cast<unsigned int>(gUnpackAlignment);
+	unsigned int paddedRowSize = (rowSize + alignment - 1) / alignment * alignment;
+	return paddedRowSize * (height - 1) + rowSize;
+}
+
+void endFrame()
+{
+	if ( !gFile )
+		return;
+	if ( gFrame>=gFirstFrame )
+		beginCommand( GLCapture::FrameEnd, FrameCommand );
+	gFrame++;
+	if ( gFrame==gFirstFrame )
+		beginCommand( GLCapture::CaptureStart, StateCommand );
+	if ( gFrame<gEndFrame )
+		return;
+	long size = ftell( gFile );
+	fclose( gFile );
+	gFile = NULL;
+	printf("GLCapture: frames %d to %d captured, %u commands, %ldKB\n", gFirstFrame, gEndFrame - 1, gCommandCount, size / 1024 );
+}
+
+}
+
+extern "C"
+{
+
+void glActiveTexture( GLenum texture )
+{
+	OGLES_GL_CAPTURE_REAL( glActiveTexture, void, (GLenum) );
+	if ( beginCommand( GLCapture::ActiveTexture, StateCommand ) )
+		writeUInt( texture );
+	real( texture );
+}
+
+void glAttachShader( GLuint program, GLuint shader )
+{
+	OGLES_GL_CAPTURE_REAL( glAttachShader, void, (GLuint, GLuint) );
+	if ( beginCommand( GLCapture::AttachShader, StateCommand ) )
+	{
+		writeUInt( program );
+		writeUInt( shader );
+	}
+	real( program, shader );
+}
+
+void glBindBuffer( GLenum target, GLuint buffer )
+{
+	OGLES_GL_CAPTURE_REAL( glBindBuffer, void, (GLenum, GLuint) );
+	if ( beginCommand( GLCapture::BindBuffer, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( buffer );
+	}
+	real( target, buffer );
+}
+
+void glBindFramebuffer( GLenum target, GLuint framebuffer )
+{
+	OGLES_GL_CAPTURE_REAL( glBindFramebuffer, void, (GLenum, GLuint) );
+	if ( beginCommand( GLCapture::BindFramebuffer, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( framebuffer );
+	}
+	real( target, framebuffer );
+}
+
+void glBindRenderbuffer( GLenum target, GLuint renderbuffer )
+{
+	OGLES_GL_CAPTURE_REAL( glBindRenderbuffer, void, (GLenum, GLuint) );
+	if ( beginCommand( GLCapture::BindRenderbuffer, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( renderbuffer );
+	}
+	real( target, renderbuffer );
+}
+
+void glBindTexture( GLenum target, GLuint texture )
+{
+	OGLES_GL_CAPTURE_REAL( glBindTexture, void, (GLenum, GLuint) );
+	if ( beginCommand( GLCapture::BindTexture, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( texture );
+	}
+	real( target, texture );
+}
+
+void glBlendFunc( GLenum sfactor, GLenum dfactor )
+{
+	OGLES_GL_CAPTURE_REAL( glBlendFunc, void, (GLenum, GLenum) );
+	if ( beginCommand( GLCapture::BlendFunc, StateCommand ) )
+	{
+		writeUInt( sfactor );
+		writeUInt( dfactor );
+	}
+	real( sfactor, dfactor );
+}
+
+void glBufferData( GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage )
+{
+	OGLES_GL_CAPTURE_REAL( glBufferData, void, (GLenum, GLsizeiptr, const GLvoid*, GLenum) );
+	if ( beginCommand( GLCapture::BufferData, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( static_cast<unsigned int>(size) );
+		writeData( data, static_cast<unsigned int>(size) );
+		writeUInt( usage );
+	}
+	real( target, size, data, usage );
+}
+
+void glBufferSubData( GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data )
+{
+	OGLES_GL_CAPTURE_REAL( glBufferSubData, void, (GLenum, GLintptr, GLsizeiptr, const GLvoid*) );
+	if ( beginCommand( GLCapture::BufferSubData, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( static_cast<unsigned int>(offset) );
+		writeData( data, static_cast<unsigned int>(size) );
+	}
+	real( target, offset, size, data );
+}
+
+GLenum glCheckFramebufferStatus( GLenum target )
+{
+	OGLES_GL_CAPTURE_REAL( glCheckFramebufferStatus, GLenum, (GLenum) );
+	if ( beginCommand( GLCapture::CheckFramebufferStatus, FrameCommand ) )
+		writeUInt( target );
+	return real( target );
+}
+
+void glClear( GLbitfield mask )
+{
+	OGLES_GL_CAPTURE_REAL( glClear, void, (GLbitfield) );
+	if ( beginCommand( GLCapture::Clear, FrameCommand ) )
+		writeUInt( mask );
+	real( mask );
+}
+
+void glClearColor( GLclampf red, GLclampf green, GLclampf blue, GLclampf alpha )
+{
+	OGLES_GL_CAPTURE_REAL( glClearColor, void, (GLclampf, GLclampf, GLclampf, GLclampf) );
+	if ( beginCommand( GLCapture::ClearColor, StateCommand ) )
+	{
+		writeFloat( red );
+		writeFloat( green );
+		writeFloat( blue );
+		writeFloat( alpha );
+	}
+	real( red, green, blue, alpha );
+}
+
+void glClearDepthf( GLclampf depth )
+{
+	OGLES_GL_CAPTURE_REAL( glClearDepthf, void, (GLclampf) );
+	if ( beginCommand( GLCapture::ClearDepthf, StateCommand ) )
+		writeFloat( depth );
+	real( depth );
+}
+
+void glCompileShader( GLuint shader )
+{
+	OGLES_GL_CAPTURE_REAL( glCompileShader, void, (GLuint) );
+	if ( beginCommand( GLCapture::CompileShader, StateCommand ) )
+		writeUInt( shader );
+	real( shader );
+}
+
+GLuint glCreateProgram( void )
+{
+	OGLES_GL_CAPTURE_REAL( glCreateProgram, GLuint, (void) );
+	GLuint program = real();
+	if ( beginCommand( GLCapture::CreateProgram, StateCommand ) )
+		writeUInt( program );
+	return program;
+}
+
+GLuint glCreateShader( GLenum type )
+{
+	OGLES_GL_CAPTURE_REAL( glCreateShader, GLuint, (GLenum) );
+	GLuint shader = real( type );
+	if ( beginCommand( GLCapture::CreateShader, StateCommand ) )
+	{
+		writeUInt( type );
+		writeUInt( shader );
+	}
+	return shader;
+}
+
+void glDeleteBuffers( GLsizei n, const GLuint* buffers )
+{
+	OGLES_GL_CAPTURE_REAL( glDeleteBuffers, void, (GLsizei, const GLuint*) );
+	if ( beginCommand( GLCapture::DeleteBuffers, StateCommand ) )
+		writeNames( n, buffers );
+	real( n, buffers );
+}
+
+void glDeleteFramebuffers( GLsizei n, const GLuint* framebuffers )
+{
+	OGLES_GL_CAPTURE_REAL( glDeleteFramebuffers, void, (GLsizei, const GLuint*) );
+	if ( beginCommand( GLCapture::DeleteFramebuffers, StateCommand ) )
+		writeNames( n, framebuffers );
+	real( n, framebuffers );
+}
+
+void glDeleteProgram( GLuint program )
+{
+	OGLES_GL_CAPTURE_REAL( glDeleteProgram, void, (GLuint) );
+	if ( beginCommand( GLCapture::DeleteProgram, StateCommand ) )
+		writeUInt( program );
+	real( program );
+}
+
+void glDeleteRenderbuffers( GLsizei n, const GLuint* renderbuffers )
+{
+	OGLES_GL_CAPTURE_REAL( glDeleteRenderbuffers, void, (GLsizei, const GLuint*) );
+	if ( beginCommand( GLCapture::DeleteRenderbuffers, StateCommand ) )
+		writeNames( n, renderbuffers );
+	real( n, renderbuffers );
+}
+
+void glDeleteShader( GLuint shader )
+{
+	OGLES_GL_CAPTURE_REAL( glDeleteShader, void, (GLuint) );
+	if ( beginCommand( GLCapture::DeleteShader, StateCommand ) )
+		writeUInt( shader );
+	real( shader );
+}
+
+void glDeleteTextures( GLsizei n, const GLuint* textures )
+{
+	OGLES_GL_CAPTURE_REAL( glDeleteTextures, void, (GLsizei, const GLuint*) );
+	if ( beginCommand( GLCapture::DeleteTextures, StateCommand ) )
+		writeNames( n, textures );
+	real( n, textures );
+}
+
+void glDepthFunc( GLenum func )
+{
+	OGLES_GL_CAPTURE_REAL( glDepthFunc, void, (GLenum) );
+	if ( beginCommand( GLCapture::DepthFunc, StateCommand ) )
+		writeUInt( func );
+	real( func );
+}
+
+void glDisable( GLenum cap )
+{
+	OGLES_GL_CAPTURE_REAL( glDisable, void, (GLenum) );
+	if ( beginCommand( GLCapture::Disable, StateCommand ) )
+		writeUInt( cap );
+	real( cap );
+}
+
+void glDisableVertexAttribArray( GLuint index )
+{
+	OGLES_GL_CAPTURE_REAL( glDisableVertexAttribArray, void, (GLuint) );
+	if ( beginCommand( GLCapture::DisableVertexAttribArray, StateCommand ) )
+		writeUInt( index );
+	real( index );
+}
+
+void glDrawArrays( GLenum mode, GLint first, GLsizei count )
+{
+	OGLES_GL_CAPTURE_REAL( glDrawArrays, void, (GLenum, GLint, GLsizei) );
+	if ( beginCommand( GLCapture::DrawArrays, FrameCommand ) )
+	{
+		writeUInt( mode );
+		writeInt( first );
+		writeInt( count );
+	}
+	real( mode, first, count );
+}
+
+// The indices come from the bound GL_ELEMENT_ARRAY_BUFFER, the pointer is an offset in it
+void glDrawElements( GLenum mode, GLsizei count, GLenum type, const GLvoid* indices )
+{
+	OGLES_GL_CAPTURE_REAL( glDrawElements, void, (GLenum, GLsizei, GLenum, const GLvoid*) );
+	if ( beginCommand( GLCapture::DrawElements, FrameCommand ) )
+	{
+		writeUInt( mode );
+		writeInt( count );
+		writeUInt( type );
+		writeUInt( static_cast<unsigned int>( reinterpret_cast<size_t>(indices) ) );
+	}
+	real( mode, count, type, indices );
+}
+
+void glEnable( GLenum cap )
+{
+	OGLES_GL_CAPTURE_REAL( glEnable, void, (GLenum) );
+	if ( beginCommand( GLCapture::Enable, StateCommand ) )
+		writeUInt( cap );
+	real( cap );
+}
+
+void glEnableVertexAttribArray( GLuint index )
+{
+	OGLES_GL_CAPTURE_REAL( glEnableVertexAttribArray, void, (GLuint) );
+	if ( beginCommand( GLCapture::EnableVertexAttribArray, StateCommand ) )
+		writeUInt( index );
+	real( index );
+}
+
+void glFinish( void )
+{
+	OGLES_GL_CAPTURE_REAL( glFinish, void, (void) );
+	beginCommand( GLCapture::Finish, FrameCommand );
+	real();
+}
+
+void glFlush( void )
+{
+	OGLES_GL_CAPTURE_REAL( glFlush, void, (void) );
+	beginCommand( GLCapture::Flush, FrameCommand );
+	real();
+}
+
+void glFramebufferRenderbuffer( GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer )
+{
+	OGLES_GL_CAPTURE_REAL( glFramebufferRenderbuffer, void, (GLenum, GLenum, GLenum, GLuint) );
+	if ( beginCommand( GLCapture::FramebufferRenderbuffer, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( attachment );
+		writeUInt( renderbuffertarget );
+		writeUInt( renderbuffer );
+	}
+	real( target, attachment, renderbuffertarget, renderbuffer );
+}
+
+void glFramebufferTexture2D( GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level )
+{
+	OGLES_GL_CAPTURE_REAL( glFramebufferTexture2D, void, (GLenum, GLenum, GLenum, GLuint, GLint) );
+	if ( beginCommand( GLCapture::FramebufferTexture2D, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( attachment );
+		writeUInt( textarget );
+		writeUInt( texture );
+		writeInt( level );
+	}
+	real( target, attachment, textarget, texture, level );
+}
+
+void glGenBuffers( GLsizei n, GLuint* buffers )
+{
+	OGLES_GL_CAPTURE_REAL( glGenBuffers, void, (GLsizei, GLuint*) );
+	real( n, buffers );
+	if ( beginCommand( GLCapture::GenBuffers, StateCommand ) )
+		writeNames( n, buffers );
+}
+
+void glGenFramebuffers( GLsizei n, GLuint* framebuffers )
+{
+	OGLES_GL_CAPTURE_REAL( glGenFramebuffers, void, (GLsizei, GLuint*) );
+	real( n, framebuffers );
+	if ( beginCommand( GLCapture::GenFramebuffers, StateCommand ) )
+		writeNames( n, framebuffers );
+}
+
+void glGenRenderbuffers( GLsizei n, GLuint* renderbuffers )
+{
+	OGLES_GL_CAPTURE_REAL( glGenRenderbuffers, void, (GLsizei, GLuint*) );
+	real( n, renderbuffers );
+	if ( beginCommand( GLCapture::GenRenderbuffers, StateCommand ) )
+		writeNames( n, renderbuffers );
+}
+
+void glGenTextures( GLsizei n, GLuint* textures )
+{
+	OGLES_GL_CAPTURE_REAL( glGenTextures, void, (GLsizei, GLuint*) );
+	real( n, textures );
+	if ( beginCommand( GLCapture::GenTextures, StateCommand ) )
+		writeNames( n, textures );
+}
+
+int glGetAttribLocation( GLuint program, const GLchar* name )
+{
+	OGLES_GL_CAPTURE_REAL( glGetAttribLocation, int, (GLuint, const GLchar*) );
+	int location = real( program, name );
+	if ( beginCommand( GLCapture::GetAttribLocation, StateCommand ) )
+	{
+		writeUInt( program );
+		writeString( name );
+		writeInt( location );
+	}
+	return location;
+}
+
+GLenum glGetError( void )
+{
+	OGLES_GL_CAPTURE_REAL( glGetError, GLenum, (void) );
+	beginCommand( GLCapture::GetError, FrameCommand );
+	return real();
+}
+
+void glGetProgramInfoLog( GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog )
+{
+	OGLES_GL_CAPTURE_REAL( glGetProgramInfoLog, void, (GLuint, GLsizei, GLsizei*, GLchar*) );
+	if ( beginCommand( GLCapture::GetProgramInfoLog, FrameCommand ) )
+	{
+		writeUInt( program );
+		writeInt( bufsize );
+	}
+	real( program, bufsize, length, infolog );
+}
+
+void glGetProgramiv( GLuint program, GLenum pname, GLint* params )
+{
+	OGLES_GL_CAPTURE_REAL( glGetProgramiv, void, (GLuint, GLenum, GLint*) );
+	if ( beginCommand( GLCapture::GetProgramiv, FrameCommand ) )
+	{
+		writeUInt( program );
+		writeUInt( pname );
+	}
+	real( program, pname, params );
+}
+
+void glGetShaderInfoLog( GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog )
+{
+	OGLES_GL_CAPTURE_REAL( glGetShaderInfoLog, void, (GLuint, GLsizei, GLsizei*, GLchar*) );
+	if ( beginCommand( GLCapture::GetShaderInfoLog, FrameCommand ) )
+	{
+		writeUInt( shader );
+		writeInt( bufsize );
+	}
+	real( shader, bufsize, length, infolog );
+}
+
+void glGetShaderiv( GLuint shader, GLenum pname, GLint* params )
+{
+	OGLES_GL_CAPTURE_REAL( glGetShaderiv, void, (GLuint, GLenum, GLint*) );
+	if ( beginCommand( GLCapture::GetShaderiv, FrameCommand ) )
+	{
+		writeUInt( shader );
+		writeUInt( pname );
+	}
+	real( shader, pname, params );
+}
+
+int glGetUniformLocation( GLuint program, const GLchar* name )
+{
+	OGLES_GL_CAPTURE_REAL( glGetUniformLocation, int, (GLuint, const GLchar*) );
+	int location = real( program, name );
+	if ( beginCommand( GLCapture::GetUniformLocation, StateCommand ) )
+	{
+		writeUInt( program );
+		writeString( name );
+		writeInt( location );
+	}
+	return location;
+}
+
+void glLinkProgram( GLuint program )
+{
+	OGLES_GL_CAPTURE_REAL( glLinkProgram, void, (GLuint) );
+	if ( beginCommand( GLCapture::LinkProgram, StateCommand ) )
+		writeUInt( program );
+	real( program );
+}
+
+void glPixelStorei( GLenum pname, GLint param )
+{
+	OGLES_GL_CAPTURE_REAL( glPixelStorei, void, (GLenum, GLint) );
+	if ( pname==GL_UNPACK_ALIGNMENT )
+		gUnpackAlignment = param;
+	if ( beginCommand( GLCapture::PixelStorei, StateCommand ) )
+	{
+		writeUInt( pname );
+		writeInt( param );
+	}
+	real( pname, param );
+}
+
+void glReadPixels( GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, GLvoid* pixels )
+{
+	OGLES_GL_CAPTURE_REAL( glReadPixels, void, (GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid*) );
+	if ( beginCommand( GLCapture::ReadPixels, FrameCommand ) )
+	{
+		writeInt( x );
+		writeInt( y );
+		writeInt( width );
+		writeInt( height );
+		writeUInt( format );
+		writeUInt( type );
+	}
+	real( x, y, width, height, format, type, pixels );
+}
+
+void glRenderbufferStorage( GLenum target, GLenum internalformat, GLsizei width, GLsizei height )
+{
+	OGLES_GL_CAPTURE_REAL( glRenderbufferStorage, void, (GLenum, GLenum, GLsizei, GLsizei) );
+	if ( beginCommand( GLCapture::RenderbufferStorage, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( internalformat );
+		writeInt( width );
+		writeInt( height );
+	}
+	real( target, internalformat, width, height );
+}
+
+void glScissor( GLint x, GLint y, GLsizei width, GLsizei height )
+{
+	OGLES_GL_CAPTURE_REAL( glScissor, void, (GLint, GLint, GLsizei, GLsizei) );
+	if ( beginCommand( GLCapture::Scissor, StateCommand ) )
+	{
+		writeInt( x );
+		writeInt( y );
+		writeInt( width );
+		writeInt( height );
+	}
+	real( x, y, width, height );
+}
+
+// The strings are written one after the other, their lengths resolved
+void glShaderSource( GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length )
+{
+	OGLES_GL_CAPTURE_REAL( glShaderSource, void, (GLuint, GLsizei, const GLchar* const*, const GLint*) );
+	if ( beginCommand( GLCapture::ShaderSource, StateCommand ) )
+	{
+		writeUInt( shader );
+		writeInt( count );
+		for ( GLsizei i=0; i<count; ++i )
+		{
+			if ( length && length[i]>=0 )
+				writeData( string[i], static_cast<unsigned int>(length[i]) );
+			else
+				writeString( string[i] );
+		}
+	}
+	real( shader, count, string, length );
+}
+
+void glTexImage2D( GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* pixels )
+{
+	OGLES_GL_CAPTURE_REAL( glTexImage2D, void, (GLenum, GLint, GLint, GLsizei, GLsizei, GLint, GLenum, GLenum, const GLvoid*) );
+	if ( beginCommand( GLCapture::TexImage2D, StateCommand ) )
+	{
+		writeUInt( target );
+		writeInt( level );
+		writeInt( internalformat );
+		writeInt( width );
+		writeInt( height );
+		writeInt( border );
+		writeUInt( format );
+		writeUInt( type );
+		writeData( pixels, getImageSize( width, height, format, type ) );
+	}
+	real( target, level, internalformat, width, height, border, format, type, pixels );
+}
+
+void glTexParameterf( GLenum target, GLenum pname, GLfloat param )
+{
+	OGLES_GL_CAPTURE_REAL( glTexParameterf, void, (GLenum, GLenum, GLfloat) );
+	if ( beginCommand( GLCapture::TexParameterf, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( pname );
+		writeFloat( param );
+	}
+	real( target, pname, param );
+}
+
+void glTexParameteri( GLenum target, GLenum pname, GLint param )
+{
+	OGLES_GL_CAPTURE_REAL( glTexParameteri, void, (GLenum, GLenum, GLint) );
+	if ( beginCommand( GLCapture::TexParameteri, StateCommand ) )
+	{
+		writeUInt( target );
+		writeUInt( pname );
+		writeInt( param );
+	}
+	real( target, pname, param );
+}
+
+void glUniform1i( GLint location, GLint x )
+{
+	OGLES_GL_CAPTURE_REAL( glUniform1i, void, (GLint, GLint) );
+	if ( beginCommand( GLCapture::Uniform1i, StateCommand ) )
+	{
+		writeInt( location );
+		writeInt( x );
+	}
+	real( location, x );
+}
+
+void glUniform2f( GLint location, GLfloat x, GLfloat y )
+{
+	OGLES_GL_CAPTURE_REAL( glUniform2f, void, (GLint, GLfloat, GLfloat) );
+	if ( beginCommand( GLCapture::Uniform2f, StateCommand ) )
+	{
+		writeInt( location );
+		writeFloat( x );
+		writeFloat( y );
+	}
+	real( location, x, y );
+}
+
+void glUniform2fv( GLint location, GLsizei count, const GLfloat* v )
+{
+	OGLES_GL_CAPTURE_REAL( glUniform2fv, void, (GLint, GLsizei, const GLfloat*) );
+	if ( beginCommand( GLCapture::Uniform2fv, StateCommand ) )
+	{
+		writeInt( location );
+		writeInt( count );
+		writeData( v, count * 2 * sizeof(GLfloat) );
+	}
+	real( location, count, v );
+}
+
+void glUniform4fv( GLint location, GLsizei count, const GLfloat* v )
+{
+	OGLES_GL_CAPTURE_REAL( glUniform4fv, void, (GLint, GLsizei, const GLfloat*) );
+	if ( beginCommand( GLCapture::Uniform4fv, StateCommand ) )
+	{
+		writeInt( location );
+		writeInt( count );
+		writeData( v, count * 4 * sizeof(GLfloat) );
+	}
+	real( location, count, v );
+}
+
+void glUniformMatrix4fv( GLint location, GLsizei count, GLboolean transpose, const GLfloat* value )
+{
+	OGLES_GL_CAPTURE_REAL( glUniformMatrix4fv, void, (GLint, GLsizei, GLboolean, const GLfloat*) );
+	if ( beginCommand( GLCapture::UniformMatrix4fv, StateCommand ) )
+	{
+		writeInt( location );
+		writeInt( count );
+		writeUInt( transpose );
+		writeData( value, count * 16 * sizeof(GLfloat) );
+	}
+	real( location, count, transpose, value );
+}
+
+void glUseProgram( GLuint program )
+{
+	OGLES_GL_CAPTURE_REAL( glUseProgram, void, (GLuint) );
+	if ( beginCommand( GLCapture::UseProgram, StateCommand ) )
+		writeUInt( program );
+	real( program );
+}
+
+// The data comes from the bound GL_ARRAY_BUFFER, the pointer is an offset in it
+void glVertexAttribPointer( GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* ptr )
+{
+	OGLES_GL_CAPTURE_REAL( glVertexAttribPointer, void, (GLuint, GLint, GLenum, GLboolean, GLsizei, const GLvoid*) );
+	if ( beginCommand( GLCapture::VertexAttribPointer, StateCommand ) )
+	{
+		writeUInt( indx );
+		writeInt( size );
+		writeUInt( type );
+		writeUInt( normalized );
+		writeInt( stride );
+		writeUInt( static_cast<unsigned int>( reinterpret_cast<size_t>(ptr) ) );
+	}
+	real( indx, size, type, normalized, stride, ptr );
+}
+
+void glViewport( GLint x, GLint y, GLsizei width, GLsizei height )
+{
+	OGLES_GL_CAPTURE_REAL( glViewport, void, (GLint, GLint, GLsizei, GLsizei) );
+	if ( beginCommand( GLCapture::Viewport, StateCommand ) )
+	{
+		writeInt( x );
+		writeInt( y );
+		writeInt( width );
+		writeInt( height );
+	}
+	real( x, y, width, height );
+}
+
+EGLBoolean eglSwapBuffers( EGLDisplay dpy, EGLSurface surface )
+{
+	typedef EGLBoolean (*RealFunction)( EGLDisplay, EGLSurface );
+	static RealFunction real = reinterpret_cast<RealFunction>( getRealFunction( "eglSwapBuffers" ) );
+	endFrame();
+	return real( dpy, surface );
+}
+
+}
+
+#endif
+
+namespace OGLESSandbox
+{
+
+bool GLCapture::isCompiledIn()
+{
+#ifdef OGLES_GL_CAPTURE_INTERPOSE
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool GLCapture::start( const std::string& path, int firstFrame, int frameCount )
+{
+#ifdef OGLES_GL_CAPTURE_INTERPOSE
+	if ( gFile || gFrame>0 )
+	{
+		printf("GLCapture: can only be started once, before the first frame\n");
+		return false;
+	}
+	if ( firstFrame<0 || frameCount<=0 )
+	{
+		printf("GLCapture: invalid frame range %d (+%d)\n", firstFrame, frameCount );
+		return false;
+	}
+	gFile = fopen( path.c_str(), "wb" );
+	if ( !gFile )
+	{
+		printf("GLCapture: can't open %s\n", path.c_str() );
+		return false;
+	}
+	setvbuf( gFile, NULL, _IOFBF, 1 << 20 );
+	Header header;
+	memcpy( header.magic, "OGLESCAP", sizeof(header.magic) );
+	header.version = Version;
+	header.firstFrame = firstFrame;
+	header.frameCount = frameCount;
+	fwrite( &header, sizeof(header), 1, gFile );
+	gFirstFrame = firstFrame;
+	gEndFrame = firstFrame + frameCount;
+	gCommandCount = 0;
+	if ( gFirstFrame==0 )
+		beginCommand( CaptureStart, StateCommand );
+	printf("GLCapture: capturing frames %d to %d into %s\n", gFirstFrame, gEndFrame - 1, path.c_str() );
+	return true;
+#else
+	printf("GLCapture: not compiled in (ENABLE_GL_CAPTURE CMake option, Linux only)\n");
+	return false;
+#endif
+}
+
+bool GLCapture::isCapturing()
+{
+#ifdef OGLES_GL_CAPTURE_INTERPOSE
+	return gFile!=NULL;
+#else
+	return false;
+#endif
+}
+
+}
@@ -0,0 +1,141 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <string>
+
+namespace OGLESSandbox
+{
+
+/*
+	GLCapture
+
+	Records the GL ES 2 commands of a range of frames into a file, for GLReplay to play 
+	them back without the application around them. 
+	When compiled in (ENABLE_GL_CAPTURE CMake option, Linux only) OGLESGLCapture.cpp 
+	defines the gl functions the sandbox uses and eglSwapBuffers: the calls of the 
+	executable land there and are forwarded to the library found next (dlsym RTLD_NEXT).
+	The capture must be started before the context is created. Until the first captured 
+	frame only the commands that change the GL state are written (creating the objects, 
+	uploading buffers and textures, binding, setting uniforms...) so that the replayer 
+	can rebuild the state the frames start from. A frame ends with eglSwapBuffers.
+	Vertices and indices must come from buffer objects, client side arrays aren't captured.
+
+	The file starts with the Header, followed by the commands. A command is a 32-bit 
+	Command followed by its arguments, each one 32 bits. Arrays and strings are a size 
+	in bytes (NullData for a NULL pointer) followed by the data padded to 32 bits. The 
+	names returned by glGen*, glCreate* and the locations returned by glGet*Location 
+	are written after the call so that the replayer can map them to its own.
+*/
+class GLCapture
+{
+public:
+	enum Command
+	{
+		ActiveTexture,
+		AttachShader,
+		BindBuffer,
+		BindFramebuffer,
+		BindRenderbuffer,
+		BindTexture,
+		BlendFunc,
+		BufferData,
+		BufferSubData,
+		CheckFramebufferStatus,
+		Clear,
+		ClearColor,
+		ClearDepthf,
+		CompileShader,
+		CreateProgram,
+		CreateShader,
+		DeleteBuffers,
+		DeleteFramebuffers,
+		DeleteProgram,
+		DeleteRenderbuffers,
+		DeleteShader,
+		DeleteTextures,
+		DepthFunc,
+		Disable,
+		DisableVertexAttribArray,
+		DrawArrays,
+		DrawElements,
+		Enable,
+		EnableVertexAttribArray,
+		Finish,
+		Flush,
+		FramebufferRenderbuffer,
+		FramebufferTexture2D,
+		GenBuffers,
+		GenFramebuffers,
+		GenRenderbuffers,
+		GenTextures,
+		GetAttribLocation,
+		GetError,
+		GetProgramInfoLog,
+		GetProgramiv,
+		GetShaderInfoLog,
+		GetShaderiv,
+		GetUniformLocation,
+		LinkProgram,
+		PixelStorei,
+		ReadPixels,
+		RenderbufferStorage,
+		Scissor,
+		ShaderSource,
+		TexImage2D,
+		TexParameterf,
+		TexParameteri,
+		Uniform1i,
+		Uniform2f,
+		Uniform2fv,
+		Uniform4fv,
+		UniformMatrix4fv,
+		UseProgram,
+		VertexAttribPointer,
+		Viewport,
+		CaptureStart,			// The state is set up, the captured frames follow
+		FrameEnd,				// eglSwapBuffers
+		CommandCount
+	};
+
+	enum
+	{
+		Version = 1,
+		NullData = 0xffffffff
+	};
+
+	struct Header
+	{
+		char			magic[8];			// "OGLESCAP"
+		unsigned int	version;
+		unsigned int	firstFrame;
+		unsigned int	frameCount;
+	};
+
+	static bool		isCompiledIn();
+	static bool		start( const std::string& path, int firstFrame, int frameCount );
+	static bool		isCapturing();
+};
+
+}
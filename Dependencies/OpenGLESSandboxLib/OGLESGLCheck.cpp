@@ -0,0 +1,120 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESGLCheck.h"
+
+#include <stdio.h>
+
+#include "GLES2/gl2.h"
+#include "OGLESTrace.h"
+
+namespace OGLESSandbox
+{
+
+namespace
+{
+
+GLCheck::Level		gLevel = GLCheck::Off;
+unsigned int		gCheckCount = 0;
+unsigned long long	gCheckTime = 0;
+unsigned int		gErrorCount = 0;
+
+// Returns the first error. The GL can hold several error flags, all of them are cleared
+GLenum getErrors()
+{
+	unsigned long long startTime = Trace::getTime();
+	GLenum firstError = glGetError();
+	if ( firstError!=GL_NO_ERROR )
+	{
+		for ( int i=0; i<8 && glGetError()!=GL_NO_ERROR; ++i )
+		{
+		}
+		gErrorCount++;
+	}
+	gCheckCount++;
+	gCheckTime += Trace::getTime() - startTime;
+	return firstError;
+}
+
+}
+
+bool GLCheck::isCompiledIn()
+{
+#ifdef OGLES_GL_CHECK_ENABLED
+	return true;
+#else
+	return false;
+#endif
+}
+
+void GLCheck::setLevel( Level level )
+{
+	gLevel = level;
+}
+
+GLCheck::Level GLCheck::getLevel()
+{
+	return gLevel;
+}
+
+void GLCheck::checkCall( const char* file, int line )
+{
+	if ( gLevel<PerCall )
+		return;
+	GLenum error = getErrors();
+	if ( error!=GL_NO_ERROR )
+		printf("GL error 0x%04x at %s:%d\n", error, file, line );
+}
+
+void GLCheck::checkPass( const char* name )
+{
+	if ( gLevel<PerPass )
+		return;
+	GLenum error = getErrors();
+	if ( error!=GL_NO_ERROR )
+		printf("GL error 0x%04x in pass %s\n", error, name );
+}
+
+unsigned int GLCheck::getCheckCount()
+{
+	return gCheckCount;
+}
+
+unsigned long long GLCheck::getCheckTime()
+{
+	return gCheckTime;
+}
+
+unsigned int GLCheck::getErrorCount()
+{
+	return gErrorCount;
+}
+
+void GLCheck::resetStats()
+{
+	gCheckCount = 0;
+	gCheckTime = 0;
+	gErrorCount = 0;
+}
+
+}
@@ -0,0 +1,79 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+/*
+	GL error checks
+
+	OGLES_GL_CHECK() goes after a GL call and OGLES_GL_CHECK_PASS("name") at the end of a 
+	rendering pass. What they do depends on the level set at runtime: nothing (Off), only 
+	the pass checks (PerPass), or both (PerCall), the call checks reporting the file and 
+	line of the failing call. glGetError() makes most drivers catch up with the commands 
+	queued so far, which is why they're off by default. Unless OGLES_GL_CHECK_ENABLED is 
+	defined (ENABLE_GL_CHECK CMake option) both expand to nothing.
+*/
+#ifdef OGLES_GL_CHECK_ENABLED
+	#define OGLES_GL_CHECK()				OGLESSandbox::GLCheck::checkCall( __FILE__, __LINE__ )
+	#define OGLES_GL_CHECK_PASS(name)		OGLESSandbox::GLCheck::checkPass( name )
+#else
+	#define OGLES_GL_CHECK()				((void)0)
+	#define OGLES_GL_CHECK_PASS(name)		((void)0)
+#endif
+
+namespace OGLESSandbox
+{
+
+/*
+	GLCheck
+
+	Behind the macros above. Errors are printed, not asserted, so that they're seen in 
+	release builds too. The number of glGetError() calls and the time spent in them are 
+	accumulated (until resetStats()) to measure what each level costs. 
+	To be used from the thread owning the GL context only.
+*/
+class GLCheck
+{
+public:
+	enum Level
+	{
+		Off,
+		PerPass,
+		PerCall,
+		LevelCount
+	};
+
+	static bool			isCompiledIn();
+	static void			setLevel( Level level );
+	static Level		getLevel();
+
+	static void			checkCall( const char* file, int line );
+	static void			checkPass( const char* name );
+
+	static unsigned int	getCheckCount();
+	static unsigned long long getCheckTime();		// In microseconds
+	static unsigned int	getErrorCount();
+	static void			resetStats();
+};
+
+}
@@ -0,0 +1,377 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESParameterRegistry.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <fstream>
+
+#ifdef __linux__
+	#include <sys/inotify.h>
+	#include <unistd.h>
+	#include <limits.h>
+#endif
+
+namespace OGLESSandbox
+{
+
+ParameterRegistry::ParameterRegistry()
+	: mParameters()
+{
+}
+
+void ParameterRegistry::addInt( const std::string& name, int* variable, DependencyMask dependencies, const std::string& description )
+{
+	add( name, IntType, variable, dependencies, description );
+}
+
+void ParameterRegistry::addFloat( const std::string& name, float* variable, DependencyMask dependencies, const std::string& description )
+{
+	add( name, FloatType, variable, dependencies, description );
+}
+
+void ParameterRegistry::addBool( const std::string& name, bool* variable, DependencyMask dependencies, const std::string& description )
+{
+	add( name, BoolType, variable, dependencies, description );
+}
+
+void ParameterRegistry::addString( const std::string& name, std::string* variable, DependencyMask dependencies, const std::string& description )
+{
+	add( name, StringType, variable, dependencies, description );
+}
+
+void ParameterRegistry::add( const std::string& name, Type type, void* variable, DependencyMask dependencies, const std::string& description )
+{
+	Parameter parameter;
+	parameter.name = name;
+	parameter.type = type;
+	parameter.variable = variable;
+	parameter.dependencies = dependencies;
+	parameter.description = description;
+	parameter.pending = false;
+	parameter.pendingInt = 0;
+	parameter.pendingFloat = 0.f;
+	mParameters.push_back( parameter );
+}
+
+ParameterRegistry::Parameter* ParameterRegistry::find( const std::string& name )
+{
+	// Command line style names are accepted too
+	std::string shortName = name;
+	if ( shortName.compare( 0, 2, "--" )==0 )
+		shortName = shortName.substr( 2 );
+	for ( std::size_t i=0; i<mParameters.size(); ++i )
+		if ( mParameters[i].name==shortName )
+			return &mParameters[i];
+	return NULL;
+}
+
+bool ParameterRegistry::parse( Parameter& parameter, const std::string& value )
+{
+	// An invalid value leaves the pending one, if any, untouched
+	const char* text = value.c_str();
+	char* end = NULL;
+	switch ( parameter.type )
+	{
+		case IntType:
+		{
+			errno = 0;
+			long intValue = strtol( text, &end, 10 );
+			if ( errno!=0 || end==text || *end!='\0' )
+				return false;
+			parameter.pendingInt = static_cast<int>( intValue );
+			return true;
+		}
+		
+		case FloatType:
+		{
+			errno = 0;
+			double floatValue = strtod( text, &end );
+			if ( errno!=0 || end==text || *end!='\0' )
+				return false;
+			parameter.pendingFloat = static_cast<float>( floatValue );
+			return true;
+		}
+		
+		case BoolType:
+			if ( value=="1" || value=="true" )
+				parameter.pendingInt = 1;
+			else if ( value=="0" || value=="false" )
+				parameter.pendingInt = 0;
+			else
+				return false;
+			return true;
+
+		case StringType:
+			parameter.pendingString = value;
+			return true;
+	}
+	return false;
+}
+
+bool ParameterRegistry::set( const std::string& name, const std::string& value )
+{
+	Parameter* parameter = find( name );
+	if ( !parameter )
+	{
+		printf("Parameter %s is not supported\n", name.c_str() );
+		return false;
+	}
+	if ( !parse( *parameter, value ) )
+	{
+		printf("Parameter %s: invalid value '%s'\n", name.c_str(), value.c_str() );
+		return false;
+	}
+	parameter->pending = true;
+	return true;
+}
+
+void ParameterRegistry::setFromParameters( const std::vector< std::pair<std::string, std::string> >& parameters )
+{
+	// The first one is the program name
+	for ( std::size_t i=1; i<parameters.size(); ++i )
+		set( parameters[i].first, parameters[i].second );
+}
+
+std::string ParameterRegistry::trim( const std::string& text )
+{
+	const char* whiteSpaces = " \t\r\n";
+	std::size_t first = text.find_first_not_of( whiteSpaces );
+	if ( first==std::string::npos )
+		return "";
+	std::size_t last = text.find_last_not_of( whiteSpaces );
+	return text.substr( first, last-first+1 );
+}
+
+bool ParameterRegistry::loadFromFile( const std::string& path )
+{
+	std::ifstream file( path.c_str() );
+	if ( !file )
+	{
+		printf("Can't open parameter file %s\n", path.c_str() );
+		return false;
+	}
+	
+	bool ok = true;
+	std::string line;
+	int lineIndex = 0;
+	while ( std::getline( file, line ) )
+	{
+		lineIndex++;
+		std::size_t commentPos = line.find( '#' );
+		if ( commentPos!=std::string::npos )
+			line = line.substr( 0, commentPos );
+		line = trim( line );
+		if ( line.empty() )
+			continue;
+		std::size_t equalPos = line.find( '=' );
+		if ( equalPos==std::string::npos )
+		{
+			printf("%s(%d): expected Name=Value\n", path.c_str(), lineIndex );
+			ok = false;
+			continue;
+		}
+		if ( !set( trim( line.substr(0, equalPos) ), trim( line.substr(equalPos+1) ) ) )
+			ok = false;
+	}
+	return ok;
+}
+
+ParameterRegistry::DependencyMask ParameterRegistry::applyPendingChanges()
+{
+	DependencyMask changes = 0;
+	for ( std::size_t i=0; i<mParameters.size(); ++i )
+	{
+		Parameter& parameter = mParameters[i];
+		if ( !parameter.pending )
+			continue;
+		parameter.pending = false;
+
+		bool changed = false;
+		switch ( parameter.type )
+		{
+			case IntType:
+			{
+				int* variable = static_cast<int*>(parameter.variable);
+				changed = *variable!=parameter.pendingInt;
+				*variable = parameter.pendingInt;
+				break;
+			}
+			case FloatType:
+			{
+				float* variable = static_cast<float*>(parameter.variable);
+				changed = *variable!=parameter.pendingFloat;
+				*variable = parameter.pendingFloat;
+				break;
+			}
+			case BoolType:
+			{
+				bool* variable = static_cast<bool*>(parameter.variable);
+				changed = *variable!=(parameter.pendingInt!=0);
+				*variable = parameter.pendingInt!=0;
+				break;
+			}
+			case StringType:
+			{
+				std::string* variable = static_cast<std::string*>(parameter.variable);
+				changed = *variable!=parameter.pendingString;
+				*variable = parameter.pendingString;
+				break;
+			}
+		}
+		if ( changed )
+			changes |= parameter.dependencies;
+	}
+	return changes;
+}
+
+void ParameterRegistry::print() const
+{
+	for ( std::size_t i=0; i<mParameters.size(); ++i )
+	{
+		const Parameter& parameter = mParameters[i];
+		switch ( parameter.type )
+		{
+			case IntType:
+				printf("%s: %d\n", parameter.name.c_str(), *static_cast<const int*>(parameter.variable) );
+				break;
+			case FloatType:
+				printf("%s: %f\n", parameter.name.c_str(), *static_cast<const float*>(parameter.variable) );
+				break;
+			case BoolType:
+				printf("%s: %d\n", parameter.name.c_str(), *static_cast<const bool*>(parameter.variable) ? 1 : 0 );
+				break;
+			case StringType:
+				printf("%s: %s\n", parameter.name.c_str(), static_cast<const std::string*>(parameter.variable)->c_str() );
+				break;
+		}
+	}
+}
+
+ParameterFileWatcher::ParameterFileWatcher()
+	: mPath(),
+	  mFileName(),
+	  mInotifyFd(-1),
+	  mWatchDescriptor(-1),
+	  mLastModificationTime(0),
+	  mLastPollTime(0)
+{
+}
+
+ParameterFileWatcher::~ParameterFileWatcher()
+{
+	close();
+}
+
+void ParameterFileWatcher::close()
+{
+#ifdef __linux__
+	if ( mInotifyFd>=0 )
+		::close( mInotifyFd );
+#endif
+	mInotifyFd = -1;
+	mWatchDescriptor = -1;
+}
+
+bool ParameterFileWatcher::watch( const std::string& path )
+{
+	close();
+	mPath = path;
+	if ( mPath.empty() )
+		return false;
+	
+	std::size_t slashPos = path.find_last_of( "/\\" );
+	std::string directory = slashPos==std::string::npos ? "." : path.substr( 0, slashPos );
+	mFileName = slashPos==std::string::npos ? path : path.substr( slashPos+1 );
+
+	struct stat fileStat;
+	mLastModificationTime = stat( mPath.c_str(), &fileStat )==0 ? static_cast<long>(fileStat.st_mtime) : 0;
+
+#ifdef __linux__
+	// Watch the directory rather than the file: many editors save by writing a new file and renaming it. 
+	// Only complete files are of interest, not one just created and still empty
+	mInotifyFd = inotify_init1( IN_NONBLOCK );
+	if ( mInotifyFd<0 )
+	{
+		printf("ParameterFileWatcher: inotify_init1 failed (%d)\n", errno );
+		return false;
+	}
+	mWatchDescriptor = inotify_add_watch( mInotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO );
+	if ( mWatchDescriptor<0 )
+	{
+		printf("ParameterFileWatcher: can't watch %s (%d)\n", directory.c_str(), errno );
+		close();
+		return false;
+	}
+#endif
+	printf("Watching parameter file %s\n", mPath.c_str() );
+	return true;
+}
+
+bool ParameterFileWatcher::hasChanged()
+{
+	if ( mPath.empty() )
+		return false;
+
+#ifdef __linux__
+	if ( mInotifyFd<0 )
+		return false;
+	
+	bool changed = false;
+	char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));		// The events are read in place
+	while ( true )
+	{
+		ssize_t length = read( mInotifyFd, buffer, sizeof(buffer) );
+		if ( length<=0 )
+			break;		// EAGAIN: nothing more to read
+		for ( ssize_t offset=0; offset<length; )
+		{
+			const struct inotify_event* event = reinterpret_cast<const struct inotify_event*>( buffer + offset );
+			if ( event->len>0 && mFileName==event->name )
+				changed = true;
+			offset += sizeof(struct inotify_event) + event->len;
+		}
+	}
+	return changed;
+#else
+	// No inotify: look at the modification time, at most once per second
+	long now = static_cast<long>( time(NULL) );
+	if ( now==mLastPollTime )
+		return false;
+	mLastPollTime = now;
+	struct stat fileStat;
+	if ( stat( mPath.c_str(), &fileStat )!=0 )
+		return false;
+	long modificationTime = static_cast<long>(fileStat.st_mtime);
+	if ( modificationTime==mLastModificationTime )
+		return false;
+	mLastModificationTime = modificationTime;
+	return true;
+#endif
+}
+
+}
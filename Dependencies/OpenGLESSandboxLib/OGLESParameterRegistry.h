@@ -0,0 +1,123 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+/*
+	ParameterRegistry
+
+	Typed parameters bound to variables of the application. Each parameter comes 
+	with a mask of dependencies whose meaning is left to the application (for example
+	"the shaders must be rebuilt"). 
+	
+	Values can come from the command line or from a text file of Name=Value lines 
+	(with or without the leading --, # starts a comment). They are parsed and checked 
+	as soon as they're set but only stored into the variables by applyPendingChanges(), 
+	which lets the application pick the moment, typically a frame boundary, and 
+	rebuild only what depends on the parameters that actually changed.
+*/
+class ParameterRegistry
+{
+public:
+	typedef unsigned int DependencyMask;
+
+	ParameterRegistry();
+
+	void	addInt( const std::string& name, int* variable, DependencyMask dependencies, const std::string& description );
+	void	addFloat( const std::string& name, float* variable, DependencyMask dependencies, const std::string& description );
+	void	addBool( const std::string& name, bool* variable, DependencyMask dependencies, const std::string& description );
+	void	addString( const std::string& name, std::string* variable, DependencyMask dependencies, const std::string& description );
+
+	bool	set( const std::string& name, const std::string& value );
+	void	setFromParameters( const std::vector< std::pair<std::string, std::string> >& parameters );
+	bool	loadFromFile( const std::string& path );
+
+	// Store the pending values into their variables. Returns the dependencies of the parameters whose value changed
+	DependencyMask	applyPendingChanges();
+	
+	void	print() const;
+
+private:
+	enum Type
+	{
+		IntType,
+		FloatType,
+		BoolType,
+		StringType
+	};
+
+	struct Parameter
+	{
+		std::string		name;
+		Type			type;
+		void*			variable;
+		DependencyMask	dependencies;
+		std::string		description;
+		bool			pending;
+		int				pendingInt;			// Also used for bools
+		float			pendingFloat;
+		std::string		pendingString;
+	};
+
+	void			add( const std::string& name, Type type, void* variable, DependencyMask dependencies, const std::string& description );
+	Parameter*		find( const std::string& name );
+	static bool		parse( Parameter& parameter, const std::string& value );
+	static std::string	trim( const std::string& text );
+
+	std::vector<Parameter>	mParameters;
+};
+
+/*
+	ParameterFileWatcher
+
+	Tells when a file has been written. Uses inotify on Linux and polls the 
+	modification time elsewhere. hasChanged() never blocks and is cheap enough 
+	to be called every frame.
+*/
+class ParameterFileWatcher
+{
+public:
+	ParameterFileWatcher();
+	~ParameterFileWatcher();
+
+	bool	watch( const std::string& path );		// An empty path stops watching
+	bool	hasChanged();
+
+private:
+	void	close();
+
+	std::string	mPath;
+	std::string	mFileName;
+	int			mInotifyFd;
+	int			mWatchDescriptor;
+	long		mLastModificationTime;
+	long		mLastPollTime;
+};
+
+}
@@ -0,0 +1,2060 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESSoftwareGL.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#ifdef OGLES_SOFTWARE_GL_ENABLED
+	// The Raspberry Pi gl2.h has no const in the glShaderSource declaration, unlike Mesa's. 
+	// The header's declaration is renamed out of the way of the definition below
+	#define glShaderSource glShaderSourceDeclaration
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#undef glShaderSource
+#endif
+
+namespace OGLESSandbox
+{
+
+SoftwareSampler::SoftwareSampler()
+	: texels(NULL),
+	  width(0),
+	  height(0),
+	  linear(false),
+	  repeatS(false),
+	  repeatT(false)
+{
+}
+
+static inline int wrapTexel( int texel, int size, bool repeat )
+{
+	if ( repeat )
+	{
+		texel %= size;
+		return texel<0 ? texel + size : texel;
+	}
+	if ( texel<0 )
+		return 0;
+	if ( texel>=size )
+		return size - 1;
+	return texel;
+}
+
+// Same computation as the nearest texel lookup of DistortionReference
+static inline int nearestTexel( float coord, int size, bool repeat )
+{
+	if ( coord!=coord )
+		return 0;
+	return wrapTexel( static_cast<int>( floorf( coord * static_cast<float>(size) ) ), size, repeat );
+}
+
+void SoftwareSampler::sample( float s, float t, float color[4] ) const
+{
+	if ( !texels )
+	{
+		color[0] = 0.f;
+		color[1] = 0.f;
+		color[2] = 0.f;
+		color[3] = 1.f;
+		return;
+	}
+
+	if ( !linear )
+	{
+		int x = nearestTexel( s, width, repeatS );
+		int y = nearestTexel( t, height, repeatT );
+		const unsigned char* texel = texels + (y*width + x)*4;
+		for ( int i=0; i<4; ++i )
+			color[i] = static_cast<float>(texel[i]) / 255.f;
+		return;
+	}
+
+	float u = s * static_cast<float>(width) - 0.5f;
+	float v = t * static_cast<float>(height) - 0.5f;
+	if ( u!=u || v!=v )
+		u = v = 0.f;
+	float u0 = floorf( u );
+	float v0 = floorf( v );
+	float a = u - u0;
+	float b = v - v0;
+	int x0 = wrapTexel( static_cast<int>(u0), width, repeatS );
+	int x1 = wrapTexel( static_cast<int>(u0) + 1, width, repeatS );
+	int y0 = wrapTexel( static_cast<int>(v0), height, repeatT );
+	int y1 = wrapTexel( static_cast<int>(v0) + 1, height, repeatT );
+	const unsigned char* t00 = texels + (y0*width + x0)*4;
+	const unsigned char* t10 = texels + (y0*width + x1)*4;
+	const unsigned char* t01 = texels + (y1*width + x0)*4;
+	const unsigned char* t11 = texels + (y1*width + x1)*4;
+	for ( int i=0; i<4; ++i )
+	{
+		float bottom = static_cast<float>(t00[i]) + (static_cast<float>(t10[i]) - static_cast<float>(t00[i])) * a;
+		float top = static_cast<float>(t01[i]) + (static_cast<float>(t11[i]) - static_cast<float>(t01[i])) * a;
+		color[i] = (bottom + (top - bottom) * b) / 255.f;
+	}
+}
+
+#ifdef OGLES_SOFTWARE_GL_ENABLED
+
+namespace
+{
+
+enum 
+{ 
+	MaxTextureUnits = 8,
+	SubPixelBits = 4,					// Vertex positions are snapped to 1/16th of a pixel
+	SubPixelScale = 1 << SubPixelBits,
+	MaxClipVertices = 9					// A triangle clipped by the 6 planes below
+};
+
+// Triangles are clipped to the near and far planes, and to a guard band of GuardBand times the 
+// viewport around it (what's left outside the viewport is only skipped by the rasterizer)
+const float GuardBand = 4.f;
+
+struct Buffer
+{
+	std::vector<unsigned char>	data;
+};
+
+struct Texture
+{
+	Texture()
+		: width(0), height(0), hasAlpha(true), texels(), 
+		  magFilter(GL_LINEAR), wrapS(GL_REPEAT), wrapT(GL_REPEAT)
+	{
+	}
+
+	int							width;
+	int							height;
+	bool						hasAlpha;		// The alpha channel is kept at 255 for the formats without one
+	std::vector<unsigned char>	texels;			// RGBA, bottom row first
+	GLenum						magFilter;
+	GLenum						wrapS;
+	GLenum						wrapT;
+};
+
+struct Renderbuffer
+{
+	Renderbuffer() : width(0), height(0), format(0), depth() {}
+
+	int							width;
+	int							height;
+	GLenum						format;
+	std::vector<float>			depth;			// Only depth renderbuffers have storage
+};
+
+struct Framebuffer
+{
+	Framebuffer() : colorTexture(0), depthRenderbuffer(0) {}
+
+	GLuint						colorTexture;
+	GLuint						depthRenderbuffer;
+};
+
+struct Shader
+{
+	Shader() : type(0), source(), implementation(NULL), compiled(false), infoLog() {}
+
+	GLenum						type;
+	std::string					source;
+	const SoftwareShader*		implementation;
+	bool						compiled;
+	std::string					infoLog;
+};
+
+struct Program
+{
+	Program() 
+		: vertexShader(0), fragmentShader(0), linked(false), infoLog(), vertex(NULL), fragment(NULL), 
+		  uniformNames(), uniformOffsets(), uniformFloatCounts(), uniformValues(), 
+		  vertexUniforms(), fragmentUniforms(), fragmentSamplers()
+	{
+	}
+
+	GLuint							vertexShader;
+	GLuint							fragmentShader;
+	bool							linked;
+	std::string						infoLog;
+	const SoftwareVertexShader*		vertex;
+	const SoftwareFragmentShader*	fragment;
+
+	// The uniforms of both shaders, the location being the index
+	std::vector<std::string>		uniformNames;
+	std::vector<int>				uniformOffsets;
+	std::vector<int>				uniformFloatCounts;
+	std::vector<float>				uniformValues;
+
+	// What the shaders get, in their declaration order
+	std::vector<const float*>		vertexUniforms;
+	std::vector<const float*>		fragmentUniforms;
+	std::vector<int>				fragmentSamplers;		// Offsets of the texture units in uniformValues
+};
+
+struct Attribute
+{
+	Attribute() : enabled(false), size(4), type(GL_FLOAT), normalized(false), stride(0), pointer(NULL), buffer(0) {}
+
+	bool						enabled;
+	GLint						size;
+	GLenum						type;
+	bool						normalized;
+	GLsizei						stride;
+	const unsigned char*		pointer;		// Offset in the buffer when there's one
+	GLuint						buffer;
+};
+
+struct Surface
+{
+	Surface() : width(0), height(0), color(), depth() {}
+
+	int							width;
+	int							height;
+	std::vector<unsigned char>	color;
+	std::vector<float>			depth;
+};
+
+struct ClipVertex
+{
+	float						position[4];
+	float						varyings[SoftwareShader::MaxVaryings];
+};
+
+// A triangle ready for rasterization, counterclockwise in window coordinates
+struct Triangle
+{
+	long long					x[3];			// In sub-pixels
+	long long					y[3];
+	float						z[3];
+	float						invW[3];
+	float						varyings[3][SoftwareShader::MaxVaryings];	// Divided by w
+	long long					area;			// Twice the area, in sub-pixels
+	int							minX;			// Pixels whose center may be covered, inclusive
+	int							minY;
+	int							maxX;
+	int							maxY;
+};
+
+// Where the draws go: the surface or the attachments of a frame buffer object
+struct Target
+{
+	unsigned char*				color;
+	float*						depth;
+	int							width;
+	int							height;
+	bool						hasAlpha;
+};
+
+struct DrawTask
+{
+	Target							target;
+	int								bounds[4];		// Min x, min y, max x, max y (exclusive)
+	int								tilesX;
+	const Triangle*					triangles;
+	int								triangleCount;
+	int								varyingCount;
+	const SoftwareFragmentShader*	shader;
+	const float* const*				uniforms;
+	const SoftwareSampler*			samplers;
+	bool							depthTest;
+	GLenum							depthFunc;
+	bool							blend;
+	GLenum							blendSource;
+	GLenum							blendDestination;
+};
+
+struct ClearTask
+{
+	Target						target;
+	int							bounds[4];
+	bool						color;
+	bool						depth;
+	unsigned char				clearColor[4];
+	float						clearDepth;
+};
+
+struct Context
+{
+	Context()
+		: shaderImplementations(), taskRunner(NULL), taskRunnerData(NULL),
+		  buffers(), textures(), renderbuffers(), framebuffers(), shaders(), programs(), nextName(1), error(GL_NO_ERROR),
+		  arrayBuffer(0), elementArrayBuffer(0), framebuffer(0), renderbuffer(0), program(0), activeTexture(0),
+		  depthTest(false), cullFace(false), scissorTest(false), blend(false), cullMode(GL_BACK), frontFace(GL_CCW), depthFunc(GL_LESS), 
+		  blendSource(GL_ONE), blendDestination(GL_ZERO), clearDepth(1.f), unpackAlignment(4), packAlignment(4),
+		  surface(), surfaceHasDepth(false), current(false), vertices(), triangles(), indices(), samplers()
+	{
+		memset( boundTextures, 0, sizeof(boundTextures) );
+		memset( viewport, 0, sizeof(viewport) );
+		memset( scissor, 0, sizeof(scissor) );
+		memset( clearColor, 0, sizeof(clearColor) );
+	}
+
+	std::map<std::string, const SoftwareShader*>	shaderImplementations;
+	SoftwareGL::TaskRunner		taskRunner;
+	void*						taskRunnerData;
+
+	std::map<GLuint, Buffer>		buffers;
+	std::map<GLuint, Texture>		textures;
+	std::map<GLuint, Renderbuffer>	renderbuffers;
+	std::map<GLuint, Framebuffer>	framebuffers;
+	std::map<GLuint, Shader>		shaders;
+	std::map<GLuint, Program>		programs;
+	GLuint						nextName;
+	GLenum						error;
+
+	GLuint						arrayBuffer;
+	GLuint						elementArrayBuffer;
+	GLuint						framebuffer;
+	GLuint						renderbuffer;
+	GLuint						program;
+	int							activeTexture;
+	GLuint						boundTextures[MaxTextureUnits];
+	Attribute					attributes[SoftwareShader::MaxAttributes];
+
+	int							viewport[4];
+	int							scissor[4];
+	bool						depthTest;
+	bool						cullFace;
+	bool						scissorTest;
+	bool						blend;
+	GLenum						cullMode;
+	GLenum						frontFace;
+	GLenum						depthFunc;
+	GLenum						blendSource;
+	GLenum						blendDestination;
+	float						clearColor[4];
+	float						clearDepth;
+	int							unpackAlignment;
+	int							packAlignment;
+
+	Surface						surface;
+	bool						surfaceHasDepth;
+	bool						current;
+
+	// Kept from one draw to the next to avoid reallocations
+	std::vector<ClipVertex>		vertices;
+	std::vector<Triangle>		triangles;
+	std::vector<unsigned int>	indices;
+	std::vector<SoftwareSampler>	samplers;
+};
+
+Context gContext;
+
+void setError( GLenum error )
+{
+	if ( gContext.error==GL_NO_ERROR )
+		gContext.error = error;
+}
+
+GLuint generateName()
+{
+	return gContext.nextName++;
+}
+
+template<typename T> T* find( std::map<GLuint, T>& objects, GLuint name )
+{
+	typename std::map<GLuint, T>::iterator itr = objects.find( name );
+	return itr!=objects.end() ? &itr->second : NULL;
+}
+
+// Returns false when the bound frame buffer object isn't complete
+bool getTarget( Target& target )
+{
+	memset( &target, 0, sizeof(target) );
+	if ( gContext.framebuffer==0 )
+	{
+		Surface& surface = gContext.surface;
+		if ( surface.color.empty() )
+			return false;
+		target.color = &surface.color[0];
+		target.depth = surface.depth.empty() ? NULL : &surface.depth[0];
+		target.width = surface.width;
+		target.height = surface.height;
+		target.hasAlpha = true;
+		return true;
+	}
+
+	Framebuffer* framebuffer = find( gContext.framebuffers, gContext.framebuffer );
+	if ( !framebuffer )
+		return false;
+	Texture* texture = find( gContext.textures, framebuffer->colorTexture );
+	if ( !texture || texture->texels.empty() )
+		return false;
+	target.color = &texture->texels[0];
+	target.width = texture->width;
+	target.height = texture->height;
+	target.hasAlpha = texture->hasAlpha;
+	if ( framebuffer->depthRenderbuffer!=0 )
+	{
+		Renderbuffer* renderbuffer = find( gContext.renderbuffers, framebuffer->depthRenderbuffer );
+		if ( !renderbuffer || renderbuffer->depth.empty() || renderbuffer->width!=texture->width || renderbuffer->height!=texture->height )
+			return false;
+		target.depth = &renderbuffer->depth[0];
+	}
+	return true;
+}
+
+// Intersection of the target with the scissor rectangle (when enabled) and with the given rectangle
+void getBounds( const Target& target, const int* rectangle, int bounds[4] )
+{
+	bounds[0] = 0;
+	bounds[1] = 0;
+	bounds[2] = target.width;
+	bounds[3] = target.height;
+	const int* rectangles[2] = { rectangle, gContext.scissorTest ? gContext.scissor : NULL };
+	for ( int i=0; i<2; ++i )
+	{
+		if ( !rectangles[i] )
+			continue;
+		bounds[0] = std::max( bounds[0], rectangles[i][0] );
+		bounds[1] = std::max( bounds[1], rectangles[i][1] );
+		bounds[2] = std::min( bounds[2], rectangles[i][0] + rectangles[i][2] );
+		bounds[3] = std::min( bounds[3], rectangles[i][1] + rectangles[i][3] );
+	}
+}
+
+void runTasks( SoftwareGL::TaskFunction function, void* userData, int taskCount )
+{
+	if ( gContext.taskRunner && taskCount>1 )
+	{
+		gContext.taskRunner( function, userData, taskCount, gContext.taskRunnerData );
+		return;
+	}
+	for ( int i=0; i<taskCount; ++i )
+		function( i, userData );
+}
+
+inline unsigned char toUnsignedByte( float value )
+{
+	if ( !(value>0.f) )
+		return 0;
+	if ( value>=1.f )
+		return 255;
+	return static_cast<unsigned char>( value * 255.f + 0.5f );
+}
+
+void clearRows( int taskIndex, void* userData )
+{
+	const ClearTask& task = *static_cast<const ClearTask*>(userData);
+	int firstRow = task.bounds[1] + taskIndex * SoftwareGL::TileSize;
+	int lastRow = std::min( firstRow + static_cast<int>(SoftwareGL::TileSize), task.bounds[3] );
+	for ( int y=firstRow; y<lastRow; ++y )
+	{
+		if ( task.color )
+		{
+			unsigned char* pixel = task.target.color + (y*task.target.width + task.bounds[0])*4;
+			for ( int x=task.bounds[0]; x<task.bounds[2]; ++x, pixel+=4 )
+				memcpy( pixel, task.clearColor, 4 );
+		}
+		if ( task.depth )
+			std::fill( task.target.depth + y*task.target.width + task.bounds[0], task.target.depth + y*task.target.width + task.bounds[2], task.clearDepth );
+	}
+}
+
+inline bool passesDepthTest( GLenum func, float depth, float stored )
+{
+	switch ( func )
+	{
+		case GL_NEVER:		return false;
+		case GL_LESS:		return depth<stored;
+		case GL_EQUAL:		return depth==stored;
+		case GL_LEQUAL:		return depth<=stored;
+		case GL_GREATER:	return depth>stored;
+		case GL_NOTEQUAL:	return depth!=stored;
+		case GL_GEQUAL:		return depth>=stored;
+		default:			return true;
+	}
+}
+
+inline float getBlendFactor( GLenum factor, const float source[4], const float destination[4], int channel )
+{
+	switch ( factor )
+	{
+		case GL_ZERO:					return 0.f;
+		case GL_SRC_COLOR:				return source[channel];
+		case GL_ONE_MINUS_SRC_COLOR:	return 1.f - source[channel];
+		case GL_DST_COLOR:				return destination[channel];
+		case GL_ONE_MINUS_DST_COLOR:	return 1.f - destination[channel];
+		case GL_SRC_ALPHA:				return source[3];
+		case GL_ONE_MINUS_SRC_ALPHA:	return 1.f - source[3];
+		case GL_DST_ALPHA:				return destination[3];
+		case GL_ONE_MINUS_DST_ALPHA:	return 1.f - destination[3];
+		default:						return 1.f;
+	}
+}
+
+// Edge function of the edge going from vertex a to vertex b at a pixel center, positive inside
+inline long long evaluateEdge( const Triangle& t, int a, int b, long long x, long long y )
+{
+	return (t.x[b] - t.x[a]) * (y - t.y[a]) - (t.y[b] - t.y[a]) * (x - t.x[a]);
+}
+
+// Top-left fill rule: a pixel center right on an edge belongs to the triangle only if the edge 
+// is a top or a left one, so that it's drawn once by triangles sharing the edge. The bias is 
+// subtracted from the edge function before testing it against 0
+inline long long getEdgeBias( const Triangle& t, int a, int b )
+{
+	long long dx = t.x[b] - t.x[a];
+	long long dy = t.y[b] - t.y[a];
+	bool topLeft = dy<0 || (dy==0 && dx<0);
+	return topLeft ? 0 : 1;
+}
+
+void rasterizeTriangle( const DrawTask& task, const Triangle& t, const int tile[4] )
+{
+	int minX = std::max( t.minX, tile[0] );
+	int minY = std::max( t.minY, tile[1] );
+	int maxX = std::min( t.maxX, tile[2] - 1 );
+	int maxY = std::min( t.maxY, tile[3] - 1 );
+	if ( minX>maxX || minY>maxY )
+		return;
+
+	const long long bias0 = getEdgeBias( t, 1, 2 );
+	const long long bias1 = getEdgeBias( t, 2, 0 );
+	const long long bias2 = getEdgeBias( t, 0, 1 );
+	const long long stepX0 = -(t.y[2] - t.y[1]) * SubPixelScale;
+	const long long stepX1 = -(t.y[0] - t.y[2]) * SubPixelScale;
+	const long long stepX2 = -(t.y[1] - t.y[0]) * SubPixelScale;
+	const float invArea = 1.f / static_cast<float>(t.area);
+	const Target& target = task.target;
+
+	float varyings[SoftwareShader::MaxVaryings];
+	float color[4];
+	float destination[4];
+	for ( int py=minY; py<=maxY; ++py )
+	{
+		long long cx = static_cast<long long>(minX) * SubPixelScale + SubPixelScale / 2;
+		long long cy = static_cast<long long>(py) * SubPixelScale + SubPixelScale / 2;
+		long long w0 = evaluateEdge( t, 1, 2, cx, cy ) - bias0;
+		long long w1 = evaluateEdge( t, 2, 0, cx, cy ) - bias1;
+		long long w2 = evaluateEdge( t, 0, 1, cx, cy ) - bias2;
+		for ( int px=minX; px<=maxX; ++px, w0+=stepX0, w1+=stepX1, w2+=stepX2 )
+		{
+			if ( (w0 | w1 | w2)<0 )
+				continue;
+
+			float l0 = static_cast<float>(w0 + bias0) * invArea;
+			float l1 = static_cast<float>(w1 + bias1) * invArea;
+			float l2 = static_cast<float>(w2 + bias2) * invArea;
+			int index = py * target.width + px;
+			float depth = l0 * t.z[0] + l1 * t.z[1] + l2 * t.z[2];
+			if ( task.depthTest && target.depth && !passesDepthTest( task.depthFunc, depth, target.depth[index] ) )
+				continue;
+
+			float invW = l0 * t.invW[0] + l1 * t.invW[1] + l2 * t.invW[2];
+			float w = 1.f / invW;
+			for ( int i=0; i<task.varyingCount; ++i )
+				varyings[i] = (l0 * t.varyings[0][i] + l1 * t.varyings[1][i] + l2 * t.varyings[2][i]) * w;
+			if ( !(*task.shader)( task.uniforms, task.samplers, varyings, color ) )
+				continue;
+
+			if ( task.depthTest && target.depth )
+				target.depth[index] = depth;
+			unsigned char* pixel = target.color + index*4;
+			if ( task.blend )
+			{
+				for ( int i=0; i<4; ++i )
+					destination[i] = static_cast<float>(pixel[i]) / 255.f;
+				for ( int i=0; i<4; ++i )
+				{
+					color[i] = color[i] * getBlendFactor( task.blendSource, color, destination, i ) + 
+							   destination[i] * getBlendFactor( task.blendDestination, color, destination, i );
+				}
+			}
+			pixel[0] = toUnsignedByte( color[0] );
+			pixel[1] = toUnsignedByte( color[1] );
+			pixel[2] = toUnsignedByte( color[2] );
+			pixel[3] = target.hasAlpha ? toUnsignedByte( color[3] ) : 255;
+		}
+	}
+}
+
+// One tile of the draw: its pixels are only ever touched by this task, the triangles in the draw order
+void rasterizeTile( int taskIndex, void* userData )
+{
+	const DrawTask& task = *static_cast<const DrawTask*>(userData);
+	int tile[4];
+	tile[0] = task.bounds[0] + (taskIndex % task.tilesX) * SoftwareGL::TileSize;
+	tile[1] = task.bounds[1] + (taskIndex / task.tilesX) * SoftwareGL::TileSize;
+	tile[2] = std::min( tile[0] + static_cast<int>(SoftwareGL::TileSize), task.bounds[2] );
+	tile[3] = std::min( tile[1] + static_cast<int>(SoftwareGL::TileSize), task.bounds[3] );
+	for ( int i=0; i<task.triangleCount; ++i )
+		rasterizeTriangle( task, task.triangles[i], tile );
+}
+
+// Reads the given vertex of an attribute array. Returns false if it's past the end of the buffer
+bool fetchAttribute( const Attribute& attribute, unsigned int vertex, float value[4] )
+{
+	value[0] = 0.f;
+	value[1] = 0.f;
+	value[2] = 0.f;
+	value[3] = 1.f;
+	if ( !attribute.enabled )
+		return true;
+
+	int componentSize = attribute.type==GL_FLOAT ? 4 : ((attribute.type==GL_UNSIGNED_SHORT || attribute.type==GL_SHORT) ? 2 : 1);
+	std::size_t stride = attribute.stride!=0 ? attribute.stride : attribute.size * componentSize;
+	std::size_t offset = vertex * stride;
+	const unsigned char* data = attribute.pointer;
+	if ( attribute.buffer!=0 )
+	{
+		Buffer* buffer = find( gContext.buffers, attribute.buffer );
+		offset += reinterpret_cast<std::size_t>(attribute.pointer);
+		if ( !buffer || offset + attribute.size * componentSize > buffer->data.size() )
+			return false;
+		data = &buffer->data[0];
+	}
+	if ( !data )
+		return false;
+	data += offset;
+
+	for ( int i=0; i<attribute.size; ++i )
+	{
+		switch ( attribute.type )
+		{
+			case GL_FLOAT:
+			{
+				float component;
+				memcpy( &component, data + i*4, 4 );
+				value[i] = component;
+				break;
+			}
+			case GL_UNSIGNED_BYTE:
+				value[i] = attribute.normalized ? data[i] / 255.f : data[i];
+				break;
+			case GL_BYTE:
+			{
+				signed char component = static_cast<signed char>(data[i]);
+				value[i] = attribute.normalized ? component / 127.f : component;
+				break;
+			}
+			case GL_UNSIGNED_SHORT:
+			{
+				unsigned short component;
+				memcpy( &component, data + i*2, 2 );
+				value[i] = attribute.normalized ? component / 65535.f : component;
+				break;
+			}
+			case GL_SHORT:
+			{
+				short component;
+				memcpy( &component, data + i*2, 2 );
+				value[i] = attribute.normalized ? component / 32767.f : component;
+				break;
+			}
+		}
+	}
+	return true;
+}
+
+void interpolate( const ClipVertex& a, const ClipVertex& b, float t, int varyingCount, ClipVertex& result )
+{
+	for ( int i=0; i<4; ++i )
+		result.position[i] = a.position[i] + (b.position[i] - a.position[i]) * t;
+	for ( int i=0; i<varyingCount; ++i )
+		result.varyings[i] = a.varyings[i] + (b.varyings[i] - a.varyings[i]) * t;
+}
+
+// Distance to the clipping planes, positive inside
+float getPlaneDistance( const float* position, int plane )
+{
+	switch ( plane )
+	{
+		case 0:		return position[3] + position[2];					// Near
+		case 1:		return position[3] - position[2];					// Far
+		case 2:		return GuardBand * position[3] + position[0];
+		case 3:		return GuardBand * position[3] - position[0];
+		case 4:		return GuardBand * position[3] + position[1];
+		default:	return GuardBand * position[3] - position[1];
+	}
+}
+
+// Sutherland-Hodgman clipping of the triangle. Returns the vertex count of the resulting polygon
+int clipTriangle( const ClipVertex* triangle[3], int varyingCount, ClipVertex polygon[MaxClipVertices] )
+{
+	ClipVertex buffer[MaxClipVertices];
+	ClipVertex* input = buffer;
+	ClipVertex* output = polygon;
+	for ( int i=0; i<3; ++i )
+		input[i] = *triangle[i];
+	int count = 3;
+	for ( int plane=0; plane<6 && count>0; ++plane )
+	{
+		int outputCount = 0;
+		for ( int i=0; i<count; ++i )
+		{
+			const ClipVertex& current = input[i];
+			const ClipVertex& next = input[(i+1) % count];
+			float currentDistance = getPlaneDistance( current.position, plane );
+			float nextDistance = getPlaneDistance( next.position, plane );
+			if ( currentDistance>=0.f )
+				output[outputCount++] = current;
+			if ( (currentDistance>=0.f)!=(nextDistance>=0.f) )
+				interpolate( current, next, currentDistance / (currentDistance - nextDistance), varyingCount, output[outputCount++] );
+		}
+		count = outputCount;
+		std::swap( input, output );
+	}
+	if ( input!=polygon )
+		std::copy( input, input + count, polygon );
+	return count;
+}
+
+bool needsClipping( const ClipVertex* triangle[3] )
+{
+	for ( int plane=0; plane<6; ++plane )
+		for ( int i=0; i<3; ++i )
+			if ( getPlaneDistance( triangle[i]->position, plane )<0.f )
+				return true;
+	return false;
+}
+
+// Projects the triangle to window coordinates and adds it unless it's culled or empty
+void setupTriangle( const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, int varyingCount, const int bounds[4] )
+{
+	const ClipVertex* vertices[3] = { &v0, &v1, &v2 };
+	Triangle t;
+	const int* viewport = gContext.viewport;
+	for ( int i=0; i<3; ++i )
+	{
+		const float* position = vertices[i]->position;
+		if ( !(position[3]>0.f) )
+			return;
+		float invW = 1.f / position[3];
+		float x = static_cast<float>(viewport[0]) + (position[0] * invW + 1.f) * 0.5f * static_cast<float>(viewport[2]);
+		float y = static_cast<float>(viewport[1]) + (position[1] * invW + 1.f) * 0.5f * static_cast<float>(viewport[3]);
+		t.x[i] = static_cast<long long>( floorf( x * SubPixelScale + 0.5f ) );
+		t.y[i] = static_cast<long long>( floorf( y * SubPixelScale + 0.5f ) );
+		t.z[i] = std::min( std::max( (position[2] * invW) * 0.5f + 0.5f, 0.f ), 1.f );
+		t.invW[i] = invW;
+		for ( int j=0; j<varyingCount; ++j )
+			t.varyings[i][j] = vertices[i]->varyings[j] * invW;
+	}
+
+	t.area = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.y[1] - t.y[0]) * (t.x[2] - t.x[0]);
+	if ( t.area==0 )
+		return;
+	if ( gContext.cullFace )
+	{
+		bool frontFacing = (t.area>0)==(gContext.frontFace==GL_CCW);
+		if ( gContext.cullMode==GL_FRONT_AND_BACK || frontFacing==(gContext.cullMode==GL_FRONT) )
+			return;
+	}
+	if ( t.area<0 )
+	{
+		// The rasterizer expects counterclockwise triangles
+		std::swap( t.x[1], t.x[2] );
+		std::swap( t.y[1], t.y[2] );
+		std::swap( t.z[1], t.z[2] );
+		std::swap( t.invW[1], t.invW[2] );
+		for ( int j=0; j<varyingCount; ++j )
+			std::swap( t.varyings[1][j], t.varyings[2][j] );
+		t.area = -t.area;
+	}
+
+	// A pixel is covered when its center, at +0.5, is inside
+	long long minX = std::min( t.x[0], std::min( t.x[1], t.x[2] ) );
+	long long minY = std::min( t.y[0], std::min( t.y[1], t.y[2] ) );
+	long long maxX = std::max( t.x[0], std::max( t.x[1], t.x[2] ) );
+	long long maxY = std::max( t.y[0], std::max( t.y[1], t.y[2] ) );
+	const long long half = SubPixelScale / 2;
+	t.minX = static_cast<int>( std::max( static_cast<long long>(bounds[0]), (minX - half + SubPixelScale - 1) >> SubPixelBits ) );
+	t.minY = static_cast<int>( std::max( static_cast<long long>(bounds[1]), (minY - half + SubPixelScale - 1) >> SubPixelBits ) );
+	t.maxX = static_cast<int>( std::min( static_cast<long long>(bounds[2] - 1), (maxX - half) >> SubPixelBits ) );
+	t.maxY = static_cast<int>( std::min( static_cast<long long>(bounds[3] - 1), (maxY - half) >> SubPixelBits ) );
+	if ( t.minX>t.maxX || t.minY>t.maxY )
+		return;
+	gContext.triangles.push_back( t );
+}
+
+void addTriangle( const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2, int varyingCount, const int bounds[4] )
+{
+	const ClipVertex* triangle[3] = { &v0, &v1, &v2 };
+	if ( !needsClipping( triangle ) )
+	{
+		setupTriangle( v0, v1, v2, varyingCount, bounds );
+		return;
+	}
+	ClipVertex polygon[MaxClipVertices];
+	int count = clipTriangle( triangle, varyingCount, polygon );
+	for ( int i=2; i<count; ++i )
+		setupTriangle( polygon[0], polygon[i-1], polygon[i], varyingCount, bounds );
+}
+
+// Indices are in gContext.indices
+void draw( GLenum mode )
+{
+	if ( mode!=GL_TRIANGLES && mode!=GL_TRIANGLE_STRIP && mode!=GL_TRIANGLE_FAN )
+	{
+		setError( GL_INVALID_ENUM );		// Points and lines aren't supported
+		return;
+	}
+	Program* program = find( gContext.programs, gContext.program );
+	if ( !program || !program->linked )
+	{
+		setError( GL_INVALID_OPERATION );
+		return;
+	}
+	Target target;
+	if ( !getTarget( target ) )
+	{
+		setError( GL_INVALID_FRAMEBUFFER_OPERATION );
+		return;
+	}
+	const std::vector<unsigned int>& indices = gContext.indices;
+	if ( indices.size()<3 )
+		return;
+	int bounds[4];
+	getBounds( target, gContext.viewport, bounds );
+	if ( bounds[0]>=bounds[2] || bounds[1]>=bounds[3] )
+		return;
+
+	// Shade the vertices of the index range
+	unsigned int minIndex = *std::min_element( indices.begin(), indices.end() );
+	unsigned int maxIndex = *std::max_element( indices.begin(), indices.end() );
+	const SoftwareVertexShader& vertexShader = *program->vertex;
+	const float* const* vertexUniforms = program->vertexUniforms.empty() ? NULL : &program->vertexUniforms[0];
+	int varyingCount = vertexShader.getVaryingCount();
+	std::vector<ClipVertex>& vertices = gContext.vertices;
+	vertices.resize( maxIndex - minIndex + 1 );
+	float attributes[SoftwareShader::MaxAttributes][4];
+	for ( unsigned int i=minIndex; i<=maxIndex; ++i )
+	{
+		for ( int j=0; j<SoftwareShader::MaxAttributes; ++j )
+		{
+			if ( !fetchAttribute( gContext.attributes[j], i, attributes[j] ) )
+			{
+				setError( GL_INVALID_OPERATION );
+				return;
+			}
+		}
+		ClipVertex& vertex = vertices[i - minIndex];
+		vertexShader( vertexUniforms, attributes, vertex.position, vertex.varyings );
+	}
+
+	// Assemble, clip and set up the triangles
+	std::vector<Triangle>& triangles = gContext.triangles;
+	triangles.clear();
+	std::size_t triangleCount = mode==GL_TRIANGLES ? indices.size() / 3 : indices.size() - 2;
+	for ( std::size_t i=0; i<triangleCount; ++i )
+	{
+		unsigned int i0, i1, i2;
+		if ( mode==GL_TRIANGLES )
+		{
+			i0 = indices[i*3];
+			i1 = indices[i*3 + 1];
+			i2 = indices[i*3 + 2];
+		}
+		else if ( mode==GL_TRIANGLE_STRIP )
+		{
+			// Every other triangle of a strip is flipped back to the orientation of the first one
+			i0 = indices[i];
+			i1 = indices[i%2==0 ? i + 1 : i + 2];
+			i2 = indices[i%2==0 ? i + 2 : i + 1];
+		}
+		else
+		{
+			i0 = indices[0];
+			i1 = indices[i + 1];
+			i2 = indices[i + 2];
+		}
+		addTriangle( vertices[i0 - minIndex], vertices[i1 - minIndex], vertices[i2 - minIndex], varyingCount, bounds );
+	}
+	if ( triangles.empty() )
+		return;
+
+	// Resolve the samplers
+	std::vector<SoftwareSampler>& samplers = gContext.samplers;
+	samplers.resize( program->fragmentSamplers.size() );
+	for ( std::size_t i=0; i<samplers.size(); ++i )
+	{
+		samplers[i] = SoftwareSampler();
+		int unit = static_cast<int>( program->uniformValues[program->fragmentSamplers[i]] );
+		if ( unit<0 || unit>=MaxTextureUnits )
+			continue;
+		Texture* texture = find( gContext.textures, gContext.boundTextures[unit] );
+		if ( !texture || texture->texels.empty() )
+			continue;
+		samplers[i].texels = &texture->texels[0];
+		samplers[i].width = texture->width;
+		samplers[i].height = texture->height;
+		samplers[i].linear = texture->magFilter==GL_LINEAR;
+		samplers[i].repeatS = texture->wrapS==GL_REPEAT;
+		samplers[i].repeatT = texture->wrapT==GL_REPEAT;
+	}
+
+	DrawTask task;
+	task.target = target;
+	memcpy( task.bounds, bounds, sizeof(bounds) );
+	task.tilesX = (bounds[2] - bounds[0] + SoftwareGL::TileSize - 1) / SoftwareGL::TileSize;
+	task.triangles = &triangles[0];
+	task.triangleCount = static_cast<int>(triangles.size());
+	task.varyingCount = varyingCount;
+	task.shader = program->fragment;
+	task.uniforms = program->fragmentUniforms.empty() ? NULL : &program->fragmentUniforms[0];
+	task.samplers = samplers.empty() ? NULL : &samplers[0];
+	task.depthTest = gContext.depthTest;
+	task.depthFunc = gContext.depthFunc;
+	task.blend = gContext.blend;
+	task.blendSource = gContext.blendSource;
+	task.blendDestination = gContext.blendDestination;
+	int tilesY = (bounds[3] - bounds[1] + SoftwareGL::TileSize - 1) / SoftwareGL::TileSize;
+	runTasks( rasterizeTile, &task, task.tilesX * tilesY );
+}
+
+void link( Program& program )
+{
+	program.linked = false;
+	program.vertex = NULL;
+	program.fragment = NULL;
+	program.uniformNames.clear();
+	program.uniformOffsets.clear();
+	program.uniformFloatCounts.clear();
+	program.uniformValues.clear();
+	program.vertexUniforms.clear();
+	program.fragmentUniforms.clear();
+	program.fragmentSamplers.clear();
+
+	Shader* vertexShader = find( gContext.shaders, program.vertexShader );
+	Shader* fragmentShader = find( gContext.shaders, program.fragmentShader );
+	if ( !vertexShader || !vertexShader->compiled || !fragmentShader || !fragmentShader->compiled )
+	{
+		program.infoLog = "SoftwareGL: a compiled vertex shader and fragment shader must be attached";
+		return;
+	}
+	program.vertex = static_cast<const SoftwareVertexShader*>(vertexShader->implementation);
+	program.fragment = static_cast<const SoftwareFragmentShader*>(fragmentShader->implementation);
+
+	// Gather the uniforms of both shaders, those with the same name are shared
+	const SoftwareShader* shaders[2] = { program.vertex, program.fragment };
+	std::vector<int> shaderUniforms[2];
+	int floatCount = 0;
+	for ( int i=0; i<2; ++i )
+	{
+		for ( const SoftwareShader::Uniform* uniform=shaders[i]->getUniforms(); uniform && uniform->name; ++uniform )
+		{
+			int floats = uniform->floatCount>0 ? uniform->floatCount : 1;
+			std::vector<std::string>::iterator itr = std::find( program.uniformNames.begin(), program.uniformNames.end(), uniform->name );
+			int location = static_cast<int>( itr - program.uniformNames.begin() );
+			if ( itr==program.uniformNames.end() )
+			{
+				program.uniformNames.push_back( uniform->name );
+				program.uniformOffsets.push_back( floatCount );
+				program.uniformFloatCounts.push_back( floats );
+				floatCount += floats;
+			}
+			else if ( program.uniformFloatCounts[location]!=floats )
+			{
+				program.infoLog = std::string("SoftwareGL: uniform ") + uniform->name + " differs between the shaders";
+				return;
+			}
+			shaderUniforms[i].push_back( location );
+			if ( i==1 && uniform->floatCount==0 )
+				program.fragmentSamplers.push_back( program.uniformOffsets[location] );
+		}
+	}
+	program.uniformValues.resize( floatCount, 0.f );
+	std::vector<const float*>* pointers[2] = { &program.vertexUniforms, &program.fragmentUniforms };
+	for ( int i=0; i<2; ++i )
+		for ( std::size_t j=0; j<shaderUniforms[i].size(); ++j )
+			pointers[i]->push_back( &program.uniformValues[ program.uniformOffsets[shaderUniforms[i][j]] ] );
+	program.infoLog.clear();
+	program.linked = true;
+}
+
+// The uniform at the location of the current program, if it has room for floatCount floats
+float* getUniform( GLint location, int floatCount )
+{
+	if ( location==-1 )
+		return NULL;
+	Program* program = find( gContext.programs, gContext.program );
+	if ( !program || !program->linked || location<0 || location>=static_cast<GLint>(program->uniformNames.size()) || 
+		 floatCount>program->uniformFloatCounts[location] )
+	{
+		setError( GL_INVALID_OPERATION );
+		return NULL;
+	}
+	return &program->uniformValues[ program->uniformOffsets[location] ];
+}
+
+void setUniform( GLint location, int floatCount, const GLfloat* values )
+{
+	float* uniform = getUniform( location, floatCount );
+	if ( uniform )
+		memcpy( uniform, values, floatCount * sizeof(float) );
+}
+
+GLint getLocation( const std::vector<std::string>& names, const GLchar* name )
+{
+	std::string key = name ? name : "";
+	if ( key.size()>3 && key.compare( key.size() - 3, 3, "[0]" )==0 )
+		key.erase( key.size() - 3 );
+	std::vector<std::string>::const_iterator itr = std::find( names.begin(), names.end(), key );
+	return itr!=names.end() ? static_cast<GLint>( itr - names.begin() ) : -1;
+}
+
+void deleteObjects( GLsizei n, const GLuint* names, int kind )
+{
+	for ( GLsizei i=0; i<n; ++i )
+	{
+		GLuint name = names[i];
+		if ( name==0 )
+			continue;
+		if ( kind==0 )
+		{
+			gContext.buffers.erase( name );
+			if ( gContext.arrayBuffer==name )
+				gContext.arrayBuffer = 0;
+			if ( gContext.elementArrayBuffer==name )
+				gContext.elementArrayBuffer = 0;
+		}
+		else if ( kind==1 )
+		{
+			gContext.textures.erase( name );
+			for ( int j=0; j<MaxTextureUnits; ++j )
+				if ( gContext.boundTextures[j]==name )
+					gContext.boundTextures[j] = 0;
+		}
+		else if ( kind==2 )
+		{
+			gContext.framebuffers.erase( name );
+			if ( gContext.framebuffer==name )
+				gContext.framebuffer = 0;
+		}
+		else
+		{
+			gContext.renderbuffers.erase( name );
+			if ( gContext.renderbuffer==name )
+				gContext.renderbuffer = 0;
+		}
+	}
+}
+
+void generateObjects( GLsizei n, GLuint* names )
+{
+	if ( n<0 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	for ( GLsizei i=0; i<n; ++i )
+		names[i] = generateName();
+}
+
+// Window surfaces aren't supported, only pbuffers. Config 1 has no depth buffer, config 2 has one
+const EGLint ConfigCount = 2;
+
+int getConfigIndex( EGLConfig config )
+{
+	std::size_t id = reinterpret_cast<std::size_t>(config);
+	return id>=1 && id<=static_cast<std::size_t>(ConfigCount) ? static_cast<int>(id) : 0;
+}
+
+}
+
+#endif
+
+bool SoftwareGL::isCompiledIn()
+{
+#ifdef OGLES_SOFTWARE_GL_ENABLED
+	return true;
+#else
+	return false;
+#endif
+}
+
+void SoftwareGL::addShader( const std::string& source, const SoftwareShader* shader )
+{
+#ifdef OGLES_SOFTWARE_GL_ENABLED
+	gContext.shaderImplementations[source] = shader;
+#endif
+}
+
+void SoftwareGL::setTaskRunner( TaskRunner runner, void* runnerData )
+{
+#ifdef OGLES_SOFTWARE_GL_ENABLED
+	gContext.taskRunner = runner;
+	gContext.taskRunnerData = runnerData;
+#endif
+}
+
+}
+
+#ifdef OGLES_SOFTWARE_GL_ENABLED
+
+using namespace OGLESSandbox;
+
+extern "C"
+{
+
+//
+// EGL
+//
+EGLDisplay eglGetDisplay( EGLNativeDisplayType displayId )
+{
+	return reinterpret_cast<EGLDisplay>(1);
+}
+
+EGLBoolean eglInitialize( EGLDisplay display, EGLint* major, EGLint* minor )
+{
+	if ( major )
+		*major = 1;
+	if ( minor )
+		*minor = 4;
+	return EGL_TRUE;
+}
+
+EGLBoolean eglTerminate( EGLDisplay display )
+{
+	return EGL_TRUE;
+}
+
+EGLint eglGetError( void )
+{
+	return EGL_SUCCESS;
+}
+
+EGLBoolean eglBindAPI( EGLenum api )
+{
+	return api==EGL_OPENGL_ES_API ? EGL_TRUE : EGL_FALSE;
+}
+
+EGLBoolean eglGetConfigs( EGLDisplay display, EGLConfig* configs, EGLint configSize, EGLint* numConfig )
+{
+	if ( !numConfig )
+		return EGL_FALSE;
+	if ( !configs )
+	{
+		*numConfig = ConfigCount;
+		return EGL_TRUE;
+	}
+	*numConfig = std::min( configSize, ConfigCount );
+	for ( EGLint i=0; i<*numConfig; ++i )
+		configs[i] = reinterpret_cast<EGLConfig>( static_cast<std::size_t>(i + 1) );
+	return EGL_TRUE;
+}
+
+EGLBoolean eglGetConfigAttrib( EGLDisplay display, EGLConfig config, EGLint attribute, EGLint* value )
+{
+	int index = getConfigIndex( config );
+	if ( index==0 || !value )
+		return EGL_FALSE;
+	switch ( attribute )
+	{
+		case EGL_CONFIG_ID:			*value = index; break;
+		case EGL_RED_SIZE:			*value = 8; break;
+		case EGL_GREEN_SIZE:		*value = 8; break;
+		case EGL_BLUE_SIZE:			*value = 8; break;
+		case EGL_ALPHA_SIZE:		*value = 8; break;
+		case EGL_DEPTH_SIZE:		*value = index==2 ? 24 : 0; break;
+		case EGL_SURFACE_TYPE:		*value = EGL_PBUFFER_BIT; break;
+		case EGL_RENDERABLE_TYPE:	*value = EGL_OPENGL_ES2_BIT; break;
+		case EGL_CONFIG_CAVEAT:		*value = EGL_NONE; break;
+		default:					*value = 0; break;
+	}
+	return EGL_TRUE;
+}
+
+EGLContext eglCreateContext( EGLDisplay display, EGLConfig config, EGLContext shareContext, const EGLint* attributes )
+{
+	return getConfigIndex( config )!=0 ? reinterpret_cast<EGLContext>(1) : EGL_NO_CONTEXT;
+}
+
+EGLBoolean eglDestroyContext( EGLDisplay display, EGLContext context )
+{
+	return EGL_TRUE;
+}
+
+// There's a single surface
+EGLSurface eglCreatePbufferSurface( EGLDisplay display, EGLConfig config, const EGLint* attributes )
+{
+	int index = getConfigIndex( config );
+	if ( index==0 )
+		return EGL_NO_SURFACE;
+	Surface& surface = gContext.surface;
+	surface.width = 0;
+	surface.height = 0;
+	for ( const EGLint* attribute=attributes; attribute && attribute[0]!=EGL_NONE; attribute+=2 )
+	{
+		if ( attribute[0]==EGL_WIDTH )
+			surface.width = attribute[1];
+		else if ( attribute[0]==EGL_HEIGHT )
+			surface.height = attribute[1];
+	}
+	if ( surface.width<=0 || surface.height<=0 )
+		return EGL_NO_SURFACE;
+	surface.color.assign( surface.width * surface.height * 4, 0 );
+	surface.depth.assign( index==2 ? surface.width * surface.height : 0, 1.f );
+	return reinterpret_cast<EGLSurface>(1);
+}
+
+EGLBoolean eglDestroySurface( EGLDisplay display, EGLSurface surface )
+{
+	gContext.surface = Surface();
+	return EGL_TRUE;
+}
+
+EGLBoolean eglQuerySurface( EGLDisplay display, EGLSurface surface, EGLint attribute, EGLint* value )
+{
+	if ( attribute==EGL_WIDTH )
+		*value = gContext.surface.width;
+	else if ( attribute==EGL_HEIGHT )
+		*value = gContext.surface.height;
+	else
+		return EGL_FALSE;
+	return EGL_TRUE;
+}
+
+EGLBoolean eglMakeCurrent( EGLDisplay display, EGLSurface draw, EGLSurface read, EGLContext context )
+{
+	gContext.current = context!=EGL_NO_CONTEXT;
+	if ( gContext.current && gContext.viewport[2]==0 )
+	{
+		gContext.viewport[2] = gContext.scissor[2] = gContext.surface.width;
+		gContext.viewport[3] = gContext.scissor[3] = gContext.surface.height;
+	}
+	return EGL_TRUE;
+}
+
+EGLBoolean eglSwapInterval( EGLDisplay display, EGLint interval )
+{
+	return EGL_TRUE;
+}
+
+// The draws are done by the time they return, and the surface is preserved
+EGLBoolean eglSwapBuffers( EGLDisplay display, EGLSurface surface )
+{
+	return EGL_TRUE;
+}
+
+//
+// GL
+//
+GLenum glGetError( void )
+{
+	GLenum error = gContext.error;
+	gContext.error = GL_NO_ERROR;
+	return error;
+}
+
+void glFinish( void )
+{
+}
+
+void glFlush( void )
+{
+}
+
+void glEnable( GLenum cap )
+{
+	switch ( cap )
+	{
+		case GL_DEPTH_TEST:		gContext.depthTest = true; break;
+		case GL_CULL_FACE:		gContext.cullFace = true; break;
+		case GL_SCISSOR_TEST:	gContext.scissorTest = true; break;
+		case GL_BLEND:			gContext.blend = true; break;
+		default:				break;
+	}
+}
+
+void glDisable( GLenum cap )
+{
+	switch ( cap )
+	{
+		case GL_DEPTH_TEST:		gContext.depthTest = false; break;
+		case GL_CULL_FACE:		gContext.cullFace = false; break;
+		case GL_SCISSOR_TEST:	gContext.scissorTest = false; break;
+		case GL_BLEND:			gContext.blend = false; break;
+		default:				break;
+	}
+}
+
+void glCullFace( GLenum mode )
+{
+	gContext.cullMode = mode;
+}
+
+void glFrontFace( GLenum mode )
+{
+	gContext.frontFace = mode;
+}
+
+void glDepthFunc( GLenum func )
+{
+	gContext.depthFunc = func;
+}
+
+void glBlendFunc( GLenum sfactor, GLenum dfactor )
+{
+	gContext.blendSource = sfactor;
+	gContext.blendDestination = dfactor;
+}
+
+void glViewport( GLint x, GLint y, GLsizei width, GLsizei height )
+{
+	if ( width<0 || height<0 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	gContext.viewport[0] = x;
+	gContext.viewport[1] = y;
+	gContext.viewport[2] = width;
+	gContext.viewport[3] = height;
+}
+
+void glScissor( GLint x, GLint y, GLsizei width, GLsizei height )
+{
+	if ( width<0 || height<0 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	gContext.scissor[0] = x;
+	gContext.scissor[1] = y;
+	gContext.scissor[2] = width;
+	gContext.scissor[3] = height;
+}
+
+void glClearColor( GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha )
+{
+	gContext.clearColor[0] = red;
+	gContext.clearColor[1] = green;
+	gContext.clearColor[2] = blue;
+	gContext.clearColor[3] = alpha;
+}
+
+void glClearDepthf( GLfloat depth )
+{
+	gContext.clearDepth = std::min( std::max( depth, 0.f ), 1.f );
+}
+
+void glClear( GLbitfield mask )
+{
+	Target target;
+	if ( !getTarget( target ) )
+	{
+		setError( GL_INVALID_FRAMEBUFFER_OPERATION );
+		return;
+	}
+	ClearTask task;
+	task.target = target;
+	getBounds( target, NULL, task.bounds );
+	task.color = (mask & GL_COLOR_BUFFER_BIT)!=0;
+	task.depth = (mask & GL_DEPTH_BUFFER_BIT)!=0 && target.depth;
+	for ( int i=0; i<4; ++i )
+		task.clearColor[i] = toUnsignedByte( gContext.clearColor[i] );
+	if ( !target.hasAlpha )
+		task.clearColor[3] = 255;
+	task.clearDepth = gContext.clearDepth;
+	if ( task.bounds[0]>=task.bounds[2] || task.bounds[1]>=task.bounds[3] || (!task.color && !task.depth) )
+		return;
+	runTasks( clearRows, &task, (task.bounds[3] - task.bounds[1] + SoftwareGL::TileSize - 1) / SoftwareGL::TileSize );
+}
+
+void glPixelStorei( GLenum pname, GLint param )
+{
+	if ( param!=1 && param!=2 && param!=4 && param!=8 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	if ( pname==GL_UNPACK_ALIGNMENT )
+		gContext.unpackAlignment = param;
+	else if ( pname==GL_PACK_ALIGNMENT )
+		gContext.packAlignment = param;
+	else
+		setError( GL_INVALID_ENUM );
+}
+
+void glReadPixels( GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void* pixels )
+{
+	// RGBA rows are always aligned, the pack alignment doesn't matter
+	if ( format!=GL_RGBA || type!=GL_UNSIGNED_BYTE )
+	{
+		setError( GL_INVALID_OPERATION );
+		return;
+	}
+	Target target;
+	if ( !getTarget( target ) )
+	{
+		setError( GL_INVALID_FRAMEBUFFER_OPERATION );
+		return;
+	}
+	unsigned char* destination = static_cast<unsigned char*>(pixels);
+	for ( GLsizei row=0; row<height; ++row )
+	{
+		int sourceY = y + row;
+		if ( sourceY<0 || sourceY>=target.height )
+			continue;
+		for ( GLsizei column=0; column<width; ++column )
+		{
+			int sourceX = x + column;
+			if ( sourceX>=0 && sourceX<target.width )
+				memcpy( destination + (row*width + column)*4, target.color + (sourceY*target.width + sourceX)*4, 4 );
+		}
+	}
+}
+
+//
+// Buffers
+//
+void glGenBuffers( GLsizei n, GLuint* buffers )
+{
+	generateObjects( n, buffers );
+}
+
+void glDeleteBuffers( GLsizei n, const GLuint* buffers )
+{
+	deleteObjects( n, buffers, 0 );
+}
+
+void glBindBuffer( GLenum target, GLuint buffer )
+{
+	if ( buffer!=0 )
+		gContext.buffers[buffer];
+	if ( target==GL_ARRAY_BUFFER )
+		gContext.arrayBuffer = buffer;
+	else if ( target==GL_ELEMENT_ARRAY_BUFFER )
+		gContext.elementArrayBuffer = buffer;
+	else
+		setError( GL_INVALID_ENUM );
+}
+
+Buffer* getBoundBuffer( GLenum target )
+{
+	GLuint name = target==GL_ARRAY_BUFFER ? gContext.arrayBuffer : (target==GL_ELEMENT_ARRAY_BUFFER ? gContext.elementArrayBuffer : 0);
+	Buffer* buffer = find( gContext.buffers, name );
+	if ( !buffer )
+		setError( GL_INVALID_OPERATION );
+	return buffer;
+}
+
+void glBufferData( GLenum target, GLsizeiptr size, const void* data, GLenum usage )
+{
+	Buffer* buffer = getBoundBuffer( target );
+	if ( !buffer )
+		return;
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+	if ( bytes )
+		buffer->data.assign( bytes, bytes + size );
+	else
+		buffer->data.assign( size, 0 );
+}
+
+void glBufferSubData( GLenum target, GLintptr offset, GLsizeiptr size, const void* data )
+{
+	Buffer* buffer = getBoundBuffer( target );
+	if ( !buffer )
+		return;
+	if ( offset<0 || size<0 || static_cast<std::size_t>(offset + size)>buffer->data.size() )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	if ( size>0 )
+		memcpy( &buffer->data[offset], data, size );
+}
+
+//
+// Textures
+//
+void glGenTextures( GLsizei n, GLuint* textures )
+{
+	generateObjects( n, textures );
+}
+
+void glDeleteTextures( GLsizei n, const GLuint* textures )
+{
+	deleteObjects( n, textures, 1 );
+}
+
+void glActiveTexture( GLenum texture )
+{
+	int unit = static_cast<int>(texture) - GL_TEXTURE0;
+	if ( unit<0 || unit>=MaxTextureUnits )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	gContext.activeTexture = unit;
+}
+
+void glBindTexture( GLenum target, GLuint texture )
+{
+	if ( target!=GL_TEXTURE_2D )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	if ( texture!=0 )
+		gContext.textures[texture];
+	gContext.boundTextures[gContext.activeTexture] = texture;
+}
+
+Texture* getBoundTexture( GLenum target )
+{
+	Texture* texture = target==GL_TEXTURE_2D ? find( gContext.textures, gContext.boundTextures[gContext.activeTexture] ) : NULL;
+	if ( !texture )
+		setError( target==GL_TEXTURE_2D ? GL_INVALID_OPERATION : GL_INVALID_ENUM );
+	return texture;
+}
+
+// Only level 0 is stored, there's no mipmapping
+void glTexImage2D( GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels )
+{
+	Texture* texture = getBoundTexture( target );
+	if ( !texture )
+		return;
+	if ( type!=GL_UNSIGNED_BYTE || static_cast<GLenum>(internalformat)!=format )
+	{
+		setError( GL_INVALID_OPERATION );
+		return;
+	}
+	int components = 0;
+	switch ( format )
+	{
+		case GL_RGBA:				components = 4; break;
+		case GL_RGB:				components = 3; break;
+		case GL_LUMINANCE_ALPHA:	components = 2; break;
+		case GL_LUMINANCE:			components = 1; break;
+		case GL_ALPHA:				components = 1; break;
+		default:
+			setError( GL_INVALID_ENUM );
+			return;
+	}
+	if ( width<0 || height<0 || border!=0 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	if ( level!=0 )
+		return;
+
+	texture->width = width;
+	texture->height = height;
+	texture->hasAlpha = format!=GL_RGB && format!=GL_LUMINANCE;
+	texture->texels.assign( width * height * 4, 0 );
+	if ( !texture->hasAlpha )
+		for ( int i=0; i<width*height; ++i )
+			texture->texels[i*4 + 3] = 255;
+	if ( !pixels )
+		return;
+
+	int alignment = gContext.unpackAlignment;
+	int rowSize = (width * components + alignment - 1) / alignment * alignment;
+	for ( int y=0; y<height; ++y )
+	{
+		const unsigned char* source = static_cast<const unsigned char*>(pixels) + y * rowSize;
+		unsigned char* texel = &texture->texels[y * width * 4];
+		for ( int x=0; x<width; ++x, source+=components, texel+=4 )
+		{
+			switch ( format )
+			{
+				case GL_RGBA:				memcpy( texel, source, 4 ); break;
+				case GL_RGB:				memcpy( texel, source, 3 ); break;
+				case GL_LUMINANCE_ALPHA:	texel[0] = texel[1] = texel[2] = source[0]; texel[3] = source[1]; break;
+				case GL_LUMINANCE:			texel[0] = texel[1] = texel[2] = source[0]; break;
+				case GL_ALPHA:				texel[3] = source[0]; break;
+			}
+		}
+	}
+}
+
+// The minification filter is ignored, the magnification one is used for both
+void glTexParameteri( GLenum target, GLenum pname, GLint param )
+{
+	Texture* texture = getBoundTexture( target );
+	if ( !texture )
+		return;
+	switch ( pname )
+	{
+		case GL_TEXTURE_MAG_FILTER:		texture->magFilter = param; break;
+		case GL_TEXTURE_MIN_FILTER:		break;
+		case GL_TEXTURE_WRAP_S:			texture->wrapS = param; break;
+		case GL_TEXTURE_WRAP_T:			texture->wrapT = param; break;
+		default:						setError( GL_INVALID_ENUM ); break;
+	}
+}
+
+void glTexParameterf( GLenum target, GLenum pname, GLfloat param )
+{
+	glTexParameteri( target, pname, static_cast<GLint>(param) );
+}
+
+//
+// Frame buffer objects
+//
+void glGenFramebuffers( GLsizei n, GLuint* framebuffers )
+{
+	generateObjects( n, framebuffers );
+}
+
+void glDeleteFramebuffers( GLsizei n, const GLuint* framebuffers )
+{
+	deleteObjects( n, framebuffers, 2 );
+}
+
+void glBindFramebuffer( GLenum target, GLuint framebuffer )
+{
+	if ( target!=GL_FRAMEBUFFER )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	if ( framebuffer!=0 )
+		gContext.framebuffers[framebuffer];
+	gContext.framebuffer = framebuffer;
+}
+
+void glFramebufferTexture2D( GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level )
+{
+	Framebuffer* framebuffer = find( gContext.framebuffers, gContext.framebuffer );
+	if ( target!=GL_FRAMEBUFFER || attachment!=GL_COLOR_ATTACHMENT0 || (texture!=0 && textarget!=GL_TEXTURE_2D) )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	if ( !framebuffer )
+	{
+		setError( GL_INVALID_OPERATION );
+		return;
+	}
+	framebuffer->colorTexture = texture;
+}
+
+void glFramebufferRenderbuffer( GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer )
+{
+	Framebuffer* framebuffer = find( gContext.framebuffers, gContext.framebuffer );
+	if ( target!=GL_FRAMEBUFFER || attachment!=GL_DEPTH_ATTACHMENT || renderbuffertarget!=GL_RENDERBUFFER )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	if ( !framebuffer )
+	{
+		setError( GL_INVALID_OPERATION );
+		return;
+	}
+	framebuffer->depthRenderbuffer = renderbuffer;
+}
+
+GLenum glCheckFramebufferStatus( GLenum target )
+{
+	if ( target!=GL_FRAMEBUFFER )
+	{
+		setError( GL_INVALID_ENUM );
+		return 0;
+	}
+	if ( gContext.framebuffer==0 )
+		return GL_FRAMEBUFFER_COMPLETE;
+	Framebuffer* framebuffer = find( gContext.framebuffers, gContext.framebuffer );
+	if ( !framebuffer || framebuffer->colorTexture==0 )
+		return GL_FRAMEBUFFER_INCOMPLETE_MISSING_ATTACHMENT;
+	Target renderTarget;
+	return getTarget( renderTarget ) ? GL_FRAMEBUFFER_COMPLETE : GL_FRAMEBUFFER_INCOMPLETE_ATTACHMENT;
+}
+
+void glGenRenderbuffers( GLsizei n, GLuint* renderbuffers )
+{
+	generateObjects( n, renderbuffers );
+}
+
+void glDeleteRenderbuffers( GLsizei n, const GLuint* renderbuffers )
+{
+	deleteObjects( n, renderbuffers, 3 );
+}
+
+void glBindRenderbuffer( GLenum target, GLuint renderbuffer )
+{
+	if ( target!=GL_RENDERBUFFER )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	if ( renderbuffer!=0 )
+		gContext.renderbuffers[renderbuffer];
+	gContext.renderbuffer = renderbuffer;
+}
+
+// Only depth renderbuffers are supported, color goes to textures
+void glRenderbufferStorage( GLenum target, GLenum internalformat, GLsizei width, GLsizei height )
+{
+	Renderbuffer* renderbuffer = find( gContext.renderbuffers, gContext.renderbuffer );
+	if ( target!=GL_RENDERBUFFER || internalformat!=GL_DEPTH_COMPONENT16 )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	if ( !renderbuffer )
+	{
+		setError( GL_INVALID_OPERATION );
+		return;
+	}
+	renderbuffer->width = width;
+	renderbuffer->height = height;
+	renderbuffer->format = internalformat;
+	renderbuffer->depth.assign( width * height, 1.f );
+}
+
+//
+// Shaders and programs
+//
+GLuint glCreateShader( GLenum type )
+{
+	if ( type!=GL_VERTEX_SHADER && type!=GL_FRAGMENT_SHADER )
+	{
+		setError( GL_INVALID_ENUM );
+		return 0;
+	}
+	GLuint name = generateName();
+	gContext.shaders[name].type = type;
+	return name;
+}
+
+void glDeleteShader( GLuint shader )
+{
+	gContext.shaders.erase( shader );
+}
+
+void glShaderSource( GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length )
+{
+	Shader* object = find( gContext.shaders, shader );
+	if ( !object )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	object->source.clear();
+	for ( GLsizei i=0; i<count; ++i )
+	{
+		if ( length && length[i]>=0 )
+			object->source.append( string[i], length[i] );
+		else
+			object->source.append( string[i] );
+	}
+}
+
+void glCompileShader( GLuint shader )
+{
+	Shader* object = find( gContext.shaders, shader );
+	if ( !object )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	std::map<std::string, const SoftwareShader*>::const_iterator itr = gContext.shaderImplementations.find( object->source );
+	object->implementation = itr!=gContext.shaderImplementations.end() ? itr->second : NULL;
+	object->compiled = object->implementation && object->implementation->isVertexShader()==(object->type==GL_VERTEX_SHADER);
+	object->infoLog = object->compiled ? "" : "SoftwareGL: no implementation was registered for this shader source (see SoftwareGL::addShader)";
+}
+
+void glGetShaderiv( GLuint shader, GLenum pname, GLint* params )
+{
+	Shader* object = find( gContext.shaders, shader );
+	if ( !object )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	switch ( pname )
+	{
+		case GL_SHADER_TYPE:			*params = object->type; break;
+		case GL_COMPILE_STATUS:			*params = object->compiled ? GL_TRUE : GL_FALSE; break;
+		case GL_INFO_LOG_LENGTH:		*params = object->infoLog.empty() ? 0 : static_cast<GLint>(object->infoLog.size()) + 1; break;
+		case GL_SHADER_SOURCE_LENGTH:	*params = object->source.empty() ? 0 : static_cast<GLint>(object->source.size()) + 1; break;
+		case GL_DELETE_STATUS:			*params = GL_FALSE; break;
+		default:						setError( GL_INVALID_ENUM ); break;
+	}
+}
+
+static void copyInfoLog( const std::string& infoLog, GLsizei bufsize, GLsizei* length, GLchar* infolog )
+{
+	GLsizei size = bufsize>0 ? std::min( bufsize - 1, static_cast<GLsizei>(infoLog.size()) ) : 0;
+	if ( bufsize>0 )
+	{
+		memcpy( infolog, infoLog.c_str(), size );
+		infolog[size] = 0;
+	}
+	if ( length )
+		*length = size;
+}
+
+void glGetShaderInfoLog( GLuint shader, GLsizei bufsize, GLsizei* length, GLchar* infolog )
+{
+	Shader* object = find( gContext.shaders, shader );
+	if ( !object )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	copyInfoLog( object->infoLog, bufsize, length, infolog );
+}
+
+GLuint glCreateProgram( void )
+{
+	GLuint name = generateName();
+	gContext.programs[name];
+	return name;
+}
+
+void glDeleteProgram( GLuint program )
+{
+	gContext.programs.erase( program );
+	if ( gContext.program==program )
+		gContext.program = 0;
+}
+
+void glAttachShader( GLuint program, GLuint shader )
+{
+	Program* programObject = find( gContext.programs, program );
+	Shader* shaderObject = find( gContext.shaders, shader );
+	if ( !programObject || !shaderObject )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	if ( shaderObject->type==GL_VERTEX_SHADER )
+		programObject->vertexShader = shader;
+	else
+		programObject->fragmentShader = shader;
+}
+
+void glLinkProgram( GLuint program )
+{
+	Program* object = find( gContext.programs, program );
+	if ( !object )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	link( *object );
+}
+
+void glGetProgramiv( GLuint program, GLenum pname, GLint* params )
+{
+	Program* object = find( gContext.programs, program );
+	if ( !object )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	switch ( pname )
+	{
+		case GL_LINK_STATUS:		*params = object->linked ? GL_TRUE : GL_FALSE; break;
+		case GL_VALIDATE_STATUS:	*params = object->linked ? GL_TRUE : GL_FALSE; break;
+		case GL_INFO_LOG_LENGTH:	*params = object->infoLog.empty() ? 0 : static_cast<GLint>(object->infoLog.size()) + 1; break;
+		case GL_ATTACHED_SHADERS:	*params = (object->vertexShader ? 1 : 0) + (object->fragmentShader ? 1 : 0); break;
+		case GL_DELETE_STATUS:		*params = GL_FALSE; break;
+		default:					setError( GL_INVALID_ENUM ); break;
+	}
+}
+
+void glGetProgramInfoLog( GLuint program, GLsizei bufsize, GLsizei* length, GLchar* infolog )
+{
+	Program* object = find( gContext.programs, program );
+	if ( !object )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	copyInfoLog( object->infoLog, bufsize, length, infolog );
+}
+
+void glUseProgram( GLuint program )
+{
+	if ( program!=0 && !find( gContext.programs, program ) )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	gContext.program = program;
+}
+
+// The attribute locations are the indices in the vertex shader's list
+GLint glGetAttribLocation( GLuint program, const GLchar* name )
+{
+	Program* object = find( gContext.programs, program );
+	if ( !object || !object->linked )
+	{
+		setError( GL_INVALID_OPERATION );
+		return -1;
+	}
+	std::vector<std::string> names;
+	for ( const char* const* attribute=object->vertex->getAttributes(); attribute && *attribute; ++attribute )
+		names.push_back( *attribute );
+	return getLocation( names, name );
+}
+
+GLint glGetUniformLocation( GLuint program, const GLchar* name )
+{
+	Program* object = find( gContext.programs, program );
+	if ( !object || !object->linked )
+	{
+		setError( GL_INVALID_OPERATION );
+		return -1;
+	}
+	return getLocation( object->uniformNames, name );
+}
+
+void glUniform1i( GLint location, GLint x )
+{
+	float value = static_cast<float>(x);
+	setUniform( location, 1, &value );
+}
+
+void glUniform2f( GLint location, GLfloat x, GLfloat y )
+{
+	float values[2] = { x, y };
+	setUniform( location, 2, values );
+}
+
+void glUniform2fv( GLint location, GLsizei count, const GLfloat* v )
+{
+	setUniform( location, count * 2, v );
+}
+
+void glUniform4fv( GLint location, GLsizei count, const GLfloat* v )
+{
+	setUniform( location, count * 4, v );
+}
+
+void glUniformMatrix4fv( GLint location, GLsizei count, GLboolean transpose, const GLfloat* value )
+{
+	if ( transpose!=GL_FALSE )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	setUniform( location, count * 16, value );
+}
+
+//
+// Vertices
+//
+void glEnableVertexAttribArray( GLuint index )
+{
+	if ( index>=SoftwareShader::MaxAttributes )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	gContext.attributes[index].enabled = true;
+}
+
+void glDisableVertexAttribArray( GLuint index )
+{
+	if ( index>=SoftwareShader::MaxAttributes )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	gContext.attributes[index].enabled = false;
+}
+
+void glVertexAttribPointer( GLuint indx, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* ptr )
+{
+	if ( indx>=SoftwareShader::MaxAttributes || size<1 || size>4 || stride<0 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	if ( type!=GL_FLOAT && type!=GL_UNSIGNED_BYTE && type!=GL_BYTE && type!=GL_UNSIGNED_SHORT && type!=GL_SHORT )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	Attribute& attribute = gContext.attributes[indx];
+	attribute.size = size;
+	attribute.type = type;
+	attribute.normalized = normalized!=GL_FALSE;
+	attribute.stride = stride;
+	attribute.pointer = static_cast<const unsigned char*>(ptr);
+	attribute.buffer = gContext.arrayBuffer;
+}
+
+void glDrawArrays( GLenum mode, GLint first, GLsizei count )
+{
+	if ( first<0 || count<0 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	std::vector<unsigned int>& indices = gContext.indices;
+	indices.resize( count );
+	for ( GLsizei i=0; i<count; ++i )
+		indices[i] = first + i;
+	draw( mode );
+}
+
+void glDrawElements( GLenum mode, GLsizei count, GLenum type, const void* indices )
+{
+	if ( type!=GL_UNSIGNED_BYTE && type!=GL_UNSIGNED_SHORT )
+	{
+		setError( GL_INVALID_ENUM );
+		return;
+	}
+	if ( count<0 )
+	{
+		setError( GL_INVALID_VALUE );
+		return;
+	}
+	int indexSize = type==GL_UNSIGNED_BYTE ? 1 : 2;
+	const unsigned char* data = static_cast<const unsigned char*>(indices);
+	if ( gContext.elementArrayBuffer!=0 )
+	{
+		Buffer* buffer = find( gContext.buffers, gContext.elementArrayBuffer );
+		std::size_t offset = reinterpret_cast<std::size_t>(indices);
+		if ( !buffer || offset + count * indexSize > buffer->data.size() )
+		{
+			setError( GL_INVALID_OPERATION );
+			return;
+		}
+		data = count>0 ? &buffer->data[offset] : NULL;
+	}
+	std::vector<unsigned int>& indexList = gContext.indices;
+	indexList.resize( count );
+	for ( GLsizei i=0; i<count; ++i )
+	{
+		if ( indexSize==1 )
+		{
+			indexList[i] = data[i];
+		}
+		else
+		{
+			unsigned short index;
+			memcpy( &index, data + i*2, 2 );
+			indexList[i] = index;
+		}
+	}
+	draw( mode );
+}
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <string>
+
+namespace OGLESSandbox
+{
+
+/*
+	SoftwareSampler
+
+	The texture bound to the unit a sampler uniform refers to, as seen by a fragment 
+	shader. Texels are RGBA, bottom row first. Without a texture, sample() returns 
+	opaque black like the GL does for an incomplete texture.
+*/
+struct SoftwareSampler
+{
+	SoftwareSampler();
+
+	void	sample( float s, float t, float color[4] ) const;
+
+	const unsigned char*	texels;
+	int						width;
+	int						height;
+	bool					linear;			// GL_TEXTURE_MAG_FILTER is GL_LINEAR (there's no mipmapping)
+	bool					repeatS;		// GL_REPEAT rather than GL_CLAMP_TO_EDGE
+	bool					repeatT;
+};
+
+/*
+	SoftwareShader
+
+	The C++ implementation of a GLSL shader for SoftwareGL, registered against its source 
+	with SoftwareGL::addShader(). It declares its uniforms (and the vertex shaders their 
+	attributes) in arrays ended by a NULL name. The uniforms it gets when called are in 
+	that same order: a pointer to the floats of each uniform (the texture unit for a sampler).
+*/
+class SoftwareShader
+{
+public:
+	enum 
+	{ 
+		MaxAttributes = 4,
+		MaxVaryings = 8
+	};
+
+	struct Uniform
+	{
+		const char*		name;
+		int				floatCount;		// 16 for a mat4, times the element count for an array. 0 for a sampler
+	};
+
+	virtual ~SoftwareShader() {}
+
+	virtual bool				isVertexShader() const = 0;
+	virtual const Uniform*		getUniforms() const = 0;
+};
+
+class SoftwareVertexShader : public SoftwareShader
+{
+public:
+	virtual bool				isVertexShader() const { return true; }
+	virtual const char* const*	getAttributes() const = 0;
+	virtual int					getVaryingCount() const = 0;
+
+	// Attributes are complete vec4s, (0,0,0,1) filling in what the vertex doesn't have
+	virtual void				operator()( const float* const* uniforms, const float attributes[][4], float position[4], float* varyings ) const = 0;
+};
+
+class SoftwareFragmentShader : public SoftwareShader
+{
+public:
+	virtual bool				isVertexShader() const { return false; }
+
+	// The samplers are those of the sampler uniforms, in declaration order. Returns false to discard the fragment
+	virtual bool				operator()( const float* const* uniforms, const SoftwareSampler* samplers, const float* varyings, float color[4] ) const = 0;
+};
+
+/*
+	SoftwareGL
+
+	A CPU implementation of the part of OpenGL ES 2.0 and EGL the sandbox applications 
+	use. When compiled in (ENABLE_SOFTWARE_GL CMake option) OGLESSoftwareGL.cpp defines
+	the gl and egl functions and the executables are no longer linked against the GPU 
+	libraries. It gives a throughput baseline on machines without a GPU, and frames that 
+	are the same bit for bit from one run to the next, whatever the thread count.
+
+	GLSL isn't compiled: glCompileShader() looks the source up among those registered 
+	with addShader() and fails for any other. Supported: triangles (indexed or not) from 
+	buffer objects or client memory, float and unsigned byte/short attributes, depth test, 
+	back face culling, scissor test, blending, RGBA8 textures (converted from the other 
+	unsigned byte formats) and frame buffer objects with a texture color attachment and 
+	a depth renderbuffer. Windows are pbuffer surfaces.
+
+	Triangles are clipped to the near plane and a guard band, then the viewport is split 
+	in tiles rasterized by the task runner, which may spread them across threads (each 
+	pixel belongs to a single tile, so the result doesn't depend on how). By default the 
+	tiles are rasterized by the calling thread.
+*/
+class SoftwareGL
+{
+public:
+	typedef void (*TaskFunction)( int taskIndex, void* userData );
+	typedef void (*TaskRunner)( TaskFunction function, void* userData, int taskCount, void* runnerData );
+
+	static bool		isCompiledIn();
+
+	// The shader isn't owned and must outlive the programs using it
+	static void		addShader( const std::string& source, const SoftwareShader* shader );
+
+	// Must run the tasks 0 to taskCount-1 and return once they're all done
+	static void		setTaskRunner( TaskRunner runner, void* runnerData );
+
+	enum { TileSize = 64 };
+};
+
+}
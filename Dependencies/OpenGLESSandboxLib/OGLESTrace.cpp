@@ -0,0 +1,249 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESTrace.h"
+
+#include <stdio.h>
+
+#ifdef _WIN32
+	#include <windows.h>
+	#define OGLES_THREAD_LOCAL	__declspec(thread)
+#else
+	#include <time.h>
+	#include <unistd.h>
+	#include <sys/syscall.h>
+	#define OGLES_THREAD_LOCAL	__thread
+#endif
+
+namespace OGLESSandbox
+{
+
+namespace
+{
+
+struct TraceEvent
+{
+	const char*			name;
+	unsigned long long	startTime;
+	unsigned int		duration;
+};
+
+struct TraceBuffer
+{
+	int						threadId;
+	const char* volatile	threadName;
+	TraceEvent*				events;
+	int						capacity;
+	volatile int			count;			// Only written by the owner thread
+	volatile int			droppedCount;
+	TraceBuffer*			next;
+};
+
+volatile bool			gStarted = false;
+volatile bool			gRecording = false;
+int						gEventsPerThread = 0;
+unsigned long long		gStartTime = 0;
+TraceBuffer* volatile	gBuffers = NULL;			// Lock-free list, buffers are only ever added
+
+OGLES_THREAD_LOCAL TraceBuffer*	tBuffer = NULL;
+OGLES_THREAD_LOCAL const char*	tThreadName = NULL;
+
+void memoryBarrier()
+{
+#ifdef _WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+bool compareAndSwap( TraceBuffer* volatile* destination, TraceBuffer* expected, TraceBuffer* value )
+{
+#ifdef _WIN32
+	return InterlockedCompareExchangePointer( reinterpret_cast<PVOID volatile*>(destination), value, expected )==expected;
+#else
+	return __sync_bool_compare_and_swap( destination, expected, value );
+#endif
+}
+
+int getCurrentThreadId()
+{
+#ifdef _WIN32
+	return static_cast<int>( GetCurrentThreadId() );
+#else
+	return static_cast<int>( syscall(SYS_gettid) );
+#endif
+}
+
+TraceBuffer* createBuffer()
+{
+	// The only allocation a thread ever makes for tracing
+	TraceBuffer* buffer = new TraceBuffer();
+	buffer->threadId = getCurrentThreadId();
+	buffer->threadName = tThreadName;
+	buffer->events = new TraceEvent[gEventsPerThread];
+	buffer->capacity = gEventsPerThread;
+	buffer->count = 0;
+	buffer->droppedCount = 0;
+	buffer->next = NULL;
+	do
+	{
+		buffer->next = gBuffers;
+	}
+	while ( !compareAndSwap( &gBuffers, buffer->next, buffer ) );
+	return buffer;
+}
+
+}
+
+bool Trace::isCompiledIn()
+{
+#ifdef OGLES_TRACE_ENABLED
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Trace::start( int eventsPerThread )
+{
+	if ( gStarted )
+	{
+		printf("Trace: recording can only be started once\n");
+		return false;
+	}
+	if ( eventsPerThread<=0 )
+		return false;
+	gEventsPerThread = eventsPerThread;
+	gStartTime = getTime();
+	gStarted = true;
+	memoryBarrier();
+	gRecording = true;
+	return true;
+}
+
+void Trace::stop()
+{
+	gRecording = false;
+}
+
+bool Trace::isRecording()
+{
+	return gRecording;
+}
+
+void Trace::setThreadName( const char* name )
+{
+	tThreadName = name;
+	if ( tBuffer )
+		tBuffer->threadName = name;
+}
+
+void Trace::addEvent( const char* name, unsigned long long startTime, unsigned long long endTime )
+{
+	if ( !gRecording )
+		return;
+	TraceBuffer* buffer = tBuffer;
+	if ( !buffer )
+	{
+		buffer = createBuffer();
+		tBuffer = buffer;
+	}
+
+	int count = buffer->count;
+	if ( count>=buffer->capacity )
+	{
+		buffer->droppedCount++;
+		return;
+	}
+	TraceEvent& event = buffer->events[count];
+	event.name = name;
+	event.startTime = startTime;
+	event.duration = static_cast<unsigned int>( endTime - startTime );
+	
+	// Publish: the event must be visible before the count that covers it
+	memoryBarrier();
+	buffer->count = count + 1;
+}
+
+unsigned long long Trace::getTime()
+{
+#ifdef _WIN32
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &counter );
+	return static_cast<unsigned long long>( counter.QuadPart / frequency.QuadPart * 1000000 + 
+											counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart );
+#else
+	struct timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+	return static_cast<unsigned long long>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+#endif
+}
+
+bool Trace::writeChromeJson( const std::string& path )
+{
+	FILE* file = fopen( path.c_str(), "w" );
+	if ( !file )
+	{
+		printf("Trace: failed to open %s\n", path.c_str() );
+		return false;
+	}
+
+#ifdef _WIN32
+	int processId = static_cast<int>( GetCurrentProcessId() );
+#else
+	int processId = static_cast<int>( getpid() );
+#endif
+
+	// Complete events ("ph":"X") with times in microseconds, plus one metadata event per thread for its name
+	fprintf( file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	fprintf( file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":0,\"args\":{\"name\":\"RiftOnThePi\"}}", processId );
+	int eventCount = 0;
+	int droppedCount = 0;
+	memoryBarrier();
+	for ( TraceBuffer* buffer=gBuffers; buffer!=NULL; buffer=buffer->next )
+	{
+		int count = buffer->count;
+		memoryBarrier();
+		const char* threadName = buffer->threadName;
+		if ( threadName )
+			fprintf( file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", processId, buffer->threadId, threadName );
+		for ( int i=0; i<count; ++i )
+		{
+			const TraceEvent& event = buffer->events[i];
+			long long startTime = static_cast<long long>(event.startTime) - static_cast<long long>(gStartTime);
+			fprintf( file, ",\n{\"name\":\"%s\",\"cat\":\"frame\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%u,\"pid\":%d,\"tid\":%d}", 
+				event.name, startTime, event.duration, processId, buffer->threadId );
+		}
+		eventCount += count;
+		droppedCount += buffer->droppedCount;
+	}
+	fprintf( file, "\n]}\n" );
+	fclose( file );
+	printf("Trace: %d events written to %s (%d dropped)\n", eventCount, path.c_str(), droppedCount );
+	return true;
+}
+
+}
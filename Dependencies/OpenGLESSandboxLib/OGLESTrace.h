@@ -0,0 +1,95 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <string>
+
+/*
+	Trace markers
+
+	OGLES_TRACE_SCOPE("name") records the time spent until the end of the enclosing 
+	scope, OGLES_TRACE_THREAD_NAME("name") names the calling thread in the trace. 
+	The name must be a string literal (only its address is stored).
+	Unless OGLES_TRACE_ENABLED is defined (ENABLE_TRACE CMake option) both expand to 
+	nothing, so the markers cost nothing in a regular build.
+*/
+#ifdef OGLES_TRACE_ENABLED
+	#define OGLES_TRACE_CONCATENATE2(a, b)	a##b
+	#define OGLES_TRACE_CONCATENATE(a, b)	OGLES_TRACE_CONCATENATE2(a, b)
+	#define OGLES_TRACE_SCOPE(name)			OGLESSandbox::TraceScope OGLES_TRACE_CONCATENATE(traceScope, __LINE__)(name)
+	#define OGLES_TRACE_THREAD_NAME(name)	OGLESSandbox::Trace::setThreadName(name)
+#else
+	#define OGLES_TRACE_SCOPE(name)
+	#define OGLES_TRACE_THREAD_NAME(name)
+#endif
+
+namespace OGLESSandbox
+{
+
+/*
+	Trace
+
+	Records time spans from any thread and exports them as Chrome trace-event JSON
+	(chrome://tracing or https://ui.perfetto.dev). 
+	Each thread writes into a buffer of its own, allocated the first time it records 
+	an event, so recording takes no lock: the event is written, then published by a 
+	release store of the buffer count which the export reads with an acquire load.
+	The buffers have a fixed capacity, events past it are counted as dropped.
+	Recording can only be started once per run.
+*/
+class Trace
+{
+public:
+	static bool			isCompiledIn();
+	static bool			start( int eventsPerThread );
+	static void			stop();
+	static bool			isRecording();
+	static bool			writeChromeJson( const std::string& path );
+
+	static void			setThreadName( const char* name );
+	static void			addEvent( const char* name, unsigned long long startTime, unsigned long long endTime );
+	static unsigned long long getTime();		// In microseconds, from an arbitrary origin
+};
+
+class TraceScope
+{
+public:
+	explicit TraceScope( const char* name )
+		: mName(name),
+		  mStartTime( Trace::isRecording() ? Trace::getTime() : 0 )
+	{
+	}
+
+	~TraceScope()
+	{
+		if ( mStartTime!=0 )
+			Trace::addEvent( mName, mStartTime, Trace::getTime() );
+	}
+
+private:
+	const char*			mName;
+	unsigned long long	mStartTime;
+};
+
+}
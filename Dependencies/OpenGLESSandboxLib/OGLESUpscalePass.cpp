@@ -0,0 +1,246 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESUpscalePass.h"
+
+#include <stdio.h>
+
+#include "OGLESGLCheck.h"
+
+#define check() OGLES_GL_CHECK()
+
+namespace OGLESSandbox
+{
+
+static const char VertexShaderString[] = 
+	"attribute vec4 Position; \n"
+	"attribute vec2 InputTexCoord; \n"
+	"varying vec2 oTexCoord; \n"
+	"void main() \n"
+	"{ \n"
+	"   oTexCoord = InputTexCoord; \n"
+	"   gl_Position = Position; \n"
+	"} \n";
+
+static const char FragmentShaderString[] = 
+	"uniform sampler2D Texture0;\n"
+	"varying mediump vec2 oTexCoord;\n"
+	"void main()\n"
+	"{\n"
+	"   gl_FragColor = texture2D(Texture0, oTexCoord);\n"
+	"}\n";
+
+// Triangle strip covering the screen: x, y, u, v
+static const GLfloat Vertices[] = {
+	-1.f, -1.f,		0.f, 0.f,
+	 1.f, -1.f,		1.f, 0.f,
+	-1.f,  1.f,		0.f, 1.f,
+	 1.f,  1.f,		1.f, 1.f
+};
+
+static GLuint compileShader( GLenum type, const char* source )
+{
+	GLuint shader = glCreateShader(type);
+	if ( shader==0 )
+		return 0;
+	glShaderSource( shader, 1, &source, NULL );
+	glCompileShader( shader );
+	GLint compiled = 0;
+	glGetShaderiv( shader, GL_COMPILE_STATUS, &compiled );
+	if ( !compiled )
+	{
+		printf("UpscalePass: error compiling shader\n");
+		glDeleteShader( shader );
+		return 0;
+	}
+	return shader;
+}
+
+UpscalePass::UpscalePass()
+	: mSourceWidth(0),
+	  mSourceHeight(0),
+	  mDestinationWidth(0),
+	  mDestinationHeight(0),
+	  mProgram(0),
+	  mPositionAttrib(0),
+	  mTexCoordAttrib(0),
+	  mTextureUniform(0),
+	  mVertexBuffer(0),
+	  mTexture(0),
+	  mDepthRenderBuffer(0),
+	  mFrameBuffer(0)
+{
+}
+
+UpscalePass::~UpscalePass()
+{
+	destroyTarget();
+	if ( mVertexBuffer )
+		glDeleteBuffers( 1, &mVertexBuffer );
+	if ( mProgram )
+		glDeleteProgram( mProgram );
+}
+
+bool UpscalePass::createProgram()
+{
+	GLuint vertexShader = compileShader( GL_VERTEX_SHADER, VertexShaderString );
+	GLuint fragmentShader = compileShader( GL_FRAGMENT_SHADER, FragmentShaderString );
+	if ( vertexShader==0 || fragmentShader==0 )
+		return false;
+
+	mProgram = glCreateProgram();
+	glAttachShader( mProgram, vertexShader );
+	glAttachShader( mProgram, fragmentShader );
+	glLinkProgram( mProgram );
+	glDeleteShader( vertexShader );
+	glDeleteShader( fragmentShader );
+	GLint linked = 0;
+	glGetProgramiv( mProgram, GL_LINK_STATUS, &linked );
+	if ( !linked )
+	{
+		printf("UpscalePass: error linking program\n");
+		glDeleteProgram( mProgram );
+		mProgram = 0;
+		return false;
+	}
+	mPositionAttrib = glGetAttribLocation( mProgram, "Position" );
+	mTexCoordAttrib = glGetAttribLocation( mProgram, "InputTexCoord" );
+	mTextureUniform = glGetUniformLocation( mProgram, "Texture0" );
+
+	glGenBuffers( 1, &mVertexBuffer );
+	check();
+	glBindBuffer( GL_ARRAY_BUFFER, mVertexBuffer );
+	check();
+	glBufferData( GL_ARRAY_BUFFER, sizeof(Vertices), Vertices, GL_STATIC_DRAW );
+	check();
+	return true;
+}
+
+void UpscalePass::destroyTarget()
+{
+	if ( mFrameBuffer )
+		glDeleteFramebuffers( 1, &mFrameBuffer );
+	if ( mDepthRenderBuffer )
+		glDeleteRenderbuffers( 1, &mDepthRenderBuffer );
+	if ( mTexture )
+		glDeleteTextures( 1, &mTexture );
+	mFrameBuffer = 0;
+	mDepthRenderBuffer = 0;
+	mTexture = 0;
+}
+
+bool UpscalePass::setSizes( int sourceWidth, int sourceHeight, int destinationWidth, int destinationHeight )
+{
+	mDestinationWidth = destinationWidth;
+	mDestinationHeight = destinationHeight;
+	if ( mFrameBuffer && sourceWidth==mSourceWidth && sourceHeight==mSourceHeight )
+		return true;
+
+	if ( !mProgram && !createProgram() )
+		return false;
+
+	destroyTarget();
+	mSourceWidth = sourceWidth;
+	mSourceHeight = sourceHeight;
+	if ( sourceWidth<=0 || sourceHeight<=0 )
+		return false;
+
+	glGenTextures( 1, &mTexture );
+	check();
+	glBindTexture( GL_TEXTURE_2D, mTexture );
+	check();
+	glTexImage2D( GL_TEXTURE_2D, 0, GL_RGB, sourceWidth, sourceHeight, 0, GL_RGB, GL_UNSIGNED_BYTE, 0 );
+	check();
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE );
+	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE );
+	check();
+
+	// Applications may use depth when drawing straight to what they think is the window
+	glGenRenderbuffers( 1, &mDepthRenderBuffer );
+	check();
+	glBindRenderbuffer( GL_RENDERBUFFER, mDepthRenderBuffer );
+	check();
+	glRenderbufferStorage( GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, sourceWidth, sourceHeight );
+	check();
+
+	glGenFramebuffers( 1, &mFrameBuffer );
+	check();
+	glBindFramebuffer( GL_FRAMEBUFFER, mFrameBuffer );
+	check();
+	glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mTexture, 0 );
+	check();
+	glFramebufferRenderbuffer( GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mDepthRenderBuffer );
+	check();
+	GLenum status = glCheckFramebufferStatus( GL_FRAMEBUFFER );
+	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+	check();
+	if ( status!=GL_FRAMEBUFFER_COMPLETE )
+	{
+		printf("UpscalePass: incomplete frame buffer (0x%x)\n", status );
+		destroyTarget();
+		return false;
+	}
+	printf("UpscalePass: %dx%d -> %dx%d\n", sourceWidth, sourceHeight, destinationWidth, destinationHeight );
+	return true;
+}
+
+void UpscalePass::draw()
+{
+	if ( !mFrameBuffer )
+		return;
+
+	glBindFramebuffer( GL_FRAMEBUFFER, 0 );
+	check();
+	glViewport( 0, 0, mDestinationWidth, mDestinationHeight );
+	check();
+	glDisable( GL_DEPTH_TEST );
+	glDisable( GL_CULL_FACE );
+	glDisable( GL_BLEND );
+	check();
+
+	glUseProgram( mProgram );
+	check();
+	glActiveTexture( GL_TEXTURE0 );
+	check();
+	glBindTexture( GL_TEXTURE_2D, mTexture );
+	check();
+	glUniform1i( mTextureUniform, 0 );
+	check();
+	glBindBuffer( GL_ARRAY_BUFFER, mVertexBuffer );
+	check();
+	glVertexAttribPointer( mPositionAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat)*4, 0 );
+	check();
+	glVertexAttribPointer( mTexCoordAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(GLfloat)*4, (GLvoid*) (sizeof(GLfloat)*2) );
+	check();
+	glEnableVertexAttribArray( mPositionAttrib );
+	check();
+	glEnableVertexAttribArray( mTexCoordAttrib );
+	check();
+	glDrawArrays( GL_TRIANGLE_STRIP, 0, 4 );
+	check();
+	OGLES_GL_CHECK_PASS( "upscalePass" );
+}
+
+}
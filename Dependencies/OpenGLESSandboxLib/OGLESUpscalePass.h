@@ -0,0 +1,75 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <EGL/egl.h>
+#include <GLES2/gl2.h>
+
+namespace OGLESSandbox
+{
+
+/*
+	UpscalePass
+
+	Lets an application render into a surface smaller than the window when the 
+	platform has no hardware scaler to do the job. The application draws into 
+	an offscreen frame buffer of the render surface size, which then gets 
+	stretched over the whole window with a single bilinear textured quad.
+*/
+class UpscalePass
+{
+public:
+	UpscalePass();
+	~UpscalePass();
+
+	// (Re)create the offscreen frame buffer if the sizes changed. Needs a current GL context
+	bool	setSizes( int sourceWidth, int sourceHeight, int destinationWidth, int destinationHeight );
+	
+	// The frame buffer the application draws into instead of the window
+	GLuint	getFrameBuffer() const { return mFrameBuffer; }
+	
+	// Draw the offscreen image over the window frame buffer
+	void	draw();
+
+private:
+	bool	createProgram();
+	void	destroyTarget();
+
+	int		mSourceWidth;
+	int		mSourceHeight;
+	int		mDestinationWidth;
+	int		mDestinationHeight;
+
+	GLuint	mProgram;
+	GLint	mPositionAttrib;
+	GLint	mTexCoordAttrib;
+	GLint	mTextureUniform;
+	GLuint	mVertexBuffer;
+	
+	GLuint	mTexture;
+	GLuint	mDepthRenderBuffer;
+	GLuint	mFrameBuffer;
+};
+
+}
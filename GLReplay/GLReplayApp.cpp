@@ -0,0 +1,617 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "GLReplayApp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "OGLESGLCapture.h"
+#include "OGLESTrace.h"
+
+namespace OGLESSandbox
+{
+
+GLReplayApp::GLReplayApp()
+	: mParameters(),
+	  mCaptureFile(),
+	  mLoopCount(100),
+	  mStream(),
+	  mFirstFrameStart(0),
+	  mPosition(0),
+	  mFrameCount(0),
+	  mFrame(0),
+	  mLoop(0),
+	  mStreamError(false),
+	  mOutputFrameBuffer(0),
+	  mCapturedProgram(0),
+	  mLastFrameTime(0),
+	  mSubmitTimeSum(0),
+	  mSubmitTimeMax(0),
+	  mFrameTimeSum(0),
+	  mFrameTimeMax(0),
+	  mTimedFrames(0)
+{
+	mParameters.addString( "CaptureFile", &mCaptureFile, 0, "File written by GLCapture" );
+	mParameters.addInt( "ReplayLoops", &mLoopCount, 0, "Passes over the captured frames before exiting" );
+}
+
+// Like the application the capture comes from, with a depth buffer in case it drew to the window with depth testing
+EGLConfigRequest GLReplayApp::getEGLConfigRequest( const ApplicationContext& context )
+{
+	EGLConfigRequest request;
+	request.preferredDepthSize = 16;
+	return request;
+}
+
+bool GLReplayApp::initialize( const ApplicationContext& context )
+{
+	mParameters.setFromParameters( context.parameters );
+	mParameters.applyPendingChanges();
+	mParameters.print();
+	if ( mLoopCount<1 )
+	{
+		printf("ReplayLoops %d is not supported, using 1\n", mLoopCount );
+		mLoopCount = 1;
+	}
+	if ( !load( mCaptureFile ) )
+		return false;
+
+	// Rebuild the state the captured frames start from
+	mOutputFrameBuffer = context.frameBuffer;
+	std::size_t position = 0;
+	while ( position<mStream.size() && mStream[position]!=GLCapture::CaptureStart )
+		position = execute( position );
+	if ( mStreamError )
+		return false;
+	if ( position==mStream.size() )
+	{
+		printf("GLReplay: no captured frame in %s\n", mCaptureFile.c_str() );
+		return false;
+	}
+	mFirstFrameStart = position + 1;
+	mPosition = mFirstFrameStart;
+	printf("GLReplay: state set up with %u words of commands, %u words of frames\n", 
+		static_cast<unsigned int>(mFirstFrameStart), static_cast<unsigned int>(mStream.size() - mFirstFrameStart) );
+	return true;
+}
+
+bool GLReplayApp::load( const std::string& path )
+{
+	FILE* file = fopen( path.c_str(), "rb" );
+	if ( !file )
+	{
+		printf("GLReplay: can't open '%s'\n", path.c_str() );
+		return false;
+	}
+	GLCapture::Header header;
+	bool valid = fread( &header, sizeof(header), 1, file )==1 && 
+				 memcmp( header.magic, "OGLESCAP", sizeof(header.magic) )==0 && 
+				 header.version==GLCapture::Version;
+	if ( !valid )
+	{
+		printf("GLReplay: %s isn't a capture file of version %d\n", path.c_str(), GLCapture::Version );
+		fclose( file );
+		return false;
+	}
+	fseek( file, 0, SEEK_END );
+	long size = ftell( file ) - static_cast<long>(sizeof(header));
+	fseek( file, sizeof(header), SEEK_SET );
+	mStream.resize( size / sizeof(unsigned int) );
+	std::size_t read = mStream.empty() ? 0 : fread( &mStream[0], sizeof(unsigned int), mStream.size(), file );
+	fclose( file );
+	if ( read!=mStream.size() )
+	{
+		printf("GLReplay: can't read %s\n", path.c_str() );
+		return false;
+	}
+	printf("GLReplay: %s, frames %u to %u, %ldKB\n", path.c_str(), header.firstFrame, header.firstFrame + header.frameCount - 1, size / 1024 );
+	return true;
+}
+
+void GLReplayApp::draw( const ApplicationContext& context )
+{
+	unsigned long long startTime = Trace::getTime();
+	if ( mLastFrameTime!=0 )
+	{
+		unsigned long long frameTime = startTime - mLastFrameTime;
+		mFrameTimeSum += frameTime;
+		if ( frameTime>mFrameTimeMax )
+			mFrameTimeMax = frameTime;
+	}
+	mLastFrameTime = startTime;
+
+	// Issue the commands of one frame
+	while ( mPosition<mStream.size() && mStream[mPosition]!=GLCapture::FrameEnd )
+		mPosition = execute( mPosition );
+	if ( mStreamError )
+		return;
+	unsigned long long submitTime = Trace::getTime() - startTime;
+	mSubmitTimeSum += submitTime;
+	if ( submitTime>mSubmitTimeMax )
+		mSubmitTimeMax = submitTime;
+	mTimedFrames++;
+
+	context.swapBuffers();
+	mPosition++;
+	mFrame++;
+
+	// Back to the first captured frame at the end of the stream
+	if ( mPosition>=mStream.size() )
+	{
+		mFrameCount = mFrame;
+		report();
+		mPosition = mFirstFrameStart;
+		mFrame = 0;
+		mLoop++;
+	}
+}
+
+void GLReplayApp::report()
+{
+	// The first frame of a pass has no previous frame time in the first pass
+	int frameTimeCount = mLoop==0 ? mTimedFrames - 1 : mTimedFrames;
+	double frameTimeMean = frameTimeCount>0 ? static_cast<double>(mFrameTimeSum) / frameTimeCount / 1000.0 : 0.0;
+	printf("GLReplay pass %d (%d frames): submit mean %.3fms max %.3fms, frame mean %.3fms max %.3fms (%.1f fps)\n", 
+		mLoop, mFrameCount, static_cast<double>(mSubmitTimeSum) / mTimedFrames / 1000.0, mSubmitTimeMax / 1000.0, 
+		frameTimeMean, mFrameTimeMax / 1000.0, frameTimeMean>0.0 ? 1000.0 / frameTimeMean : 0.0 );
+	mSubmitTimeSum = 0;
+	mSubmitTimeMax = 0;
+	mFrameTimeSum = 0;
+	mFrameTimeMax = 0;
+	mTimedFrames = 0;
+}
+
+const void* GLReplayApp::readData( std::size_t& position, unsigned int& size ) const
+{
+	size = mStream[position++];
+	if ( size==GLCapture::NullData )
+	{
+		size = 0;
+		return NULL;
+	}
+	const void* data = &mStream[position];
+	position += (size + 3) / 4;
+	return data;
+}
+
+float GLReplayApp::readFloat( std::size_t& position ) const
+{
+	float value = 0.f;
+	memcpy( &value, &mStream[position++], sizeof(value) );
+	return value;
+}
+
+void GLReplayApp::readNames( std::size_t& position, std::vector<GLuint>& names )
+{
+	GLsizei n = static_cast<GLsizei>(mStream[position++]);
+	names.resize( n );
+	for ( GLsizei i=0; i<n; ++i )
+		names[i] = mStream[position++];
+}
+
+GLuint GLReplayApp::getName( const std::vector<GLuint>& names, GLuint capturedName )
+{
+	if ( capturedName<names.size() && names[capturedName]!=0 )
+		return names[capturedName];
+	return capturedName;
+}
+
+void GLReplayApp::setName( std::vector<GLuint>& names, GLuint capturedName, GLuint name )
+{
+	if ( capturedName>=names.size() )
+		names.resize( capturedName + 1, 0 );
+	names[capturedName] = name;
+}
+
+GLint GLReplayApp::getUniformLocation( GLint capturedLocation ) const
+{
+	if ( capturedLocation<0 || mCapturedProgram>=mUniformLocations.size() )
+		return capturedLocation;
+	const std::vector<GLint>& locations = mUniformLocations[mCapturedProgram];
+	if ( static_cast<std::size_t>(capturedLocation)>=locations.size() )
+		return capturedLocation;
+	return locations[capturedLocation];
+}
+
+GLuint GLReplayApp::getAttribLocation( GLuint capturedLocation ) const
+{
+	if ( capturedLocation>=mAttribLocations.size() || mAttribLocations[capturedLocation]<0 )
+		return capturedLocation;
+	return static_cast<GLuint>(mAttribLocations[capturedLocation]);
+}
+
+// Issues the command at the given position and returns the position of the next one, or the end 
+// of the stream after an unknown command (mStreamError tells it)
+std::size_t GLReplayApp::execute( std::size_t position )
+{
+	const std::vector<unsigned int>& s = mStream;
+	unsigned int command = s[position++];
+	unsigned int size = 0;
+	switch ( command )
+	{
+		case GLCapture::ActiveTexture:
+			glActiveTexture( s[position] );
+			position += 1;
+			break;
+		case GLCapture::AttachShader:
+			glAttachShader( getName(mPrograms, s[position]), getName(mShaders, s[position+1]) );
+			position += 2;
+			break;
+		case GLCapture::BindBuffer:
+			glBindBuffer( s[position], getName(mBuffers, s[position+1]) );
+			position += 2;
+			break;
+		case GLCapture::BindFramebuffer:
+			glBindFramebuffer( s[position], s[position+1]==0 ? mOutputFrameBuffer : getName(mFramebuffers, s[position+1]) );
+			position += 2;
+			break;
+		case GLCapture::BindRenderbuffer:
+			glBindRenderbuffer( s[position], getName(mRenderbuffers, s[position+1]) );
+			position += 2;
+			break;
+		case GLCapture::BindTexture:
+			glBindTexture( s[position], getName(mTextures, s[position+1]) );
+			position += 2;
+			break;
+		case GLCapture::BlendFunc:
+			glBlendFunc( s[position], s[position+1] );
+			position += 2;
+			break;
+		case GLCapture::BufferData:
+		{
+			GLenum target = s[position++];
+			GLsizeiptr bufferSize = static_cast<GLsizeiptr>(s[position++]);
+			const void* data = readData( position, size );
+			glBufferData( target, bufferSize, data, s[position++] );
+			break;
+		}
+		case GLCapture::BufferSubData:
+		{
+			GLenum target = s[position++];
+			GLintptr offset = static_cast<GLintptr>(s[position++]);
+			const void* data = readData( position, size );
+			glBufferSubData( target, offset, size, data );
+			break;
+		}
+		case GLCapture::CheckFramebufferStatus:
+			glCheckFramebufferStatus( s[position] );
+			position += 1;
+			break;
+		case GLCapture::Clear:
+			glClear( s[position] );
+			position += 1;
+			break;
+		case GLCapture::ClearColor:
+		{
+			float red = readFloat( position );
+			float green = readFloat( position );
+			float blue = readFloat( position );
+			float alpha = readFloat( position );
+			glClearColor( red, green, blue, alpha );
+			break;
+		}
+		case GLCapture::ClearDepthf:
+			glClearDepthf( readFloat(position) );
+			break;
+		case GLCapture::CompileShader:
+			glCompileShader( getName(mShaders, s[position]) );
+			position += 1;
+			break;
+		case GLCapture::CreateProgram:
+			setName( mPrograms, s[position], glCreateProgram() );
+			position += 1;
+			break;
+		case GLCapture::CreateShader:
+			setName( mShaders, s[position+1], glCreateShader(s[position]) );
+			position += 2;
+			break;
+		case GLCapture::DeleteBuffers:
+		case GLCapture::DeleteFramebuffers:
+		case GLCapture::DeleteRenderbuffers:
+		case GLCapture::DeleteTextures:
+		{
+			std::vector<GLuint>& names = command==GLCapture::DeleteBuffers ? mBuffers : 
+										 command==GLCapture::DeleteFramebuffers ? mFramebuffers : 
+										 command==GLCapture::DeleteRenderbuffers ? mRenderbuffers : mTextures;
+			readNames( position, mNames );
+			for ( std::size_t i=0; i<mNames.size(); ++i )
+			{
+				GLuint capturedName = mNames[i];
+				mNames[i] = getName( names, capturedName );
+				setName( names, capturedName, 0 );
+			}
+			GLsizei n = static_cast<GLsizei>(mNames.size());
+			const GLuint* deletedNames = n>0 ? &mNames[0] : NULL;
+			if ( command==GLCapture::DeleteBuffers )
+				glDeleteBuffers( n, deletedNames );
+			else if ( command==GLCapture::DeleteFramebuffers )
+				glDeleteFramebuffers( n, deletedNames );
+			else if ( command==GLCapture::DeleteRenderbuffers )
+				glDeleteRenderbuffers( n, deletedNames );
+			else
+				glDeleteTextures( n, deletedNames );
+			break;
+		}
+		case GLCapture::DeleteProgram:
+			glDeleteProgram( getName(mPrograms, s[position]) );
+			setName( mPrograms, s[position], 0 );
+			position += 1;
+			break;
+		case GLCapture::DeleteShader:
+			glDeleteShader( getName(mShaders, s[position]) );
+			setName( mShaders, s[position], 0 );
+			position += 1;
+			break;
+		case GLCapture::DepthFunc:
+			glDepthFunc( s[position] );
+			position += 1;
+			break;
+		case GLCapture::Disable:
+			glDisable( s[position] );
+			position += 1;
+			break;
+		case GLCapture::DisableVertexAttribArray:
+			glDisableVertexAttribArray( getAttribLocation(s[position]) );
+			position += 1;
+			break;
+		case GLCapture::DrawArrays:
+			glDrawArrays( s[position], static_cast<GLint>(s[position+1]), static_cast<GLsizei>(s[position+2]) );
+			position += 3;
+			break;
+		case GLCapture::DrawElements:
+			glDrawElements( s[position], static_cast<GLsizei>(s[position+1]), s[position+2], reinterpret_cast<const GLvoid*>( static_cast<std::size_t>(s[position+3]) ) );
+			position += 4;
+			break;
+		case GLCapture::Enable:
+			glEnable( s[position] );
+			position += 1;
+			break;
+		case GLCapture::EnableVertexAttribArray:
+			glEnableVertexAttribArray( getAttribLocation(s[position]) );
+			position += 1;
+			break;
+		case GLCapture::Finish:
+			glFinish();
+			break;
+		case GLCapture::Flush:
+			glFlush();
+			break;
+		case GLCapture::FramebufferRenderbuffer:
+			glFramebufferRenderbuffer( s[position], s[position+1], s[position+2], getName(mRenderbuffers, s[position+3]) );
+			position += 4;
+			break;
+		case GLCapture::FramebufferTexture2D:
+			glFramebufferTexture2D( s[position], s[position+1], s[position+2], getName(mTextures, s[position+3]), static_cast<GLint>(s[position+4]) );
+			position += 5;
+			break;
+		case GLCapture::GenBuffers:
+		case GLCapture::GenFramebuffers:
+		case GLCapture::GenRenderbuffers:
+		case GLCapture::GenTextures:
+		{
+			std::vector<GLuint>& names = command==GLCapture::GenBuffers ? mBuffers : 
+										 command==GLCapture::GenFramebuffers ? mFramebuffers : 
+										 command==GLCapture::GenRenderbuffers ? mRenderbuffers : mTextures;
+			readNames( position, mNames );
+			for ( std::size_t i=0; i<mNames.size(); ++i )
+			{
+				GLuint name = 0;
+				if ( command==GLCapture::GenBuffers )
+					glGenBuffers( 1, &name );
+				else if ( command==GLCapture::GenFramebuffers )
+					glGenFramebuffers( 1, &name );
+				else if ( command==GLCapture::GenRenderbuffers )
+					glGenRenderbuffers( 1, &name );
+				else
+					glGenTextures( 1, &name );
+				setName( names, mNames[i], name );
+			}
+			break;
+		}
+		case GLCapture::GetAttribLocation:
+		{
+			GLuint program = getName( mPrograms, s[position++] );
+			const char* name = static_cast<const char*>( readData( position, size ) );
+			std::string nameString( name ? name : "", size );
+			GLint capturedLocation = static_cast<GLint>(s[position++]);
+			GLint location = glGetAttribLocation( program, nameString.c_str() );
+			if ( capturedLocation>=0 )
+			{
+				if ( static_cast<std::size_t>(capturedLocation)>=mAttribLocations.size() )
+					mAttribLocations.resize( capturedLocation + 1, -1 );
+				mAttribLocations[capturedLocation] = location;
+			}
+			break;
+		}
+		case GLCapture::GetError:
+			glGetError();
+			break;
+		case GLCapture::GetProgramInfoLog:
+		case GLCapture::GetShaderInfoLog:
+		{
+			GLsizei bufferSize = static_cast<GLsizei>(s[position+1]);
+			mReadBuffer.resize( bufferSize>0 ? bufferSize : 1 );
+			if ( command==GLCapture::GetProgramInfoLog )
+				glGetProgramInfoLog( getName(mPrograms, s[position]), bufferSize, NULL, &mReadBuffer[0] );
+			else
+				glGetShaderInfoLog( getName(mShaders, s[position]), bufferSize, NULL, &mReadBuffer[0] );
+			position += 2;
+			break;
+		}
+		case GLCapture::GetProgramiv:
+		{
+			GLint value = 0;
+			glGetProgramiv( getName(mPrograms, s[position]), s[position+1], &value );
+			position += 2;
+			break;
+		}
+		case GLCapture::GetShaderiv:
+		{
+			GLint value = 0;
+			glGetShaderiv( getName(mShaders, s[position]), s[position+1], &value );
+			position += 2;
+			break;
+		}
+		case GLCapture::GetUniformLocation:
+		{
+			GLuint capturedProgram = s[position++];
+			const char* name = static_cast<const char*>( readData( position, size ) );
+			std::string nameString( name ? name : "", size );
+			GLint capturedLocation = static_cast<GLint>(s[position++]);
+			GLint location = glGetUniformLocation( getName(mPrograms, capturedProgram), nameString.c_str() );
+			if ( capturedLocation>=0 )
+			{
+				if ( capturedProgram>=mUniformLocations.size() )
+					mUniformLocations.resize( capturedProgram + 1 );
+				std::vector<GLint>& locations = mUniformLocations[capturedProgram];
+				while ( locations.size()<=static_cast<std::size_t>(capturedLocation) )
+					locations.push_back( static_cast<GLint>(locations.size()) );
+				locations[capturedLocation] = location;
+			}
+			break;
+		}
+		case GLCapture::LinkProgram:
+			glLinkProgram( getName(mPrograms, s[position]) );
+			position += 1;
+			break;
+		case GLCapture::PixelStorei:
+			glPixelStorei( s[position], static_cast<GLint>(s[position+1]) );
+			position += 2;
+			break;
+		case GLCapture::ReadPixels:
+		{
+			GLsizei width = static_cast<GLsizei>(s[position+2]);
+			GLsizei height = static_cast<GLsizei>(s[position+3]);
+			mReadBuffer.resize( width>0 && height>0 ? width * height * 4 : 4 );
+			glReadPixels( static_cast<GLint>(s[position]), static_cast<GLint>(s[position+1]), width, height, s[position+4], s[position+5], &mReadBuffer[0] );
+			position += 6;
+			break;
+		}
+		case GLCapture::RenderbufferStorage:
+			glRenderbufferStorage( s[position], s[position+1], static_cast<GLsizei>(s[position+2]), static_cast<GLsizei>(s[position+3]) );
+			position += 4;
+			break;
+		case GLCapture::Scissor:
+			glScissor( static_cast<GLint>(s[position]), static_cast<GLint>(s[position+1]), static_cast<GLsizei>(s[position+2]), static_cast<GLsizei>(s[position+3]) );
+			position += 4;
+			break;
+		case GLCapture::ShaderSource:
+		{
+			GLuint shader = getName( mShaders, s[position++] );
+			GLsizei count = static_cast<GLsizei>(s[position++]);
+			std::vector<const GLchar*> strings( count>0 ? count : 1 );
+			std::vector<GLint> lengths( count>0 ? count : 1 );
+			for ( GLsizei i=0; i<count; ++i )
+			{
+				strings[i] = static_cast<const GLchar*>( readData( position, size ) );
+				lengths[i] = static_cast<GLint>(size);
+			}
+			glShaderSource( shader, count, &strings[0], &lengths[0] );
+			break;
+		}
+		case GLCapture::TexImage2D:
+		{
+			GLenum target = s[position++];
+			GLint level = static_cast<GLint>(s[position++]);
+			GLint internalFormat = static_cast<GLint>(s[position++]);
+			GLsizei width = static_cast<GLsizei>(s[position++]);
+			GLsizei height = static_cast<GLsizei>(s[position++]);
+			GLint border = static_cast<GLint>(s[position++]);
+			GLenum format = s[position++];
+			GLenum type = s[position++];
+			const void* pixels = readData( position, size );
+			glTexImage2D( target, level, internalFormat, width, height, border, format, type, pixels );
+			break;
+		}
+		case GLCapture::TexParameterf:
+		{
+			GLenum target = s[position++];
+			GLenum name = s[position++];
+			glTexParameterf( target, name, readFloat(position) );
+			break;
+		}
+		case GLCapture::TexParameteri:
+			glTexParameteri( s[position], s[position+1], static_cast<GLint>(s[position+2]) );
+			position += 3;
+			break;
+		case GLCapture::Uniform1i:
+			glUniform1i( getUniformLocation( static_cast<GLint>(s[position]) ), static_cast<GLint>(s[position+1]) );
+			position += 2;
+			break;
+		case GLCapture::Uniform2f:
+		{
+			GLint location = getUniformLocation( static_cast<GLint>(s[position++]) );
+			float x = readFloat( position );
+			float y = readFloat( position );
+			glUniform2f( location, x, y );
+			break;
+		}
+		case GLCapture::Uniform2fv:
+		case GLCapture::Uniform4fv:
+		{
+			GLint location = getUniformLocation( static_cast<GLint>(s[position++]) );
+			GLsizei count = static_cast<GLsizei>(s[position++]);
+			const GLfloat* values = static_cast<const GLfloat*>( readData( position, size ) );
+			if ( command==GLCapture::Uniform2fv )
+				glUniform2fv( location, count, values );
+			else
+				glUniform4fv( location, count, values );
+			break;
+		}
+		case GLCapture::UniformMatrix4fv:
+		{
+			GLint location = getUniformLocation( static_cast<GLint>(s[position++]) );
+			GLsizei count = static_cast<GLsizei>(s[position++]);
+			GLboolean transpose = static_cast<GLboolean>(s[position++]);
+			const GLfloat* values = static_cast<const GLfloat*>( readData( position, size ) );
+			glUniformMatrix4fv( location, count, transpose, values );
+			break;
+		}
+		case GLCapture::UseProgram:
+			mCapturedProgram = s[position];
+			glUseProgram( getName(mPrograms, s[position]) );
+			position += 1;
+			break;
+		case GLCapture::VertexAttribPointer:
+			glVertexAttribPointer( getAttribLocation(s[position]), static_cast<GLint>(s[position+1]), s[position+2], static_cast<GLboolean>(s[position+3]), 
+				static_cast<GLsizei>(s[position+4]), reinterpret_cast<const GLvoid*>( static_cast<std::size_t>(s[position+5]) ) );
+			position += 6;
+			break;
+		case GLCapture::Viewport:
+			glViewport( static_cast<GLint>(s[position]), static_cast<GLint>(s[position+1]), static_cast<GLsizei>(s[position+2]), static_cast<GLsizei>(s[position+3]) );
+			position += 4;
+			break;
+		case GLCapture::CaptureStart:
+		case GLCapture::FrameEnd:
+			break;
+		default:
+			printf("GLReplay: unknown command %u, stopping\n", command );
+			mStreamError = true;
+			return s.size();
+	}
+	return position;
+}
+
+}
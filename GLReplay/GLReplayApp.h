@@ -0,0 +1,106 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "OGLESApplication.h"
+#include "OGLESParameterRegistry.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	GLReplayApp
+
+	Plays back a file written by GLCapture. The commands recorded before the captured 
+	frames are issued once at initialization to rebuild the GL state, then the captured 
+	frames are issued over and over, as fast as the swap allows. The time taken to issue 
+	the commands of each frame (driver CPU cost) and the time between two frames (GPU 
+	throughput, or the display rate) are reported after each pass over the frames.
+	The names and uniform locations the replay gets from the GL are mapped from the 
+	captured ones. The captured frames are expected not to create or delete objects.
+	The replay is done after --ReplayLoops passes, or as soon as it meets a command it 
+	doesn't know, which also fails the exit status.
+*/
+class GLReplayApp : public Application
+{
+public:
+	GLReplayApp();
+	virtual EGLConfigRequest getEGLConfigRequest( const ApplicationContext& context );
+	virtual bool initialize( const ApplicationContext& context );
+	virtual void draw( const ApplicationContext& context );
+	virtual bool isDone() const { return mStreamError || mLoop>=mLoopCount; }
+	virtual int getExitStatus() const { return mStreamError || mFirstFrameStart==0 ? 1 : 0; }	// Also when the capture couldn't be set up
+
+private:
+	bool				load( const std::string& path );
+	std::size_t			execute( std::size_t position );
+	const void*			readData( std::size_t& position, unsigned int& size ) const;
+	float				readFloat( std::size_t& position ) const;
+	void				readNames( std::size_t& position, std::vector<GLuint>& names );
+	void				report();
+
+	static GLuint		getName( const std::vector<GLuint>& names, GLuint capturedName );
+	static void			setName( std::vector<GLuint>& names, GLuint capturedName, GLuint name );
+	GLint				getUniformLocation( GLint capturedLocation ) const;
+	GLuint				getAttribLocation( GLuint capturedLocation ) const;
+
+	ParameterRegistry	mParameters;
+	std::string			mCaptureFile;
+	int					mLoopCount;					// Passes over the captured frames before exiting
+
+	std::vector<unsigned int>	mStream;			// The commands, in 32-bit words
+	std::size_t			mFirstFrameStart;
+	std::size_t			mPosition;
+	int					mFrameCount;				// Known once the whole stream was played
+	int					mFrame;
+	int					mLoop;
+	bool				mStreamError;				// An unknown command was met, nothing after it can be issued
+	GLuint				mOutputFrameBuffer;
+
+	// Captured names to replay names
+	std::vector<GLuint>	mBuffers;
+	std::vector<GLuint>	mTextures;
+	std::vector<GLuint>	mFramebuffers;
+	std::vector<GLuint>	mRenderbuffers;
+	std::vector<GLuint>	mShaders;
+	std::vector<GLuint>	mPrograms;
+	std::vector< std::vector<GLint> > mUniformLocations;	// Per captured program
+	std::vector<GLint>	mAttribLocations;
+	GLuint				mCapturedProgram;			// In use
+	std::vector<GLuint>	mNames;						// Scratch
+	std::vector<char>	mReadBuffer;				// Scratch for glReadPixels and the info logs
+
+	// Times of the current pass, in microseconds
+	unsigned long long	mLastFrameTime;
+	unsigned long long	mSubmitTimeSum;
+	unsigned long long	mSubmitTimeMax;
+	unsigned long long	mFrameTimeSum;
+	unsigned long long	mFrameTimeMax;
+	int					mTimedFrames;
+};
+
+}
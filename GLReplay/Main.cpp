@@ -0,0 +1,44 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "OGLESApplicationRunner.h"
+#include "GLReplayApp.h"
+
+int main( int argc, char** argv )
+{
+	OGLESSandbox::Application* application = new OGLESSandbox::GLReplayApp();
+	OGLESSandbox::ApplicationRunner* runner = OGLESSandbox::ApplicationRunner::create();
+	
+	runner->run( application, argc, argv );
+	int exitStatus = application->getExitStatus();
+	if ( exitStatus==0 )
+		exitStatus = runner->getExitStatus();
+
+	delete application;
+	application = NULL;
+
+	delete runner;
+	runner = NULL;
+
+	return exitStatus;
+}
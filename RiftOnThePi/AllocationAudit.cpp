@@ -0,0 +1,202 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "AllocationAudit.h"
+
+#include <stdlib.h>
+#include <new>
+
+#if defined(_MSC_VER)
+	#define OGLES_THREAD_LOCAL __declspec(thread)
+#else
+	#define OGLES_THREAD_LOCAL __thread
+#endif
+
+#if __cplusplus >= 201103L
+	#define OGLES_THROWS_BAD_ALLOC
+	#define OGLES_THROWS_NOTHING noexcept
+#else
+	#define OGLES_THROWS_BAD_ALLOC throw(std::bad_alloc)
+	#define OGLES_THROWS_NOTHING throw()
+#endif
+
+namespace
+{
+
+// Plain old data only: these are read by operator new, which can run before any constructor
+OGLES_THREAD_LOCAL bool			gActive = false;
+OGLES_THREAD_LOCAL unsigned int	gNewCount = 0;
+OGLES_THREAD_LOCAL unsigned int	gOVRCount = 0;
+OGLES_THREAD_LOCAL OVR::UPInt	gBytes = 0;
+
+inline void countNew( std::size_t size )
+{
+	if ( !gActive )
+		return;
+	++gNewCount;
+	gBytes += size;
+}
+
+void* allocate( std::size_t size )
+{
+	countNew( size );
+	void* p = malloc( size>0 ? size : 1 );
+	if ( !p )
+		throw std::bad_alloc();
+	return p;
+}
+
+void* allocateNoThrow( std::size_t size )
+{
+	countNew( size );
+	return malloc( size>0 ? size : 1 );
+}
+
+class AuditAllocator : public OVR::Allocator
+{
+public:
+	AuditAllocator()
+		: mTarget(NULL)
+	{
+	}
+
+	virtual void* Alloc( OVR::UPInt size )
+	{
+		count( size );
+		return getTarget()->Alloc( size );
+	}
+
+	virtual void* Realloc( void* p, OVR::UPInt newSize )
+	{
+		count( newSize );
+		return getTarget()->Realloc( p, newSize );
+	}
+
+	virtual void Free( void* p )
+	{
+		getTarget()->Free( p );
+	}
+
+private:
+	static void count( OVR::UPInt size )
+	{
+		if ( !gActive )
+			return;
+		++gOVRCount;
+		gBytes += size;
+	}
+
+	// Created on first use: OVR::System::Init() is given this allocator before any allocation
+	OVR::Allocator* getTarget()
+	{
+		if ( !mTarget )
+			mTarget = OVR::DefaultAllocator::InitSystemSingleton();
+		return mTarget;
+	}
+
+	OVR::Allocator*	mTarget;
+};
+
+AuditAllocator gAuditAllocator;
+
+}
+
+void* operator new( std::size_t size ) OGLES_THROWS_BAD_ALLOC
+{
+	return allocate( size );
+}
+
+void* operator new[]( std::size_t size ) OGLES_THROWS_BAD_ALLOC
+{
+	return allocate( size );
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) OGLES_THROWS_NOTHING
+{
+	return allocateNoThrow( size );
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& ) OGLES_THROWS_NOTHING
+{
+	return allocateNoThrow( size );
+}
+
+void operator delete( void* p ) OGLES_THROWS_NOTHING
+{
+	free( p );
+}
+
+void operator delete[]( void* p ) OGLES_THROWS_NOTHING
+{
+	free( p );
+}
+
+void operator delete( void* p, const std::nothrow_t& ) OGLES_THROWS_NOTHING
+{
+	free( p );
+}
+
+void operator delete[]( void* p, const std::nothrow_t& ) OGLES_THROWS_NOTHING
+{
+	free( p );
+}
+
+namespace OGLESSandbox
+{
+
+AllocationAudit::Counts::Counts()
+	: newCount(0),
+	  ovrCount(0),
+	  bytes(0)
+{
+}
+
+void AllocationAudit::begin()
+{
+	gNewCount = 0;
+	gOVRCount = 0;
+	gBytes = 0;
+	gActive = true;
+}
+
+AllocationAudit::Counts AllocationAudit::end()
+{
+	gActive = false;
+	Counts counts;
+	counts.newCount = gNewCount;
+	counts.ovrCount = gOVRCount;
+	counts.bytes = gBytes;
+	return counts;
+}
+
+bool AllocationAudit::isActive()
+{
+	return gActive;
+}
+
+OVR::Allocator* AllocationAudit::getOVRAllocator()
+{
+	return &gAuditAllocator;
+}
+
+}
@@ -0,0 +1,62 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	AllocationAudit
+
+	Counts the heap allocations made by a thread while it's being audited: those going 
+	through the global operator new (replaced in AllocationAudit.cpp) and those LibOVR 
+	makes through its OVR::Allocator, provided OVR::System was initialized with 
+	getOVRAllocator(). The counts are kept per thread, so the allocations made by the 
+	other threads in the meantime aren't counted. When no thread is audited, the cost 
+	of an allocation is one more thread local read.
+*/
+class AllocationAudit
+{
+public:
+	struct Counts
+	{
+		Counts();
+		unsigned int	getTotal() const { return newCount + ovrCount; }
+
+		unsigned int	newCount;			// operator new and new[]
+		unsigned int	ovrCount;			// OVR::Allocator Alloc and Realloc
+		OVR::UPInt		bytes;
+	};
+
+	static void				begin();		// Starts counting on the calling thread, from zero
+	static Counts			end();			// Stops counting on the calling thread and returns the counts
+	static bool				isActive();
+
+	// An allocator forwarding to LibOVR's default one, to be given to OVR::System::Init()
+	static OVR::Allocator*	getOVRAllocator();
+};
+
+}
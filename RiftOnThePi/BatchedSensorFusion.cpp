@@ -0,0 +1,312 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "BatchedSensorFusion.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#include "OGLESTrace.h"
+
+#ifdef __linux__
+	#include <time.h>
+#endif
+
+namespace OGLESSandbox
+{
+
+const float BatchedSensorFusion::GravityGain = 0.5f;
+
+static const float gGravity = 9.81f;
+static const float gGravityTolerance = 0.1f;		// Fraction of 1g the block average may differ by to be trusted as gravity
+
+BatchedSensorFusion::BatchedSensorFusion()
+	: mQueueMutex(),
+	  mQueueCount(0),
+	  mFusionMutex()
+{
+	memset( mQueue, 0, sizeof(mQueue) );
+	memset( mBlock, 0, sizeof(mBlock) );
+	memset( mHalfAngles, 0, sizeof(mHalfAngles) );
+	reset();
+}
+
+void BatchedSensorFusion::reset()
+{
+	OVR::Mutex::Locker locker( &mFusionMutex );
+	mOrientation[0] = 0.f;
+	mOrientation[1] = 0.f;
+	mOrientation[2] = 0.f;
+	mOrientation[3] = 1.f;
+	mLatestArrivalTime = 0;
+}
+
+void BatchedSensorFusion::addSample( const OVR::MessageBodyFrame& message )
+{
+	OVR::UInt64 arrivalTime = getMonotonicTime();
+	OVR::Mutex::Locker locker( &mQueueMutex );
+	if ( mQueueCount==QueueSize )
+		flushFullQueueLocked();
+	Sample& sample = mQueue[mQueueCount++];
+	sample.acceleration[0] = message.Acceleration.x;
+	sample.acceleration[1] = message.Acceleration.y;
+	sample.acceleration[2] = message.Acceleration.z;
+	sample.rotationRate[0] = message.RotationRate.x;
+	sample.rotationRate[1] = message.RotationRate.y;
+	sample.rotationRate[2] = message.RotationRate.z;
+	sample.timeDelta = message.TimeDelta;
+	sample.arrivalTime = arrivalTime;
+}
+
+void BatchedSensorFusion::addSamples( const Sample* samples, int count )
+{
+	OVR::Mutex::Locker locker( &mQueueMutex );
+	for ( int i=0; i<count; ++i )
+	{
+		if ( mQueueCount==QueueSize )
+			flushFullQueueLocked();
+		mQueue[mQueueCount++] = samples[i];
+	}
+}
+
+void BatchedSensorFusion::flushFullQueueLocked()
+{
+	OGLES_TRACE_SCOPE("sensorQueueFull");
+	OVR::Mutex::Locker fusionLocker( &mFusionMutex );
+	integrateLocked( mQueue, mQueueCount );
+	mQueueCount = 0;
+}
+
+int BatchedSensorFusion::process()
+{
+	OGLES_TRACE_SCOPE("sensorFusion");
+	mQueueMutex.DoLock();
+	mFusionMutex.DoLock();
+	int count = mQueueCount;
+	memcpy( mBlock, mQueue, count * sizeof(Sample) );
+	mQueueCount = 0;
+	mQueueMutex.Unlock();
+	integrateLocked( mBlock, count );
+	mFusionMutex.Unlock();
+	return count;
+}
+
+OVR::Quatf BatchedSensorFusion::getOrientation() const
+{
+	OVR::Mutex::Locker locker( &mFusionMutex );
+	return OVR::Quatf( mOrientation[0], mOrientation[1], mOrientation[2], mOrientation[3] );
+}
+
+OVR::UInt64 BatchedSensorFusion::getLatestArrivalTime() const
+{
+	OVR::Mutex::Locker locker( &mFusionMutex );
+	return mLatestArrivalTime;
+}
+
+OVR::UInt64 BatchedSensorFusion::getMonotonicTime()
+{
+#ifdef __linux__
+	struct timespec time;
+	clock_gettime( CLOCK_MONOTONIC, &time );
+	return static_cast<OVR::UInt64>(time.tv_sec) * 1000000 + time.tv_nsec / 1000;
+#else
+	return OVR::Timer::GetTicks();
+#endif
+}
+
+void BatchedSensorFusion::integrate( const Sample* samples, int count )
+{
+	OVR::Mutex::Locker locker( &mFusionMutex );
+	while ( count>0 )
+	{
+		int blockSize = count<MaxBlockSize ? count : MaxBlockSize;
+		integrateLocked( samples, blockSize );
+		samples += blockSize;
+		count -= blockSize;
+	}
+}
+
+void BatchedSensorFusion::integrateLocked( const Sample* samples, int count )
+{
+	if ( count==0 )
+		return;
+
+	// Rotation increment of each sample, as half angles about the body axes
+	float* hx = mHalfAngles[0];
+	float* hy = mHalfAngles[1];
+	float* hz = mHalfAngles[2];
+	for ( int i=0; i<count; ++i )
+	{
+		float halfTimeDelta = samples[i].timeDelta * 0.5f;
+		hx[i] = samples[i].rotationRate[0] * halfTimeDelta;
+		hy[i] = samples[i].rotationRate[1] * halfTimeDelta;
+		hz[i] = samples[i].rotationRate[2] * halfTimeDelta;
+	}
+
+	// The increments are applied in the body frame (orientation * increment), like SensorFusion does. 
+	// At 1kHz they're a few milliradians: the second order expansion of the increment quaternion is 
+	// accurate and the length error it leaves is removed by normalizing once at the end
+	float qx = mOrientation[0];
+	float qy = mOrientation[1];
+	float qz = mOrientation[2];
+	float qw = mOrientation[3];
+	for ( int i=0; i<count; ++i )
+	{
+		float rx = hx[i];
+		float ry = hy[i];
+		float rz = hz[i];
+		float rw = 1.f - 0.5f * (rx * rx + ry * ry + rz * rz);
+		float x = qw * rx + qx * rw + qy * rz - qz * ry;
+		float y = qw * ry - qx * rz + qy * rw + qz * rx;
+		float z = qw * rz + qx * ry - qy * rx + qz * rw;
+		float w = qw * rw - qx * rx - qy * ry - qz * rz;
+		qx = x;
+		qy = y;
+		qz = z;
+		qw = w;
+	}
+
+	// Tilt correction from the average acceleration of the block
+	float ax = 0.f;
+	float ay = 0.f;
+	float az = 0.f;
+	float duration = 0.f;
+	for ( int i=0; i<count; ++i )
+	{
+		ax += samples[i].acceleration[0];
+		ay += samples[i].acceleration[1];
+		az += samples[i].acceleration[2];
+		duration += samples[i].timeDelta;
+	}
+	float length = sqrtf( ax * ax + ay * ay + az * az ) / static_cast<float>(count);
+	if ( length>0.f && fabsf( length - gGravity )<gGravityTolerance * gGravity )
+	{
+		float scale = 1.f / (length * static_cast<float>(count));
+		float vx = ax * scale;
+		float vy = ay * scale;
+		float vz = az * scale;
+
+		// The measured up direction in the world frame: q * v * conj(q)
+		float tx = 2.f * (qy * vz - qz * vy);
+		float ty = 2.f * (qz * vx - qx * vz);
+		float tz = 2.f * (qx * vy - qy * vx);
+		float wx = vx + qw * tx + (qy * tz - qz * ty);
+		float wy = vy + qw * ty + (qz * tx - qx * tz);
+		float wz = vz + qw * tz + (qx * ty - qy * tx);
+
+		// Rotate it towards +y about (measured x up), by at most GravityGain rad/s
+		float cx = -wz;
+		float cz = wx;
+		float sinAngle = sqrtf( cx * cx + cz * cz );
+		float angle = atan2f( sinAngle, wy );
+		float correction = angle<GravityGain * duration ? angle : GravityGain * duration;
+		if ( sinAngle>1e-6f && correction>0.f )
+		{
+			float s = sinf( correction * 0.5f ) / sinAngle;
+			float rx = cx * s;
+			float rz = cz * s;
+			float rw = cosf( correction * 0.5f );
+
+			// World frame correction: correction * orientation
+			float x = rw * qx + rx * qw - rz * qy;
+			float y = rw * qy + rz * qx - rx * qz;
+			float z = rw * qz + rx * qy + rz * qw;
+			float w = rw * qw - rx * qx - rz * qz;
+			qx = x;
+			qy = y;
+			qz = z;
+			qw = w;
+		}
+	}
+
+	float norm = sqrtf( qx * qx + qy * qy + qz * qz + qw * qw );
+	if ( norm>0.f )
+	{
+		float invNorm = 1.f / norm;
+		qx *= invNorm;
+		qy *= invNorm;
+		qz *= invNorm;
+		qw *= invNorm;
+	}
+	mOrientation[0] = qx;
+	mOrientation[1] = qy;
+	mOrientation[2] = qz;
+	mOrientation[3] = qw;
+	mLatestArrivalTime = samples[count-1].arrivalTime;
+}
+
+static void makeSyntheticSample( int index, OVR::MessageBodyFrame& message )
+{
+	// A head slowly nodding and turning, at rest otherwise
+	float t = static_cast<float>(index) * 0.001f;
+	message.TimeDelta = 0.001f;
+	message.RotationRate = OVR::Vector3f( 0.5f * sinf( 3.f * t ), 0.8f * cosf( 1.3f * t ), 0.1f * sinf( 0.7f * t ) );
+	message.Acceleration = OVR::Vector3f( 0.2f * sinf( 5.f * t ), gGravity, 0.1f * cosf( 4.f * t ) );
+	message.MagneticField = OVR::Vector3f( 0.f, 0.f, 0.f );
+	message.Temperature = 30.f;
+}
+
+void BatchedSensorFusion::runBenchmark( int sampleCount, int blockSize )
+{
+	if ( sampleCount<=0 || blockSize<=0 )
+		return;
+
+	// The samples of a block are made before timing it, so that only the processing is measured
+	std::vector<OVR::MessageBodyFrame> messages( blockSize, OVR::MessageBodyFrame(NULL) );
+	OVR::SensorFusion* sensorFusion = new OVR::SensorFusion();
+	BatchedSensorFusion* batched = new BatchedSensorFusion();
+	OVR::UInt64 perMessageTicks = 0;
+	OVR::UInt64 batchedTicks = 0;
+	for ( int first=0; first<sampleCount; first+=blockSize )
+	{
+		int count = sampleCount - first<blockSize ? sampleCount - first : blockSize;
+		for ( int i=0; i<count; ++i )
+			makeSyntheticSample( first + i, messages[i] );
+
+		OVR::UInt64 startTicks = OVR::Timer::GetTicks();
+		for ( int i=0; i<count; ++i )
+			sensorFusion->OnMessage( messages[i] );
+		OVR::UInt64 endTicks = OVR::Timer::GetTicks();
+		perMessageTicks += endTicks - startTicks;
+
+		startTicks = endTicks;
+		for ( int i=0; i<count; ++i )
+			batched->addSample( messages[i] );
+		batched->process();
+		batchedTicks += OVR::Timer::GetTicks() - startTicks;
+	}
+	OVR::Quatf perMessageOrientation = sensorFusion->GetOrientation();
+	OVR::Quatf batchedOrientation = batched->getOrientation();
+	delete sensorFusion;
+	delete batched;
+
+	float dot = perMessageOrientation.x * batchedOrientation.x + perMessageOrientation.y * batchedOrientation.y + 
+				perMessageOrientation.z * batchedOrientation.z + perMessageOrientation.w * batchedOrientation.w;
+	float difference = 2.f * acosf( fabsf(dot)<1.f ? fabsf(dot) : 1.f ) * 180.f / 3.14159265f;
+	printf("SensorFusion benchmark: %d samples, per message %.1fus per 1000 samples, batched by %d %.1fus per 1000 samples, orientations %.2f degrees apart\n",
+		sampleCount, perMessageTicks * 1000.0 / sampleCount, blockSize, batchedTicks * 1000.0 / sampleCount, difference );
+}
+
+}
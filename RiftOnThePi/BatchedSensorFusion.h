@@ -0,0 +1,110 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	BatchedSensorFusion
+
+	An orientation filter fed with the same body frames as OVR::SensorFusion, but which 
+	doesn't process them as they come. The DK1 sends about 1000 samples per second: the 
+	LibOVR device thread only queues them (a copy under a lock), and the render thread 
+	integrates the queued ones as a block once per frame, on a core it already holds.
+
+	Within a block, the per-sample rotation increments are computed in separate arrays 
+	(which the compiler vectorizes), then chained into the orientation, normalized once 
+	per block. The tilt drift is corrected once per block too: when the average 
+	acceleration of the block is close to 1g, the orientation is rotated towards making 
+	it point up, by at most GravityGain radians per second. Like SensorFusion without 
+	magnetometer, the yaw drift isn't corrected.
+
+	Each sample carries the time its report came in, so that the render thread can 
+	tell how old the orientation it uses is.
+
+	Should the render thread stop draining the queue, the device thread integrates it 
+	when it's full.
+*/
+class BatchedSensorFusion
+{
+public:
+	enum 
+	{ 
+		QueueSize = 1024,
+		MaxBlockSize = QueueSize
+	};
+
+	struct Sample
+	{
+		float	acceleration[3];		// m/s^2
+		float	rotationRate[3];		// rad/s
+		float	timeDelta;				// s
+		OVR::UInt64	arrivalTime;		// When the report carrying it came in, see getMonotonicTime()
+	};
+
+	BatchedSensorFusion();
+
+	// Called by the device thread. A body frame is stamped with the time it's added at
+	void			addSample( const OVR::MessageBodyFrame& message );
+	void			addSamples( const Sample* samples, int count );
+
+	// Integrates the queued samples. Returns how many there were
+	int				process();
+
+	OVR::Quatf		getOrientation() const;
+	OVR::UInt64		getLatestArrivalTime() const;		// Of the last sample integrated, 0 if none
+	void			reset();
+
+	// Integrates a block straight away, without going through the queue
+	void			integrate( const Sample* samples, int count );
+
+	// Feeds sampleCount synthetic samples to a SensorFusion one message at a time, and to a 
+	// BatchedSensorFusion through the queue drained every blockSize samples. Prints the cost of both
+	static void		runBenchmark( int sampleCount, int blockSize );
+
+	// Monotonic clock in microseconds
+	static OVR::UInt64	getMonotonicTime();
+
+	static const float GravityGain;
+
+private:
+	void			integrateLocked( const Sample* samples, int count );
+	void			flushFullQueueLocked();
+
+	mutable OVR::Mutex	mQueueMutex;
+	Sample				mQueue[QueueSize];
+	int					mQueueCount;
+
+	// The orientation is only touched with mFusionMutex held. Locked after mQueueMutex when both are
+	mutable OVR::Mutex	mFusionMutex;
+	float				mOrientation[4];		// x, y, z, w
+	OVR::UInt64			mLatestArrivalTime;
+	Sample				mBlock[MaxBlockSize];	// Copy of the queue being integrated
+	float				mHalfAngles[3][MaxBlockSize];
+};
+
+}
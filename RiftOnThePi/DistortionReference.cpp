@@ -0,0 +1,387 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "DistortionReference.h"
+
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+const double ImageError::PerfectPSNR = 999.0;
+
+struct DistortionReference::WarpTask
+{
+	DistortionReference::Program		program;
+	const DistortionParams*				params;
+	const Image*						source;
+	Image*								destination;
+	OVR::Util::Render::Viewport			VP;
+	int									rowsPerTask;
+};
+
+DistortionParams DistortionReference::computeParams( const OVR::Util::Render::Viewport& VP, 
+													 unsigned int screenHResolution, unsigned int screenVResolution,
+													 const OVR::Util::Render::DistortionConfig& distortionConfig )
+{
+	DistortionParams params;
+
+	float w = float(VP.w) / float(screenHResolution);
+	float h = float(VP.h) / float(screenVResolution);
+	float x = float(VP.x) / float(screenHResolution);
+	float y = float(VP.y) / float(screenVResolution);
+	params.texm[0] = w;
+	params.texm[1] = h;
+	params.texm[2] = x;
+	params.texm[3] = y;
+
+	float as = float(VP.w) / float(VP.h);
+	float scaleFactor = 1.0f / distortionConfig.Scale;		
+
+	params.lensCenter[0] = x + (w + distortionConfig.XCenterOffset * 0.5f)*0.5f;
+	params.lensCenter[1] = y + h * 0.5f;
+	
+	params.screenCenter[0] = x + w*0.5f;
+	params.screenCenter[1] = y + h*0.5f;
+
+	params.scale[0] = (w/2.f) * scaleFactor;
+	params.scale[1] = (h/2.f) * scaleFactor * as;
+	
+	params.scaleIn[0] = (2.f/w);
+	params.scaleIn[1] = (2.f/h) / as;
+
+	for ( int i=0; i<4; ++i )
+	{
+		params.hmdWarpParam[i] = distortionConfig.K[i];
+		params.chromAbParam[i] = distortionConfig.ChromaticAberration[i];
+	}
+	return params;
+}
+
+void DistortionReference::warp( Program program, const DistortionParams& params, const Image& source, 
+								const OVR::Util::Render::Viewport& VP, Image& destination, TaskPool* pool )
+{
+	if ( VP.w<=0 || VP.h<=0 || source.getWidth()==0 || source.getHeight()==0 )
+		return;
+
+	WarpTask task;
+	task.program = program;
+	task.params = &params;
+	task.source = &source;
+	task.destination = &destination;
+	task.VP = VP;
+	task.rowsPerTask = 16;
+
+	int taskCount = (VP.h + task.rowsPerTask - 1) / task.rowsPerTask;
+	if ( pool )
+	{
+		pool->run( warpRows, &task, taskCount );
+	}
+	else
+	{
+		for ( int i=0; i<taskCount; ++i )
+			warpRows( i, &task );
+	}
+}
+
+void DistortionReference::warpRows( int taskIndex, void* userData )
+{
+	const WarpTask& task = *static_cast<const WarpTask*>(userData);
+	
+	// One scratch buffer per task for the 9 intermediate rows computed by warpRow()
+	std::vector<float> buffer( task.VP.w * 9 );
+	
+	int firstRow = taskIndex * task.rowsPerTask;
+	int lastRow = firstRow + task.rowsPerTask;
+	if ( lastRow>task.VP.h )
+		lastRow = task.VP.h;
+	for ( int row=firstRow; row<lastRow; ++row )
+		warpRow( task, row, &buffer[0] );
+}
+
+static inline int nearestTexel( float coord, int size )
+{
+	int texel = static_cast<int>( std::floor( coord * static_cast<float>(size) ) );
+	if ( texel<0 )
+		return 0;
+	if ( texel>=size )
+		return size-1;
+	return texel;
+}
+
+static inline bool isInside( float x, float y, const DistortionParams& params )
+{
+	// Same test as !all(equal(clamp(tc, ScreenCenter-vec2(0.25,0.5), ScreenCenter+vec2(0.25,0.5)), tc))
+	return	x>=params.screenCenter[0]-0.25f && x<=params.screenCenter[0]+0.25f &&
+			y>=params.screenCenter[1]-0.5f && y<=params.screenCenter[1]+0.5f;
+}
+
+static inline void extendBounds( float bounds[4], bool& found, float x, float y )
+{
+	if ( !found )
+	{
+		bounds[0] = bounds[2] = x;
+		bounds[1] = bounds[3] = y;
+		found = true;
+		return;
+	}
+	bounds[0] = std::min( bounds[0], x );
+	bounds[1] = std::min( bounds[1], y );
+	bounds[2] = std::max( bounds[2], x );
+	bounds[3] = std::max( bounds[3], y );
+}
+
+void DistortionReference::warpRow( const WarpTask& task, int row, float* buffer )
+{
+	const DistortionParams& p = *task.params;
+	const Image& source = *task.source;
+	const int n = task.VP.w;
+	computeRowTexCoords( task.program, p, task.VP, row, buffer );
+	
+	const float* tcX = buffer;
+	const float* tcY = buffer + n;
+	const float* tcRedX = buffer + n*3;
+	const float* tcRedY = buffer + n*4;
+	const float* tcBlueX = buffer + n*5;
+	const float* tcBlueY = buffer + n*6;
+
+	// Texture lookups
+	const int sw = source.getWidth();
+	const int sh = source.getHeight();
+	const int y = task.VP.y + row;
+	if ( y<0 || y>=task.destination->getHeight() )
+		return;
+	for ( int i=0; i<n; ++i )
+	{
+		int x = task.VP.x + i;
+		if ( x<0 || x>=task.destination->getWidth() )
+			continue;
+		unsigned char* out = task.destination->getPixel( x, y );
+		
+		bool inside = true;
+		if ( task.program==Distortion )
+			inside = isInside( tcX[i], tcY[i], p );
+		else if ( task.program==DistortionAndChroma )
+			inside = isInside( tcBlueX[i], tcBlueY[i], p );
+		if ( !inside )
+		{
+			out[0] = 255;
+			out[1] = 0;
+			out[2] = 255;
+			out[3] = 255;
+			continue;
+		}
+
+		const unsigned char* center = source.getPixel( nearestTexel(tcX[i], sw), nearestTexel(tcY[i], sh) );
+		if ( task.program==DistortionAndChroma )
+		{
+			const unsigned char* red = source.getPixel( nearestTexel(tcRedX[i], sw), nearestTexel(tcRedY[i], sh) );
+			const unsigned char* blue = source.getPixel( nearestTexel(tcBlueX[i], sw), nearestTexel(tcBlueY[i], sh) );
+			out[0] = red[0];
+			out[1] = center[1];
+			out[2] = blue[2];
+			out[3] = 255;
+		}
+		else
+		{
+			out[0] = center[0];
+			out[1] = center[1];
+			out[2] = center[2];
+			out[3] = task.program==Copy ? center[3] : 255;
+		}
+	}
+}
+
+bool DistortionReference::computeSampledBounds( Program program, const DistortionParams& params, 
+												const OVR::Util::Render::Viewport& VP, float bounds[4] )
+{
+	if ( VP.w<=0 || VP.h<=0 )
+		return false;
+
+	const int n = VP.w;
+	std::vector<float> buffer( n * 9 );
+	const float* tcX = &buffer[0];
+	const float* tcY = &buffer[n];
+	const float* tcRedX = &buffer[n*3];
+	const float* tcRedY = &buffer[n*4];
+	const float* tcBlueX = &buffer[n*5];
+	const float* tcBlueY = &buffer[n*6];
+
+	bool found = false;
+	for ( int row=0; row<VP.h; ++row )
+	{
+		computeRowTexCoords( program, params, VP, row, &buffer[0] );
+		for ( int i=0; i<n; ++i )
+		{
+			// Same selection as warpRow(): the fragments out of range read nothing
+			if ( program==Distortion && !isInside( tcX[i], tcY[i], params ) )
+				continue;
+			if ( program==DistortionAndChroma && !isInside( tcBlueX[i], tcBlueY[i], params ) )
+				continue;
+
+			extendBounds( bounds, found, tcX[i], tcY[i] );
+			if ( program==DistortionAndChroma )
+			{
+				extendBounds( bounds, found, tcRedX[i], tcRedY[i] );
+				extendBounds( bounds, found, tcBlueX[i], tcBlueY[i] );
+			}
+		}
+	}
+	return found;
+}
+
+void DistortionReference::computeRowTexCoords( Program program, const DistortionParams& p, 
+											   const OVR::Util::Render::Viewport& VP, int row, float* buffer )
+{
+	const int n = VP.w;
+	float* tcX = buffer;			// Green (or only) lookup
+	float* tcY = buffer + n;
+	float* rSqs = buffer + n*2;
+	float* tcRedX = buffer + n*3;
+	float* tcRedY = buffer + n*4;
+	float* tcBlueX = buffer + n*5;
+	float* tcBlueY = buffer + n*6;
+	float* theta1Xs = buffer + n*7;
+	float* theta1Ys = buffer + n*8;
+
+	// Varying oTexCoord at the center of the fragments of this row. The quad InputTexCoord goes 
+	// from 0 to 1 across the viewport and gets transformed by Texm in the vertex shader
+	const float invW = 1.f / static_cast<float>(VP.w);
+	const float v = (static_cast<float>(row) + 0.5f) / static_cast<float>(VP.h);
+	const float oTexCoordY = p.texm[1] * v + p.texm[3];
+	for ( int i=0; i<n; ++i )
+		tcX[i] = p.texm[0] * ((static_cast<float>(i) + 0.5f) * invW) + p.texm[2];
+	for ( int i=0; i<n; ++i )
+		tcY[i] = oTexCoordY;
+
+	if ( program!=Copy )
+	{
+		// HmdWarp()
+		const float* K = p.hmdWarpParam;
+		const float thetaY = (oTexCoordY - p.lensCenter[1]) * p.scaleIn[1];
+		for ( int i=0; i<n; ++i )
+		{
+			float thetaX = (tcX[i] - p.lensCenter[0]) * p.scaleIn[0];
+			float rSq = thetaX * thetaX + thetaY * thetaY;
+			float k = K[0] + K[1] * rSq + K[2] * rSq * rSq + K[3] * rSq * rSq * rSq;
+			float theta1X = thetaX * k;
+			float theta1Y = thetaY * k;
+			rSqs[i] = rSq;
+			theta1Xs[i] = theta1X;
+			theta1Ys[i] = theta1Y;
+			tcX[i] = p.lensCenter[0] + p.scale[0] * theta1X;
+			tcY[i] = p.lensCenter[1] + p.scale[1] * theta1Y;
+		}
+	}
+
+	if ( program==DistortionAndChroma )
+	{
+		const float* C = p.chromAbParam;
+		for ( int i=0; i<n; ++i )
+		{
+			float redFactor = C[0] + C[1] * rSqs[i];
+			float blueFactor = C[2] + C[3] * rSqs[i];
+			tcRedX[i] = p.lensCenter[0] + p.scale[0] * (theta1Xs[i] * redFactor);
+			tcRedY[i] = p.lensCenter[1] + p.scale[1] * (theta1Ys[i] * redFactor);
+			tcBlueX[i] = p.lensCenter[0] + p.scale[0] * (theta1Xs[i] * blueFactor);
+			tcBlueY[i] = p.lensCenter[1] + p.scale[1] * (theta1Ys[i] * blueFactor);
+		}
+	}
+}
+
+ImageError DistortionReference::computeError( const Image& image0, const Image& image1, const OVR::Util::Render::Viewport& VP )
+{
+	ImageError error;
+	error.psnr = 0.0;
+	error.maxError = 255;
+	error.percentileError = 255;
+	error.mismatchCount = 0;
+	error.pixelCount = 0;
+
+	// Nothing compared must not pass for a match
+	if ( image0.getWidth()!=image1.getWidth() || image0.getHeight()!=image1.getHeight() )
+		return error;
+
+	int errorHistogram[256] = { 0 };		// Of the largest channel difference of each pixel
+	double squaredErrorSum = 0.0;
+	error.maxError = 0;
+	for ( int y=VP.y; y<VP.y+VP.h; ++y )
+	{
+		if ( y<0 || y>=image0.getHeight() )
+			continue;
+		for ( int x=VP.x; x<VP.x+VP.w; ++x )
+		{
+			if ( x<0 || x>=image0.getWidth() )
+				continue;
+			const unsigned char* p0 = image0.getPixel( x, y );
+			const unsigned char* p1 = image1.getPixel( x, y );
+			int pixelError = 0;
+			for ( int c=0; c<3; ++c )
+			{
+				int diff = static_cast<int>(p0[c]) - static_cast<int>(p1[c]);
+				if ( diff<0 )
+					diff = -diff;
+				if ( diff>pixelError )
+					pixelError = diff;
+				squaredErrorSum += static_cast<double>(diff * diff);
+			}
+			if ( pixelError>error.maxError )
+				error.maxError = pixelError;
+			if ( pixelError!=0 )
+				error.mismatchCount++;
+			errorHistogram[pixelError]++;
+			error.pixelCount++;
+		}
+	}
+	if ( error.pixelCount==0 )
+	{
+		error.maxError = 255;
+		return error;
+	}
+
+	error.percentileError = 0;
+	int outlierCount = error.pixelCount / 1000;
+	for ( int e=255; e>0; --e )
+	{
+		outlierCount -= errorHistogram[e];
+		if ( outlierCount<0 )
+		{
+			error.percentileError = e;
+			break;
+		}
+	}
+
+	error.psnr = ImageError::PerfectPSNR;
+	if ( squaredErrorSum>0.0 )
+	{
+		double mse = squaredErrorSum / (3.0 * error.pixelCount);
+		error.psnr = 10.0 * std::log10( (255.0 * 255.0) / mse );
+	}
+	return error;
+}
+
+}
@@ -0,0 +1,113 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include "Image.h"
+
+namespace OGLESSandbox
+{
+
+class TaskPool;
+
+/*
+	DistortionParams
+
+	The uniform values fed to the quad fragment shaders for one eye. 
+	They're computed in one place so that the GPU path and the CPU reference 
+	below are guaranteed to work from exactly the same numbers.
+*/
+struct DistortionParams
+{
+	float	texm[4];			// Scale (x,y) then offset (x,y) applied to the quad texture coordinates (the Texm uniform)
+	float	lensCenter[2];
+	float	screenCenter[2];
+	float	scale[2];
+	float	scaleIn[2];
+	float	hmdWarpParam[4];
+	float	chromAbParam[4];
+};
+
+struct ImageError
+{
+	double	psnr;				// In dB over the RGB channels. Identical images are reported as ImageError::PerfectPSNR
+	int		maxError;			// Largest absolute difference found on a single channel (0 to 255)
+	int		percentileError;	// The one 99.9% of the pixels stay within, leaving out isolated texel boundary ties
+	int		mismatchCount;		// Number of pixels that differ at all
+	int		pixelCount;
+
+	static const double PerfectPSNR;
+};
+
+/*
+	DistortionReference
+
+	CPU implementation of the quad fragment programs (FragmentShader0StringQuad,
+	FragmentShader1StringQuad and FragmentShader2StringQuad in RiftOnThePiApp.cpp).
+	It follows the shader math operation for operation, including the nearest 
+	texel lookup and the magenta out-of-range color, so that GL readbacks of any 
+	StereoRenderTechnique can be compared against it.
+
+	The per-pixel math is done on whole rows in separate arrays so that the compiler
+	vectorizes it (-ftree-vectorize is set on the Pi), and rows are spread across 
+	the threads of a TaskPool.
+*/
+class DistortionReference
+{
+public:
+	enum Program
+	{
+		Copy,					// FragmentShader0StringQuad
+		Distortion,				// FragmentShader1StringQuad
+		DistortionAndChroma		// FragmentShader2StringQuad
+	};
+
+	static DistortionParams computeParams( const OVR::Util::Render::Viewport& VP, 
+										   unsigned int screenHResolution, unsigned int screenVResolution,
+										   const OVR::Util::Render::DistortionConfig& distortionConfig );
+
+	// Distort the source image (the render texture) into the VP area of the destination image (the screen).
+	// If no pool is given, the work is done on the calling thread
+	static void		warp( Program program, const DistortionParams& params, const Image& source, 
+						  const OVR::Util::Render::Viewport& VP, Image& destination, TaskPool* pool );
+
+	// Compare the VP area of two images of the same size. Images of different sizes, or an area 
+	// outside of them, compare as entirely different (0dB, maximum error)
+	static ImageError computeError( const Image& image0, const Image& image1, const OVR::Util::Render::Viewport& VP );
+
+	// Bounding rectangle (min x, min y, max x, max y) of the texture coordinates the program reads 
+	// for the fragments of the VP area, all channels included. Returns false if nothing is read
+	static bool		computeSampledBounds( Program program, const DistortionParams& params, 
+										  const OVR::Util::Render::Viewport& VP, float bounds[4] );
+
+private:
+	struct WarpTask;
+	static void		warpRows( int taskIndex, void* userData );
+	static void		warpRow( const WarpTask& task, int row, float* buffer );
+	static void		computeRowTexCoords( Program program, const DistortionParams& params, 
+										 const OVR::Util::Render::Viewport& VP, int row, float* buffer );
+};
+
+}
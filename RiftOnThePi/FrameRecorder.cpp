@@ -0,0 +1,261 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "FrameRecorder.h"
+
+#include <string.h>
+
+#include "OGLESTrace.h"
+
+namespace OGLESSandbox
+{
+
+FrameRecorder::FrameRecorder()
+	: mFile(NULL),
+	  mY4M(false),
+	  mWidth(0),
+	  mHeight(0),
+	  mBuffers(),
+	  mOutputBuffer(),
+	  mFreeBuffers(),
+	  mQueuedBuffers(),
+	  mWrittenFrameCount(0),
+	  mDroppedFrameCount(0),
+	  mMutex(),
+	  mCondition(),
+	  mQuit(false),
+	  mThreadRunning(false),
+	  mThread()
+{
+}
+
+FrameRecorder::~FrameRecorder()
+{
+	stop();
+}
+
+bool FrameRecorder::start( const std::string& path, int width, int height, int bufferCount, int frameRateNum, int frameRateDen )
+{
+	stop();
+	if ( width<=0 || height<=0 || bufferCount<=0 )
+		return false;
+
+	mFile = fopen( path.c_str(), "wb" );
+	if ( !mFile )
+	{
+		printf("FrameRecorder: failed to open %s\n", path.c_str() );
+		return false;
+	}
+	mY4M = path.size()>=4 && path.compare( path.size() - 4, 4, ".y4m" )==0;
+	mWidth = width;
+	mHeight = height;
+	if ( mY4M )
+		fprintf( mFile, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 C420jpeg\n", width, height, frameRateNum, frameRateDen );
+
+	mBuffers.assign( bufferCount, std::vector<unsigned char>( width * height * 4 ) );
+	mFreeBuffers.clear();
+	mFreeBuffers.reserve( bufferCount );
+	for ( int i=0; i<bufferCount; ++i )
+		mFreeBuffers.push_back( &mBuffers[i][0] );
+	mQueuedBuffers.clear();
+	mQueuedBuffers.reserve( bufferCount );
+
+	int chromaSize = ((width + 1) / 2) * ((height + 1) / 2);
+	mOutputBuffer.resize( mY4M ? width * height + chromaSize * 2 : width * height * 3 );
+	mWrittenFrameCount = 0;
+	mDroppedFrameCount = 0;
+
+	mQuit = false;
+	mThreadRunning = true;
+	mThread = *new OVR::Thread( threadFunction, this );
+	if ( !mThread->Start() )
+	{
+		printf("FrameRecorder: failed to start thread\n");
+		mThreadRunning = false;
+		mThread.Clear();
+		fclose( mFile );
+		mFile = NULL;
+		return false;
+	}
+	printf("FrameRecorder: recording %dx%d %s frames into %s\n", width, height, mY4M ? "Y4M" : "raw RGB24", path.c_str() );
+	return true;
+}
+
+void FrameRecorder::stop()
+{
+	if ( !isRunning() )
+		return;
+
+	// The frames already submitted are written first
+	mMutex.DoLock();
+	mQuit = true;
+	mCondition.NotifyAll();
+	while ( mThreadRunning )
+		mCondition.Wait( &mMutex );
+	mMutex.Unlock();
+	mThread.Clear();
+
+	fclose( mFile );
+	mFile = NULL;
+	printf("FrameRecorder: %u frames written, %u dropped\n", mWrittenFrameCount, mDroppedFrameCount );
+}
+
+unsigned char* FrameRecorder::acquireBuffer()
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	if ( mFreeBuffers.empty() )
+	{
+		mDroppedFrameCount++;
+		return NULL;
+	}
+	unsigned char* buffer = mFreeBuffers.back();
+	mFreeBuffers.pop_back();
+	return buffer;
+}
+
+void FrameRecorder::submitBuffer( unsigned char* buffer )
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	mQueuedBuffers.push_back( buffer );
+	mCondition.NotifyAll();
+}
+
+unsigned int FrameRecorder::getWrittenFrameCount() const
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	return mWrittenFrameCount;
+}
+
+unsigned int FrameRecorder::getDroppedFrameCount() const
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	return mDroppedFrameCount;
+}
+
+int FrameRecorder::threadFunction( OVR::Thread* /*thread*/, void* userData )
+{
+	FrameRecorder* recorder = static_cast<FrameRecorder*>(userData);
+	recorder->writerLoop();
+	return 0;
+}
+
+void FrameRecorder::writerLoop()
+{
+	OGLES_TRACE_THREAD_NAME("FrameRecorder");
+	mMutex.DoLock();
+	while ( true )
+	{
+		if ( mQueuedBuffers.empty() )
+		{
+			if ( mQuit )
+				break;
+			mCondition.Wait( &mMutex );
+			continue;
+		}
+		unsigned char* buffer = mQueuedBuffers.front();
+		mQueuedBuffers.erase( mQueuedBuffers.begin() );
+		mMutex.Unlock();
+
+		writeFrame( buffer );
+
+		mMutex.DoLock();
+		mWrittenFrameCount++;
+		mFreeBuffers.push_back( buffer );
+	}
+	mThreadRunning = false;
+	mCondition.NotifyAll();
+	mMutex.Unlock();
+}
+
+void FrameRecorder::writeFrame( const unsigned char* pixels )
+{
+	OGLES_TRACE_SCOPE("writeFrame");
+	if ( mY4M )
+		writeY4MFrame( pixels );
+	else
+		writeRGBFrame( pixels );
+}
+
+void FrameRecorder::writeRGBFrame( const unsigned char* pixels )
+{
+	unsigned char* destination = &mOutputBuffer[0];
+	for ( int y=mHeight-1; y>=0; --y )
+	{
+		const unsigned char* source = pixels + y * mWidth * 4;
+		for ( int x=0; x<mWidth; ++x, destination+=3 )
+		{
+			destination[0] = source[x*4];
+			destination[1] = source[x*4 + 1];
+			destination[2] = source[x*4 + 2];
+		}
+	}
+	fwrite( &mOutputBuffer[0], 1, mOutputBuffer.size(), mFile );
+}
+
+// Y4M frames are planar: all of Y, then U, then V, top row first
+void FrameRecorder::writeY4MFrame( const unsigned char* pixels )
+{
+	int chromaWidth = (mWidth + 1) / 2;
+	int chromaHeight = (mHeight + 1) / 2;
+	unsigned char* lumaPlane = &mOutputBuffer[0];
+	unsigned char* uPlane = lumaPlane + mWidth * mHeight;
+	unsigned char* vPlane = uPlane + chromaWidth * chromaHeight;
+	for ( int row=0; row<chromaHeight; ++row )
+	{
+		// The readback is bottom row first. With an odd height, the last row is paired with itself
+		int top = mHeight - 1 - row*2;
+		int bottom = top>0 ? top - 1 : top;
+		unsigned char* y0 = lumaPlane + row * 2 * mWidth;
+		unsigned char* y1 = top>0 ? y0 + mWidth : y0;
+		convertRowsToYUV( pixels + top * mWidth * 4, pixels + bottom * mWidth * 4, mWidth, y0, y1, 
+						  uPlane + row * chromaWidth, vPlane + row * chromaWidth );
+	}
+	fputs( "FRAME\n", mFile );
+	fwrite( &mOutputBuffer[0], 1, mOutputBuffer.size(), mFile );
+}
+
+// Full range BT.601 in 8.8 fixed point. The chroma is the average of the 2x2 block.
+// The loops only use simple integer arithmetic on arrays so that they're vectorized
+void FrameRecorder::convertRowsToYUV( const unsigned char* row0, const unsigned char* row1, int width, 
+									  unsigned char* y0, unsigned char* y1, unsigned char* u, unsigned char* v )
+{
+	for ( int x=0; x<width; ++x )
+	{
+		y0[x] = static_cast<unsigned char>( (77 * row0[x*4] + 150 * row0[x*4 + 1] + 29 * row0[x*4 + 2] + 128) >> 8 );
+		y1[x] = static_cast<unsigned char>( (77 * row1[x*4] + 150 * row1[x*4 + 1] + 29 * row1[x*4 + 2] + 128) >> 8 );
+	}
+	int chromaWidth = (width + 1) / 2;
+	for ( int x=0; x<chromaWidth; ++x )
+	{
+		int x0 = x*2;
+		int x1 = x0 + 1<width ? x0 + 1 : x0;
+		int r = row0[x0*4] + row0[x1*4] + row1[x0*4] + row1[x1*4];
+		int g = row0[x0*4 + 1] + row0[x1*4 + 1] + row1[x0*4 + 1] + row1[x1*4 + 1];
+		int b = row0[x0*4 + 2] + row0[x1*4 + 2] + row1[x0*4 + 2] + row1[x1*4 + 2];
+		// The sums are 4 times the average, hence the 10 bit shift. The results stay in [0,255]
+		u[x] = static_cast<unsigned char>( ((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128 );
+		v[x] = static_cast<unsigned char>( ((128 * r - 107 * g - 21 * b + 512) >> 10) + 128 );
+	}
+}
+
+}
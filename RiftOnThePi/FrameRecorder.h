@@ -0,0 +1,100 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+/*
+	FrameRecorder
+
+	Writes frames read back by the render thread to a video file from a thread of its own, 
+	so that the render loop never waits for the conversion or the disk. The frames go 
+	through a fixed pool of buffers allocated by start(): the render thread takes a free 
+	buffer, reads the frame into it and submits it, the writer thread writes it and gives 
+	it back. When the writer falls behind and no buffer is free, the frame is dropped 
+	instead of blocking (and counted).
+
+	Files whose name ends in .y4m are YUV4MPEG2 (4:2:0, full range BT.601), the others raw 
+	RGB24 frames (top row first, no header). The RGB to YUV conversion is done on whole 
+	rows in separate arrays with integer math so that the compiler vectorizes it.
+*/
+class FrameRecorder
+{
+public:
+	FrameRecorder();
+	~FrameRecorder();
+
+	// The frames are RGBA, bottom row first, as glReadPixels returns them.
+	// frameRateNum/frameRateDen only ends up in the Y4M header
+	bool	start( const std::string& path, int width, int height, int bufferCount, int frameRateNum, int frameRateDen );
+	void	stop();
+	bool	isRunning() const { return mThread.GetPtr()!=NULL; }
+
+	int		getWidth() const { return mWidth; }
+	int		getHeight() const { return mHeight; }
+
+	// Returns NULL when every buffer is in use, the frame is then dropped. Never blocks nor allocates
+	unsigned char*	acquireBuffer();
+	void			submitBuffer( unsigned char* buffer );
+
+	unsigned int	getWrittenFrameCount() const;
+	unsigned int	getDroppedFrameCount() const;
+
+private:
+	static int		threadFunction( OVR::Thread* thread, void* userData );
+	void			writerLoop();
+	void			writeFrame( const unsigned char* pixels );
+	void			writeRGBFrame( const unsigned char* pixels );
+	void			writeY4MFrame( const unsigned char* pixels );
+	static void		convertRowsToYUV( const unsigned char* row0, const unsigned char* row1, int width, 
+									  unsigned char* y0, unsigned char* y1, unsigned char* u, unsigned char* v );
+
+	FILE*							mFile;
+	bool							mY4M;
+	int								mWidth;
+	int								mHeight;
+	std::vector< std::vector<unsigned char> >	mBuffers;
+	std::vector<unsigned char>		mOutputBuffer;			// A frame as written to the file, filled by the writer thread
+
+	// Buffers are pointers into mBuffers. Both lists are reserved to the pool size up front
+	std::vector<unsigned char*>		mFreeBuffers;
+	std::vector<unsigned char*>		mQueuedBuffers;			// In submission order
+	unsigned int					mWrittenFrameCount;
+	unsigned int					mDroppedFrameCount;
+
+	mutable OVR::Mutex				mMutex;
+	OVR::WaitCondition				mCondition;
+	bool							mQuit;
+	bool							mThreadRunning;
+	OVR::Ptr<OVR::Thread>			mThread;
+};
+
+}
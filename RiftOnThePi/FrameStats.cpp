@@ -0,0 +1,110 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "FrameStats.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace OGLESSandbox
+{
+
+FrameStats::FrameStats()
+{
+	reset();
+}
+
+void FrameStats::reset()
+{
+	mCount = 0;
+	mMin = 0;
+	mMax = 0;
+	mSum = 0.0;
+	mSumOfSquares = 0.0;
+	memset( mBuckets, 0, sizeof(mBuckets) );
+}
+
+void FrameStats::add( unsigned int duration )
+{
+	if ( mCount==0 || duration<mMin )
+		mMin = duration;
+	if ( duration>mMax )
+		mMax = duration;
+	mCount++;
+	mSum += duration;
+	mSumOfSquares += static_cast<double>(duration) * duration;
+	
+	unsigned int bucket = duration / BucketDuration;
+	if ( bucket>BucketCount )
+		bucket = BucketCount;
+	mBuckets[bucket]++;
+}
+
+double FrameStats::getMean() const
+{
+	if ( mCount==0 )
+		return 0.0;
+	return mSum / mCount;
+}
+
+double FrameStats::getStandardDeviation() const
+{
+	if ( mCount<2 )
+		return 0.0;
+	double mean = getMean();
+	double variance = mSumOfSquares / mCount - mean * mean;
+	return variance>0.0 ? sqrt(variance) : 0.0;
+}
+
+unsigned int FrameStats::getPercentile( float percentile ) const
+{
+	if ( mCount==0 )
+		return 0;
+	if ( percentile<0.f )
+		percentile = 0.f;
+	if ( percentile>100.f )
+		percentile = 100.f;
+
+	// Rank of the sample we're looking for, then the bucket that holds it.
+	// The result is the middle of the bucket, kept within the observed extremes
+	unsigned int rank = static_cast<unsigned int>( ceil( percentile / 100.0 * mCount ) );
+	if ( rank<1 )
+		rank = 1;
+	unsigned int cumulatedCount = 0;
+	for ( unsigned int i=0; i<BucketCount; ++i )
+	{
+		cumulatedCount += mBuckets[i];
+		if ( cumulatedCount>=rank )
+		{
+			unsigned int duration = i * BucketDuration + BucketDuration / 2;
+			if ( duration<mMin )
+				duration = mMin;
+			if ( duration>mMax )
+				duration = mMax;
+			return duration;
+		}
+	}
+	return mMax;
+}
+
+}
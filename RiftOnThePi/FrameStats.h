@@ -0,0 +1,67 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+namespace OGLESSandbox
+{
+
+/*
+	FrameStats
+
+	Accumulates durations in microseconds and reports their mean, extremes
+	and percentiles. Percentiles come from a fixed histogram (50us buckets up 
+	to 100ms, longer durations fall in an overflow bucket) so adding a sample 
+	costs the same and never allocates, however long the run.
+*/
+class FrameStats
+{
+public:
+	FrameStats();
+
+	void			reset();
+	void			add( unsigned int duration );
+
+	unsigned int	getCount() const { return mCount; }
+	unsigned int	getMin() const { return mCount>0 ? mMin : 0; }
+	unsigned int	getMax() const { return mMax; }
+	double			getMean() const;
+	double			getStandardDeviation() const;
+	unsigned int	getPercentile( float percentile ) const;	// percentile in [0,100]
+
+private:
+	enum 
+	{
+		BucketDuration = 50,
+		BucketCount = 2000
+	};
+
+	unsigned int	mCount;
+	unsigned int	mMin;
+	unsigned int	mMax;
+	double			mSum;
+	double			mSumOfSquares;
+	unsigned int	mBuckets[BucketCount+1];		// The last one is the overflow bucket
+};
+
+}
@@ -0,0 +1,335 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "HIDReportReader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "OGLESTrace.h"
+
+#ifdef __linux__
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <sys/epoll.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+namespace OGLESSandbox
+{
+
+HIDReportReader::Statistics::Statistics()
+	: wakeups(0),
+	  reads(0),
+	  reports(0),
+	  samples(0),
+	  skippedBytes(0)
+{
+}
+
+HIDReportReader::HIDReportReader()
+	: mSensorFusion(NULL),
+	  mFd(-1),
+	  mReportPerRead(false),
+	  mEpollFd(-1),
+	  mBufferedBytes(0),
+	  mPreviousTimestamp(-1),
+	  mMutex(),
+	  mCondition(),
+	  mThreadRunning(false),
+	  mStatistics(),
+	  mThread()
+{
+	mWakeFds[0] = -1;
+	mWakeFds[1] = -1;
+	memset( mBuffer, 0, sizeof(mBuffer) );
+	memset( mSamples, 0, sizeof(mSamples) );
+}
+
+HIDReportReader::~HIDReportReader()
+{
+	stop();
+}
+
+bool HIDReportReader::start( const std::string& devicePath, BatchedSensorFusion* sensorFusion )
+{
+#ifdef __linux__
+	int fd = open( devicePath.c_str(), O_RDONLY | O_NONBLOCK );
+	if ( fd<0 )
+	{
+		printf("HIDReportReader: failed to open %s (%s)\n", devicePath.c_str(), strerror(errno) );
+		return false;
+	}
+	printf("HIDReportReader: reading %s\n", devicePath.c_str() );
+	return start( fd, sensorFusion );
+#else
+	printf("HIDReportReader: only available on Linux\n");
+	return false;
+#endif
+}
+
+bool HIDReportReader::start( int fd, BatchedSensorFusion* sensorFusion )
+{
+	stop();
+#ifdef __linux__
+	mFd = fd;
+	mSensorFusion = sensorFusion;
+	mBufferedBytes = 0;
+	mPreviousTimestamp = -1;
+	mStatistics = Statistics();
+	
+	struct stat fileStat;
+	mReportPerRead = fstat( mFd, &fileStat )==0 && S_ISCHR( fileStat.st_mode );
+
+	int flags = fcntl( mFd, F_GETFL );
+	if ( flags<0 || fcntl( mFd, F_SETFL, flags | O_NONBLOCK )<0 || pipe( mWakeFds )<0 )
+	{
+		printf("HIDReportReader: failed to set the device up (%s)\n", strerror(errno) );
+		closeDevice();
+		return false;
+	}
+
+	mEpollFd = epoll_create( 2 );
+	struct epoll_event event;
+	memset( &event, 0, sizeof(event) );
+	event.events = EPOLLIN;
+	event.data.fd = mFd;
+	bool ok = mEpollFd>=0 && epoll_ctl( mEpollFd, EPOLL_CTL_ADD, mFd, &event )==0;
+	event.data.fd = mWakeFds[0];
+	ok = ok && epoll_ctl( mEpollFd, EPOLL_CTL_ADD, mWakeFds[0], &event )==0;
+	if ( !ok )
+	{
+		printf("HIDReportReader: failed to set epoll up (%s)\n", strerror(errno) );
+		closeDevice();
+		return false;
+	}
+
+	mThreadRunning = true;
+	mThread = *new OVR::Thread( threadFunction, this );
+	if ( !mThread->Start() )
+	{
+		printf("HIDReportReader: failed to start thread\n");
+		mThreadRunning = false;
+		mThread.Clear();
+		closeDevice();
+		return false;
+	}
+	return true;
+#else
+	printf("HIDReportReader: only available on Linux\n");
+	return false;
+#endif
+}
+
+void HIDReportReader::stop()
+{
+	if ( !isRunning() )
+		return;
+#ifdef __linux__
+	char wake = 0;
+	if ( write( mWakeFds[1], &wake, 1 )!=1 )
+		printf("HIDReportReader: failed to wake the thread up\n");
+#endif
+	mMutex.DoLock();
+	while ( mThreadRunning )
+		mCondition.Wait( &mMutex );
+	mMutex.Unlock();
+	mThread.Clear();
+	closeDevice();
+}
+
+void HIDReportReader::closeDevice()
+{
+#ifdef __linux__
+	int* fds[] = { &mFd, &mEpollFd, &mWakeFds[0], &mWakeFds[1] };
+	for ( size_t i=0; i<sizeof(fds)/sizeof(fds[0]); ++i )
+	{
+		if ( *fds[i]>=0 )
+			close( *fds[i] );
+		*fds[i] = -1;
+	}
+#endif
+}
+
+HIDReportReader::Statistics HIDReportReader::takeStatistics()
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	Statistics statistics = mStatistics;
+	mStatistics = Statistics();
+	return statistics;
+}
+
+int HIDReportReader::threadFunction( OVR::Thread* /*thread*/, void* userData )
+{
+	HIDReportReader* reader = static_cast<HIDReportReader*>(userData);
+	reader->readerLoop();
+	return 0;
+}
+
+void HIDReportReader::readerLoop()
+{
+	OGLES_TRACE_THREAD_NAME("HID reader");
+#ifdef __linux__
+	bool done = false;
+	while ( !done )
+	{
+		struct epoll_event events[2];
+		int eventCount = epoll_wait( mEpollFd, events, 2, -1 );
+		if ( eventCount<0 )
+		{
+			if ( errno==EINTR )
+				continue;
+			printf("HIDReportReader: epoll_wait failed (%s)\n", strerror(errno) );
+			break;
+		}
+		bool readable = false;
+		for ( int i=0; i<eventCount; ++i )
+		{
+			if ( events[i].data.fd==mWakeFds[0] )
+				done = true;
+			else
+				readable = true;
+		}
+		if ( readable && !done )
+			done = !drain();
+	}
+#endif
+	mMutex.DoLock();
+	mThreadRunning = false;
+	mCondition.NotifyAll();
+	mMutex.Unlock();
+}
+
+bool HIDReportReader::drain()
+{
+	OGLES_TRACE_SCOPE("hidReports");
+	Statistics statistics;
+	statistics.wakeups = 1;
+	bool deviceOpen = true;
+	int sampleCount = 0;
+#ifdef __linux__
+	for ( ;; )
+	{
+		// Never less than MaxReportsPerRead-1 reports of room: whole reports are consumed after each read
+		ssize_t size = read( mFd, mBuffer + mBufferedBytes, sizeof(mBuffer) - mBufferedBytes );
+		if ( size<0 )
+		{
+			if ( errno==EINTR )
+				continue;
+			if ( errno!=EAGAIN && errno!=EWOULDBLOCK )
+			{
+				printf("HIDReportReader: read failed (%s)\n", strerror(errno) );
+				deviceOpen = false;
+			}
+			break;
+		}
+		if ( size==0 )
+		{
+			printf("HIDReportReader: device closed\n");
+			deviceOpen = false;
+			break;
+		}
+		OVR::UInt64 arrivalTime = BatchedSensorFusion::getMonotonicTime();
+		statistics.reads++;
+		mBufferedBytes += static_cast<int>(size);
+
+		int offset = 0;
+		while ( mBufferedBytes - offset>=ReportSize )
+		{
+			const unsigned char* report = mBuffer + offset;
+			if ( report[0]!=TrackerReportId )
+			{
+				offset++;
+				statistics.skippedBytes++;
+				continue;
+			}
+			if ( sampleCount + MaxSamplesPerReport>static_cast<int>(sizeof(mSamples)/sizeof(mSamples[0])) )
+			{
+				mSensorFusion->addSamples( mSamples, sampleCount );
+				sampleCount = 0;
+			}
+			int count = decodeReport( report, mPreviousTimestamp, arrivalTime, mSamples + sampleCount );
+			mPreviousTimestamp = report[2] | (report[3] << 8);
+			sampleCount += count;
+			statistics.samples += count;
+			statistics.reports++;
+			offset += ReportSize;
+		}
+		memmove( mBuffer, mBuffer + offset, mBufferedBytes - offset );
+		mBufferedBytes -= offset;
+	}
+#endif
+	if ( sampleCount>0 )
+		mSensorFusion->addSamples( mSamples, sampleCount );
+
+	OVR::Mutex::Locker locker( &mMutex );
+	mStatistics.wakeups += statistics.wakeups;
+	mStatistics.reads += statistics.reads;
+	mStatistics.reports += statistics.reports;
+	mStatistics.samples += statistics.samples;
+	mStatistics.skippedBytes += statistics.skippedBytes;
+	return deviceOpen;
+}
+
+// Three signed 21 bit values packed big endian in 8 bytes
+static void unpackSensor( const unsigned char* buffer, float* values )
+{
+	int x = (buffer[0] << 13) | (buffer[1] << 5) | ((buffer[2] & 0xF8) >> 3);
+	int y = ((buffer[2] & 0x07) << 18) | (buffer[3] << 10) | (buffer[4] << 2) | ((buffer[5] & 0xC0) >> 6);
+	int z = ((buffer[5] & 0x3F) << 15) | (buffer[6] << 7) | (buffer[7] >> 1);
+	values[0] = static_cast<float>( (x ^ 0x100000) - 0x100000 ) * 0.0001f;
+	values[1] = static_cast<float>( (y ^ 0x100000) - 0x100000 ) * 0.0001f;
+	values[2] = static_cast<float>( (z ^ 0x100000) - 0x100000 ) * 0.0001f;
+}
+
+int HIDReportReader::decodeReport( const unsigned char* report, int previousTimestamp, OVR::UInt64 arrivalTime, BatchedSensorFusion::Sample* samples )
+{
+	// Layout of the DK1 tracker report (as decoded by LibOVR's SensorDeviceImpl): report id, 
+	// sample count, 16 bit timestamp (counting samples), last command id, temperature, then up to 
+	// 3 samples of 16 bytes (acceleration then rotation rate) and the magnetic field. The values 
+	// are in the HMD frame that LibOVR configures the device with
+	int sampleCount = report[1];
+	int count = sampleCount<MaxSamplesPerReport ? sampleCount : MaxSamplesPerReport;
+	int timestamp = report[2] | (report[3] << 8);
+	int elapsed = sampleCount;
+	if ( previousTimestamp>=0 )
+		elapsed = (timestamp - previousTimestamp) & 0xFFFF;
+	
+	// The device sends the latest samples only, the first one stands for those it skipped
+	int firstSampleUnits = elapsed - count + 1;
+	if ( firstSampleUnits<1 )
+		firstSampleUnits = 1;
+	for ( int i=0; i<count; ++i )
+	{
+		const unsigned char* sampleData = report + 8 + 16 * i;
+		BatchedSensorFusion::Sample& sample = samples[i];
+		unpackSensor( sampleData, sample.acceleration );
+		unpackSensor( sampleData + 8, sample.rotationRate );
+		sample.timeDelta = static_cast<float>( i==0 ? firstSampleUnits : 1 ) * 0.001f;
+		sample.arrivalTime = arrivalTime;
+	}
+	return count;
+}
+
+}
@@ -0,0 +1,112 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include "BatchedSensorFusion.h"
+
+#include <string>
+
+namespace OGLESSandbox
+{
+
+/*
+	HIDReportReader
+
+	Reads the DK1 tracker reports straight from its hidraw device on a thread of its own, 
+	instead of LibOVR's one read per report. The thread sleeps in epoll until the device 
+	is readable, then drains everything pending with non-blocking reads before going back 
+	to sleep. Each read is stamped with the monotonic clock and the samples of its reports 
+	go to a BatchedSensorFusion, the whole wakeup's worth under a single lock.
+
+	A hidraw read returns a single report, so on the Rift a wakeup still costs one read 
+	per pending report: only the epoll wakeups are saved. Any byte stream carrying back 
+	to back reports (such as the pipe of SimulatedTrackerDevice) is read as well, several 
+	reports per read, which the real device can't match.
+	LibOVR's sensor device has to stay open meanwhile: it sends the keep-alives without 
+	which the DK1 stops streaming after a few seconds. Linux only.
+*/
+class HIDReportReader
+{
+public:
+	enum
+	{
+		ReportSize = 62,
+		TrackerReportId = 1,
+		MaxSamplesPerReport = 3,
+		MaxReportsPerRead = 64
+	};
+
+	struct Statistics
+	{
+		Statistics();
+
+		unsigned int	wakeups;
+		unsigned int	reads;
+		unsigned int	reports;
+		unsigned int	samples;
+		unsigned int	skippedBytes;		// Not starting a tracker report
+	};
+
+	HIDReportReader();
+	~HIDReportReader();
+
+	bool		start( const std::string& devicePath, BatchedSensorFusion* sensorFusion );
+	bool		start( int fd, BatchedSensorFusion* sensorFusion );		// Takes the ownership of fd
+	void		stop();
+	bool		isRunning() const { return mThread.GetPtr()!=NULL; }
+	bool		isReportPerRead() const { return mReportPerRead; }		// A character device such as hidraw, not a stream
+
+	// Returns the statistics since the previous call
+	Statistics	takeStatistics();
+
+	// Decodes the samples of a tracker report. The first sample covers the ones the device 
+	// skipped since previousTimestamp (when not negative). Returns the number of samples
+	static int	decodeReport( const unsigned char* report, int previousTimestamp, OVR::UInt64 arrivalTime, BatchedSensorFusion::Sample* samples );
+
+private:
+	static int	threadFunction( OVR::Thread* thread, void* userData );
+	void		readerLoop();
+	bool		drain();
+	void		closeDevice();
+
+	BatchedSensorFusion*		mSensorFusion;
+	int							mFd;
+	bool						mReportPerRead;
+	int							mEpollFd;
+	int							mWakeFds[2];			// Written to by stop() to wake the thread up
+	unsigned char				mBuffer[ReportSize * MaxReportsPerRead];
+	int							mBufferedBytes;
+	int							mPreviousTimestamp;
+	BatchedSensorFusion::Sample	mSamples[MaxSamplesPerReport * MaxReportsPerRead];
+	
+	mutable OVR::Mutex			mMutex;
+	OVR::WaitCondition			mCondition;
+	bool						mThreadRunning;
+	Statistics					mStatistics;
+	OVR::Ptr<OVR::Thread>		mThread;
+};
+
+}
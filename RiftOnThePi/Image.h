@@ -0,0 +1,58 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+/*
+	Image
+
+	A plain RGBA 8-bit per channel image stored bottom row first, which is
+	the layout glReadPixels() returns and glTexImage2D() expects.
+*/
+class Image
+{
+public:
+	Image();
+	Image( int width, int height );
+
+	void					resize( int width, int height );
+	
+	int						getWidth() const { return mWidth; }
+	int						getHeight() const { return mHeight; }
+	unsigned char*			getPixels() { return mPixels.empty() ? 0 : &mPixels[0]; }
+	const unsigned char*	getPixels() const { return mPixels.empty() ? 0 : &mPixels[0]; }
+	unsigned char*			getPixel( int x, int y ) { return &mPixels[(y*mWidth + x)*4]; }
+	const unsigned char*	getPixel( int x, int y ) const { return &mPixels[(y*mWidth + x)*4]; }
+
+private:
+	int							mWidth;
+	int							mHeight;
+	std::vector<unsigned char>	mPixels;
+};
+
+}
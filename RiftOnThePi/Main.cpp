@@ -30,6 +30,9 @@ int main( int argc, char** argv )
 	OGLESSandbox::ApplicationRunner* runner = OGLESSandbox::ApplicationRunner::create();
 	
 	runner->run( application, argc, argv );
+	int exitStatus = application->getExitStatus();
+	if ( exitStatus==0 )
+		exitStatus = runner->getExitStatus();
 
 	delete application;
 	application = NULL;
@@ -37,5 +40,5 @@ int main( int argc, char** argv )
 	delete runner;
 	runner = NULL;
 
-	return 0;
+	return exitStatus;
 }
\ No newline at end of file
@@ -0,0 +1,382 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "MetricsServer.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "OGLESTrace.h"
+
+#ifdef __linux__
+	#include <errno.h>
+	#include <poll.h>
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+namespace OGLESSandbox
+{
+
+namespace
+{
+
+void memoryBarrier()
+{
+#ifdef _WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+const int RequestTimeoutMs = 100;		// A client that sends nothing within it gets the bare metrics
+
+void appendHeader( std::string& text, const char* name, const char* type, const char* help )
+{
+	char line[256];
+	snprintf( line, sizeof(line), "# HELP riftonthepi_%s %s\n# TYPE riftonthepi_%s %s\n", name, help, name, type );
+	text += line;
+}
+
+}
+
+MetricsServer::Snapshot::Snapshot()
+	: time(0.0),
+	  frameCount(0),
+	  droppedFrameCount(0),
+	  frameRate(0.f),
+	  stereoRenderTechnique(0),
+	  sensorSampleCount(0),
+	  sensorSampleRate(0.f),
+	  thermalZoneCount(0),
+	  cpuCount(0)
+{
+	memset( frameTimes, 0, sizeof(frameTimes) );
+	memset( drawTimes, 0, sizeof(drawTimes) );
+	for ( int i=0; i<StartupProfile::PhaseCount; ++i )
+		startupPhaseTimes[i] = -1.f;
+	memset( temperatures, 0, sizeof(temperatures) );
+	memset( cpuFrequencies, 0, sizeof(cpuFrequencies) );
+}
+
+MetricsServer::MetricsServer()
+	: mSocketPath(),
+	  mListenFd(-1),
+	  mSequence(0),
+	  mSnapshot(),
+	  mScrapeCount(0),
+	  mMutex(),
+	  mCondition(),
+	  mThreadRunning(false),
+	  mThread()
+{
+	mWakeFds[0] = -1;
+	mWakeFds[1] = -1;
+}
+
+MetricsServer::~MetricsServer()
+{
+	stop();
+}
+
+bool MetricsServer::start( const std::string& socketPath )
+{
+	stop();
+#ifdef __linux__
+	struct sockaddr_un address;
+	memset( &address, 0, sizeof(address) );
+	address.sun_family = AF_UNIX;
+	if ( socketPath.empty() || socketPath.size()>=sizeof(address.sun_path) )
+	{
+		printf("MetricsServer: invalid socket path '%s'\n", socketPath.c_str() );
+		return false;
+	}
+	strcpy( address.sun_path, socketPath.c_str() );
+	unlink( socketPath.c_str() );		// Left behind by a previous run
+
+	mListenFd = socket( AF_UNIX, SOCK_STREAM, 0 );
+	if ( mListenFd<0 || 
+		 bind( mListenFd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address) )<0 ||
+		 listen( mListenFd, 4 )<0 || 
+		 pipe( mWakeFds )<0 )
+	{
+		printf("MetricsServer: failed to listen on %s (%s)\n", socketPath.c_str(), strerror(errno) );
+		closeSockets();
+		return false;
+	}
+	mSocketPath = socketPath;
+	mScrapeCount = 0;
+
+	mThreadRunning = true;
+	mThread = *new OVR::Thread( threadFunction, this );
+	if ( !mThread->Start() )
+	{
+		printf("MetricsServer: failed to start thread\n");
+		mThreadRunning = false;
+		mThread.Clear();
+		closeSockets();
+		return false;
+	}
+	printf("MetricsServer: serving on %s\n", socketPath.c_str() );
+	return true;
+#else
+	printf("MetricsServer: only available on Linux\n");
+	return false;
+#endif
+}
+
+void MetricsServer::stop()
+{
+	if ( !isRunning() )
+		return;
+#ifdef __linux__
+	char wake = 0;
+	if ( write( mWakeFds[1], &wake, 1 )!=1 )
+		printf("MetricsServer: failed to wake the thread up\n");
+#endif
+	mMutex.DoLock();
+	while ( mThreadRunning )
+		mCondition.Wait( &mMutex );
+	mMutex.Unlock();
+	mThread.Clear();
+	closeSockets();
+}
+
+void MetricsServer::closeSockets()
+{
+#ifdef __linux__
+	int* fds[] = { &mListenFd, &mWakeFds[0], &mWakeFds[1] };
+	for ( size_t i=0; i<sizeof(fds)/sizeof(fds[0]); ++i )
+	{
+		if ( *fds[i]>=0 )
+			close( *fds[i] );
+		*fds[i] = -1;
+	}
+	if ( !mSocketPath.empty() )
+		unlink( mSocketPath.c_str() );
+	mSocketPath.clear();
+#endif
+}
+
+void MetricsServer::publish( const Snapshot& snapshot )
+{
+	// Only the render thread writes, so the sequence can be bumped without an atomic operation
+	mSequence = mSequence + 1;
+	memoryBarrier();
+	mSnapshot = snapshot;
+	memoryBarrier();
+	mSequence = mSequence + 1;
+}
+
+bool MetricsServer::readSnapshot( Snapshot& snapshot ) const
+{
+	for ( int attempt=0; attempt<100; ++attempt )
+	{
+		unsigned int sequence = mSequence;
+		memoryBarrier();
+		if ( sequence & 1 )
+			continue;
+		snapshot = mSnapshot;
+		memoryBarrier();
+		if ( sequence==mSequence )
+			return sequence!=0;		// Nothing published yet otherwise
+	}
+	return false;
+}
+
+float MetricsServer::getQuantile( int index )
+{
+	static const float quantiles[QuantileCount] = { 0.5f, 0.9f, 0.99f, 1.f };
+	return quantiles[index];
+}
+
+int MetricsServer::threadFunction( OVR::Thread* /*thread*/, void* userData )
+{
+	MetricsServer* server = static_cast<MetricsServer*>(userData);
+	server->serverLoop();
+	return 0;
+}
+
+void MetricsServer::serverLoop()
+{
+	OGLES_TRACE_THREAD_NAME("Metrics server");
+#ifdef __linux__
+	for ( ;; )
+	{
+		struct pollfd fds[2];
+		fds[0].fd = mListenFd;
+		fds[0].events = POLLIN;
+		fds[1].fd = mWakeFds[0];
+		fds[1].events = POLLIN;
+		if ( poll( fds, 2, -1 )<0 )
+		{
+			if ( errno==EINTR )
+				continue;
+			printf("MetricsServer: poll failed (%s)\n", strerror(errno) );
+			break;
+		}
+		if ( fds[1].revents!=0 )
+			break;
+		if ( fds[0].revents & POLLIN )
+		{
+			int clientFd = accept( mListenFd, NULL, NULL );
+			if ( clientFd>=0 )
+			{
+				serveClient( clientFd );
+				close( clientFd );
+			}
+		}
+	}
+#endif
+	OVR::Mutex::Locker locker( &mMutex );
+	mThreadRunning = false;
+	mCondition.NotifyAll();
+}
+
+void MetricsServer::serveClient( int fd )
+{
+#ifdef __linux__
+	// Only the first bytes matter, to tell an HTTP client from a bare one
+	char request[512];
+	int requestSize = 0;
+	struct pollfd client;
+	client.fd = fd;
+	client.events = POLLIN;
+	if ( poll( &client, 1, RequestTimeoutMs )>0 )
+	{
+		ssize_t size = read( fd, request, sizeof(request)-1 );
+		requestSize = size>0 ? static_cast<int>(size) : 0;
+	}
+	request[requestSize] = 0;
+	bool http = strncmp( request, "GET ", 4 )==0;
+
+	Snapshot snapshot;
+	++mScrapeCount;
+	std::string body = readSnapshot( snapshot ) ? format( snapshot ) : std::string();
+
+	std::string response;
+	if ( http )
+	{
+		char header[128];
+		snprintf( header, sizeof(header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %u\r\n\r\n", 
+			static_cast<unsigned int>(body.size()) );
+		response = header;
+	}
+	response += body;
+
+	size_t written = 0;
+	while ( written<response.size() )
+	{
+		ssize_t size = send( fd, response.data() + written, response.size() - written, MSG_NOSIGNAL );
+		if ( size<0 && errno==EINTR )
+			continue;
+		if ( size<=0 )
+		{
+			printf("MetricsServer: failed to answer a client (%s)\n", strerror(errno) );
+			break;
+		}
+		written += size;
+	}
+#endif
+}
+
+std::string MetricsServer::format( const Snapshot& snapshot ) const
+{
+	std::string text;
+	char line[256];
+	
+	appendHeader( text, "uptime_seconds", "gauge", "Time since the start of the application" );
+	snprintf( line, sizeof(line), "riftonthepi_uptime_seconds %.3f\n", snapshot.time );
+	text += line;
+
+	appendHeader( text, "frames_total", "counter", "Frames drawn" );
+	snprintf( line, sizeof(line), "riftonthepi_frames_total %u\n", snapshot.frameCount );
+	text += line;
+
+	appendHeader( text, "dropped_frames_total", "counter", "Frames that took more than one and a half refresh intervals" );
+	snprintf( line, sizeof(line), "riftonthepi_dropped_frames_total %u\n", snapshot.droppedFrameCount );
+	text += line;
+
+	appendHeader( text, "frame_rate", "gauge", "Frames per second over the last second" );
+	snprintf( line, sizeof(line), "riftonthepi_frame_rate %.2f\n", snapshot.frameRate );
+	text += line;
+
+	appendHeader( text, "frame_time_seconds", "summary", "Time between frames over the last second" );
+	for ( int i=0; i<QuantileCount; ++i )
+	{
+		snprintf( line, sizeof(line), "riftonthepi_frame_time_seconds{quantile=\"%g\"} %.6f\n", getQuantile(i), snapshot.frameTimes[i] );
+		text += line;
+	}
+
+	appendHeader( text, "draw_time_seconds", "summary", "Time spent in draw() over the last second" );
+	for ( int i=0; i<QuantileCount; ++i )
+	{
+		snprintf( line, sizeof(line), "riftonthepi_draw_time_seconds{quantile=\"%g\"} %.6f\n", getQuantile(i), snapshot.drawTimes[i] );
+		text += line;
+	}
+
+	appendHeader( text, "stereo_render_technique", "gauge", "Current StereoRenderTechnique parameter" );
+	snprintf( line, sizeof(line), "riftonthepi_stereo_render_technique %d\n", snapshot.stereoRenderTechnique );
+	text += line;
+
+	appendHeader( text, "sensor_samples_total", "counter", "Tracker samples fed to the sensor fusion" );
+	snprintf( line, sizeof(line), "riftonthepi_sensor_samples_total %u\n", snapshot.sensorSampleCount );
+	text += line;
+
+	appendHeader( text, "sensor_sample_rate", "gauge", "Tracker samples per second over the last second" );
+	snprintf( line, sizeof(line), "riftonthepi_sensor_sample_rate %.1f\n", snapshot.sensorSampleRate );
+	text += line;
+
+	appendHeader( text, "startup_phase_seconds", "gauge", "Duration of the startup phases that ran" );
+	for ( int i=0; i<StartupProfile::PhaseCount; ++i )
+	{
+		if ( snapshot.startupPhaseTimes[i]<0.f )
+			continue;
+		snprintf( line, sizeof(line), "riftonthepi_startup_phase_seconds{phase=\"%s\"} %.6f\n", 
+			StartupProfile::getPhaseName( static_cast<StartupProfile::Phase>(i) ), snapshot.startupPhaseTimes[i] );
+		text += line;
+	}
+
+	appendHeader( text, "temperature_celsius", "gauge", "Thermal zone temperatures" );
+	for ( int i=0; i<snapshot.thermalZoneCount; ++i )
+	{
+		snprintf( line, sizeof(line), "riftonthepi_temperature_celsius{zone=\"%d\"} %.1f\n", i, snapshot.temperatures[i] );
+		text += line;
+	}
+
+	appendHeader( text, "cpu_frequency_hertz", "gauge", "Current CPU frequencies" );
+	for ( int i=0; i<snapshot.cpuCount; ++i )
+	{
+		snprintf( line, sizeof(line), "riftonthepi_cpu_frequency_hertz{cpu=\"%d\"} %.0f\n", i, snapshot.cpuFrequencies[i] * 1000.0 );
+		text += line;
+	}
+
+	appendHeader( text, "scrapes_total", "counter", "Requests served by the metrics server" );
+	snprintf( line, sizeof(line), "riftonthepi_scrapes_total %u\n", mScrapeCount );
+	text += line;
+	return text;
+}
+
+}
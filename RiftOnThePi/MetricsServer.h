@@ -0,0 +1,110 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include "StartupProfile.h"
+#include "TelemetrySampler.h"
+
+#include <string>
+
+namespace OGLESSandbox
+{
+
+/*
+	MetricsServer
+
+	Serves the health metrics of the application in the Prometheus text format on a 
+	Unix domain socket, from a thread of its own. A client sending an HTTP request gets 
+	an HTTP response (curl --unix-socket), one sending nothing gets the bare metrics.
+
+	The render thread publishes a fixed size snapshot once per second. Publishing is a 
+	sequence lock: the render thread never waits, the server thread copies the snapshot 
+	again if it was being published meanwhile. Formatting and socket I/O only happen on 
+	the server thread. Linux only.
+*/
+class MetricsServer
+{
+public:
+	enum
+	{
+		QuantileCount = 4			// See getQuantile()
+	};
+
+	struct Snapshot
+	{
+		Snapshot();
+
+		double			time;								// Seconds since the start of the application
+		unsigned int	frameCount;							// Since the start, as the dropped ones
+		unsigned int	droppedFrameCount;
+		float			frameRate;
+		float			frameTimes[QuantileCount];			// In seconds, over the last second
+		float			drawTimes[QuantileCount];
+		int				stereoRenderTechnique;
+		unsigned int	sensorSampleCount;					// Since the start
+		float			sensorSampleRate;					// Per second, over the last second
+		float			startupPhaseTimes[StartupProfile::PhaseCount];		// In seconds, negative when not run
+		int				thermalZoneCount;
+		float			temperatures[TelemetrySampler::MaxThermalZones];	// In degrees Celsius
+		int				cpuCount;
+		int				cpuFrequencies[TelemetrySampler::MaxCpus];			// In kHz
+	};
+
+	MetricsServer();
+	~MetricsServer();
+
+	bool			start( const std::string& socketPath );
+	void			stop();
+	bool			isRunning() const { return mThread.GetPtr()!=NULL; }
+
+	// Called by the render thread, never blocks
+	void			publish( const Snapshot& snapshot );
+
+	static float	getQuantile( int index );		// 0.5, 0.9, 0.99 and 1 (the maximum)
+
+private:
+	static int		threadFunction( OVR::Thread* thread, void* userData );
+	void			serverLoop();
+	bool			readSnapshot( Snapshot& snapshot ) const;
+	void			serveClient( int fd );
+	std::string		format( const Snapshot& snapshot ) const;
+	void			closeSockets();
+
+	std::string				mSocketPath;
+	int						mListenFd;
+	int						mWakeFds[2];			// Written to by stop() to wake the thread up
+
+	volatile unsigned int	mSequence;				// Odd while a snapshot is being published
+	Snapshot				mSnapshot;
+	unsigned int			mScrapeCount;			// Server thread only
+
+	mutable OVR::Mutex		mMutex;
+	OVR::WaitCondition		mCondition;
+	bool					mThreadRunning;
+	OVR::Ptr<OVR::Thread>	mThread;
+};
+
+}
@@ -0,0 +1,544 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "PerformanceHud.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "OGLESGLCheck.h"
+
+#define check() OGLES_GL_CHECK()
+
+namespace OGLESSandbox
+{
+
+static const char VertexShaderStringHud[] = 
+	"uniform vec2 Offset; \n"
+	"attribute vec2 Position; \n"
+	"attribute vec2 UV; \n"
+	"attribute vec4 Color; \n"
+	"varying vec2 oUV; \n"
+	"varying vec4 oColor; \n"
+	"void main(void) \n"
+	"{ \n"
+	"  oUV = UV; \n"
+	"  oColor = Color; \n"
+	"  gl_Position = vec4(Position + Offset, 0, 1); \n"
+	"} \n";
+
+static const char FragmentShaderStringHud[] = 
+	"uniform sampler2D Font; \n"
+	"varying mediump vec2 oUV; \n"
+	"varying lowp vec4 oColor; \n"
+	"void main(void) \n"
+	"{ \n"
+	"  gl_FragColor = vec4(oColor.rgb, oColor.a * texture2D(Font, oUV).a); \n"
+	"} \n";
+
+//
+// Font
+// 5x7 glyphs, one byte per row from top to bottom, the most significant of the 5 bits is the leftmost pixel.
+// Lower case letters are drawn with the upper case glyphs
+//
+struct Glyph
+{
+	char			character;
+	unsigned char	rows[7];
+};
+
+static const Glyph Glyphs[] = {
+	{ '0', { 0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E } },
+	{ '1', { 0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+	{ '2', { 0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F } },
+	{ '3', { 0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E } },
+	{ '4', { 0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02 } },
+	{ '5', { 0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E } },
+	{ '6', { 0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E } },
+	{ '7', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 } },
+	{ '8', { 0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E } },
+	{ '9', { 0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C } },
+	{ '.', { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C } },
+	{ ':', { 0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00 } },
+	{ '%', { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 } },
+	{ '/', { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 } },
+	{ '-', { 0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00 } },
+	{ 'A', { 0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11 } },
+	{ 'B', { 0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E } },
+	{ 'C', { 0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E } },
+	{ 'D', { 0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C } },
+	{ 'E', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F } },
+	{ 'F', { 0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'G', { 0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F } },
+	{ 'H', { 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11 } },
+	{ 'I', { 0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E } },
+	{ 'J', { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C } },
+	{ 'K', { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 } },
+	{ 'L', { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F } },
+	{ 'M', { 0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11 } },
+	{ 'N', { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 } },
+	{ 'O', { 0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'P', { 0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10 } },
+	{ 'Q', { 0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D } },
+	{ 'R', { 0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11 } },
+	{ 'S', { 0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E } },
+	{ 'T', { 0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 } },
+	{ 'U', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E } },
+	{ 'V', { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04 } },
+	{ 'W', { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A } },
+	{ 'X', { 0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11 } },
+	{ 'Y', { 0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04 } },
+	{ 'Z', { 0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F } }
+};
+
+// The atlas is a grid of 8x8 cells. Cell 0 is solid (for bars and backgrounds), glyph i is in cell i+1
+static const int AtlasWidth = 128;
+static const int AtlasHeight = 32;
+static const int CellSize = 8;
+static const int CellsPerRow = AtlasWidth / CellSize;
+static const int GlyphWidth = 5;
+static const int GlyphHeight = 7;
+static const int GlyphAdvance = 6;
+static const int LineHeight = 9;
+
+static int findGlyphCell( char character )
+{
+	if ( character>='a' && character<='z' )
+		character = character - 'a' + 'A';
+	for ( size_t i=0; i<sizeof(Glyphs)/sizeof(Glyphs[0]); ++i )
+	{
+		if ( Glyphs[i].character==character )
+			return static_cast<int>(i) + 1;
+	}
+	return -1;
+}
+
+static const unsigned char BackgroundColor[4] = { 0, 0, 0, 160 };
+static const unsigned char TextColor[4] = { 255, 255, 255, 255 };
+static const unsigned char GoodColor[4] = { 64, 220, 64, 255 };
+static const unsigned char LateColor[4] = { 240, 200, 32, 255 };
+static const unsigned char BadColor[4] = { 240, 48, 48, 255 };
+static const unsigned char ReferenceColor[4] = { 255, 255, 255, 128 };
+static const unsigned char PhaseColors[PerformanceHud::PhaseCount][4] = { 
+	{ 64, 160, 255, 255 },		// Scene
+	{ 200, 96, 255, 255 },		// Distortion
+	{ 255, 64, 96, 255 },		// Record
+	{ 160, 160, 160, 255 },		// Swap
+	{ 255, 128, 32, 255 }		// HUD
+};
+static const char* PhaseNames[PerformanceHud::PhaseCount] = { "SCENE", "WARP", "REC", "SWAP", "HUD" };
+static const float FrameBudget = 16667.f;		// Microseconds, at 60Hz
+
+PerformanceHud::PerformanceHud()
+	: mProgram(0),
+	  mOffsetUniform(0),
+	  mFontUniform(0),
+	  mPositionAttrib(0),
+	  mUVAttrib(0),
+	  mColorAttrib(0),
+	  mFontTexture(0),
+	  mVertexBuffer(0),
+	  mIndexBuffer(0),
+	  mVertices(),
+	  mQuadCount(0),
+	  mViewportWidth(0),
+	  mViewportHeight(0),
+	  mGlyphScale(1.f),
+	  mFrameIndex(0),
+	  mFrameCount(0),
+	  mAccumulatedTime(0),
+	  mAccumulatedFrames(0),
+	  mDisplayedFPS(0.f),
+	  mTemperature(-1.f),
+	  mCpuFrequency(-1)
+{
+	memset( mFrameIntervals, 0, sizeof(mFrameIntervals) );
+	memset( mFrameTimes, 0, sizeof(mFrameTimes) );
+	memset( mAccumulatedPhaseTimes, 0, sizeof(mAccumulatedPhaseTimes) );
+	memset( mDisplayedPhaseTimes, 0, sizeof(mDisplayedPhaseTimes) );
+}
+
+PerformanceHud::~PerformanceHud()
+{
+	// GL resources can't be released here, the context may already be gone
+}
+
+bool PerformanceHud::create()
+{
+	printf("PerformanceHud::create\n");
+	if ( isCreated() )
+		return true;
+
+	GLuint vertexShader = Common::createAndCompileShader( GL_VERTEX_SHADER, VertexShaderStringHud );
+	if ( vertexShader==0 )
+		return false;
+	GLuint fragmentShader = Common::createAndCompileShader( GL_FRAGMENT_SHADER, FragmentShaderStringHud );
+	if ( fragmentShader==0 )
+		return false;
+	GLuint programObject = Common::createAndLinkProgram( vertexShader, fragmentShader );
+	glDeleteShader( vertexShader );
+	glDeleteShader( fragmentShader );
+	if ( programObject==0 )
+		return false;
+	
+	mProgram = programObject;
+	mOffsetUniform = glGetUniformLocation(mProgram, "Offset");
+	mFontUniform = glGetUniformLocation(mProgram, "Font");
+	mPositionAttrib = glGetAttribLocation(mProgram, "Position");
+	mUVAttrib = glGetAttribLocation(mProgram, "UV");
+	mColorAttrib = glGetAttribLocation(mProgram, "Color");
+
+	// Bake the font into the atlas. GL rows go bottom-up, the glyph rows top-down
+	std::vector<unsigned char> atlas( AtlasWidth * AtlasHeight, 0 );
+	for ( int y=0; y<CellSize; ++y )
+		for ( int x=0; x<CellSize; ++x )
+			atlas[y*AtlasWidth + x] = 255;
+	for ( size_t i=0; i<sizeof(Glyphs)/sizeof(Glyphs[0]); ++i )
+	{
+		int cell = static_cast<int>(i) + 1;
+		int cellX = (cell % CellsPerRow) * CellSize;
+		int cellY = (cell / CellsPerRow) * CellSize;
+		for ( int row=0; row<GlyphHeight; ++row )
+		{
+			int y = cellY + GlyphHeight - 1 - row;
+			for ( int column=0; column<GlyphWidth; ++column )
+			{
+				if ( Glyphs[i].rows[row] & (0x10 >> column) )
+					atlas[y*AtlasWidth + cellX + column] = 255;
+			}
+		}
+	}
+	glGenTextures(1, &mFontTexture);
+	check();
+	glBindTexture(GL_TEXTURE_2D, mFontTexture);
+	check();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	check();
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, AtlasWidth, AtlasHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, &atlas[0]);
+	check();
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	check();
+
+	// The quads all share the same index pattern, so the index buffer is static
+	std::vector<GLushort> indices( MaxQuads * 6 );
+	for ( int i=0; i<MaxQuads; ++i )
+	{
+		GLushort first = static_cast<GLushort>( i * 4 );
+		indices[i*6+0] = first;
+		indices[i*6+1] = first + 1;
+		indices[i*6+2] = first + 2;
+		indices[i*6+3] = first + 2;
+		indices[i*6+4] = first + 3;
+		indices[i*6+5] = first;
+	}
+	glGenBuffers(1, &mIndexBuffer);
+	check();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	check();
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLushort), &indices[0], GL_STATIC_DRAW);
+	check();
+
+	glGenBuffers(1, &mVertexBuffer);
+	check();
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	check();
+	glBufferData(GL_ARRAY_BUFFER, MaxQuads * 4 * sizeof(HudVertex), NULL, GL_STREAM_DRAW);
+	check();
+
+	mVertices.resize( MaxQuads * 4 );
+	mQuadCount = 0;
+	return true;
+}
+
+void PerformanceHud::destroy()
+{
+	if ( !isCreated() )
+		return;
+	glDeleteProgram( mProgram );
+	check();
+	glDeleteTextures( 1, &mFontTexture );
+	check();
+	glDeleteBuffers( 1, &mVertexBuffer );
+	check();
+	glDeleteBuffers( 1, &mIndexBuffer );
+	check();
+	mProgram = 0;
+	mFontTexture = 0;
+	mVertexBuffer = 0;
+	mIndexBuffer = 0;
+	mQuadCount = 0;
+}
+
+void PerformanceHud::addFrame( unsigned int frameInterval, const unsigned int phaseTimes[PhaseCount] )
+{
+	// The graph shows the time spent in the frame phases, the HUD excluded
+	unsigned int frameTime = 0;
+	for ( int i=0; i<PhaseCount; ++i )
+	{
+		if ( i!=HudPhase )
+			frameTime += phaseTimes[i];
+	}
+	mFrameIntervals[mFrameIndex] = frameInterval;
+	mFrameTimes[mFrameIndex] = frameTime;
+	mFrameIndex = (mFrameIndex + 1) % GraphFrameCount;
+	if ( mFrameCount<GraphFrameCount )
+		mFrameCount++;
+
+	// The figures are averaged over a fraction of a second, otherwise they change too fast to be read
+	mAccumulatedTime += frameInterval;
+	mAccumulatedFrames++;
+	for ( int i=0; i<PhaseCount; ++i )
+		mAccumulatedPhaseTimes[i] += phaseTimes[i];
+	if ( mAccumulatedTime>=DisplayRefreshInterval )
+	{
+		mDisplayedFPS = static_cast<float>( mAccumulatedFrames * 1000000.0 / mAccumulatedTime );
+		for ( int i=0; i<PhaseCount; ++i )
+		{
+			mDisplayedPhaseTimes[i] = static_cast<float>( mAccumulatedPhaseTimes[i] / mAccumulatedFrames / 1000.0 );
+			mAccumulatedPhaseTimes[i] = 0.0;
+		}
+		mAccumulatedTime = 0;
+		mAccumulatedFrames = 0;
+	}
+}
+
+void PerformanceHud::setTelemetry( float temperature, int cpuFrequency )
+{
+	mTemperature = temperature;
+	mCpuFrequency = cpuFrequency;
+}
+
+void PerformanceHud::update( int viewportWidth, int viewportHeight )
+{
+	if ( !isCreated() )
+		return;
+
+	mViewportWidth = viewportWidth;
+	mViewportHeight = viewportHeight;
+	mGlyphScale = static_cast<float>( viewportHeight / 400 );		// Font pixels twice as large at the DK1 resolution
+	if ( mGlyphScale<1.f )
+		mGlyphScale = 1.f;
+	mQuadCount = 0;
+
+	// Layout in eye viewport pixels, the panel being centered. Sizes are in font pixels
+	const float s = mGlyphScale;
+	const int columnCount = 22;
+	const int lineCount = 2 + PhaseCount;
+	const float margin = 3.f * s;
+	const float graphHeight = 30.f * s;
+	const float panelWidth = columnCount * GlyphAdvance * s + 2.f * margin;
+	const float panelHeight = lineCount * LineHeight * s + graphHeight + 3.f * margin;
+	const float left = static_cast<float>( static_cast<int>( (viewportWidth - panelWidth) / 2.f ) );
+	const float top = static_cast<float>( static_cast<int>( (viewportHeight + panelHeight) / 2.f ) );
+	const float textLeft = left + margin;
+	
+	addBar( left, top - panelHeight, panelWidth, panelHeight, BackgroundColor );
+
+	char text[64];
+	float y = top - margin - GlyphHeight * s;
+	float frameTime = 0.f;
+	for ( int i=0; i<PhaseCount; ++i )
+	{
+		if ( i!=HudPhase )
+			frameTime += mDisplayedPhaseTimes[i];
+	}
+	sprintf( text, "FPS %5.1f  FRAME %5.2f", mDisplayedFPS, frameTime );
+	addText( textLeft, y, text, TextColor );
+	y -= LineHeight * s;
+
+	// One line per phase: its time and a bar, full width being the frame budget
+	const float barLeft = textLeft + 12 * GlyphAdvance * s;
+	const float barMaxWidth = left + panelWidth - margin - barLeft;
+	for ( int i=0; i<PhaseCount; ++i )
+	{
+		sprintf( text, "%-6s%5.2f", PhaseNames[i], mDisplayedPhaseTimes[i] );
+		addText( textLeft, y, text, TextColor );
+		float barWidth = mDisplayedPhaseTimes[i] * 1000.f / FrameBudget * barMaxWidth;
+		if ( barWidth>barMaxWidth )
+			barWidth = barMaxWidth;
+		addBar( barLeft, y, barWidth, GlyphHeight * s, PhaseColors[i] );
+		y -= LineHeight * s;
+	}
+
+	if ( mTemperature>=0.f || mCpuFrequency>=0 )
+	{
+		sprintf( text, "%4.1fC  %4dMHZ", mTemperature, mCpuFrequency / 1000 );
+		addText( textLeft, y, text, TextColor );
+	}
+	
+	// Frame time graph, oldest on the left. Full height is two frame budgets
+	const float graphLeft = textLeft;
+	const float graphBottom = top - panelHeight + margin;
+	const float graphWidth = panelWidth - 2.f * margin;
+	const float columnWidth = graphWidth / GraphFrameCount;
+	for ( int i=0; i<mFrameCount; ++i )
+	{
+		int index = (mFrameIndex - mFrameCount + i + GraphFrameCount) % GraphFrameCount;
+		float value = static_cast<float>( mFrameTimes[index] );
+		float height = value / (2.f * FrameBudget) * graphHeight;
+		if ( height>graphHeight )
+			height = graphHeight;
+		const unsigned char* color = GoodColor;
+		if ( value>2.f * FrameBudget )
+			color = BadColor;
+		else if ( value>FrameBudget )
+			color = LateColor;
+		addBar( graphLeft + (GraphFrameCount - mFrameCount + i) * columnWidth, graphBottom, columnWidth, height, color );
+	}
+	addBar( graphLeft, graphBottom + graphHeight / 2.f, graphWidth, s, ReferenceColor );
+
+	// Orphan the previous content so the upload doesn't wait for the draws still using it
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	check();
+	glBufferData(GL_ARRAY_BUFFER, MaxQuads * 4 * sizeof(HudVertex), NULL, GL_STREAM_DRAW);
+	check();
+	glBufferSubData(GL_ARRAY_BUFFER, 0, mQuadCount * 4 * sizeof(HudVertex), &mVertices[0]);
+	check();
+}
+
+void PerformanceHud::draw( float offsetX )
+{
+	if ( !isCreated() || mQuadCount==0 )
+		return;
+
+	glDisable(GL_DEPTH_TEST);
+	check();
+	glDisable(GL_CULL_FACE);
+	check();
+	glEnable(GL_BLEND);
+	check();
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	check();
+
+	glUseProgram( mProgram );
+	check();
+	glUniform2f( mOffsetUniform, offsetX, 0.f );
+	check();
+	glActiveTexture( GL_TEXTURE0 );
+	check();
+	glBindTexture( GL_TEXTURE_2D, mFontTexture );
+	check();
+	glUniform1i( mFontUniform, 0 );
+	check();
+
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+	check();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+	check();
+	glVertexAttribPointer(mPositionAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), 0);
+	check();
+	glVertexAttribPointer(mUVAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(HudVertex), (GLvoid*) (sizeof(float) * 2));
+	check();
+	glVertexAttribPointer(mColorAttrib, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(HudVertex), (GLvoid*) (sizeof(float) * 4));
+	check();
+	glEnableVertexAttribArray(mPositionAttrib);
+	check();
+	glEnableVertexAttribArray(mUVAttrib);
+	check();
+	glEnableVertexAttribArray(mColorAttrib);
+	check();
+
+	glDrawElements(GL_TRIANGLES, mQuadCount * 6, GL_UNSIGNED_SHORT, 0);
+	check();
+
+	// Leave the state as the other passes expect it
+	glDisableVertexAttribArray(mColorAttrib);
+	check();
+	glDisableVertexAttribArray(mUVAttrib);
+	check();
+	glDisableVertexAttribArray(mPositionAttrib);
+	check();
+	glDisable(GL_BLEND);
+	check();
+}
+
+void PerformanceHud::addQuad( float x, float y, float w, float h, int cell, const unsigned char color[4] )
+{
+	if ( mQuadCount>=MaxQuads || w<=0.f || h<=0.f )
+		return;
+
+	// Texture coordinates: the 5x7 glyph area of a glyph cell, the middle of the solid cell
+	float cellX = static_cast<float>( (cell % CellsPerRow) * CellSize );
+	float cellY = static_cast<float>( (cell / CellsPerRow) * CellSize );
+	float u0, v0, u1, v1;
+	if ( cell==0 )
+	{
+		u0 = (cellX + 2.f) / AtlasWidth;
+		v0 = (cellY + 2.f) / AtlasHeight;
+		u1 = (cellX + CellSize - 2.f) / AtlasWidth;
+		v1 = (cellY + CellSize - 2.f) / AtlasHeight;
+	}
+	else
+	{
+		u0 = cellX / AtlasWidth;
+		v0 = cellY / AtlasHeight;
+		u1 = (cellX + GlyphWidth) / AtlasWidth;
+		v1 = (cellY + GlyphHeight) / AtlasHeight;
+	}
+
+	// Eye viewport pixels to normalized device coordinates
+	float x0 = x / mViewportWidth * 2.f - 1.f;
+	float y0 = y / mViewportHeight * 2.f - 1.f;
+	float x1 = (x + w) / mViewportWidth * 2.f - 1.f;
+	float y1 = (y + h) / mViewportHeight * 2.f - 1.f;
+	
+	const float positions[4][2] = { { x0, y0 }, { x1, y0 }, { x1, y1 }, { x0, y1 } };
+	const float uvs[4][2] = { { u0, v0 }, { u1, v0 }, { u1, v1 }, { u0, v1 } };
+	HudVertex* vertices = &mVertices[mQuadCount * 4];
+	for ( int i=0; i<4; ++i )
+	{
+		vertices[i].position[0] = positions[i][0];
+		vertices[i].position[1] = positions[i][1];
+		vertices[i].uv[0] = uvs[i][0];
+		vertices[i].uv[1] = uvs[i][1];
+		memcpy( vertices[i].color, color, 4 );
+	}
+	mQuadCount++;
+}
+
+void PerformanceHud::addText( float x, float y, const char* text, const unsigned char color[4] )
+{
+	const float s = mGlyphScale;
+	for ( const char* c=text; *c!='\0'; ++c )
+	{
+		int cell = findGlyphCell( *c );
+		if ( cell>0 )
+			addQuad( x, y, GlyphWidth * s, GlyphHeight * s, cell, color );
+		x += GlyphAdvance * s;
+	}
+}
+
+void PerformanceHud::addBar( float x, float y, float w, float h, const unsigned char color[4] )
+{
+	addQuad( x, y, w, h, 0, color );
+}
+
+}
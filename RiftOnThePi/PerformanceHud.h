@@ -0,0 +1,124 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "Common.h"
+
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+/*
+	PerformanceHud
+
+	An overlay showing the frame rate, a graph of the latest frame times and one bar per
+	frame phase, readable from inside the headset.
+	The glyphs come from a small bitmap font compiled in and baked into an alpha texture 
+	atlas which also holds a solid cell for the bars. Every frame the whole overlay is 
+	written into a single dynamic vertex buffer (built once by update()) and drawn with 
+	one draw call per eye. The HUD measures its own cost: the application reports it as
+	a phase of its own and leaves it out of the other times.
+*/
+class PerformanceHud
+{
+public:
+	enum Phase
+	{
+		ScenePhase,
+		DistortionPhase,
+		RecordPhase,
+		SwapPhase,
+		HudPhase,
+		PhaseCount
+	};
+
+	PerformanceHud();
+	~PerformanceHud();
+
+	bool	create();
+	void	destroy();
+	bool	isCreated() const { return mProgram!=0; }
+
+	// Frame times in microseconds. The frame interval is measured from frame start to frame start
+	void	addFrame( unsigned int frameInterval, const unsigned int phaseTimes[PhaseCount] );
+	void	setTelemetry( float temperature, int cpuFrequency );		// Negative values when unknown
+
+	// Builds the geometry of the overlay for an eye viewport of the given size and uploads it
+	void	update( int viewportWidth, int viewportHeight );
+
+	// Draws the overlay in the current viewport, shifted horizontally by offsetX (in 
+	// normalized device coordinates) to center it on the lens
+	void	draw( float offsetX );
+
+private:
+	struct HudVertex
+	{
+		float			position[2];
+		float			uv[2];
+		unsigned char	color[4];
+	};
+
+	enum 
+	{
+		MaxQuads = 512,
+		GraphFrameCount = 64,
+		DisplayRefreshInterval = 250000		// Microseconds between two updates of the figures, so they can be read
+	};
+
+	void	addQuad( float x, float y, float w, float h, int cell, const unsigned char color[4] );
+	void	addText( float x, float y, const char* text, const unsigned char color[4] );
+	void	addBar( float x, float y, float w, float h, const unsigned char color[4] );
+
+	GLuint	mProgram;
+	GLint	mOffsetUniform;
+	GLint	mFontUniform;
+	GLint	mPositionAttrib;
+	GLint	mUVAttrib;
+	GLint	mColorAttrib;
+	GLuint	mFontTexture;
+	GLuint	mVertexBuffer;
+	GLuint	mIndexBuffer;
+
+	std::vector<HudVertex>	mVertices;					// Reserved once, never grows
+	int						mQuadCount;
+	int						mViewportWidth;
+	int						mViewportHeight;
+	float					mGlyphScale;
+
+	unsigned int	mFrameIntervals[GraphFrameCount];	// Ring buffers
+	unsigned int	mFrameTimes[GraphFrameCount];
+	int				mFrameIndex;
+	int				mFrameCount;
+
+	unsigned int	mAccumulatedTime;
+	unsigned int	mAccumulatedFrames;
+	double			mAccumulatedPhaseTimes[PhaseCount];
+	float			mDisplayedFPS;
+	float			mDisplayedPhaseTimes[PhaseCount];	// In ms
+	float			mTemperature;
+	int				mCpuFrequency;
+};
+
+}
@@ -25,13 +25,22 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <fstream>
 #include <cmath>
+#include <algorithm>
 
 #include "Common.h"
+#include "DistortionReference.h"
+#include "AllocationAudit.h"
+#include "TaskPool.h"
+#include "SoftwareShaders.h"
+#include "OGLESTrace.h"
+#include "OGLESGLCheck.h"
+#include "OGLESSoftwareGL.h"
 #include "Kernel/OVR_Timer.h"
 
-#define check() assert(glGetError() == 0)
+#define check() OGLES_GL_CHECK()
 
 namespace OGLESSandbox
 {
@@ -60,10 +69,49 @@ static const char FragmentShaderStringBox[] =
 	"  gl_FragColor = DestinationColor; \n"
 	"} \n";
 
+// Single pass stereo box: each vertex carries the index of the eye it's drawn for, which picks
+// the eye matrices. ClipTransform squeezes the eye's clip space horizontally into its half of the 
+// side by side viewport (scale, then offset in units of w). What falls out of the eye's own frustum 
+// on the inner side isn't clipped by the hardware anymore, the fragment shader discards it instead
+static const char VertexShaderStringStereoBox[] = 
+	"uniform mat4 Projection[2]; \n"
+	"uniform mat4 ModelView[2]; \n"
+	"uniform vec2 ClipTransform[2]; \n"
+	"attribute vec4 Position; \n"
+	"attribute vec4 SourceColor; \n"
+	"attribute float EyeIndex; \n"
+	"varying vec4 DestinationColor; \n"
+	"varying vec2 EyeClip; \n"
+	"void main(void) \n"
+	"{ \n"
+	"  int eye = int(EyeIndex); \n"
+	"  vec4 position = Projection[eye] * ModelView[eye] * Position; \n"
+	"  EyeClip = vec2(position.w + position.x, position.w - position.x); \n"
+	"  position.x = position.x * ClipTransform[eye].x + position.w * ClipTransform[eye].y; \n"
+	"  DestinationColor = SourceColor; \n"
+	"  gl_Position = position; \n"
+	"} \n";
+
+static const char FragmentShaderStringStereoBox[] = 
+	"varying lowp vec4 DestinationColor; \n"
+	"varying mediump vec2 EyeClip; \n"
+	"void main(void) \n"
+	"{ \n"
+	"  if ( EyeClip.x<0.0 || EyeClip.y<0.0 ) \n"
+	"    discard; \n"
+	"  gl_FragColor = DestinationColor; \n"
+	"} \n";
+
 typedef struct {
     float Position[3];
     float Color[4];
 } VertexWithColor;
+
+typedef struct {
+    float Position[3];
+    float Color[4];
+	float EyeIndex;
+} VertexWithColorAndEye;
  
 static const VertexWithColor VerticesBox[] = {
     {{ 1, -1,  1},	{1, 0, 0, 1}},
@@ -111,12 +159,36 @@ static const char VertexShaderStringQuad[] =
 	"	gl_Position = Position; \n"
 	"} \n";
 
-static const char* FragmentShader0StringQuad=
+// The quad fragment shaders read the scene through sampleScene(), defined by one of these prefixes.
+// With multi-resolution eye buffers, the scene is in two textures: Texture0 covers the whole eye at a 
+// reduced density, Texture1 the region around the lens center at full density. CenterTransform maps
+// the coordinates in Texture0 to those in Texture1 (scale then offset), CenterBounds is the rectangle
+// of the eye in Texture1 (min then max)
+static const char* SceneSamplingString =
+	"uniform sampler2D Texture0;\n"
+	"vec4 sampleScene(vec2 tc)\n"
+	"{\n"
+	"   return texture2D(Texture0, tc);\n"
+	"}\n";
+
+static const char* MultiResolutionSceneSamplingString =
 	"uniform sampler2D Texture0;\n"
+	"uniform sampler2D Texture1;\n"
+	"uniform vec4 CenterTransform;\n"
+	"uniform vec4 CenterBounds;\n"
+	"vec4 sampleScene(vec2 tc)\n"
+	"{\n"
+	"   vec2 ctc = tc * CenterTransform.xy + CenterTransform.zw;\n"
+	"   if (all(greaterThanEqual(ctc, CenterBounds.xy)) && all(lessThanEqual(ctc, CenterBounds.zw)))\n"
+	"       return texture2D(Texture1, ctc);\n"
+	"   return texture2D(Texture0, tc);\n"
+	"}\n";
+
+static const char* FragmentShader0StringQuad=
 	"varying vec2 oTexCoord;\n"
 	"void main()\n"
 	"{\n"
-	"   gl_FragColor = texture2D(Texture0, oTexCoord);\n"
+	"   gl_FragColor = sampleScene(oTexCoord);\n"
 	"}\n";
 
 static const char* FragmentShader1StringQuad=
@@ -125,7 +197,6 @@ static const char* FragmentShader1StringQuad=
 	"uniform vec2 Scale;\n"
 	"uniform vec2 ScaleIn;\n"
 	"uniform vec4 HmdWarpParam;\n"
-	"uniform sampler2D Texture0;\n"
 	"varying vec2 oTexCoord;\n"
 	"\n"
 	"vec2 HmdWarp(vec2 in01)\n"
@@ -142,7 +213,7 @@ static const char* FragmentShader1StringQuad=
 	"   if (!all(equal(clamp(tc, ScreenCenter-vec2(0.25,0.5), ScreenCenter+vec2(0.25,0.5)), tc)))\n"
 	"       gl_FragColor = vec4(1, 0, 1, 1);\n"  // JBM: was vec4(0) in original shader
 	"   else\n"
-	"       gl_FragColor = texture2D(Texture0, tc);\n"
+	"       gl_FragColor = sampleScene(tc);\n"
 	"}\n";
 
 // Shader with lens distortion and chromatic aberration correction.
@@ -153,7 +224,6 @@ static const char* FragmentShader2StringQuad =
 	"uniform vec2 ScaleIn;\n"
 	"uniform vec4 HmdWarpParam;\n"
 	"uniform vec4 ChromAbParam;\n"
-	"uniform sampler2D Texture0;\n"
 	"varying vec2 oTexCoord;\n"
 	"\n"
 	// Scales input texture coordinates for distortion.
@@ -176,16 +246,16 @@ static const char* FragmentShader2StringQuad =
 	"   }\n"
 	"   \n"
 	"   // Now do blue texture lookup.\n"
-	"   float blue = texture2D(Texture0, tcBlue).b;\n"
+	"   float blue = sampleScene(tcBlue).b;\n"
 	"   \n"
 	"   // Do green lookup (no scaling).\n"
 	"   vec2  tcGreen = LensCenter + Scale * theta1;\n"
-	"   vec4  center = texture2D(Texture0, tcGreen);\n"
+	"   vec4  center = sampleScene(tcGreen);\n"
 	"   \n"
 	"   // Do red scale and lookup.\n"
 	"   vec2  thetaRed = theta1 * (ChromAbParam.x + ChromAbParam.y * rSq);\n"
 	"   vec2  tcRed = LensCenter + Scale * thetaRed;\n"
-	"   float red = texture2D(Texture0, tcRed).r;\n"
+	"   float red = sampleScene(tcRed).r;\n"
 	"   \n"
 	"   gl_FragColor = vec4(red, center.g, blue, 1);\n"
 	"}\n";
@@ -207,95 +277,591 @@ static const GLubyte IndicesQuad[] = {
      2, 3, 0
 };
 
+RiftOnThePiApp::QuadProgram::QuadProgram()
+	: program(0),
+	  texmUniform(0),
+	  lensCenterUniform(0),
+	  screenCenterUniform(0),
+	  scaleUniform(0),
+	  scaleInUniform(0),
+	  hmdWarpParamUniform(0),
+	  chromAbParamUniform(0),
+	  texture0Uniform(0),
+	  texture1Uniform(0),
+	  centerTransformUniform(0),
+	  centerBoundsUniform(0),
+	  positionAttrib(0),
+	  inputTexCoordAttrib(0)
+{
+}
+
+RiftOnThePiApp::RenderTarget::RenderTarget()
+	: texture(0),
+	  frameBuffer(0),
+	  centerTexture(0),
+	  centerFrameBuffer(0)
+{
+}
+
+RiftOnThePiApp::TechniqueStats::TechniqueStats()
+	: drawTime(),
+	  swapTime(),
+	  frameTime(),
+	  eyesTime(),
+	  temperatureSum(0.0),
+	  temperatureCount(0),
+	  cpuFrequencySum(0.0),
+	  cpuFrequencyCount(0),
+	  latency()
+{
+}
+
 RiftOnThePiApp::RiftOnThePiApp()
 	: mCounter(0),
 	  mLastTime(0),
+	  mParameters(),
+	  mParameterFileWatcher(),
+	  mParametersRead(false),
+	  mConfigFile(),
 	  mStereoRenderTechnique(RenderTextureDistortionCorrection),
+	  mStereoRenderTechniqueParameter(RenderTextureDistortionCorrection),
+	  mSpecializedDraw(true),
+	  mDrawEyesFunction(&RiftOnThePiApp::drawEyes<DynamicTechnique>),
 	  mDistortionScaleEnabled(false),
 	  mAnimationEnabled(true),
 	  mUseRiftOrientation(false),
+	  mBatchedFusionEnabled(false),
+	  mSensorFusionBenchmark(0),
+	  mSensorFusionBenchmarkDone(false),
+	  mSinglePassStereo(false),
+	  mMonoFarField(false),
+	  mFarFieldSplitDepth(10.f),
+	  mEnvironmentBoxCount(0),
+	  mEnvironmentDistance(20.f),
+	  mMultiResolution(false),
+	  mMultiResolutionCenterFraction(0.5f),
+	  mMultiResolutionPeripheryDensity(0.5f),
+	  mDistortionScissorEnabled(true),
+	  mRenderTargetCount(1),
+	  mForceFinish(true),
+	  mGLCheckLevel(GLCheck::Off),
+	  mGLCheckFrameCount(0),
+	  mValidateDistortionFrame(0),
+	  mValidationMinPSNR(30.f),
+	  mValidationMaxError(32),
+	  mExitAfterChecks(false),
+	  mChecksFailed(false),
+	  mAllocationAuditFrame(0),
+	  mAllocationAuditFrameCount(300),
+	  mAllocationAuditExcused(false),
+	  mAllocationAuditFailedFrames(0),
+	  mAllocationAuditExcusedFrames(0),
+	  mBenchmarkFramesPerTechnique(0),
+	  mBenchmarkTechniques("0,1,2,3"),
+	  mBenchmarkWarmupFrames(10),
+	  mBenchmarkReportInterval(10),
+	  mBenchmarkDrawDispatch(false),
+	  mBenchmarkGenericDraw(false),
+	  mBenchmarkTechniqueList(),
+	  mBenchmarkFrame(0),
+	  mBenchmarkLastReportTime(0),
+	  mTelemetryInterval(1000),
+	  mTelemetrySysRoot("/sys"),
+	  mTelemetryProcRoot("/proc"),
+	  mFrameLog(),
+	  mTelemetrySampler(),
+	  mTelemetrySample(),
+	  mFrameLogFile(NULL),
+	  mRecordFile(),
+	  mRecordInterval(1),
+	  mRecordBufferCount(4),
+	  mRecordFrameRate(60),
+	  mFrameRecorder(),
+	  mRecordTimeSum(0),
+	  mRecordedFrames(0),
+	  mHudEnabled(false),
+	  mHud(),
+	  mLastFrameTicks(0),
+	  mTraceFile(),
+	  mTraceFrameCount(300),
+	  mTraceEventsPerThread(65536),
+	  mTraceEndFrame(-1),
+	  mLatencyTesterMode(NoLatencyTester),
+	  mSimulatedDisplayDelay(10.f),
+	  mSimulatedLatencyTestInterval(2000),
+	  mSimulatedHMD(false),
+	  mSoftwareGLThreadCount(0),
+	  mSoftwareGLTaskPool(NULL),
+	  mSensorDevice(),
+	  mSimulatedSensorDevice(false),
+	  mSimulatedSensorBurst(1),
+	  mHIDReportReader(),
+	  mSimulatedTrackerDevice(),
+	  mSensorAgeSum(0),
+	  mSensorAgeCount(0),
+	  mParallelStartup(true),
+	  mStartupProfile(),
+	  mDeviceStartupThread(),
+	  mDeviceStartupMutex(),
+	  mDeviceStartupCondition(),
+	  mDeviceStartupState(DeviceStartupNotStarted),
+	  mDeviceStartupDone(false),
+	  mStartupReported(false),
 	  mDeviceManager(),
 	  mHMD(),
 	  mSensor(),
 	  mSensorFusion(NULL),
+	  mBatchedSensorFusion(NULL),
+	  mSensorMessageHandler(NULL),
+	  mLatencyTester(),
+	  mLatencyUtil(),
+	  mSimulatedLatencyTester(),
+	  mHMDInfo(),
 	  mStereoConfig(),
 	  mScreenHResolution(0),
 	  mScreenVResolution(0),
+	  mRenderScale(1.f),
+	  mOutputFrameBuffer(0),
 	  mBoxAngleX(0.f),
 	  mBoxAngleY(0.f),
 	  mBoxAngleZ(0.f),
+	  mBoxModels(),
+	  mFarBoxCount(0),
+	  mHeadMatrix(),
 	  mShaderProgramBox(0),
 	  mVertexBufferBox(0),
 	  mIndexBufferBox(0),
-	  mShaderProgramQuad(0),
 	  mVertexBufferQuad(0),
 	  mIndexBufferQuad(0),
+	  mRenderTargets(),
+	  mRenderTargetIndex(0),
 	  mTexture(0),
 	  mTextureFrameBuffer(0),
+	  mTextureWidth(0),
+	  mTextureHeight(0),
+	  mCenterTexture(0),
+	  mCenterTextureFrameBuffer(0),
+	  mCenterTextureWidth(0),
+	  mCenterTextureHeight(0),
 
 	  mBoxProjectionUniform(0),
 	  mBoxModelViewUniform(0),
 	  mBoxPositionAttrib(0),
 	  mBoxColorAttrib(0),
-
-	  mQuadTexmUniform(0),
-	  mQuadLensCenterUniform(0),
-	  mQuadScreenCenterCenterUniform(0),
-	  mQuadScaleCenterUniform(0),
-	  mQuadScaleInCenterUniform(0),
-	  mQuadHmdWarpParamCenterUniform(0),
-	  mQuadChromAbParamUniform(0),
-	  mQuadTexture0Uniform(0),
-	  mQuadPositionAttrib(0),
-	  mQuadInputTexCoordAttrib(0)
+	  mShaderProgramStereoBox(0),
+	  mVertexBufferStereoBox(0),
+	  mIndexBufferStereoBox(0),
+	  mStereoBoxProjectionUniform(0),
+	  mStereoBoxModelViewUniform(0),
+	  mStereoBoxClipTransformUniform(0),
+	  mStereoBoxPositionAttrib(0),
+	  mStereoBoxColorAttrib(0),
+	  mStereoBoxEyeIndexAttrib(0),
+	  mCopyProgram(),
+	  mFarFieldTexture(0),
+	  mFarFieldFrameBuffer(0),
+	  mFarFieldWidth(0),
+	  mFarFieldHeight(0),
+	  mSpectatorInterval(0),
+	  mSpectatorWidth(640),
+	  mSpectatorFile(),
+	  mSpectatorTexture(0),
+	  mSpectatorFrameBuffer(0),
+	  mSpectatorHeight(0),
+	  mSpectatorRecorder(),
+	  mSpectatorTimeSum(0),
+	  mSpectatorReadbackTimeSum(0),
+	  mSpectatorViews(0),
+	  mSpectatorFrames(0),
+	  mMetricsSocket(),
+	  mMetricsServer(),
+	  mMetricsFrameTimes(),
+	  mMetricsDrawTimes(),
+	  mMetricsFrameCount(0),
+	  mMetricsDroppedFrameCount(0),
+	  mMetricsSensorSampleCount(0),
+	  mMetricsLastSensorSampleCount(0),
+	  mMetricsLastTime(0)
 {
 	mLastTime = OVR::Timer::GetTicksMs();
+	memset( mPhaseTimes, 0, sizeof(mPhaseTimes) );
+	memset( mEyeDistortionParams, 0, sizeof(mEyeDistortionParams) );
+	registerParameters();
 }
 
-bool RiftOnThePiApp::initialize( const ApplicationContext& context ) 
+RiftOnThePiApp::~RiftOnThePiApp()
 {
+	if ( mTraceEndFrame>=0 )
+		writeTrace();
+	mMetricsServer.stop();
+	mTelemetrySampler.stop();
+	mFrameRecorder.stop();
+	mSpectatorRecorder.stop();
+	closeFrameLog();
+	waitForDeviceStartup( DeviceStartupDone );
+	mDeviceStartupThread.Clear();
+	mSimulatedTrackerDevice.stop();		// Before the reader closes the other end of its pipe
+	mHIDReportReader.stop();
+	delete mSensorMessageHandler;		// Removes itself from the sensor
+	mSensorMessageHandler = NULL;
+	delete mSensorFusion;
+	mSensorFusion = NULL;
+	delete mBatchedSensorFusion;
+	mBatchedSensorFusion = NULL;
+	SoftwareGL::setTaskRunner( NULL, NULL );
+	delete mSoftwareGLTaskPool;
+	mSoftwareGLTaskPool = NULL;
+}
+
+EGLConfigRequest RiftOnThePiApp::getEGLConfigRequest( const ApplicationContext& context )
+{
+	// The window only receives the distortion pass, so the bandwidth-saving defaults 
+	// (RGB565, no alpha, no depth) are fine. Except when the scene is drawn 
+	// straight to the window (possibly only as one of the benchmarked techniques): 
+	// the box then needs a depth buffer
 	readParameters(context);
-	if ( !initOculus() )
-		return false;
+	EGLConfigRequest request;
+	if ( isTechniqueResident(NoCorrection) )
+	{
+		request.minDepthSize = 16;
+		request.preferredDepthSize = 16;
+	}
+
+	// The devices are looked for while the runner creates the EGL context
+	if ( mParallelStartup )
+		startDeviceStartup();
+	mStartupProfile.begin( StartupProfile::EGLSetupPhase );
+	return request;
+}
+
+bool RiftOnThePiApp::initialize( const ApplicationContext& context ) 
+{
+	mStartupProfile.end( StartupProfile::EGLSetupPhase );
+	if ( !mParametersRead )
+		readParameters(context);
+	printf("EGLConfig: %s\n", context.configInfo.toString().c_str() );
+	if ( context.outputWidth>0 && context.width!=context.outputWidth )
+		mRenderScale = static_cast<float>(context.width) / static_cast<float>(context.outputWidth);
+	mOutputFrameBuffer = context.frameBuffer;
+	printf("RenderScale: %f\n", mRenderScale );
+	OGLES_TRACE_THREAD_NAME("Render");
+	startTrace();
+	startTelemetry();
+	startMetricsServer();
+	openFrameLog();
+	mBenchmarkLastReportTime = OVR::Timer::GetTicksMs();
+	startDeviceStartup();
+
+	// The shaders and geometries don't depend on the HMD, unlike the rest
+	setupSoftwareGL();
+	mStartupProfile.begin( StartupProfile::ShaderCompilationPhase );
 	createShaderPrograms();
 	createGeometries();
+	createEnvironment();
+	mStartupProfile.end( StartupProfile::ShaderCompilationPhase );
+
+	mStartupProfile.begin( StartupProfile::HMDWaitPhase );
+	DeviceStartupState state = waitForDeviceStartup( DeviceStartupHMDInfoReady );
+	mStartupProfile.end( StartupProfile::HMDWaitPhase );
+	if ( state==DeviceStartupFailed )
+		return false;
+
+	mStartupProfile.begin( StartupProfile::ResourceCreationPhase );
+	applyHMDInfo();
+	configureStereo( mStereoConfig, mStereoRenderTechnique );
 	createTexture();
+	createFarFieldLayer();
+	createSpectator();
+	computeEyeScissors();
+	computeEyeDistortionParams();
+	if ( mHudEnabled )
+		mHud.create();
+	setupLatencyTester();
+	startRecording();
+	mStartupProfile.end( StartupProfile::ResourceCreationPhase );
+	mStartupProfile.begin( StartupProfile::FirstFramePhase );
 	return true;
 }
 
 
+void RiftOnThePiApp::registerParameters()
+{
+	const ParameterRegistry::DependencyMask rebuildAll = StereoConfigDependency | ShaderProgramsDependency | GeometriesDependency | TextureDependency;
+	mParameters.addString( "ConfigFile", &mConfigFile, ConfigFileDependency, "Parameter file, watched and reloaded when saved" );
+	mParameters.addInt( "StereoRenderTechnique", &mStereoRenderTechniqueParameter, rebuildAll, "0 to 3, see StereoRenderTechnique" );
+	mParameters.addBool( "DistortionScaleEnabled", &mDistortionScaleEnabled, StereoConfigDependency | TextureDependency, "Enlarge the render texture to use the whole Rift FOV" );
+	mParameters.addBool( "SpecializedDraw", &mSpecializedDraw, DrawDispatchDependency, "Draw with the passes compiled for the current technique only, 0 to compare with the generic ones" );
+	mParameters.addBool( "AnimationEnabled", &mAnimationEnabled, 0, "Rotate the box" );
+	mParameters.addBool( "UseRiftOrientation", &mUseRiftOrientation, 0, "Apply the Rift sensor orientation to the view" );
+	mParameters.addBool( "BatchedSensorFusion", &mBatchedFusionEnabled, 0, "Integrate the sensor samples once per frame on the render thread (at startup)" );
+	mParameters.addInt( "SensorFusionBenchmark", &mSensorFusionBenchmark, 0, "Synthetic sensor samples run through both fusions once started, 0 to skip" );
+	mParameters.addBool( "SinglePassStereo", &mSinglePassStereo, ShaderProgramsDependency | GeometriesDependency, "Draw the scene of both eyes in a single pass" );
+	mParameters.addBool( "MonoFarField", &mMonoFarField, ShaderProgramsDependency | GeometriesDependency | TextureDependency, "Draw the boxes beyond FarFieldSplitDepth once for both eyes" );
+	mParameters.addFloat( "FarFieldSplitDepth", &mFarFieldSplitDepth, GeometriesDependency, "Distance in meters beyond which boxes are in the far field" );
+	mParameters.addInt( "EnvironmentBoxCount", &mEnvironmentBoxCount, GeometriesDependency, "Number of boxes in a ring around the viewer" );
+	mParameters.addFloat( "EnvironmentDistance", &mEnvironmentDistance, GeometriesDependency, "Radius of the ring of boxes in meters" );
+	mParameters.addBool( "MultiResolution", &mMultiResolution, ShaderProgramsDependency | TextureDependency, "Render the periphery of the eyes at a lower density than the lens center" );
+	mParameters.addFloat( "MultiResolutionCenterFraction", &mMultiResolutionCenterFraction, TextureDependency, "Size of the full density region (0 to 1 of the eye)" );
+	mParameters.addFloat( "MultiResolutionPeripheryDensity", &mMultiResolutionPeripheryDensity, TextureDependency, "Density of the periphery (0 to 1)" );
+	mParameters.addBool( "DistortionScissorEnabled", &mDistortionScissorEnabled, ScissorDependency, "Only clear and render the part of the render texture the distortion reads" );
+	mParameters.addInt( "RenderTargetCount", &mRenderTargetCount, TextureDependency, "Number of render textures the frames are drawn into in turn" );
+	mParameters.addBool( "ForceFinish", &mForceFinish, 0, "Wait for the GPU to be done at the end of each pass (glFinish)" );
+	mParameters.addInt( "GLCheckLevel", &mGLCheckLevel, GLCheckDependency, "GL error checks: 0 off, 1 after each pass, 2 after each call" );
+	mParameters.addInt( "ValidateDistortion", &mValidateDistortionFrame, 0, "Index of the frame to compare against the CPU reference distortion" );
+	mParameters.addFloat( "ValidationMinPSNR", &mValidationMinPSNR, 0, "Distortion validation threshold in dB" );
+	mParameters.addInt( "ValidationMaxError", &mValidationMaxError, 0, "Distortion validation threshold on the error of the 99.9th percentile pixel (0 to 255)" );
+	mParameters.addBool( "ExitAfterChecks", &mExitAfterChecks, 0, "Exit once the distortion validation and the allocation audit are done, with a non-zero status if one failed" );
+	mParameters.addInt( "AllocationAuditFrame", &mAllocationAuditFrame, 0, "First frame whose heap allocations are counted, 0 to disable" );
+	mParameters.addInt( "AllocationAuditFrameCount", &mAllocationAuditFrameCount, 0, "Number of frames whose heap allocations are counted" );
+	mParameters.addInt( "BenchmarkFramesPerTechnique", &mBenchmarkFramesPerTechnique, rebuildAll | BenchmarkDependency, "When not 0, alternate the benchmarked techniques every that many frames" );
+	mParameters.addString( "BenchmarkTechniques", &mBenchmarkTechniques, rebuildAll | BenchmarkDependency, "Comma separated list of the techniques to benchmark" );
+	mParameters.addInt( "BenchmarkWarmupFrames", &mBenchmarkWarmupFrames, BenchmarkDependency, "Frames not measured after each technique switch" );
+	mParameters.addInt( "BenchmarkReportInterval", &mBenchmarkReportInterval, 0, "Seconds between two benchmark reports" );
+	mParameters.addBool( "BenchmarkDrawDispatch", &mBenchmarkDrawDispatch, BenchmarkDependency, "Alternate the generic and specialized draw of each benchmarked technique, and report what the specialization saves" );
+	mParameters.addInt( "TelemetryInterval", &mTelemetryInterval, TelemetryDependency, "Milliseconds between two temperature/clock/CPU samples, 0 to disable" );
+	mParameters.addString( "TelemetrySysRoot", &mTelemetrySysRoot, TelemetryDependency, "Where the telemetry sampler finds sysfs" );
+	mParameters.addString( "TelemetryProcRoot", &mTelemetryProcRoot, TelemetryDependency, "Where the telemetry sampler finds procfs" );
+	mParameters.addString( "FrameLog", &mFrameLog, FrameLogDependency, "CSV file receiving the times and telemetry of every frame" );
+	mParameters.addString( "RecordFile", &mRecordFile, RecordDependency, "Y4M (.y4m) or raw RGB24 file receiving the distorted frames" );
+	mParameters.addInt( "RecordInterval", &mRecordInterval, RecordDependency, "Record every that many frames" );
+	mParameters.addInt( "RecordBufferCount", &mRecordBufferCount, RecordDependency, "Frames waiting to be written before the next ones are dropped" );
+	mParameters.addInt( "RecordFrameRate", &mRecordFrameRate, RecordDependency, "Frame rate of the rendering, for the Y4M header" );
+	mParameters.addInt( "SpectatorInterval", &mSpectatorInterval, ShaderProgramsDependency | SpectatorDependency, "Draw the spectator view every that many frames, 0 for none" );
+	mParameters.addInt( "SpectatorWidth", &mSpectatorWidth, SpectatorDependency, "Width of the spectator view in pixels" );
+	mParameters.addString( "SpectatorFile", &mSpectatorFile, SpectatorDependency, "Y4M (.y4m) or raw RGB24 file receiving the spectator view" );
+	mParameters.addString( "MetricsSocket", &mMetricsSocket, MetricsDependency, "Unix domain socket serving the metrics in the Prometheus text format, empty for none" );
+	mParameters.addBool( "HudEnabled", &mHudEnabled, HudDependency, "Show the frame rate and frame times in the headset" );
+	mParameters.addString( "TraceFile", &mTraceFile, TraceDependency, "Chrome trace-event JSON file (needs a build with ENABLE_TRACE)" );
+	mParameters.addInt( "TraceFrameCount", &mTraceFrameCount, 0, "Number of frames to trace before writing TraceFile" );
+	mParameters.addInt( "TraceEventsPerThread", &mTraceEventsPerThread, 0, "Capacity of the trace buffer of each thread" );
+	mParameters.addInt( "LatencyTester", &mLatencyTesterMode, LatencyTesterDependency, "0 none, 1 Oculus latency tester, 2 simulated latency tester" );
+	mParameters.addFloat( "SimulatedDisplayDelay", &mSimulatedDisplayDelay, LatencyTesterDependency, "Milliseconds between the swap and the simulated tester seeing the patch" );
+	mParameters.addInt( "SimulatedLatencyTestInterval", &mSimulatedLatencyTestInterval, LatencyTesterDependency, "Milliseconds between two simulated latency tests" );
+	mParameters.addBool( "SimulatedHMD", &mSimulatedHMD, 0, "Go on without a Rift, with the DK1 defaults and no head tracking (at startup)" );
+	mParameters.addInt( "SoftwareGLThreadCount", &mSoftwareGLThreadCount, 0, "Threads of the software GL rasterizer, 0 for one per core (at startup)" );
+	mParameters.addBool( "ParallelStartup", &mParallelStartup, 0, "Look for the Rift and start its sensor while the GL is set up (at startup)" );
+	mParameters.addString( "SensorDevice", &mSensorDevice, 0, "hidraw device of the Rift tracker to read the reports from, for example /dev/hidraw0 (at startup)" );
+	mParameters.addBool( "SimulatedSensorDevice", &mSimulatedSensorDevice, 0, "Read canned tracker reports from a pipe instead of the sensor (at startup)" );
+	mParameters.addInt( "SimulatedSensorBurst", &mSimulatedSensorBurst, 0, "Reports the simulated sensor device writes at once, every that many ms (at startup)" );
+}
+
 void RiftOnThePiApp::readParameters( const ApplicationContext& context )
 {
 	printf("readParameters\n");
+	mStartupProfile.begin( StartupProfile::ParametersPhase );
+
+	mParameters.setFromParameters( context.parameters );
+	mParameters.applyPendingChanges();
+
+	// The values of the parameter file take precedence over the command line ones
+	if ( !mConfigFile.empty() )
+	{
+		mParameters.loadFromFile( mConfigFile );
+		mParameters.applyPendingChanges();
+		mParameterFileWatcher.watch( mConfigFile );
+	}
+	applyParameterChanges( 0 );
+	mParametersRead = true;
+	mStartupProfile.end( StartupProfile::ParametersPhase );
+}
+
+void RiftOnThePiApp::updateParameters()
+{
+	// Parameters only change here, between two frames
+	if ( mParameterFileWatcher.hasChanged() )
+	{
+		printf("Reloading %s\n", mConfigFile.c_str() );
+		mParameters.loadFromFile( mConfigFile );
+	}
+	ParameterRegistry::DependencyMask changes = mParameters.applyPendingChanges();
+	if ( changes!=0 )
+		applyParameterChanges( changes );
+}
+
+void RiftOnThePiApp::applyParameterChanges( ParameterRegistry::DependencyMask changes )
+{
+	mAllocationAuditExcused = true;
+	if ( mStereoRenderTechniqueParameter<NoCorrection || mStereoRenderTechniqueParameter>RenderTextureDistortionAndChromaCorrection )
+	{
+		printf("StereoRenderTechnique %d is not supported\n", mStereoRenderTechniqueParameter );
+		mStereoRenderTechniqueParameter = mStereoRenderTechnique;
+	}
+	if ( mStereoRenderTechnique!=mStereoRenderTechniqueParameter && mScreenHResolution!=0 && mStereoRenderTechniqueParameter==NoCorrection )
+		printf("Warning: the window was created without a depth buffer, restart to get one with StereoRenderTechnique 0\n");
+	mStereoRenderTechnique = static_cast<StereoRenderTechnique>(mStereoRenderTechniqueParameter);
+	parseBenchmarkTechniques();
+	if ( isBenchmarking() && mBenchmarkWarmupFrames>=mBenchmarkFramesPerTechnique )
+	{
+		printf("BenchmarkWarmupFrames must be smaller than BenchmarkFramesPerTechnique\n");
+		mBenchmarkWarmupFrames = mBenchmarkFramesPerTechnique - 1;
+	}
+	mParameters.print();
+
+	// The first call (from readParameters) comes with no changes, the constructor's choice is the generic draw
+	if ( !mParametersRead || (changes & (StereoConfigDependency | BenchmarkDependency | DrawDispatchDependency)) )
+	{
+		mBenchmarkGenericDraw = false;
+		selectDrawEyesFunction();
+	}
+
+	// The parameter file names another one: watch it instead, its values come with the next update
+	if ( changes & ConfigFileDependency )
+	{
+		mParameterFileWatcher.watch( mConfigFile );
+		if ( !mConfigFile.empty() )
+			mParameters.loadFromFile( mConfigFile );
+	}
+
+	if ( changes & GLCheckDependency )
+	{
+		if ( mGLCheckLevel<GLCheck::Off || mGLCheckLevel>=GLCheck::LevelCount )
+		{
+			printf("GLCheckLevel %d is not supported\n", mGLCheckLevel );
+			mGLCheckLevel = GLCheck::getLevel();
+		}
+		if ( mGLCheckLevel!=GLCheck::Off && !GLCheck::isCompiledIn() )
+			printf("GLCheckLevel: the GL checks aren't compiled in (ENABLE_GL_CHECK CMake option)\n");
+		GLCheck::setLevel( static_cast<GLCheck::Level>(mGLCheckLevel) );
+		GLCheck::resetStats();
+		mGLCheckFrameCount = 0;
+	}
+
+	if ( changes & BenchmarkDependency )
+	{
+		for ( int i=0; i<StereoRenderTechniqueCount; ++i )
+		{
+			mBenchmarkStats[i] = TechniqueStats();
+			mBenchmarkGenericStats[i] = TechniqueStats();
+		}
+		mBenchmarkFrame = 0;
+		mBenchmarkLastReportTime = OVR::Timer::GetTicksMs();
+	}
+
+	// Nothing to rebuild before initialization
+	if ( mScreenHResolution==0 )
+		return;
 
-	for ( std::size_t i=1; i<context.parameters.size(); ++i )
-	{
-		const std::string& name = context.parameters[i].first;
-		const std::string& value = context.parameters[i].second;
-		int intValue = atoi( value.c_str() );
-		if ( name=="--StereoRenderTechnique" )
-			mStereoRenderTechnique = static_cast<StereoRenderTechnique>(intValue);
-		else if ( name=="--DistortionScaleEnabled" )
-			mDistortionScaleEnabled = intValue!=0;
-		else if ( name=="--AnimationEnabled" )
-			mAnimationEnabled = intValue!=0;
-		else if ( name=="--UseRiftOrientation" )
-			mUseRiftOrientation = intValue!=0;
+	if ( changes & TelemetryDependency )
+		startTelemetry();
+	if ( changes & MetricsDependency )
+		startMetricsServer();
+	if ( changes & FrameLogDependency )
+		openFrameLog();
+	if ( changes & TraceDependency )
+		startTrace();
+	if ( changes & RecordDependency )
+		startRecording();
+	if ( changes & LatencyTesterDependency )
+		setupLatencyTester();
+	if ( changes & HudDependency )
+	{
+		if ( mHudEnabled )
+			mHud.create();
 		else
-			printf("Parameter %s is not supported\n", name.c_str() );
+			mHud.destroy();
+	}
+
+	if ( changes & StereoConfigDependency )
+		configureStereo( mStereoConfig, mStereoRenderTechnique );
+	if ( changes & ShaderProgramsDependency )
+	{
+		destroyQuadShaderPrograms();
+		createShaderPrograms();
+	}
+	if ( changes & GeometriesDependency )
+	{
+		destroyQuadGeometry();
+		createGeometries();
+		createEnvironment();
+	}
+	if ( changes & TextureDependency )
+	{
+		destroyTexture();
+		createTexture();
+		destroyFarFieldLayer();
+		createFarFieldLayer();
+	}
+	if ( changes & (TextureDependency | SpectatorDependency | RecordDependency) )
+	{
+		destroySpectator();
+		createSpectator();
+	}
+	if ( changes & (StereoConfigDependency | TextureDependency | ScissorDependency) )
+		computeEyeScissors();
+	if ( changes & StereoConfigDependency )
+		computeEyeDistortionParams();
+}
+
+void RiftOnThePiApp::startDeviceStartup()
+{
+	if ( mDeviceStartupState!=DeviceStartupNotStarted )
+		return;
+
+	// On this thread, before LibOVR allocates anything for the startup thread
+	OVR::System::Init( OVR::Log::ConfigureDefaultLog(OVR::LogMask_All), AllocationAudit::getOVRAllocator() );
+	mDeviceStartupState = DeviceStartupRunning;
+	if ( mParallelStartup )
+	{
+		mDeviceStartupThread = *new OVR::Thread( deviceStartupFunction, this );
+		if ( mDeviceStartupThread->Start() )
+			return;
+		printf("Failed to start the device startup thread\n");
+		mDeviceStartupThread.Clear();
 	}
-	printf("StereoRenderTechnique: %d\n", mStereoRenderTechnique );
-	printf("DistortionScaleEnabled: %d\n", mDistortionScaleEnabled );
-	printf("AnimationEnabled: %d\n", mAnimationEnabled );
-	printf("UseRiftOrientation: %d\n", mUseRiftOrientation );
+	initOculus();
+}
+
+int RiftOnThePiApp::deviceStartupFunction( OVR::Thread* /*thread*/, void* userData )
+{
+	OGLES_TRACE_THREAD_NAME("Device startup");
+	RiftOnThePiApp* app = static_cast<RiftOnThePiApp*>(userData);
+	app->initOculus();
+	return 0;
+}
+
+void RiftOnThePiApp::setDeviceStartupState( DeviceStartupState state )
+{
+	OVR::Mutex::Locker locker( &mDeviceStartupMutex );
+	mDeviceStartupState = state;
+	mDeviceStartupCondition.NotifyAll();
+}
+
+RiftOnThePiApp::DeviceStartupState RiftOnThePiApp::waitForDeviceStartup( DeviceStartupState state )
+{
+	OVR::Mutex::Locker locker( &mDeviceStartupMutex );
+	while ( mDeviceStartupState!=DeviceStartupNotStarted && mDeviceStartupState<state )
+		mDeviceStartupCondition.Wait( &mDeviceStartupMutex );
+	return mDeviceStartupState;
+}
+
+bool RiftOnThePiApp::isDeviceStartupDone() const
+{
+	OVR::Mutex::Locker locker( &mDeviceStartupMutex );
+	return mDeviceStartupState>=DeviceStartupDone;
 }
 
 bool RiftOnThePiApp::initOculus()
 {
+	// On the device startup thread unless ParallelStartup is off. The render thread may use the 
+	// HMD info once the state says so, and the sensor members once the startup is done
 	printf("initOculus\n");
+	mStartupProfile.begin( StartupProfile::DeviceEnumerationPhase );
+	bool hmdOpened = openHMD();
+	mStartupProfile.end( StartupProfile::DeviceEnumerationPhase );
+	setDeviceStartupState( hmdOpened ? DeviceStartupHMDInfoReady : DeviceStartupFailed );
+	if ( !hmdOpened )
+		return false;
 
-	OVR::System::Init( OVR::Log::ConfigureDefaultLog(OVR::LogMask_All));
+	mStartupProfile.begin( StartupProfile::SensorStartupPhase );
+	if ( !openSensor() )
+		printf("No head tracking\n");
+	mStartupProfile.end( StartupProfile::SensorStartupPhase );
+	setDeviceStartupState( DeviceStartupDone );
+	return true;
+}
 
+bool RiftOnThePiApp::openHMD()
+{
 	mDeviceManager = *OVR::DeviceManager::Create();
 	if ( !mDeviceManager )
 	{
@@ -303,25 +869,60 @@ bool RiftOnThePiApp::initOculus()
 		return false;
 	}
 	mHMD = *mDeviceManager->EnumerateDevices<OVR::HMDDevice>().CreateDevice();
+	if ( !mHMD && mSimulatedHMD )
+	{
+		// The StereoConfig comes with the DK1 characteristics
+		printf("No Rift found, simulating one\n");
+		mHMDInfo = mStereoConfig.GetHMDInfo();
+		return true;
+	}
 	if ( !mHMD )
 	{
 		printf("Failed to create Device\n");
 		return false;
 	}
-	
-	mSensor = *mHMD->GetSensor();
-	if ( !mSensor )
+	if (!mHMD->GetDeviceInfo(&mHMDInfo))
 	{
-		printf("Failed to get sensor\n");
+		printf("Failed to get the HMD info\n");
 		return false;
 	}
+	return true;
+}
 
-	mSensorFusion = new OVR::SensorFusion(mSensor);
-	
-	
-	OVR::HMDInfo hmd;
-	if (!mHMD->GetDeviceInfo(&hmd))
-		return false;
+bool RiftOnThePiApp::openSensor()
+{
+	if ( mHMD )
+	{
+		mSensor = *mHMD->GetSensor();
+		if ( !mSensor )
+		{
+			printf("Failed to get sensor\n");
+			return false;
+		}
+
+		// The fusion gets the sensor messages through our handler rather than attaching to the sensor itself.
+		// When we read the reports ourselves (see startHIDReportReader), LibOVR's sensor is only kept for its keep-alives
+		bool readReports = !mSensorDevice.empty() || mSimulatedSensorDevice;
+		if ( !readReports && mBatchedFusionEnabled )
+		{
+			mBatchedSensorFusion = new BatchedSensorFusion();
+			mSensorMessageHandler = new SensorMessageHandler(mBatchedSensorFusion);
+		}
+		else if ( !readReports )
+		{
+			mSensorFusion = new OVR::SensorFusion();
+			mSensorMessageHandler = new SensorMessageHandler(mSensorFusion);
+		}
+		if ( mSensorMessageHandler )
+			mSensor->SetMessageHandler(mSensorMessageHandler);
+	}
+	startHIDReportReader();
+	return true;
+}
+
+void RiftOnThePiApp::applyHMDInfo()
+{
+	const OVR::HMDInfo& hmd = mHMDInfo;
 
 	printf("HResolution: %d\n", hmd.HResolution );
 	printf("VResolution: %d\n", hmd.VResolution );
@@ -332,20 +933,74 @@ bool RiftOnThePiApp::initOculus()
 	printf("LensSeparationDistance: %f\n", hmd.LensSeparationDistance );
 	printf("InterpupillaryDistance: %f\n", hmd.InterpupillaryDistance );
 	
-	// Remember screen resolution
-	mScreenHResolution = hmd.HResolution;
-	mScreenVResolution = hmd.VResolution;
+	// Remember screen resolution, that is the size of the part of the render surface covering the HMD screen.
+	// The distortion math works in normalized coordinates so it's not affected by the render scale
+	mScreenHResolution = static_cast<unsigned int>( hmd.HResolution * mRenderScale + 0.5f );
+	mScreenVResolution = static_cast<unsigned int>( hmd.VResolution * mRenderScale + 0.5f );
 	
 	// Prepare StereoConfig object
 	mStereoConfig.SetHMDInfo(hmd);
-	mStereoConfig.SetFullViewport( OVR::Util::Render::Viewport(0,0, hmd.HResolution, hmd.VResolution) );
+	mStereoConfig.SetFullViewport( OVR::Util::Render::Viewport(0,0, mScreenHResolution, mScreenVResolution) );
 	mStereoConfig.SetStereoMode( OVR::Util::Render::Stereo_LeftRight_Multipass);
+}
 
-	if ( mStereoRenderTechnique==NoCorrection )
+// The C++ implementations of the shaders, registered against their sources with the software GL
+static BoxVertexShader gBoxVertexShader;
+static BoxFragmentShader gBoxFragmentShader;
+static StereoBoxVertexShader gStereoBoxVertexShader;
+static StereoBoxFragmentShader gStereoBoxFragmentShader;
+static QuadVertexShader gQuadVertexShader;
+static QuadFragmentShader gQuadFragmentShaders[2][3] = 
+{
+	{ 
+		QuadFragmentShader(DistortionReference::Copy, false), 
+		QuadFragmentShader(DistortionReference::Distortion, false), 
+		QuadFragmentShader(DistortionReference::DistortionAndChroma, false) 
+	},
+	{ 
+		QuadFragmentShader(DistortionReference::Copy, true), 
+		QuadFragmentShader(DistortionReference::Distortion, true), 
+		QuadFragmentShader(DistortionReference::DistortionAndChroma, true) 
+	}
+};
+
+static void runSoftwareGLTasks( SoftwareGL::TaskFunction function, void* userData, int taskCount, void* runnerData )
+{
+	static_cast<TaskPool*>(runnerData)->run( function, userData, taskCount );
+}
+
+void RiftOnThePiApp::setupSoftwareGL()
+{
+	if ( !SoftwareGL::isCompiledIn() )
+		return;
+
+	// The HUD shaders have no software implementation, so the HUD can't be used with the software GL
+	SoftwareGL::addShader( VertexShaderStringBox, &gBoxVertexShader );
+	SoftwareGL::addShader( FragmentShaderStringBox, &gBoxFragmentShader );
+	SoftwareGL::addShader( VertexShaderStringStereoBox, &gStereoBoxVertexShader );
+	SoftwareGL::addShader( FragmentShaderStringStereoBox, &gStereoBoxFragmentShader );
+	SoftwareGL::addShader( VertexShaderStringQuad, &gQuadVertexShader );
+	const char* samplingStrings[2] = { SceneSamplingString, MultiResolutionSceneSamplingString };
+	const char* fragmentShaderBodies[3] = { FragmentShader0StringQuad, FragmentShader1StringQuad, FragmentShader2StringQuad };
+	for ( int i=0; i<2; ++i )
+		for ( int j=0; j<3; ++j )
+			SoftwareGL::addShader( std::string(samplingStrings[i]) + fragmentShaderBodies[j], &gQuadFragmentShaders[i][j] );
+
+	// Created here rather than in the constructor: the pool's threads need LibOVR to be initialized
+	if ( !mSoftwareGLTaskPool )
+		mSoftwareGLTaskPool = new TaskPool( mSoftwareGLThreadCount );
+	SoftwareGL::setTaskRunner( runSoftwareGLTasks, mSoftwareGLTaskPool );
+	printf("SoftwareGL: %d rasterizer threads\n", mSoftwareGLTaskPool->getThreadCount() );
+}
+
+void RiftOnThePiApp::configureStereo( OVR::Util::Render::StereoConfig& stereoConfig, StereoRenderTechnique technique ) const
+{
+	const OVR::HMDInfo& hmd = mHMDInfo;
+	if ( technique==NoCorrection )
 	{
 		// No distortion correction, so no scaling
 		// Important to do even if we don't correct, because it affects the FOV used to render the scene
-		mStereoConfig.SetDistortionFitPointVP(0.f, 0.f);	
+		stereoConfig.SetDistortionFitPointVP(0.f, 0.f);	
 	}
 	else
 	{
@@ -358,25 +1013,26 @@ bool RiftOnThePiApp::initOculus()
 			if (hmd.HScreenSize > 0.0f)
 			{
 				if (hmd.HScreenSize > 0.140f) // 7"
-					mStereoConfig.SetDistortionFitPointVP(-1.0f, 0.0f);
+					stereoConfig.SetDistortionFitPointVP(-1.0f, 0.0f);
 				else
-					mStereoConfig.SetDistortionFitPointVP(0.0f, 1.0f);
+					stereoConfig.SetDistortionFitPointVP(0.0f, 1.0f);
 			}
 		}
 		else
 		{
-			mStereoConfig.SetDistortionFitPointVP(0.f, 0.f);	
+			stereoConfig.SetDistortionFitPointVP(0.f, 0.f);	
 		}
 	}
-	printf("DistortionScale: %f\n", mStereoConfig.GetDistortionScale() );    
-	mStereoConfig.Set2DAreaFov(OVR::DegreeToRad(85.0f));		// This is the default value in mStereoConfig 
-
-	return true;
+	printf("DistortionScale: %f\n", stereoConfig.GetDistortionScale() );    
+	stereoConfig.Set2DAreaFov(OVR::DegreeToRad(85.0f));		// This is the default value in mStereoConfig 
 }
 
 void RiftOnThePiApp::createShaderPrograms()
 {
 	printf("createShaderPrograms\n");
+	
+	// The box program doesn't depend on any parameter, it's only created once
+	if ( mShaderProgramBox==0 )
 	{
 		GLuint vertexShader = Common::createAndCompileShader( GL_VERTEX_SHADER, VertexShaderStringBox );
 		if ( vertexShader==0 )
@@ -397,46 +1053,115 @@ void RiftOnThePiApp::createShaderPrograms()
 		mBoxColorAttrib = glGetAttribLocation(mShaderProgramBox, "SourceColor");
 	}
 
-	if ( mStereoRenderTechnique!=NoCorrection )
+	// Same for the stereo box, once needed
+	if ( mSinglePassStereo && mShaderProgramStereoBox==0 )
 	{
-		GLuint vertexShader = Common::createAndCompileShader( GL_VERTEX_SHADER, VertexShaderStringQuad );
+		GLuint vertexShader = Common::createAndCompileShader( GL_VERTEX_SHADER, VertexShaderStringStereoBox );
 		if ( vertexShader==0 )
 			return;
-
-		GLuint fragmentShader = 0;
-		if ( mStereoRenderTechnique==RenderTextureNoDistortionCorrection)
-			fragmentShader = Common::createAndCompileShader( GL_FRAGMENT_SHADER, FragmentShader0StringQuad );
-		else if ( mStereoRenderTechnique==RenderTextureDistortionCorrection )
-			fragmentShader = Common::createAndCompileShader( GL_FRAGMENT_SHADER, FragmentShader1StringQuad );
-		else if ( mStereoRenderTechnique==RenderTextureDistortionAndChromaCorrection )
-			fragmentShader = Common::createAndCompileShader( GL_FRAGMENT_SHADER, FragmentShader2StringQuad );
-		
+		GLuint fragmentShader = Common::createAndCompileShader( GL_FRAGMENT_SHADER, FragmentShaderStringStereoBox );
 		if ( fragmentShader==0 )
 			return;
-
 		GLuint programObject = Common::createAndLinkProgram( vertexShader, fragmentShader );
 		if ( programObject==0 )
 			return;
 	
 		// Store
-		mShaderProgramQuad = programObject;
+		mShaderProgramStereoBox = programObject;
+
+		mStereoBoxProjectionUniform = glGetUniformLocation(mShaderProgramStereoBox, "Projection");
+		mStereoBoxModelViewUniform = glGetUniformLocation(mShaderProgramStereoBox, "ModelView");
+		mStereoBoxClipTransformUniform = glGetUniformLocation(mShaderProgramStereoBox, "ClipTransform");
+		mStereoBoxPositionAttrib = glGetAttribLocation(mShaderProgramStereoBox, "Position");
+		mStereoBoxColorAttrib = glGetAttribLocation(mShaderProgramStereoBox, "SourceColor");
+		mStereoBoxEyeIndexAttrib = glGetAttribLocation(mShaderProgramStereoBox, "EyeIndex");
+	}
+
+	// The far field layer is copied into each eye and the left eye into the spectator view by a plain textured quad
+	if ( (mMonoFarField || mSpectatorInterval>0) && mCopyProgram.program==0 )
+	{
+		GLuint vertexShader = Common::createAndCompileShader( GL_VERTEX_SHADER, VertexShaderStringQuad );
+		if ( vertexShader==0 )
+			return;
+		std::string fragmentShaderString = std::string(SceneSamplingString) + FragmentShader0StringQuad;
+		GLuint fragmentShader = Common::createAndCompileShader( GL_FRAGMENT_SHADER, fragmentShaderString.c_str() );
+		if ( fragmentShader==0 )
+			return;
+		GLuint programObject = Common::createAndLinkProgram( vertexShader, fragmentShader );
+		glDeleteShader( vertexShader );
+		glDeleteShader( fragmentShader );
+		if ( programObject==0 )
+			return;
+
+		// Store
+		mCopyProgram.program = programObject;
+		mCopyProgram.texmUniform = glGetUniformLocation(programObject, "Texm");
+		mCopyProgram.texture0Uniform = glGetUniformLocation(programObject, "Texture0");
+		mCopyProgram.positionAttrib = glGetAttribLocation(programObject, "Position");
+		mCopyProgram.inputTexCoordAttrib = glGetAttribLocation(programObject, "InputTexCoord");
+	}
 
-		mQuadTexmUniform = glGetUniformLocation(mShaderProgramQuad, "Texm");
-		mQuadLensCenterUniform = glGetUniformLocation(mShaderProgramQuad, "LensCenter");
-		mQuadScreenCenterCenterUniform = glGetUniformLocation(mShaderProgramQuad, "ScreenCenter");
-		mQuadScaleCenterUniform = glGetUniformLocation(mShaderProgramQuad, "Scale");
-		mQuadScaleInCenterUniform = glGetUniformLocation(mShaderProgramQuad, "ScaleIn");
-		mQuadHmdWarpParamCenterUniform = glGetUniformLocation(mShaderProgramQuad, "HmdWarpParam");
-		mQuadChromAbParamUniform = glGetUniformLocation(mShaderProgramQuad, "ChromAbParam");
-		mQuadTexture0Uniform = glGetUniformLocation(mShaderProgramQuad, "Texture0");
-		mQuadPositionAttrib = glGetAttribLocation(mShaderProgramQuad, "Position");
-		mQuadInputTexCoordAttrib = glGetAttribLocation(mShaderProgramQuad, "InputTexCoord");
+	// One quad program per resident technique. Those already there are kept
+	for ( int i=RenderTextureNoDistortionCorrection; i<StereoRenderTechniqueCount; ++i )
+	{
+		StereoRenderTechnique technique = static_cast<StereoRenderTechnique>(i);
+		if ( isTechniqueResident(technique) && mQuadPrograms[technique].program==0 )
+			createQuadShaderProgram( technique );
 	}
 }
 
+void RiftOnThePiApp::createQuadShaderProgram( StereoRenderTechnique technique )
+{
+	GLuint vertexShader = Common::createAndCompileShader( GL_VERTEX_SHADER, VertexShaderStringQuad );
+	if ( vertexShader==0 )
+		return;
+
+	const char* fragmentShaderBody = NULL;
+	if ( technique==RenderTextureNoDistortionCorrection)
+		fragmentShaderBody = FragmentShader0StringQuad;
+	else if ( technique==RenderTextureDistortionCorrection )
+		fragmentShaderBody = FragmentShader1StringQuad;
+	else if ( technique==RenderTextureDistortionAndChromaCorrection )
+		fragmentShaderBody = FragmentShader2StringQuad;
+	if ( !fragmentShaderBody )
+		return;
+
+	std::string fragmentShaderString = std::string(mMultiResolution ? MultiResolutionSceneSamplingString : SceneSamplingString) + fragmentShaderBody;
+	GLuint fragmentShader = Common::createAndCompileShader( GL_FRAGMENT_SHADER, fragmentShaderString.c_str() );
+	if ( fragmentShader==0 )
+		return;
+
+	GLuint programObject = Common::createAndLinkProgram( vertexShader, fragmentShader );
+	
+	// The shaders are only flagged for deletion, they go away with the program
+	glDeleteShader( vertexShader );
+	glDeleteShader( fragmentShader );
+	if ( programObject==0 )
+		return;
+
+	// Store
+	QuadProgram& quadProgram = mQuadPrograms[technique];
+	quadProgram.program = programObject;
+
+	quadProgram.texmUniform = glGetUniformLocation(programObject, "Texm");
+	quadProgram.lensCenterUniform = glGetUniformLocation(programObject, "LensCenter");
+	quadProgram.screenCenterUniform = glGetUniformLocation(programObject, "ScreenCenter");
+	quadProgram.scaleUniform = glGetUniformLocation(programObject, "Scale");
+	quadProgram.scaleInUniform = glGetUniformLocation(programObject, "ScaleIn");
+	quadProgram.hmdWarpParamUniform = glGetUniformLocation(programObject, "HmdWarpParam");
+	quadProgram.chromAbParamUniform = glGetUniformLocation(programObject, "ChromAbParam");
+	quadProgram.texture0Uniform = glGetUniformLocation(programObject, "Texture0");
+	quadProgram.texture1Uniform = glGetUniformLocation(programObject, "Texture1");
+	quadProgram.centerTransformUniform = glGetUniformLocation(programObject, "CenterTransform");
+	quadProgram.centerBoundsUniform = glGetUniformLocation(programObject, "CenterBounds");
+	quadProgram.positionAttrib = glGetAttribLocation(programObject, "Position");
+	quadProgram.inputTexCoordAttrib = glGetAttribLocation(programObject, "InputTexCoord");
+}
+
 void RiftOnThePiApp::createGeometries()
 {
 	printf("createGeometries\n");
+	if ( mVertexBufferBox==0 )
 	{
 		GLuint vertexBuffer;
 		glGenBuffers(1, &vertexBuffer);
@@ -459,7 +1184,48 @@ void RiftOnThePiApp::createGeometries()
 		mIndexBufferBox = indexBuffer;
 	}
 
-	if ( mStereoRenderTechnique!=NoCorrection )
+	if ( mSinglePassStereo && mVertexBufferStereoBox==0 )
+	{
+		// The box twice, the second copy tagged for the right eye
+		const int vertexCount = sizeof(VerticesBox)/sizeof(VerticesBox[0]);
+		const int indexCount = sizeof(IndicesBox)/sizeof(IndicesBox[0]);
+		VertexWithColorAndEye vertices[vertexCount*2];
+		GLubyte indices[indexCount*2];
+		for ( int eye=0; eye<2; ++eye )
+		{
+			for ( int i=0; i<vertexCount; ++i )
+			{
+				VertexWithColorAndEye& vertex = vertices[eye*vertexCount + i];
+				memcpy( vertex.Position, VerticesBox[i].Position, sizeof(vertex.Position) );
+				memcpy( vertex.Color, VerticesBox[i].Color, sizeof(vertex.Color) );
+				vertex.EyeIndex = static_cast<float>(eye);
+			}
+			for ( int i=0; i<indexCount; ++i )
+				indices[eye*indexCount + i] = static_cast<GLubyte>(eye*vertexCount + IndicesBox[i]);
+		}
+
+		GLuint vertexBuffer;
+		glGenBuffers(1, &vertexBuffer);
+		check();
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		check();
+		glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+		check();
+ 
+		GLuint indexBuffer;
+		glGenBuffers(1, &indexBuffer);
+		check();
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
+		check();
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+		check();
+
+		// Store
+		mVertexBufferStereoBox = vertexBuffer;
+		mIndexBufferStereoBox = indexBuffer;
+	}
+
+	if ( (isRenderTextureNeeded() || mMonoFarField) && mVertexBufferQuad==0 )
 	{
 		GLuint vertexBuffer;
 		glGenBuffers(1, &vertexBuffer);
@@ -486,58 +1252,438 @@ void RiftOnThePiApp::createGeometries()
 void RiftOnThePiApp::createTexture()		
 {
 	printf("createTexture\n");
-	if ( mStereoRenderTechnique==NoCorrection )
+	if ( !isRenderTextureNeeded() )
 	{
 		printf("No render texture\n");
 		return;
 	}
 	
-	// Prepare a texture image
-	GLuint texture = 0;
-	glGenTextures(1, &texture);
-	check();
-	glBindTexture(GL_TEXTURE_2D, texture);
-	check();
-	
 	// The texture we render into is scaled to be potentially larger than the screen (to compensate
 	// for the pinching in effect). 
 	// See RenderDevice::initPostProcessSupport(PostProcessType pptype) in RenderTiny_Device.cpp
-	float sceneRenderScale = mStereoConfig.GetDistortionScale();
-	GLsizei w = (int)ceil(sceneRenderScale * mScreenHResolution);	
-	GLsizei h = (int)ceil(sceneRenderScale * mScreenVResolution);
+	// All the texture techniques share the same scale, but the current technique may not be 
+	// one of them when benchmarking, so it's computed on a configuration of its own
+	OVR::Util::Render::StereoConfig textureStereoConfig = mStereoConfig;
+	configureStereo( textureStereoConfig, RenderTextureDistortionCorrection );
+	float sceneRenderScale = textureStereoConfig.GetDistortionScale();
+	float density = mMultiResolution ? mMultiResolutionPeripheryDensity : 1.f;
+	GLsizei w = (int)ceil(sceneRenderScale * density * mScreenHResolution);	
+	GLsizei h = (int)ceil(sceneRenderScale * density * mScreenVResolution);
 	printf( "TextureWidth: %d\n", w );
 	printf( "TextureHeight: %d\n", h );
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+	mTextureWidth = w;
+	mTextureHeight = h;
+
+	// The full density region around the lens centers
+	GLsizei cw = 0;
+	GLsizei ch = 0;
+	if ( mMultiResolution )
+	{
+		cw = (int)ceil(sceneRenderScale * mMultiResolutionCenterFraction * mScreenHResolution);	
+		ch = (int)ceil(sceneRenderScale * mMultiResolutionCenterFraction * mScreenVResolution);
+		mCenterTextureWidth = cw;
+		mCenterTextureHeight = ch;
+	}
+
+	int renderTargetCount = std::max( mRenderTargetCount, 1 );
+	mRenderTargets.resize( renderTargetCount );
+	for ( int i=0; i<renderTargetCount; ++i )
+	{
+		RenderTarget& renderTarget = mRenderTargets[i];
+		createRenderTexture( w, h, renderTarget.texture, renderTarget.frameBuffer );
+		if ( mMultiResolution )
+			createRenderTexture( cw, ch, renderTarget.centerTexture, renderTarget.centerFrameBuffer );
+	}
+	selectRenderTarget( 0 );
+
+	// GL_RGB, 3 bytes per pixel at best
+	double targetPixels = static_cast<double>(w) * h + static_cast<double>(cw) * ch;
+	printf( "RenderTargets: %d x %.0f pixels, %.0fKB\n", renderTargetCount, targetPixels, renderTargetCount * targetPixels * 3.0 / 1024.0 );
+
+	if ( !mMultiResolution )
+		return;
+
+	// Compared to the single texture sized by GetDistortionScale()
+	double uniformPixels = ceil(sceneRenderScale * mScreenHResolution) * ceil(sceneRenderScale * mScreenVResolution);
+	double multiResolutionPixels = static_cast<double>(w) * h + static_cast<double>(cw) * ch;
+	printf( "MultiResolution: center %dx%d + periphery %dx%d = %.0f pixels instead of %.0f (%.0f%% fewer)\n", 
+		cw, ch, w, h, multiResolutionPixels, uniformPixels, 100.0 * (1.0 - multiResolutionPixels / uniformPixels) );
+}
+
+void RiftOnThePiApp::createRenderTexture( GLsizei width, GLsizei height, GLuint& texture, GLuint& frameBuffer )
+{
+	// Prepare a texture image
+	texture = 0;
+	glGenTextures(1, &texture);
+	check();
+	glBindTexture(GL_TEXTURE_2D, texture);
+	check();
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
 	check();
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	check();
 	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	check();
 
-	// Store
-	mTexture = texture;
-
 	// Prepare a framebuffer for rendering
-	GLuint textureFrameBuffer = 0;
-	glGenFramebuffers(1, &textureFrameBuffer);
+	frameBuffer = 0;
+	glGenFramebuffers(1, &frameBuffer);
 	check();
-	glBindFramebuffer(GL_FRAMEBUFFER, textureFrameBuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
 	check();
 	glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
 	check();
 	glBindFramebuffer(GL_FRAMEBUFFER,0);
 	check();
-
-	// Store
-	mTextureFrameBuffer = textureFrameBuffer;
 }
 
-void RiftOnThePiApp::draw( const ApplicationContext& context ) 
+void RiftOnThePiApp::selectRenderTarget( int index )
 {
-	unsigned int time = OVR::Timer::GetTicksMs();
-	float deltaTime = static_cast<float>( time - mLastTime );
+	const RenderTarget& renderTarget = mRenderTargets[index];
+	mRenderTargetIndex = index;
+	mTexture = renderTarget.texture;
+	mTextureFrameBuffer = renderTarget.frameBuffer;
+	mCenterTexture = renderTarget.centerTexture;
+	mCenterTextureFrameBuffer = renderTarget.centerFrameBuffer;
+}
 
-	bool displayDrawTime = (mLastTime/1000 != time/1000);
+void RiftOnThePiApp::destroyQuadShaderPrograms()
+{
+	for ( int i=0; i<StereoRenderTechniqueCount; ++i )
+	{
+		if ( mQuadPrograms[i].program==0 )
+			continue;
+		glDeleteProgram( mQuadPrograms[i].program );
+		check();
+		mQuadPrograms[i] = QuadProgram();
+	}
+}
+
+void RiftOnThePiApp::destroyQuadGeometry()
+{
+	if ( mVertexBufferQuad==0 )
+		return;
+	glDeleteBuffers( 1, &mVertexBufferQuad );
+	check();
+	glDeleteBuffers( 1, &mIndexBufferQuad );
+	check();
+	mVertexBufferQuad = 0;
+	mIndexBufferQuad = 0;
+}
+
+void RiftOnThePiApp::destroyTexture()
+{
+	for ( std::size_t i=0; i<mRenderTargets.size(); ++i )
+	{
+		RenderTarget& renderTarget = mRenderTargets[i];
+		glDeleteFramebuffers( 1, &renderTarget.frameBuffer );
+		check();
+		glDeleteTextures( 1, &renderTarget.texture );
+		check();
+		if ( renderTarget.centerTexture==0 )
+			continue;
+		glDeleteFramebuffers( 1, &renderTarget.centerFrameBuffer );
+		check();
+		glDeleteTextures( 1, &renderTarget.centerTexture );
+		check();
+	}
+	mRenderTargets.clear();
+	mRenderTargetIndex = 0;
+	mTextureFrameBuffer = 0;
+	mTexture = 0;
+	mTextureWidth = 0;
+	mTextureHeight = 0;
+	mCenterTextureFrameBuffer = 0;
+	mCenterTexture = 0;
+	mCenterTextureWidth = 0;
+	mCenterTextureHeight = 0;
+}
+
+// A box of the environment, sorted farthest first
+struct EnvironmentBox
+{
+	float			distance;
+	float			radius;						// Of its bounding sphere
+	OVR::Matrix4f	model;
+	bool operator<( const EnvironmentBox& other ) const { return distance>other.distance; }
+};
+
+void RiftOnThePiApp::createEnvironment()
+{
+	// A ring of boxes around the viewer, growing with the distance so that they stay visible. 
+	// Each one is in the far field if its bounding sphere is entirely beyond the split depth
+	std::vector<EnvironmentBox> boxes;
+	for ( int i=0; i<mEnvironmentBoxCount; ++i )
+	{
+		// Every other box is pulled in halfway, so that a split depth can fall in between
+		float distance = mEnvironmentDistance * ( (i%2)==0 ? 1.f : 0.5f );
+		float angle = 2.f * gPi * i / mEnvironmentBoxCount;
+		float size = distance * 0.1f;
+		EnvironmentBox box;
+		box.distance = distance;
+		box.radius = size * sqrt(3.f);
+		box.model = OVR::Matrix4f::Translation( sin(angle) * distance, 0.f, -cos(angle) * distance ) * OVR::Matrix4f::Scaling( size, size, size );
+		boxes.push_back( box );
+	}
+	std::sort( boxes.begin(), boxes.end() );
+
+	mBoxModels.clear();
+	mFarBoxCount = 0;
+	for ( size_t i=0; i<boxes.size(); ++i )
+	{
+		mBoxModels.push_back( boxes[i].model );
+		if ( boxes[i].distance - boxes[i].radius > mFarFieldSplitDepth )
+			mFarBoxCount++;
+	}
+	mBoxModels.push_back( getBoxModel() );		// The animated box, updated every frame
+	printf("Environment: %d boxes, %d in the far field\n", static_cast<int>(mBoxModels.size()), mFarBoxCount );
+}
+
+void RiftOnThePiApp::createFarFieldLayer()
+{
+	if ( !mMonoFarField )
+		return;
+
+	// As wide as the scene of an eye plus the projection center offset on both sides, in the 
+	// normalized coordinates of the eye
+	const OVR::Util::Render::StereoEyeParams& eye = mStereoConfig.GetEyeRenderParams(OVR::Util::Render::StereoEye_Left);
+	OVR::Util::Render::Viewport svp = getSceneViewport( eye );
+	float margin = fabs( getProjectionCenterOffset(eye) );
+	GLsizei w = (int)ceil( svp.w * (1.f + margin) );
+	GLsizei h = svp.h;
+	printf( "FarFieldLayer: %dx%d\n", w, h );
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	check();
+	glBindTexture(GL_TEXTURE_2D, texture);
+	check();
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+	check();
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	check();
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	check();
+
+	GLuint frameBuffer = 0;
+	glGenFramebuffers(1, &frameBuffer);
+	check();
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+	check();
+	glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+	check();
+	glBindFramebuffer(GL_FRAMEBUFFER,0);
+	check();
+
+	// Store
+	mFarFieldTexture = texture;
+	mFarFieldFrameBuffer = frameBuffer;
+	mFarFieldWidth = w;
+	mFarFieldHeight = h;
+}
+
+void RiftOnThePiApp::destroyFarFieldLayer()
+{
+	if ( mFarFieldTexture==0 )
+		return;
+	glDeleteFramebuffers( 1, &mFarFieldFrameBuffer );
+	check();
+	glDeleteTextures( 1, &mFarFieldTexture );
+	check();
+	mFarFieldFrameBuffer = 0;
+	mFarFieldTexture = 0;
+	mFarFieldWidth = 0;
+	mFarFieldHeight = 0;
+}
+
+void RiftOnThePiApp::createSpectator()
+{
+	if ( mSpectatorInterval<=0 )
+		return;
+	if ( mStereoRenderTechnique==NoCorrection || mTexture==0 || mCopyProgram.program==0 )
+	{
+		printf("Spectator: needs a render texture, not available with StereoRenderTechnique 0\n");
+		return;
+	}
+	if ( mSpectatorFile.empty() )
+	{
+		printf("Spectator: SpectatorFile is needed, the view is only written there\n");
+		return;
+	}
+	if ( mSpectatorWidth<16 )
+	{
+		printf("SpectatorWidth %d is not supported, using 16\n", mSpectatorWidth );
+		mSpectatorWidth = 16;
+	}
+
+	// With the aspect ratio of the scene of an eye
+	const OVR::Util::Render::StereoEyeParams& eye = mStereoConfig.GetEyeRenderParams(OVR::Util::Render::StereoEye_Left);
+	OVR::Util::Render::Viewport svp = getSceneViewport( eye );
+	GLsizei w = mSpectatorWidth;
+	GLsizei h = static_cast<GLsizei>( static_cast<float>(w) * svp.h / svp.w + 0.5f ) & ~1;		// Even for the Y4M chroma
+	if ( !mSpectatorRecorder.start( mSpectatorFile, w, h, mRecordBufferCount, mRecordFrameRate, mSpectatorInterval ) )
+		return;
+	printf( "Spectator: %dx%d every %d frames\n", w, h, mSpectatorInterval );
+
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	check();
+	glBindTexture(GL_TEXTURE_2D, texture);
+	check();
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, w, h, 0, GL_RGB, GL_UNSIGNED_BYTE, 0);
+	check();
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	check();
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	check();
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	check();
+
+	GLuint frameBuffer = 0;
+	glGenFramebuffers(1, &frameBuffer);
+	check();
+	glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer);
+	check();
+	glFramebufferTexture2D( GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+	check();
+	glBindFramebuffer(GL_FRAMEBUFFER,0);
+	check();
+
+	// Store
+	mSpectatorTexture = texture;
+	mSpectatorFrameBuffer = frameBuffer;
+	mSpectatorHeight = h;
+	mSpectatorTimeSum = 0;
+	mSpectatorReadbackTimeSum = 0;
+	mSpectatorViews = 0;
+	mSpectatorFrames = 0;
+}
+
+void RiftOnThePiApp::destroySpectator()
+{
+	mSpectatorRecorder.stop();
+	if ( mSpectatorTexture==0 )
+		return;
+	glDeleteFramebuffers( 1, &mSpectatorFrameBuffer );
+	check();
+	glDeleteTextures( 1, &mSpectatorTexture );
+	check();
+	mSpectatorFrameBuffer = 0;
+	mSpectatorTexture = 0;
+	mSpectatorHeight = 0;
+}
+
+void RiftOnThePiApp::computeEyeScissors()
+{
+	for ( int i=0; i<StereoRenderTechniqueCount; ++i )
+	{
+		mEyeScissors[i][0] = OVR::Util::Render::Viewport();
+		mEyeScissors[i][1] = OVR::Util::Render::Viewport();
+	}
+	if ( !mDistortionScissorEnabled || mTexture==0 )
+		return;
+
+	// The CPU reference distortion tells which texture coordinates each technique reads. The
+	// rectangle around them gets a texel of margin for the GPU rounding differences
+	float density = mCenterTexture!=0 ? mMultiResolutionPeripheryDensity : 1.f;
+	for ( int i=RenderTextureNoDistortionCorrection; i<StereoRenderTechniqueCount; ++i )
+	{
+		StereoRenderTechnique technique = static_cast<StereoRenderTechnique>(i);
+		if ( !isTechniqueResident(technique) )
+			continue;
+
+		unsigned int startTime = OVR::Timer::GetTicksMs();
+		OVR::Util::Render::StereoConfig stereoConfig = mStereoConfig;
+		configureStereo( stereoConfig, technique );
+		const OVR::Util::Render::StereoEye eyes[2] = { OVR::Util::Render::StereoEye_Left, OVR::Util::Render::StereoEye_Right };
+		double eyePixels = 0.0;
+		double scissorPixels = 0.0;
+		for ( int eye=0; eye<2; ++eye )
+		{
+			const OVR::Util::Render::StereoEyeParams& stereoEyeParam = stereoConfig.GetEyeRenderParams( eyes[eye] );
+			OVR::Util::Render::Viewport eyeVP = scaleViewport( stereoEyeParam.VP, stereoEyeParam.pDistortion->Scale * density );
+			eyePixels += static_cast<double>(eyeVP.w) * eyeVP.h;
+
+			DistortionParams params = DistortionReference::computeParams( stereoEyeParam.VP, mScreenHResolution, mScreenVResolution, 
+																		  getEyeDistortionConfig(stereoEyeParam) );
+			float bounds[4];
+			if ( !DistortionReference::computeSampledBounds( getDistortionProgram(technique), params, stereoEyeParam.VP, bounds ) )
+				continue;
+			int x0 = std::max( eyeVP.x, static_cast<int>( floor(bounds[0] * mTextureWidth) ) - 1 );
+			int y0 = std::max( eyeVP.y, static_cast<int>( floor(bounds[1] * mTextureHeight) ) - 1 );
+			int x1 = std::min( eyeVP.x + eyeVP.w, static_cast<int>( floor(bounds[2] * mTextureWidth) ) + 2 );
+			int y1 = std::min( eyeVP.y + eyeVP.h, static_cast<int>( floor(bounds[3] * mTextureHeight) ) + 2 );
+			if ( x1<=x0 || y1<=y0 )
+				continue;
+			mEyeScissors[technique][eye] = OVR::Util::Render::Viewport( x0, y0, x1 - x0, y1 - y0 );
+			scissorPixels += static_cast<double>(x1 - x0) * (y1 - y0);
+		}
+
+		// Both eyes or none
+		if ( mEyeScissors[technique][0].w==0 || mEyeScissors[technique][1].w==0 )
+		{
+			mEyeScissors[technique][0] = OVR::Util::Render::Viewport();
+			mEyeScissors[technique][1] = OVR::Util::Render::Viewport();
+			continue;
+		}
+		printf("Scissor (technique %d): left %dx%d right %dx%d, %.0f pixels instead of %.0f (%.0f%% of the fill saved, computed in %dms)\n", 
+			technique, mEyeScissors[technique][0].w, mEyeScissors[technique][0].h, mEyeScissors[technique][1].w, mEyeScissors[technique][1].h, 
+			scissorPixels, eyePixels, 100.0 * (1.0 - scissorPixels / eyePixels), OVR::Timer::GetTicksMs() - startTime );
+	}
+}
+
+void RiftOnThePiApp::computeEyeDistortionParams()
+{
+	const OVR::Util::Render::StereoEye eyes[2] = { OVR::Util::Render::StereoEye_Left, OVR::Util::Render::StereoEye_Right };
+	for ( int i=RenderTextureNoDistortionCorrection; i<StereoRenderTechniqueCount; ++i )
+	{
+		StereoRenderTechnique technique = static_cast<StereoRenderTechnique>(i);
+		if ( !isTechniqueResident(technique) )
+			continue;
+		OVR::Util::Render::StereoConfig stereoConfig = mStereoConfig;
+		configureStereo( stereoConfig, technique );
+		for ( int eye=0; eye<2; ++eye )
+		{
+			const OVR::Util::Render::StereoEyeParams& stereoEyeParam = stereoConfig.GetEyeRenderParams( eyes[eye] );
+			mEyeDistortionParams[technique][eye] = DistortionReference::computeParams( stereoEyeParam.VP, mScreenHResolution, mScreenVResolution, 
+																					  getEyeDistortionConfig(stereoEyeParam) );
+		}
+	}
+}
+
+void RiftOnThePiApp::draw( const ApplicationContext& context ) 
+{
+	OGLES_TRACE_SCOPE("frame");
+	auditAllocations();
+	{
+		OGLES_TRACE_SCOPE("updateParameters");
+		updateParameters();
+		if ( isBenchmarking() )
+			updateBenchmarkTechnique();
+	}
+
+	// Like the sensor, the latency tester inputs are taken at the start of the frame
+	if ( mLatencyTester )
+		mLatencyUtil.ProcessInputs();
+	mSimulatedLatencyTester.processInputs();
+
+	OVR::UInt64 startTicks = OVR::Timer::GetTicks();
+	unsigned int time = OVR::Timer::GetTicksMs();
+	unsigned int frameInterval = mLastFrameTicks!=0 ? static_cast<unsigned int>(startTicks - mLastFrameTicks) : 0;
+	mLastFrameTicks = startTicks;
+	memset( mPhaseTimes, 0, sizeof(mPhaseTimes) );
+	if ( mTelemetrySampler.isRunning() )
+		mTelemetrySample = mTelemetrySampler.getLatestSample();
+	mOutputFrameBuffer = context.frameBuffer;		// The runner may recreate it when the window is resized
+	float deltaTime = static_cast<float>( time - mLastTime );
+
+	bool displayDrawTime = (mLastTime/1000 != time/1000);
 	mLastTime = time;
 
 	if ( mAnimationEnabled )
@@ -552,23 +1698,423 @@ void RiftOnThePiApp::draw( const ApplicationContext& context )
 		mBoxAngleY = 0.f;
 		mBoxAngleZ = 0.f;	
 	}
+	mBoxModels.back() = getBoxModel();
+	if ( !mDeviceStartupDone && isDeviceStartupDone() )
+	{
+		// The render loop starts as soon as the HMD info is known, the sensor may come later
+		mDeviceStartupDone = true;
+		if ( mStartupReported )
+			mStartupProfile.printPhase( StartupProfile::SensorStartupPhase );
+	}
+	if ( mDeviceStartupDone && mBatchedSensorFusion )
+	{
+		OGLES_TRACE_SCOPE("sensorFusion");
+		mMetricsSensorSampleCount += mBatchedSensorFusion->process();
+		OVR::UInt64 arrivalTime = mBatchedSensorFusion->getLatestArrivalTime();
+		if ( arrivalTime!=0 )
+		{
+			mSensorAgeSum += BatchedSensorFusion::getMonotonicTime() - arrivalTime;
+			mSensorAgeCount++;
+		}
+	}
+	mHeadMatrix = getHeadMatrix();
+
+	OGLES_TRACE_SCOPE("draw");
+	if ( mRenderTargets.size()>1 )
+		selectRenderTarget( (mRenderTargetIndex + 1) % static_cast<int>(mRenderTargets.size()) );
+	const OVR::Util::Render::StereoEyeParams& leftEye = mStereoConfig.GetEyeRenderParams(OVR::Util::Render::StereoEye_Left);
+	const OVR::Util::Render::StereoEyeParams& rightEye = mStereoConfig.GetEyeRenderParams(OVR::Util::Render::StereoEye_Right);
+	OVR::UInt64 eyesStartTicks = OVR::Timer::GetTicks();
+	(this->*mDrawEyesFunction)( leftEye, rightEye );
+	unsigned int eyesTimeUs = static_cast<unsigned int>(OVR::Timer::GetTicks() - eyesStartTicks);
 
-	if ( mStereoRenderTechnique!=NoCorrection )
+	OVR::UInt64 drawEndTicks = OVR::Timer::GetTicks();
+
+	// The comparison reads the back buffer, so it must happen before the swap (and before the HUD is drawn over)
+	if ( mValidateDistortionFrame>0 && mCounter==mValidateDistortionFrame )
+		validateDistortion();
+
+	// Recorded before the HUD and the latency patch are drawn over the frame
+	if ( mFrameRecorder.isRunning() && mCounter % mRecordInterval==0 )
+	{
+		OVR::UInt64 recordStartTicks = OVR::Timer::GetTicks();
+		recordFrame();
+		mPhaseTimes[PerformanceHud::RecordPhase] = static_cast<unsigned int>(OVR::Timer::GetTicks() - recordStartTicks);
+		mRecordTimeSum += mPhaseTimes[PerformanceHud::RecordPhase];
+	}
+
+	// The spectator view is drawn at a reduced rate, its cost is reported spread over every frame. 
+	// The readback is timed apart: without ForceFinish it also waits for the whole frame
+	if ( mSpectatorFrameBuffer!=0 )
+	{
+		mSpectatorFrames++;
+		if ( mCounter % mSpectatorInterval==0 )
+		{
+			OVR::UInt64 spectatorStartTicks = OVR::Timer::GetTicks();
+			drawSpectator( leftEye );
+			OVR::UInt64 readbackStartTicks = OVR::Timer::GetTicks();
+			readSpectator();
+			mSpectatorTimeSum += static_cast<unsigned int>(readbackStartTicks - spectatorStartTicks);
+			mSpectatorReadbackTimeSum += static_cast<unsigned int>(OVR::Timer::GetTicks() - readbackStartTicks);
+			mSpectatorViews++;
+		}
+	}
+
+	if ( mTraceEndFrame>=0 && mCounter>=mTraceEndFrame )
+		writeTrace();
+
+	// The HUD is timed separately, so that the times it shows and the ones reported below don't include it
+	if ( mHud.isCreated() )
+	{
+		OVR::UInt64 hudStartTicks = OVR::Timer::GetTicks();
+		drawHud( leftEye, rightEye );
+		mPhaseTimes[PerformanceHud::HudPhase] = static_cast<unsigned int>(OVR::Timer::GetTicks() - hudStartTicks);
+	}
+
+	// The latency test patch goes on top of everything
+	OVR::Color latencyPatchColor;
+	bool latencyPatchDrawn = false;
+	if ( mLatencyTester )
+		latencyPatchDrawn = mLatencyUtil.DisplayScreenColor( latencyPatchColor );
+	else if ( mSimulatedLatencyTester.isStarted() )
+		latencyPatchDrawn = mSimulatedLatencyTester.displayScreenColor( latencyPatchColor );
+	if ( latencyPatchDrawn )
+		drawLatencyPatch( latencyPatchColor, leftEye, rightEye );
+
+	// Present the result
+	OVR::UInt64 swapStartTicks = OVR::Timer::GetTicks();
+	context.swapBuffers();
+	check();
+	OGLES_GL_CHECK_PASS( "swap" );
+	mCounter++;
+	OVR::UInt64 swapEndTicks = OVR::Timer::GetTicks();
+	mSimulatedLatencyTester.onSwap( swapEndTicks, latencyPatchDrawn );
+
+	unsigned int drawTimeUs = static_cast<unsigned int>(drawEndTicks - startTicks);
+	unsigned int swapTimeUs = static_cast<unsigned int>(swapEndTicks - swapStartTicks);
+	unsigned int drawTime = drawTimeUs / 1000;
+	unsigned int swapTime = swapTimeUs / 1000;
+	mPhaseTimes[PerformanceHud::SwapPhase] = swapTimeUs;
+	if ( mHud.isCreated() )
+		mHud.addFrame( frameInterval, mPhaseTimes );
+	if ( mMetricsServer.isRunning() )
+	{
+		// A frame taking more than one and a half 60Hz refreshes missed at least one vsync
+		mMetricsFrameCount++;
+		if ( frameInterval>25000 )
+			mMetricsDroppedFrameCount++;
+		if ( frameInterval>0 )
+			mMetricsFrameTimes.add( frameInterval );
+		mMetricsDrawTimes.add( drawTimeUs );
+		if ( displayDrawTime )
+			publishMetrics( time );
+	}
+
+	if ( mFrameLogFile )
+		logFrame( drawTimeUs, swapTimeUs );
+	if ( mLatencyTester )
+		reportLatency( mLatencyUtil.GetResultsString() );
+	else if ( mSimulatedLatencyTester.isStarted() )
+		reportLatency( mSimulatedLatencyTester.getResultsString() );
+	if ( isBenchmarking() )
+	{
+		recordBenchmarkFrame( drawTimeUs, swapTimeUs, eyesTimeUs );
+	}
+	else if ( displayDrawTime )
+	{
+		if ( mTelemetrySample.time!=0 )
+			printf("draw:%d swap:%d temp:%.1f cpufreq:%dMHz cpu:%.0f%%\n", drawTime, swapTime, 
+				mTelemetrySample.getMaxTemperature(), mTelemetrySample.getMinCpuFrequency() / 1000, mTelemetrySample.processCpuUsage );
+		else
+			printf("draw:%d swap:%d\n", drawTime, swapTime );
+	}
+
+	if ( displayDrawTime && mFrameRecorder.isRunning() )
+	{
+		printf("record: %u written, %u dropped, readback %.2fms per recorded frame\n", mFrameRecorder.getWrittenFrameCount(), 
+			mFrameRecorder.getDroppedFrameCount(), mRecordedFrames>0 ? mRecordTimeSum / 1000.0 / mRecordedFrames : 0.0 );
+		mRecordTimeSum = 0;
+		mRecordedFrames = 0;
+	}
+
+	if ( displayDrawTime && mSpectatorFrames>0 )
+	{
+		printf("spectator: %u views, %.2fms each, %.3fms per frame amortized, readback %.2fms each, %u dropped\n", mSpectatorViews, 
+			mSpectatorViews>0 ? mSpectatorTimeSum / 1000.0 / mSpectatorViews : 0.0, mSpectatorTimeSum / 1000.0 / mSpectatorFrames, 
+			mSpectatorViews>0 ? mSpectatorReadbackTimeSum / 1000.0 / mSpectatorViews : 0.0, mSpectatorRecorder.getDroppedFrameCount() );
+		mSpectatorTimeSum = 0;
+		mSpectatorReadbackTimeSum = 0;
+		mSpectatorViews = 0;
+		mSpectatorFrames = 0;
+	}
+
+	if ( displayDrawTime && mHIDReportReader.isRunning() )
+	{
+		HIDReportReader::Statistics statistics = mHIDReportReader.takeStatistics();
+		// Only a stream, like the simulated device's pipe, gets several reports per read. Not hidraw
+		printf("hid: %u reports (%u samples) in %u wakeups and %u reads (%.1f reads per wakeup, %s), %u bytes skipped, sensor age %.2fms\n", 
+			statistics.reports, statistics.samples, statistics.wakeups, statistics.reads, 
+			statistics.wakeups>0 ? static_cast<double>(statistics.reads) / statistics.wakeups : 0.0, 
+			mHIDReportReader.isReportPerRead() ? "one report per read" : "stream", statistics.skippedBytes, 
+			mSensorAgeCount>0 ? mSensorAgeSum / 1000.0 / mSensorAgeCount : 0.0 );
+		mSensorAgeSum = 0;
+		mSensorAgeCount = 0;
+	}
+
+	// What the checks cost, to compare the levels
+	mGLCheckFrameCount++;
+	if ( displayDrawTime && GLCheck::getLevel()!=GLCheck::Off )
+	{
+		printf("glcheck: level %d, %.1f checks and %.3fms per frame, %u errors\n", GLCheck::getLevel(), 
+			static_cast<double>(GLCheck::getCheckCount()) / mGLCheckFrameCount, GLCheck::getCheckTime() / 1000.0 / mGLCheckFrameCount, 
+			GLCheck::getErrorCount() );
+		GLCheck::resetStats();
+		mGLCheckFrameCount = 0;
+	}
+
+	if ( !mStartupReported )
+	{
+		mStartupProfile.end( StartupProfile::FirstFramePhase );
+		mStartupProfile.print();
+		mStartupReported = true;
+	}
+
+	// Once the startup is over, so that it neither delays the first frame nor shares the CPU with the startup threads
+	if ( mSensorFusionBenchmark>0 && !mSensorFusionBenchmarkDone && mStartupReported && mDeviceStartupDone )
+	{
+		mAllocationAuditExcused = true;
+		BatchedSensorFusion::runBenchmark( mSensorFusionBenchmark, 16 );		// About a frame of samples per block at 60Hz
+		mSensorFusionBenchmarkDone = true;
+	}
+}
+
+bool RiftOnThePiApp::isDone() const
+{
+	// The checks run in draw(), mCounter is past them once they have given their verdict
+	if ( !mExitAfterChecks )
+		return false;
+	bool validated = mValidateDistortionFrame<=0 || mCounter>mValidateDistortionFrame;
+	bool audited = mAllocationAuditFrame<=0 || mCounter>mAllocationAuditFrame + mAllocationAuditFrameCount;
+	return validated && audited;
+}
+
+bool RiftOnThePiApp::isTechniqueResident( StereoRenderTechnique technique ) const
+{
+	if ( technique==mStereoRenderTechnique )
+		return true;
+	if ( !isBenchmarking() )
+		return false;
+	return std::find( mBenchmarkTechniqueList.begin(), mBenchmarkTechniqueList.end(), technique )!=mBenchmarkTechniqueList.end();
+}
+
+bool RiftOnThePiApp::isRenderTextureNeeded() const
+{
+	for ( int i=RenderTextureNoDistortionCorrection; i<StereoRenderTechniqueCount; ++i )
 	{
-		// Clear texture frame buffer
+		if ( isTechniqueResident( static_cast<StereoRenderTechnique>(i) ) )
+			return true;
+	}
+	return false;
+}
+
+void RiftOnThePiApp::parseBenchmarkTechniques()
+{
+	mBenchmarkTechniqueList.clear();
+	const char* text = mBenchmarkTechniques.c_str();
+	while ( *text!='\0' )
+	{
+		char* end = NULL;
+		long value = strtol( text, &end, 10 );
+		if ( end==text )
+		{
+			printf("BenchmarkTechniques: can't parse '%s'\n", text );
+			break;
+		}
+		if ( value<NoCorrection || value>=StereoRenderTechniqueCount )
+			printf("BenchmarkTechniques: StereoRenderTechnique %ld is not supported\n", value );
+		else
+			mBenchmarkTechniqueList.push_back( static_cast<StereoRenderTechnique>(value) );
+		text = end;
+		while ( *text==',' || *text==' ' )
+			++text;
+	}
+}
+
+void RiftOnThePiApp::updateBenchmarkTechnique()
+{
+	// All the techniques are resident, switching is only a matter of stereo configuration
+	// (the FOV of NoCorrection isn't the same as the others'). With mBenchmarkDrawDispatch, each 
+	// technique has two slots in a row, the generic draw first
+	unsigned int slotsPerTechnique = mBenchmarkDrawDispatch ? 2 : 1;
+	unsigned int slot = (mBenchmarkFrame / mBenchmarkFramesPerTechnique) % (mBenchmarkTechniqueList.size() * slotsPerTechnique);
+	StereoRenderTechnique technique = mBenchmarkTechniqueList[slot / slotsPerTechnique];
+	bool genericDraw = mBenchmarkDrawDispatch && slot % 2==0;
+	if ( technique==mStereoRenderTechnique && genericDraw==mBenchmarkGenericDraw )
+		return;
+	mBenchmarkGenericDraw = genericDraw;
+	if ( technique!=mStereoRenderTechnique )
+	{
+		mStereoRenderTechnique = technique;
+		configureStereo( mStereoConfig, mStereoRenderTechnique );
+	}
+	selectDrawEyesFunction();
+}
+
+void RiftOnThePiApp::recordBenchmarkFrame( unsigned int drawTime, unsigned int swapTime, unsigned int eyesTime )
+{
+	// The first frames after a switch pay for it (cold caches, pipeline changes), they're left out
+	unsigned int frameInSlot = mBenchmarkFrame % mBenchmarkFramesPerTechnique;
+	if ( frameInSlot>=static_cast<unsigned int>(mBenchmarkWarmupFrames) )
+	{
+		TechniqueStats& stats = (mBenchmarkGenericDraw ? mBenchmarkGenericStats : mBenchmarkStats)[mStereoRenderTechnique];
+		stats.drawTime.add( drawTime );
+		stats.swapTime.add( swapTime );
+		stats.frameTime.add( drawTime + swapTime );
+		stats.eyesTime.add( eyesTime );
+		
+		float temperature = mTelemetrySample.getMaxTemperature();
+		if ( mTelemetrySample.time!=0 && temperature>=0.f )
+		{
+			stats.temperatureSum += temperature;
+			stats.temperatureCount++;
+		}
+		int cpuFrequency = mTelemetrySample.getMinCpuFrequency();
+		if ( mTelemetrySample.time!=0 && cpuFrequency>=0 )
+		{
+			stats.cpuFrequencySum += cpuFrequency;
+			stats.cpuFrequencyCount++;
+		}
+	}
+	mBenchmarkFrame++;
+
+	unsigned int time = OVR::Timer::GetTicksMs();
+	if ( mBenchmarkReportInterval>0 && time - mBenchmarkLastReportTime >= static_cast<unsigned int>(mBenchmarkReportInterval) * 1000 )
+	{
+		printBenchmarkReport();
+		mBenchmarkLastReportTime = time;
+	}
+}
+
+void RiftOnThePiApp::printBenchmarkReport() const
+{
+	// Times in ms. The techniques have been interleaved all along, so they compare under the same 
+	// thermal and load conditions. The ratio is relative to the first benchmarked technique
+	printf("Benchmark (%d frames per technique, %d warmup, %s draw):\n", mBenchmarkFramesPerTechnique, mBenchmarkWarmupFrames, 
+		mBenchmarkDrawDispatch || mSpecializedDraw ? "specialized" : "generic" );
+	printf("  technique  frames   draw(mean)  swap(mean)  frame(mean   stddev   p50      p95      p99      max)     ratio  temp   cpufreq  latency\n");
+	double referenceMean = mBenchmarkStats[mBenchmarkTechniqueList[0]].frameTime.getMean();
+	for ( int i=0; i<StereoRenderTechniqueCount; ++i )
+	{
+		StereoRenderTechnique technique = static_cast<StereoRenderTechnique>(i);
+		if ( std::find( mBenchmarkTechniqueList.begin(), mBenchmarkTechniqueList.end(), technique )==mBenchmarkTechniqueList.end() )
+			continue;
+		const TechniqueStats& stats = mBenchmarkStats[i];
+		const FrameStats& frameTime = stats.frameTime;
+		double ratio = referenceMean>0.0 ? frameTime.getMean() / referenceMean : 0.0;
+		
+		// Mean temperature and CPU clock over the measured frames, -1 when unknown
+		double temperature = stats.temperatureCount>0 ? stats.temperatureSum / stats.temperatureCount : -1.0;
+		double cpuFrequency = stats.cpuFrequencyCount>0 ? stats.cpuFrequencySum / stats.cpuFrequencyCount / 1000.0 : -1.0;
+		double latency = stats.latency.getCount()>0 ? stats.latency.getMean() / 1000.0 : -1.0;
+		printf("  %-9d  %-7u  %-10.2f  %-10.2f  %-10.2f  %-7.2f  %-7.2f  %-7.2f  %-7.2f  %-8.2f  %-5.3f  %-5.1f  %-7.0f  %.1f\n", 
+			i, frameTime.getCount(), 
+			stats.drawTime.getMean() / 1000.0, stats.swapTime.getMean() / 1000.0, 
+			frameTime.getMean() / 1000.0, frameTime.getStandardDeviation() / 1000.0, 
+			frameTime.getPercentile(50.f) / 1000.0, frameTime.getPercentile(95.f) / 1000.0, 
+			frameTime.getPercentile(99.f) / 1000.0, frameTime.getMax() / 1000.0, ratio, 
+			temperature, cpuFrequency, latency );
+	}
+
+	// Same techniques, same conditions, only the draw dispatch differs: the difference of the CPU 
+	// time issuing the eye passes is what the specialization saves per frame
+	if ( mBenchmarkDrawDispatch )
+	{
+		printf("  technique  frames   eyes generic(mean)  eyes specialized(mean)  saved(us/frame)  draw generic(mean)  draw specialized(mean)\n");
+		for ( int i=0; i<StereoRenderTechniqueCount; ++i )
+		{
+			StereoRenderTechnique technique = static_cast<StereoRenderTechnique>(i);
+			if ( std::find( mBenchmarkTechniqueList.begin(), mBenchmarkTechniqueList.end(), technique )==mBenchmarkTechniqueList.end() )
+				continue;
+			const TechniqueStats& generic = mBenchmarkGenericStats[i];
+			const TechniqueStats& specialized = mBenchmarkStats[i];
+			printf("  %-9d  %-7u  %-18.3f  %-22.3f  %-15.1f  %-18.2f  %.2f\n", 
+				i, generic.eyesTime.getCount() + specialized.eyesTime.getCount(), 
+				generic.eyesTime.getMean() / 1000.0, specialized.eyesTime.getMean() / 1000.0, 
+				generic.eyesTime.getMean() - specialized.eyesTime.getMean(), 
+				generic.drawTime.getMean() / 1000.0, specialized.drawTime.getMean() / 1000.0 );
+		}
+	}
+
+	// Where the CPU time went over the last telemetry interval
+	if ( mTelemetrySample.threadCount>0 )
+	{
+		printf("  threads (cpu%%):");
+		for ( int i=0; i<mTelemetrySample.threadCount; ++i )
+			printf(" %s/%d:%.0f", mTelemetrySample.threads[i].name, mTelemetrySample.threads[i].id, mTelemetrySample.threads[i].cpuUsage );
+		printf("\n");
+	}
+}
+
+void RiftOnThePiApp::selectDrawEyesFunction()
+{
+	static const DrawEyesFunction specializedFunctions[StereoRenderTechniqueCount] = 
+	{
+		&RiftOnThePiApp::drawEyes<NoCorrection>,
+		&RiftOnThePiApp::drawEyes<RenderTextureNoDistortionCorrection>,
+		&RiftOnThePiApp::drawEyes<RenderTextureDistortionCorrection>,
+		&RiftOnThePiApp::drawEyes<RenderTextureDistortionAndChromaCorrection>
+	};
+	bool specialized = isBenchmarking() && mBenchmarkDrawDispatch ? !mBenchmarkGenericDraw : mSpecializedDraw;
+	mDrawEyesFunction = specialized ? specializedFunctions[mStereoRenderTechnique] : &RiftOnThePiApp::drawEyes<DynamicTechnique>;
+}
+
+template<int Technique> 
+RiftOnThePiApp::StereoRenderTechnique RiftOnThePiApp::getTechnique() const
+{
+	return Technique==DynamicTechnique ? mStereoRenderTechnique : static_cast<StereoRenderTechnique>(Technique);
+}
+
+template<int Technique> 
+void RiftOnThePiApp::drawEyes( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye )
+{
+	const StereoRenderTechnique technique = getTechnique<Technique>();
+	if ( technique!=NoCorrection )
+	{
+		OGLES_TRACE_SCOPE("clear");
+		// Clear texture frame buffer, only where the distortion reads it if possible
 		glBindFramebuffer(GL_FRAMEBUFFER, mTextureFrameBuffer);
 		check();
 		glClearColor( 0.4f, 0.4f, 0.4f, 1.f );
 		check();
 		glClearDepthf(1.f);
 		check();
-		glClear( GL_COLOR_BUFFER_BIT |GL_DEPTH_BUFFER_BIT);
-		check();
+		if ( isDistortionScissorUsed<Technique>() )
+		{
+			glEnable(GL_SCISSOR_TEST);
+			check();
+			const OVR::Util::Render::StereoEyeParams* eyes[2] = { &leftEye, &rightEye };
+			for ( int i=0; i<2; ++i )
+			{
+				const OVR::Util::Render::Viewport& scissor = getEyeScissor<Technique>( *eyes[i] );
+				glScissor( scissor.x, scissor.y, scissor.w, scissor.h );
+				check();
+				glClear( GL_COLOR_BUFFER_BIT |GL_DEPTH_BUFFER_BIT);
+				check();
+			}
+			glDisable(GL_SCISSOR_TEST);
+			check();
+		}
+		else
+		{
+			glClear( GL_COLOR_BUFFER_BIT |GL_DEPTH_BUFFER_BIT);
+			check();
+		}
 	}
 	else
 	{
+		OGLES_TRACE_SCOPE("clear");
 		// Clear frame buffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, mOutputFrameBuffer);
 		check();
 		glClearColor( 0.4f, 0.4f, 0.4f, 1.f );
 		check();
@@ -578,85 +2124,359 @@ void RiftOnThePiApp::draw( const ApplicationContext& context )
 		check();
 	}
 
+	if ( isFarFieldLayerUsed() )
+		drawFarFieldLayer( leftEye );
+	if ( mSinglePassStereo )
+		drawStereoScene<Technique>( leftEye, rightEye );
+
 	// Draw left eye
-	OVR::Util::Render::StereoEyeParams leftEye = mStereoConfig.GetEyeRenderParams(OVR::Util::Render::StereoEye_Left);
-	drawForEye( leftEye );
+	drawForEye<Technique>( leftEye );
 	
 	// Draw right eye
-	OVR::Util::Render::StereoEyeParams rightEye = mStereoConfig.GetEyeRenderParams(OVR::Util::Render::StereoEye_Right);
-	drawForEye( rightEye );
-
-	unsigned int time2 = OVR::Timer::GetTicksMs();
-	unsigned int drawTime = time2 - time;
-
-	// Present the result
-	eglSwapBuffers(context.display, context.surface);
-	check();
-	mCounter++;
+	drawForEye<Technique>( rightEye );
+}
 
-	unsigned int time3 = OVR::Timer::GetTicksMs();
-	unsigned int swapTime = time3 - time2;
+template<int Technique> 
+void RiftOnThePiApp::drawForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
+{
+	const StereoRenderTechnique technique = getTechnique<Technique>();
+	OGLES_TRACE_SCOPE("drawForEye");
 
-	if ( displayDrawTime )
-		printf("draw:%d swap:%d\n", drawTime, swapTime );
+	// In single pass stereo, the scene of both eyes has already been drawn
+	if ( !mSinglePassStereo )
+		drawSceneForEye<Technique>( stereoEyeParam );
+	if ( isMultiResolutionUsed<Technique>() )
+		drawCenterForEye( stereoEyeParam );
 
+	if ( technique!=NoCorrection )
+	{
+		// Draw the render texture in a quad covering the screen
+		OVR::UInt64 distortionStartTicks = OVR::Timer::GetTicks();
+		{
+			OGLES_TRACE_SCOPE("distortionPass");
+			glBindFramebuffer(GL_FRAMEBUFFER, mOutputFrameBuffer);
+			check();
+			glViewport( stereoEyeParam.VP.x, stereoEyeParam.VP.y, stereoEyeParam.VP.w, stereoEyeParam.VP.h );
+			check();
+			drawQuad<Technique>( stereoEyeParam );
+			finishPass( "distortionPass" );
+		}
+		mPhaseTimes[PerformanceHud::DistortionPhase] += static_cast<unsigned int>(OVR::Timer::GetTicks() - distortionStartTicks);
+	}
 }
 
-void RiftOnThePiApp::drawForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
+template<int Technique> 
+void RiftOnThePiApp::drawSceneForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
 {
-	if ( mStereoRenderTechnique==NoCorrection )
+	const StereoRenderTechnique technique = getTechnique<Technique>();
+	OGLES_TRACE_SCOPE("scenePass");
+	OVR::UInt64 sceneStartTicks = OVR::Timer::GetTicks();
+	glBindFramebuffer(GL_FRAMEBUFFER, technique==NoCorrection ? mOutputFrameBuffer : mTextureFrameBuffer);
+	check();
+	OVR::Util::Render::Viewport svp = getSceneViewport<Technique>( stereoEyeParam );
+	glViewport( svp.x, svp.y, svp.w, svp.h );		
+	check();
+	if ( isDistortionScissorUsed<Technique>() )
 	{
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		check();
-		OVR::Util::Render::Viewport svp = stereoEyeParam.VP;
-		glViewport( svp.x, svp.y, svp.w, svp.h );		
-		check();
-		drawBox( stereoEyeParam.Projection, stereoEyeParam.ViewAdjust );
-		glFlush();
+		const OVR::Util::Render::Viewport& scissor = getEyeScissor<Technique>( stereoEyeParam );
+		glScissor( scissor.x, scissor.y, scissor.w, scissor.h );
 		check();
-		glFinish();
+		glEnable(GL_SCISSOR_TEST);
 		check();
 	}
+	OVR::Matrix4f viewMat = mHeadMatrix * stereoEyeParam.ViewAdjust;
+	int boxCount = static_cast<int>(mBoxModels.size());
+	if ( isFarFieldLayerUsed() )
+	{
+		compositeFarField( stereoEyeParam );
+		drawBoxes( stereoEyeParam.Projection, viewMat, mFarBoxCount, boxCount - mFarBoxCount );
+	}
 	else
 	{
-		// Draw the box inside the render texture (which can be larger than the screen resolution)
-		glBindFramebuffer(GL_FRAMEBUFFER, mTextureFrameBuffer);
-		check();
-		float sceneRenderScale = stereoEyeParam.pDistortion->Scale; 
-		OVR::Util::Render::Viewport svp = stereoEyeParam.VP;
-		svp.w = (int)ceil(sceneRenderScale * stereoEyeParam.VP.w);	// See void RenderDevice::SetViewport(const Viewport& vp) in RenderDevice.cpp
-		svp.h = (int)ceil(sceneRenderScale * stereoEyeParam.VP.h);
-		svp.x = (int)ceil(sceneRenderScale * stereoEyeParam.VP.x);
-		svp.y = (int)ceil(sceneRenderScale * stereoEyeParam.VP.y);
-		glViewport( svp.x, svp.y, svp.w, svp.h );		
-		check();
-		drawBox( stereoEyeParam.Projection, stereoEyeParam.ViewAdjust );
-		glFlush();
+		drawBoxes( stereoEyeParam.Projection, viewMat, 0, boxCount );
+	}
+	glDisable(GL_SCISSOR_TEST);
+	check();
+	finishPass( "scenePass" );
+	mPhaseTimes[PerformanceHud::ScenePhase] += static_cast<unsigned int>(OVR::Timer::GetTicks() - sceneStartTicks);
+}
+
+template<int Technique> 
+void RiftOnThePiApp::drawStereoScene( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye )
+{
+	const StereoRenderTechnique technique = getTechnique<Technique>();
+	OGLES_TRACE_SCOPE("stereoScenePass");
+	OVR::UInt64 sceneStartTicks = OVR::Timer::GetTicks();
+	glBindFramebuffer(GL_FRAMEBUFFER, technique==NoCorrection ? mOutputFrameBuffer : mTextureFrameBuffer);
+	check();
+
+	// One viewport spanning the viewports of both eyes
+	OVR::Util::Render::Viewport leftVP = getSceneViewport<Technique>( leftEye );
+	OVR::Util::Render::Viewport rightVP = getSceneViewport<Technique>( rightEye );
+	OVR::Util::Render::Viewport svp;
+	svp.x = std::min( leftVP.x, rightVP.x );
+	svp.y = std::min( leftVP.y, rightVP.y );
+	svp.w = std::max( leftVP.x + leftVP.w, rightVP.x + rightVP.w ) - svp.x;
+	svp.h = std::max( leftVP.y + leftVP.h, rightVP.y + rightVP.h ) - svp.y;
+	// A single scissor rectangle, around those of both eyes
+	if ( isDistortionScissorUsed<Technique>() )
+	{
+		const OVR::Util::Render::Viewport& leftScissor = getEyeScissor<Technique>( leftEye );
+		const OVR::Util::Render::Viewport& rightScissor = getEyeScissor<Technique>( rightEye );
+		int x = std::min( leftScissor.x, rightScissor.x );
+		int y = std::min( leftScissor.y, rightScissor.y );
+		int w = std::max( leftScissor.x + leftScissor.w, rightScissor.x + rightScissor.w ) - x;
+		int h = std::max( leftScissor.y + leftScissor.h, rightScissor.y + rightScissor.h ) - y;
+		glScissor( x, y, w, h );
 		check();
-		glFinish();
+		glEnable(GL_SCISSOR_TEST);
 		check();
-
-		// Draw the render texture in a quad covering the screen
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+	int boxCount = static_cast<int>(mBoxModels.size());
+	if ( isFarFieldLayerUsed() )
+	{
+		glViewport( leftVP.x, leftVP.y, leftVP.w, leftVP.h );
 		check();
-		glViewport( stereoEyeParam.VP.x, stereoEyeParam.VP.y, stereoEyeParam.VP.w, stereoEyeParam.VP.h );
+		compositeFarField( leftEye );
+		glViewport( rightVP.x, rightVP.y, rightVP.w, rightVP.h );
 		check();
-		// The sign of the Distortion.XCenterOffset value must be chagned for the right eye. 
-		// This tweak is done in Render_Tiny::SetDistortionConfig().
-		// It's weird this isn't taken care of by the StereoEyeParam object!
-		OVR::Util::Render::DistortionConfig distortionConfig = *stereoEyeParam.pDistortion;
-		if ( stereoEyeParam.Eye==OVR::Util::Render::StereoEye_Right )
-			distortionConfig.XCenterOffset = -distortionConfig.XCenterOffset;
-		drawQuad( stereoEyeParam.VP, distortionConfig );
-		glFlush();
+		compositeFarField( rightEye );
+		glViewport( svp.x, svp.y, svp.w, svp.h );		
 		check();
-		glFinish();
+		drawStereoBoxes( leftEye, rightEye, svp, mFarBoxCount, boxCount - mFarBoxCount );
+	}
+	else
+	{
+		glViewport( svp.x, svp.y, svp.w, svp.h );		
 		check();
+		drawStereoBoxes( leftEye, rightEye, svp, 0, boxCount );
+	}
+	glDisable(GL_SCISSOR_TEST);
+	check();
+	finishPass( "stereoScenePass" );
+	mPhaseTimes[PerformanceHud::ScenePhase] += static_cast<unsigned int>(OVR::Timer::GetTicks() - sceneStartTicks);
+}
+
+void RiftOnThePiApp::drawCenterForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
+{
+	OGLES_TRACE_SCOPE("centerPass");
+	OVR::UInt64 sceneStartTicks = OVR::Timer::GetTicks();
+	glBindFramebuffer(GL_FRAMEBUFFER, mCenterTextureFrameBuffer);
+	check();
+	OVR::Util::Render::Viewport cvp = getCenterViewport( stereoEyeParam );
+	glViewport( cvp.x, cvp.y, cvp.w, cvp.h );		
+	check();
+	glClearColor( 0.4f, 0.4f, 0.4f, 1.f );
+	check();
+	glClear( GL_COLOR_BUFFER_BIT );
+	check();
+
+	// The part of the eye frustum centered on the lens, mCenterFraction of its size in 
+	// normalized device coordinates. All the boxes are drawn, including the far field ones
+	float offset = getProjectionCenterOffset( stereoEyeParam );
+	float scale = 1.f / mMultiResolutionCenterFraction;
+	OVR::Matrix4f projectionMat = OVR::Matrix4f::Scaling( scale, scale, 1.f ) * OVR::Matrix4f::Translation( -offset, 0.f, 0.f ) * stereoEyeParam.Projection;
+	OVR::Matrix4f viewMat = mHeadMatrix * stereoEyeParam.ViewAdjust;
+	drawBoxes( projectionMat, viewMat, 0, static_cast<int>(mBoxModels.size()) );
+	finishPass( "centerPass" );
+	mPhaseTimes[PerformanceHud::ScenePhase] += static_cast<unsigned int>(OVR::Timer::GetTicks() - sceneStartTicks);
+}
+
+OVR::Util::Render::Viewport RiftOnThePiApp::getSceneViewport( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const
+{
+	return getSceneViewport<DynamicTechnique>( stereoEyeParam );
+}
+
+template<int Technique> 
+OVR::Util::Render::Viewport RiftOnThePiApp::getSceneViewport( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const
+{
+	if ( getTechnique<Technique>()==NoCorrection )
+		return stereoEyeParam.VP;
+
+	// The render texture can be larger than the screen resolution, and its density is 
+	// reduced when the center of the eyes is rendered separately
+	float sceneRenderScale = stereoEyeParam.pDistortion->Scale; 
+	if ( isMultiResolutionUsed<Technique>() )
+		sceneRenderScale *= mMultiResolutionPeripheryDensity;
+	return scaleViewport( stereoEyeParam.VP, sceneRenderScale );
+}
+
+OVR::Util::Render::Viewport RiftOnThePiApp::getCenterViewport( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const
+{
+	return scaleViewport( stereoEyeParam.VP, stereoEyeParam.pDistortion->Scale * mMultiResolutionCenterFraction );
+}
+
+OVR::Util::Render::Viewport RiftOnThePiApp::scaleViewport( const OVR::Util::Render::Viewport& VP, float scale )
+{
+	OVR::Util::Render::Viewport svp;
+	svp.w = (int)ceil(scale * VP.w);	// See void RenderDevice::SetViewport(const Viewport& vp) in RenderDevice.cpp
+	svp.h = (int)ceil(scale * VP.h);
+	svp.x = (int)ceil(scale * VP.x);
+	svp.y = (int)ceil(scale * VP.y);
+	return svp;
+}
+
+// Without waiting, the passes of consecutive frames can overlap on the GPU (given enough render 
+// targets), but the phase times then only measure how long it takes to submit them
+void RiftOnThePiApp::finishPass( const char* name )
+{
+	OGLES_GL_CHECK_PASS( name );
+	if ( !mForceFinish )
+		return;
+	glFlush();
+	check();
+	glFinish();
+	check();
+}
+
+bool RiftOnThePiApp::isDistortionScissorUsed() const
+{
+	return isDistortionScissorUsed<DynamicTechnique>();
+}
+
+template<int Technique> 
+bool RiftOnThePiApp::isDistortionScissorUsed() const
+{
+	const StereoRenderTechnique technique = getTechnique<Technique>();
+	return technique!=NoCorrection && mDistortionScissorEnabled && mEyeScissors[technique][0].w>0;
+}
+
+const OVR::Util::Render::Viewport& RiftOnThePiApp::getEyeScissor( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const
+{
+	return getEyeScissor<DynamicTechnique>( stereoEyeParam );
+}
+
+template<int Technique> 
+const OVR::Util::Render::Viewport& RiftOnThePiApp::getEyeScissor( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const
+{
+	return mEyeScissors[getTechnique<Technique>()][stereoEyeParam.Eye==OVR::Util::Render::StereoEye_Right ? 1 : 0];
+}
+
+bool RiftOnThePiApp::isMultiResolutionUsed() const
+{
+	return isMultiResolutionUsed<DynamicTechnique>();
+}
+
+template<int Technique> 
+bool RiftOnThePiApp::isMultiResolutionUsed() const
+{
+	return getTechnique<Technique>()!=NoCorrection && mMultiResolution && mCenterTexture!=0;
+}
+
+OVR::Matrix4f RiftOnThePiApp::getHeadMatrix() const
+{
+	// Rift orientation
+	OVR::Matrix4f headMat;
+	headMat.SetIdentity();
+	if ( mUseRiftOrientation && mDeviceStartupDone && (mSensorFusion || mBatchedSensorFusion) )
+	{
+		OVR::Quatf orientation = mSensorFusion ? mSensorFusion->GetOrientation() : mBatchedSensorFusion->getOrientation(); 
+		OVR::Matrix4f orientationMat = orientation;
+		headMat = orientationMat.Inverted();
 	}
+	return headMat;
+}
+
+OVR::Matrix4f RiftOnThePiApp::getBoxModel() const
+{
+	float x = 0.f; 
+	float y = 0.f;
+	float z = -3.f;
+	//float ax = mBoxAngleX / 360.f * (2.f * gPi);
+	float az = mBoxAngleY / 360.f * (2.f * gPi);
+	float ay = mBoxAngleZ / 360.f * (2.f * gPi);
+	OVR::Matrix4f modelMat;
+	modelMat.SetIdentity();
+	modelMat = OVR::Matrix4f::RotationZ(az) * modelMat;
+	modelMat = OVR::Matrix4f::RotationY(ay) * modelMat;
+	modelMat = OVR::Matrix4f::Translation( x, y, z ) * modelMat;
+	return modelMat;
+}
+
+float RiftOnThePiApp::getProjectionCenterOffset( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
+{
+	// The eye projection is Translation(offset, 0, 0) * centered projection, which only differs 
+	// from the centered projection by -offset in M[0][2]. In normalized device coordinates, the 
+	// eye sees what the center eye sees shifted by offset
+	return -stereoEyeParam.Projection.M[0][2];
+}
+
+bool RiftOnThePiApp::isFarFieldLayerUsed() const
+{
+	return mMonoFarField && mFarFieldTexture!=0 && mCopyProgram.program!=0 && mFarBoxCount>0;
+}
+
+void RiftOnThePiApp::drawFarFieldLayer( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
+{
+	OGLES_TRACE_SCOPE("farFieldPass");
+	OVR::UInt64 sceneStartTicks = OVR::Timer::GetTicks();
+	glBindFramebuffer(GL_FRAMEBUFFER, mFarFieldFrameBuffer);
+	check();
+	glViewport( 0, 0, mFarFieldWidth, mFarFieldHeight );
+	check();
+	glClearColor( 0.4f, 0.4f, 0.4f, 1.f );
+	check();
+	glClear( GL_COLOR_BUFFER_BIT );
+	check();
+
+	// Seen from the center eye (no ViewAdjust), with the projection of an eye recentered and 
+	// widened by the projection center offset on each side
+	float offset = getProjectionCenterOffset( stereoEyeParam );
+	OVR::Matrix4f projectionMat = stereoEyeParam.Projection;
+	projectionMat.M[0][2] = 0.f;
+	float widening = 1.f / (1.f + fabs(offset));
+	projectionMat = OVR::Matrix4f::Scaling( widening, 1.f, 1.f ) * projectionMat;
+	drawBoxes( projectionMat, mHeadMatrix, 0, mFarBoxCount );
+	finishPass( "farFieldPass" );
+	mPhaseTimes[PerformanceHud::ScenePhase] += static_cast<unsigned int>(OVR::Timer::GetTicks() - sceneStartTicks);
+}
+
+void RiftOnThePiApp::compositeFarField( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
+{
+	OGLES_TRACE_SCOPE("compositeFarField");
+
+	// Covers the whole eye viewport (bound by the caller) and replaces its content, the near 
+	// boxes are then drawn over it. The eye coordinate x maps to the layer coordinate 
+	// (x - offset) * widening, which in texture coordinates gives u' = s * u + t
+	float offset = getProjectionCenterOffset( stereoEyeParam );
+	float widening = 1.f / (1.f + fabs(offset));
+	float t = 0.5f * (1.f - widening) - 0.5f * offset * widening;
+	OVR::Matrix4f texm(	widening, 0, 0, t,
+						0, 1, 0, 0,
+						0, 0, 0, 0,
+						0, 0, 0, 1);
+
+	glDisable(GL_DEPTH_TEST);
+	check();
+	glUseProgram( mCopyProgram.program );
+	check();
+	glUniformMatrix4fv(mCopyProgram.texmUniform, 1, 0, reinterpret_cast<float*>( texm.Transposed().M ) );
+	check();
+	glActiveTexture( GL_TEXTURE0 );
+	check();
+	glBindTexture( GL_TEXTURE_2D, mFarFieldTexture );
+	check();
+	glUniform1i( mCopyProgram.texture0Uniform, 0 );
+	check();
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBufferQuad);
+	check();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBufferQuad);
+	check();
+	glVertexAttribPointer(mCopyProgram.positionAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), 0);
+	check();
+	glVertexAttribPointer(mCopyProgram.inputTexCoordAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), (GLvoid*) (sizeof(float) * 3));
+	check();
+	glEnableVertexAttribArray(mCopyProgram.positionAttrib);
+	check();
+	glEnableVertexAttribArray(mCopyProgram.inputTexCoordAttrib);
+	check();
+	glDrawElements(GL_TRIANGLES, sizeof(IndicesQuad)/sizeof(IndicesQuad[0]), GL_UNSIGNED_BYTE, 0);
+	check();
 }
 
-void RiftOnThePiApp::drawBox( const OVR::Matrix4f& projectionMat, const OVR::Matrix4f& viewAdjustMat )
+void RiftOnThePiApp::drawBoxes( const OVR::Matrix4f& projectionMat, const OVR::Matrix4f& viewMat, int firstBox, int boxCount )
 {  
+	OGLES_TRACE_SCOPE("drawBoxes");
 	glEnable(GL_CULL_FACE);
 	check();
 	glEnable(GL_DEPTH_TEST);
@@ -670,30 +2490,6 @@ void RiftOnThePiApp::drawBox( const OVR::Matrix4f& projectionMat, const OVR::Mat
 	glUniformMatrix4fv(mBoxProjectionUniform, 1, 0, reinterpret_cast<const float*>(projectionMat.Transposed().M) );		
 	check();
 
-	float x = 0.f; 
-	float y = 0.f;
-	float z = -3.f;
-	//float ax = mBoxAngleX / 360.f * (2.f * gPi);
-	float az = mBoxAngleY / 360.f * (2.f * gPi);
-	float ay = mBoxAngleZ / 360.f * (2.f * gPi);
-	OVR::Matrix4f modelViewMat;
-	modelViewMat.SetIdentity();
-	modelViewMat = OVR::Matrix4f::RotationZ(az) * modelViewMat;
-	modelViewMat = OVR::Matrix4f::RotationY(ay) * modelViewMat;
-	modelViewMat = OVR::Matrix4f::Translation( x, y, z ) * modelViewMat;
-	modelViewMat = viewAdjustMat * modelViewMat;
-	
-	// Rift orientation
-	if ( mUseRiftOrientation )
-	{
-		OVR::Quatf orientation = mSensorFusion->GetOrientation(); 
-		OVR::Matrix4f orientationMat = orientation;
-		modelViewMat = (orientationMat.Inverted()) * modelViewMat;
-	}
-
-	glUniformMatrix4fv(mBoxModelViewUniform, 1, 0, reinterpret_cast<float*>( modelViewMat.Transposed().M ) );
-	check();
-
 	glBindBuffer(GL_ARRAY_BUFFER, mVertexBufferBox);
 	check();
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBufferBox);
@@ -709,76 +2505,128 @@ void RiftOnThePiApp::drawBox( const OVR::Matrix4f& projectionMat, const OVR::Mat
 	glEnableVertexAttribArray(mBoxColorAttrib);
 	check();
 	
-	glDrawElements(GL_TRIANGLES, sizeof(IndicesBox)/sizeof(IndicesBox[0]), GL_UNSIGNED_BYTE, 0);
+	for ( int i=firstBox; i<firstBox+boxCount; ++i )
+	{
+		OVR::Matrix4f modelViewMat = viewMat * mBoxModels[i];
+		glUniformMatrix4fv(mBoxModelViewUniform, 1, 0, reinterpret_cast<float*>( modelViewMat.Transposed().M ) );
+		check();
+		glDrawElements(GL_TRIANGLES, sizeof(IndicesBox)/sizeof(IndicesBox[0]), GL_UNSIGNED_BYTE, 0);
+		check();
+	}
+}
+
+void RiftOnThePiApp::drawStereoBoxes( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye, const OVR::Util::Render::Viewport& sceneVP, int firstBox, int boxCount )
+{  
+	OGLES_TRACE_SCOPE("drawStereoBoxes");
+	glEnable(GL_CULL_FACE);
+	check();
+	glEnable(GL_DEPTH_TEST);
+	check();
+	glDepthFunc(GL_LEQUAL);
+	check();
+
+	glUseProgram( mShaderProgramStereoBox );
+	check();
+
+	const OVR::Util::Render::StereoEyeParams* eyes[2] = { &leftEye, &rightEye };
+	OVR::Matrix4f viewMats[2];
+	float projections[2][16];
+	float clipTransforms[2][2];
+	for ( int i=0; i<2; ++i )
+	{
+		viewMats[i] = mHeadMatrix * eyes[i]->ViewAdjust;
+		OVR::Matrix4f projectionMat = eyes[i]->Projection.Transposed();
+		memcpy( projections[i], projectionMat.M, sizeof(projections[i]) );
+
+		// From the clip space of the eye viewport to the clip space of the whole scene viewport
+		OVR::Util::Render::Viewport eyeVP = getSceneViewport( *eyes[i] );
+		float scale = static_cast<float>(eyeVP.w) / sceneVP.w;
+		float center = ( (eyeVP.x - sceneVP.x) + eyeVP.w * 0.5f ) / sceneVP.w * 2.f - 1.f;
+		clipTransforms[i][0] = scale;
+		clipTransforms[i][1] = center;
+	}
+	glUniformMatrix4fv(mStereoBoxProjectionUniform, 2, 0, &projections[0][0] );		
+	check();
+	glUniform2fv(mStereoBoxClipTransformUniform, 2, &clipTransforms[0][0] );
+	check();
+
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBufferStereoBox);
+	check();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBufferStereoBox);
+	check();
+			
+	// Define the vertex format
+	glVertexAttribPointer(mStereoBoxPositionAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(VertexWithColorAndEye), 0);
+	check();
+	glVertexAttribPointer(mStereoBoxColorAttrib, 4, GL_FLOAT, GL_FALSE, sizeof(VertexWithColorAndEye), (GLvoid*) (sizeof(float) * 3));
+	check();
+	glVertexAttribPointer(mStereoBoxEyeIndexAttrib, 1, GL_FLOAT, GL_FALSE, sizeof(VertexWithColorAndEye), (GLvoid*) (sizeof(float) * 7));
+	check();
+	glEnableVertexAttribArray(mStereoBoxPositionAttrib);
+	check();
+	glEnableVertexAttribArray(mStereoBoxColorAttrib);
+	check();
+	glEnableVertexAttribArray(mStereoBoxEyeIndexAttrib);
+	check();
+	
+	// One draw per box, covering both eyes
+	for ( int i=firstBox; i<firstBox+boxCount; ++i )
+	{
+		float modelViews[2][16];
+		for ( int eye=0; eye<2; ++eye )
+		{
+			OVR::Matrix4f modelViewMat = (viewMats[eye] * mBoxModels[i]).Transposed();
+			memcpy( modelViews[eye], modelViewMat.M, sizeof(modelViews[eye]) );
+		}
+		glUniformMatrix4fv(mStereoBoxModelViewUniform, 2, 0, &modelViews[0][0] );
+		check();
+		glDrawElements(GL_TRIANGLES, 2 * sizeof(IndicesBox)/sizeof(IndicesBox[0]), GL_UNSIGNED_BYTE, 0);
+		check();
+	}
+
+	// The other programs don't feed it
+	glDisableVertexAttribArray(mStereoBoxEyeIndexAttrib);
 	check();
 }
 
-void RiftOnThePiApp::drawQuad( const OVR::Util::Render::Viewport& VP, const OVR::Util::Render::DistortionConfig& distortionConfig )		
+template<int Technique> 
+void RiftOnThePiApp::drawQuad( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )		
 {
-	glUseProgram( mShaderProgramQuad );
+	const StereoRenderTechnique technique = getTechnique<Technique>();
+	OGLES_TRACE_SCOPE("drawQuad");
+	const QuadProgram& quadProgram = mQuadPrograms[technique];
+	glUseProgram( quadProgram.program );
 	check();
 	
-	float w = float(VP.w) / float(mScreenHResolution);
-	float h = float(VP.h) / float(mScreenVResolution);
-	float x = float(VP.x) / float(mScreenHResolution);
-	float y = float(VP.y) / float(mScreenVResolution);
-	if ( mStereoRenderTechnique!=NoCorrection )
-	{
-		OVR::Matrix4f texm(	w, 0, 0, x,
-						0, h, 0, y,
+	const DistortionParams& params = mEyeDistortionParams[technique][stereoEyeParam.Eye==OVR::Util::Render::StereoEye_Right ? 1 : 0];
+	if ( technique!=NoCorrection )
+	{
+		OVR::Matrix4f texm(	params.texm[0], 0, 0, params.texm[2],
+						0, params.texm[1], 0, params.texm[3],
 						0, 0, 0, 0,
 						0, 0, 0, 1);
-		glUniformMatrix4fv(mQuadTexmUniform, 1, 0, reinterpret_cast<float*>( texm.Transposed().M ) );
+		glUniformMatrix4fv(quadProgram.texmUniform, 1, 0, reinterpret_cast<float*>( texm.Transposed().M ) );
 		check();
 	}
 
-	if ( mStereoRenderTechnique==RenderTextureDistortionCorrection ||
-		 mStereoRenderTechnique==RenderTextureDistortionAndChromaCorrection )
+	if ( technique==RenderTextureDistortionCorrection ||
+		 technique==RenderTextureDistortionAndChromaCorrection )
 	{
-		float as = float(VP.w) / float(VP.h);
-		float scaleFactor = 1.0f / distortionConfig.Scale;		
-
-		float lensCenter[2];
-		lensCenter[0] = x + (w + distortionConfig.XCenterOffset * 0.5f)*0.5f;
-		lensCenter[1] = y + h * 0.5f;
-		glUniform2fv(mQuadLensCenterUniform, 1, lensCenter  );
+		glUniform2fv(quadProgram.lensCenterUniform, 1, params.lensCenter );
 		check();
-		
-		float screenCenterCenter[2];
-		screenCenterCenter[0] = x + w*0.5f;
-		screenCenterCenter[1] = y + h*0.5f;
-		glUniform2fv(mQuadScreenCenterCenterUniform, 1, screenCenterCenter  );
+		glUniform2fv(quadProgram.screenCenterUniform, 1, params.screenCenter );
 		check();
-
-		float scaleCenter[2];
-		scaleCenter[0] = (w/2.f) * scaleFactor;
-		scaleCenter[1] = (h/2.f) * scaleFactor * as;
-		glUniform2fv(mQuadScaleCenterUniform, 1, scaleCenter  );
+		glUniform2fv(quadProgram.scaleUniform, 1, params.scale );
 		check();
-		
-		float scaleInCenter[2];
-		scaleInCenter[0] = (2.f/w);
-		scaleInCenter[1] = (2.f/h) / as;
-		glUniform2fv(mQuadScaleInCenterUniform, 1, scaleInCenter  );
+		glUniform2fv(quadProgram.scaleInUniform, 1, params.scaleIn );
 		check();
-	
-		float hmdWarpParamCenter[4];
-		hmdWarpParamCenter[0] = distortionConfig.K[0];
-		hmdWarpParamCenter[1] = distortionConfig.K[1];
-		hmdWarpParamCenter[2] = distortionConfig.K[2];
-		hmdWarpParamCenter[3] = distortionConfig.K[3];
-		glUniform4fv(mQuadHmdWarpParamCenterUniform, 1, hmdWarpParamCenter );
+		glUniform4fv(quadProgram.hmdWarpParamUniform, 1, params.hmdWarpParam );
 		check();
 	}
 	
-	if ( mStereoRenderTechnique==RenderTextureDistortionAndChromaCorrection )
+	if ( technique==RenderTextureDistortionAndChromaCorrection )
 	{
-		float chromAbParam[4];
-		chromAbParam[0] = distortionConfig.ChromaticAberration[0];
-		chromAbParam[1] = distortionConfig.ChromaticAberration[1];
-		chromAbParam[2] = distortionConfig.ChromaticAberration[2];
-		chromAbParam[3] = distortionConfig.ChromaticAberration[3];
-		glUniform4fv(mQuadChromAbParamUniform, 1, chromAbParam );
+		glUniform4fv(quadProgram.chromAbParamUniform, 1, params.chromAbParam );
 		check();
 	}
 	
@@ -786,8 +2634,34 @@ void RiftOnThePiApp::drawQuad( const OVR::Util::Render::Viewport& VP, const OVR:
 	check();
 	glBindTexture( GL_TEXTURE_2D, mTexture );
 	check();
-	glUniform1i( mQuadTexture0Uniform, 0 );
+	glUniform1i( quadProgram.texture0Uniform, 0 );
 	check();
+	if ( isMultiResolutionUsed<Technique>() )
+	{
+		// From the eye region of mTexture to the same region of mCenterTexture, which only covers 
+		// mMultiResolutionCenterFraction of it, centered on the lens (offset by the projection 
+		// center offset, a quarter of the texture being half an eye)
+		float scale = 1.f / mMultiResolutionCenterFraction;
+		float lensOffset = getProjectionCenterOffset( stereoEyeParam ) * 0.25f;
+		const float* eyeCenter = params.screenCenter;
+		float centerTransform[4] = {	scale, 
+										scale, 
+										eyeCenter[0] - (eyeCenter[0] + lensOffset) * scale, 
+										eyeCenter[1] - eyeCenter[1] * scale };
+		float centerBounds[4] = { eyeCenter[0] - 0.25f, 0.f, eyeCenter[0] + 0.25f, 1.f };
+		glUniform4fv( quadProgram.centerTransformUniform, 1, centerTransform );
+		check();
+		glUniform4fv( quadProgram.centerBoundsUniform, 1, centerBounds );
+		check();
+		glActiveTexture( GL_TEXTURE1 );
+		check();
+		glBindTexture( GL_TEXTURE_2D, mCenterTexture );
+		check();
+		glUniform1i( quadProgram.texture1Uniform, 1 );
+		check();
+		glActiveTexture( GL_TEXTURE0 );
+		check();
+	}
 	//glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 	//glEnable(GL_BLEND);
 	glBindBuffer(GL_ARRAY_BUFFER, mVertexBufferQuad);
@@ -796,18 +2670,469 @@ void RiftOnThePiApp::drawQuad( const OVR::Util::Render::Viewport& VP, const OVR:
 	check();
 	
 	check();
-	glVertexAttribPointer(mQuadPositionAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), 0);
+	glVertexAttribPointer(quadProgram.positionAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), 0);
 	check();
-	glVertexAttribPointer(mQuadInputTexCoordAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), (GLvoid*) (sizeof(float) * 3));
+	glVertexAttribPointer(quadProgram.inputTexCoordAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), (GLvoid*) (sizeof(float) * 3));
 	check();
 	
-	glEnableVertexAttribArray(mQuadPositionAttrib);
+	glEnableVertexAttribArray(quadProgram.positionAttrib);
 	check();
-	glEnableVertexAttribArray(mQuadInputTexCoordAttrib);
+	glEnableVertexAttribArray(quadProgram.inputTexCoordAttrib);
 	check();
 	glDrawElements(GL_TRIANGLES, sizeof(IndicesQuad)/sizeof(IndicesQuad[0]), GL_UNSIGNED_BYTE, 0);
 	check();
 	//glDisable(GL_BLEND);
 }
 
-}
\ No newline at end of file
+void RiftOnThePiApp::drawHud( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye )
+{
+	OGLES_TRACE_SCOPE("drawHud");
+	if ( mTelemetrySample.time!=0 )
+		mHud.setTelemetry( mTelemetrySample.getMaxTemperature(), mTelemetrySample.getMinCpuFrequency() );
+	else
+		mHud.setTelemetry( -1.f, -1 );
+	mHud.update( leftEye.VP.w, leftEye.VP.h );
+
+	// Drawn on top of the final image, centered on each lens. XCenterOffset is the lens
+	// center in the normalized device coordinates of the eye viewport
+	glBindFramebuffer(GL_FRAMEBUFFER, mOutputFrameBuffer);
+	check();
+	const OVR::Util::Render::StereoEyeParams* eyes[2] = { &leftEye, &rightEye };
+	for ( int i=0; i<2; ++i )
+	{
+		const OVR::Util::Render::Viewport& VP = eyes[i]->VP;
+		glViewport( VP.x, VP.y, VP.w, VP.h );
+		check();
+		mHud.draw( getEyeDistortionConfig(*eyes[i]).XCenterOffset );
+	}
+	finishPass( "hudPass" );
+}
+
+DistortionReference::Program RiftOnThePiApp::getDistortionProgram( StereoRenderTechnique technique )
+{
+	if ( technique==RenderTextureDistortionCorrection )
+		return DistortionReference::Distortion;
+	if ( technique==RenderTextureDistortionAndChromaCorrection )
+		return DistortionReference::DistortionAndChroma;
+	return DistortionReference::Copy;
+}
+
+OVR::Util::Render::DistortionConfig RiftOnThePiApp::getEyeDistortionConfig( const OVR::Util::Render::StereoEyeParams& stereoEyeParam )
+{
+	// The sign of the Distortion.XCenterOffset value must be chagned for the right eye. 
+	// This tweak is done in Render_Tiny::SetDistortionConfig().
+	// It's weird this isn't taken care of by the StereoEyeParam object!
+	OVR::Util::Render::DistortionConfig distortionConfig = *stereoEyeParam.pDistortion;
+	if ( stereoEyeParam.Eye==OVR::Util::Render::StereoEye_Right )
+		distortionConfig.XCenterOffset = -distortionConfig.XCenterOffset;
+	return distortionConfig;
+}
+
+// Called at the start of each frame: what's counted covers a whole frame, including the swap and 
+// whatever the runner does between two frames. Frames that rebuilt resources, validated the 
+// distortion or wrote the trace are expected to allocate and aren't held against the loop
+void RiftOnThePiApp::auditAllocations()
+{
+	if ( mAllocationAuditFrame<=0 || mCounter<mAllocationAuditFrame )
+		return;
+	int endFrame = mAllocationAuditFrame + mAllocationAuditFrameCount;
+	if ( mCounter>endFrame )
+		return;
+	if ( mCounter==mAllocationAuditFrame )
+	{
+		printf("AllocationAudit: counting the allocations of frames %d to %d\n", mAllocationAuditFrame, endFrame - 1 );
+		mAllocationAuditExcused = false;
+		mAllocationAuditFailedFrames = 0;
+		mAllocationAuditExcusedFrames = 0;
+		AllocationAudit::begin();
+		return;
+	}
+
+	AllocationAudit::Counts counts = AllocationAudit::end();
+	if ( mAllocationAuditExcused )
+	{
+		mAllocationAuditExcusedFrames++;
+	}
+	else if ( counts.getTotal()>0 )
+	{
+		mAllocationAuditFailedFrames++;
+		printf("AllocationAudit: frame %d made %u allocations (%u new, %u LibOVR), %lu bytes\n", 
+			mCounter - 1, counts.getTotal(), counts.newCount, counts.ovrCount, static_cast<unsigned long>(counts.bytes) );
+	}
+	mAllocationAuditExcused = false;
+
+	if ( mCounter<endFrame )
+	{
+		AllocationAudit::begin();
+		return;
+	}
+	printf("AllocationAudit: %d frames, %d with allocations, %d excused: %s\n", mAllocationAuditFrameCount, 
+		mAllocationAuditFailedFrames, mAllocationAuditExcusedFrames, mAllocationAuditFailedFrames==0 ? "PASSED" : "FAILED" );
+	if ( mAllocationAuditFailedFrames>0 )
+		mChecksFailed = true;
+}
+
+void RiftOnThePiApp::validateDistortion()
+{
+	OGLES_TRACE_SCOPE("validateDistortion");
+	printf("validateDistortion (frame %d)\n", mCounter );
+	mAllocationAuditExcused = true;
+	if ( mStereoRenderTechnique==NoCorrection )
+	{
+		printf("Validation: not applicable, there's no render texture with this technique\n");
+		return;
+	}
+	if ( isMultiResolutionUsed() )
+	{
+		printf("Validation: not applicable, the reference implementation reads a single render texture\n");
+		return;
+	}
+
+	DistortionReference::Program program = getDistortionProgram( mStereoRenderTechnique );
+
+	// Read back what the scene pass rendered into the texture...
+	Image textureImage( mTextureWidth, mTextureHeight );
+	glBindFramebuffer(GL_FRAMEBUFFER, mTextureFrameBuffer);
+	check();
+	glReadPixels( 0, 0, mTextureWidth, mTextureHeight, GL_RGBA, GL_UNSIGNED_BYTE, textureImage.getPixels() );
+	check();
+
+	// ... and what the quad pass produced on screen
+	Image screenImage( mScreenHResolution, mScreenVResolution );
+	glBindFramebuffer(GL_FRAMEBUFFER, mOutputFrameBuffer);
+	check();
+	glReadPixels( 0, 0, mScreenHResolution, mScreenVResolution, GL_RGBA, GL_UNSIGNED_BYTE, screenImage.getPixels() );
+	check();
+
+	TaskPool taskPool;
+	Image referenceImage( mScreenHResolution, mScreenVResolution );
+	
+	const OVR::Util::Render::StereoEye eyes[2] = { OVR::Util::Render::StereoEye_Left, OVR::Util::Render::StereoEye_Right };
+	const char* eyeNames[2] = { "left", "right" };
+	bool passed = true;
+	for ( int i=0; i<2; ++i )
+	{
+		const OVR::Util::Render::StereoEyeParams& stereoEyeParam = mStereoConfig.GetEyeRenderParams( eyes[i] );
+		DistortionParams params = DistortionReference::computeParams( stereoEyeParam.VP, mScreenHResolution, mScreenVResolution, 
+																	  getEyeDistortionConfig(stereoEyeParam) );
+		
+		unsigned int startTime = OVR::Timer::GetTicksMs();
+		DistortionReference::warp( program, params, textureImage, stereoEyeParam.VP, referenceImage, &taskPool );
+		unsigned int warpTime = OVR::Timer::GetTicksMs() - startTime;
+		
+		// Nearest texel lookups that land right on a texel boundary can go either way on the GPU,
+		// so isolated pixels may legitimately differ a lot. PSNR is the main criteria
+		ImageError error = DistortionReference::computeError( screenImage, referenceImage, stereoEyeParam.VP );
+		bool eyePassed = error.psnr>=mValidationMinPSNR && error.percentileError<=mValidationMaxError;
+		printf("Validation %s eye: psnr:%.2fdB maxError:%d (99.9%%:%d) mismatch:%d/%d cpu:%dms threads:%d %s\n", 
+			eyeNames[i], error.psnr, error.maxError, error.percentileError, error.mismatchCount, error.pixelCount, 
+			warpTime, taskPool.getThreadCount(), eyePassed ? "PASSED" : "FAILED" );
+		passed = passed && eyePassed;
+	}
+	printf("Validation: %s\n", passed ? "PASSED" : "FAILED" );
+	if ( !passed )
+		mChecksFailed = true;
+}
+
+
+void RiftOnThePiApp::startTelemetry()
+{
+	mTelemetrySampler.stop();
+	mTelemetrySample = TelemetrySampler::Sample();
+	if ( mTelemetryInterval<=0 )
+		return;
+	mTelemetrySampler.start( mTelemetrySysRoot, mTelemetryProcRoot, static_cast<unsigned int>(mTelemetryInterval) );
+}
+
+void RiftOnThePiApp::openFrameLog()
+{
+	closeFrameLog();
+	if ( mFrameLog.empty() )
+		return;
+	mFrameLogFile = fopen( mFrameLog.c_str(), "w" );
+	if ( !mFrameLogFile )
+	{
+		printf("Failed to open frame log %s\n", mFrameLog.c_str() );
+		return;
+	}
+	fprintf( mFrameLogFile, "frame,technique,drawUs,swapUs,recordUs,telemetryTimeMs,temperature,cpuFrequencyKHz,processCpu\n" );
+}
+
+void RiftOnThePiApp::closeFrameLog()
+{
+	if ( !mFrameLogFile )
+		return;
+	fclose( mFrameLogFile );
+	mFrameLogFile = NULL;
+}
+
+void RiftOnThePiApp::logFrame( unsigned int drawTime, unsigned int swapTime )
+{
+	// Each frame is tagged with the latest telemetry sample, whose time tells how old it is.
+	// The stdio buffer keeps this to one write every few dozens of frames
+	const TelemetrySampler::Sample& sample = mTelemetrySample;
+	fprintf( mFrameLogFile, "%d,%d,%u,%u,%u,%u,%.1f,%d,%.1f\n", mCounter-1, mStereoRenderTechnique, drawTime, swapTime, 
+		mPhaseTimes[PerformanceHud::RecordPhase], sample.time, sample.getMaxTemperature(), sample.getMinCpuFrequency(), sample.processCpuUsage );
+}
+
+void RiftOnThePiApp::startHIDReportReader()
+{
+	if ( mSensorDevice.empty() && !mSimulatedSensorDevice )
+		return;
+
+	// The reports read here only make sense to the batched fusion, which takes their samples in bulk
+	if ( !mBatchedSensorFusion )
+		mBatchedSensorFusion = new BatchedSensorFusion();
+	if ( mSimulatedSensorDevice )
+	{
+		if ( !mSimulatedTrackerDevice.start( mSimulatedSensorBurst ) )
+			return;
+		if ( !mHIDReportReader.start( mSimulatedTrackerDevice.takeReadFd(), mBatchedSensorFusion ) )
+			mSimulatedTrackerDevice.stop();
+	}
+	else
+	{
+		mHIDReportReader.start( mSensorDevice, mBatchedSensorFusion );
+	}
+}
+
+void RiftOnThePiApp::startMetricsServer()
+{
+	mMetricsServer.stop();
+	mMetricsFrameTimes.reset();
+	mMetricsDrawTimes.reset();
+	mMetricsLastTime = 0;
+	if ( mMetricsSocket.empty() )
+		return;
+	mMetricsServer.start( mMetricsSocket );
+}
+
+void RiftOnThePiApp::publishMetrics( unsigned int time )
+{
+	// Only fixed size copies here, the server thread does the formatting
+	MetricsServer::Snapshot snapshot;
+	float elapsed = mMetricsLastTime!=0 ? (time - mMetricsLastTime) / 1000.f : 0.f;
+	snapshot.time = mStartupProfile.getElapsedTime();
+	snapshot.frameCount = mMetricsFrameCount;
+	snapshot.droppedFrameCount = mMetricsDroppedFrameCount;
+	snapshot.frameRate = elapsed>0.f ? mMetricsFrameTimes.getCount() / elapsed : 0.f;
+	for ( int i=0; i<MetricsServer::QuantileCount; ++i )
+	{
+		float percentile = MetricsServer::getQuantile(i) * 100.f;
+		snapshot.frameTimes[i] = (percentile<100.f ? mMetricsFrameTimes.getPercentile(percentile) : mMetricsFrameTimes.getMax()) / 1000000.f;
+		snapshot.drawTimes[i] = (percentile<100.f ? mMetricsDrawTimes.getPercentile(percentile) : mMetricsDrawTimes.getMax()) / 1000000.f;
+	}
+	snapshot.stereoRenderTechnique = mStereoRenderTechnique;
+
+	// The samples integrated by the batched fusion, else those the handler forwarded to the SensorFusion
+	unsigned int sensorSampleCount = mMetricsSensorSampleCount;
+	if ( mSensorMessageHandler && !mBatchedSensorFusion )
+		sensorSampleCount = mSensorMessageHandler->getBodyFrameCount();
+	snapshot.sensorSampleCount = sensorSampleCount;
+	snapshot.sensorSampleRate = elapsed>0.f ? (sensorSampleCount - mMetricsLastSensorSampleCount) / elapsed : 0.f;
+	mMetricsLastSensorSampleCount = sensorSampleCount;
+
+	for ( int i=0; i<StartupProfile::PhaseCount; ++i )
+		snapshot.startupPhaseTimes[i] = static_cast<float>( mStartupProfile.getDuration( static_cast<StartupProfile::Phase>(i) ) );
+	snapshot.thermalZoneCount = mTelemetrySample.thermalZoneCount;
+	memcpy( snapshot.temperatures, mTelemetrySample.temperatures, sizeof(snapshot.temperatures) );
+	snapshot.cpuCount = mTelemetrySample.cpuCount;
+	memcpy( snapshot.cpuFrequencies, mTelemetrySample.cpuFrequencies, sizeof(snapshot.cpuFrequencies) );
+	mMetricsServer.publish( snapshot );
+
+	mMetricsFrameTimes.reset();
+	mMetricsDrawTimes.reset();
+	mMetricsLastTime = time;
+}
+
+void RiftOnThePiApp::startRecording()
+{
+	mFrameRecorder.stop();
+	mRecordTimeSum = 0;
+	mRecordedFrames = 0;
+	if ( mRecordFile.empty() )
+		return;
+	if ( mRecordInterval<1 )
+	{
+		printf("RecordInterval %d is not supported, using 1\n", mRecordInterval );
+		mRecordInterval = 1;
+	}
+	mFrameRecorder.start( mRecordFile, mScreenHResolution, mScreenVResolution, mRecordBufferCount, mRecordFrameRate, mRecordInterval );
+}
+
+// GLES 2 has no asynchronous readback, so glReadPixels waits for the frame to be drawn. Everything 
+// else (conversion, file writes) is left to the recorder's thread, and when it's behind the frame 
+// isn't even read back
+void RiftOnThePiApp::recordFrame()
+{
+	OGLES_TRACE_SCOPE("recordFrame");
+	unsigned char* buffer = mFrameRecorder.acquireBuffer();
+	if ( !buffer )
+		return;
+	glBindFramebuffer(GL_FRAMEBUFFER, mOutputFrameBuffer);
+	check();
+	glReadPixels( 0, 0, mFrameRecorder.getWidth(), mFrameRecorder.getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, buffer );
+	check();
+	mFrameRecorder.submitBuffer( buffer );
+	mRecordedFrames++;
+}
+
+// Rather than a second EGL surface, the view goes to a frame buffer object of the same context: no 
+// surface switch, and the render texture of the frame is there to be copied from
+void RiftOnThePiApp::drawSpectator( const OVR::Util::Render::StereoEyeParams& eye )
+{
+	OGLES_TRACE_SCOPE("spectatorPass");
+	glBindFramebuffer(GL_FRAMEBUFFER, mSpectatorFrameBuffer);
+	check();
+	glViewport( 0, 0, mSpectatorWidth, mSpectatorHeight );
+	check();
+
+	// From the quad texture coordinates to the scene of the eye in the render texture
+	OVR::Util::Render::Viewport svp = getSceneViewport( eye );
+	float sx = static_cast<float>(svp.w) / mTextureWidth;
+	float sy = static_cast<float>(svp.h) / mTextureHeight;
+	float tx = static_cast<float>(svp.x) / mTextureWidth;
+	float ty = static_cast<float>(svp.y) / mTextureHeight;
+	OVR::Matrix4f texm(	sx, 0, 0, tx,
+						0, sy, 0, ty,
+						0, 0, 0, 0,
+						0, 0, 0, 1);
+
+	glDisable(GL_DEPTH_TEST);
+	check();
+	glUseProgram( mCopyProgram.program );
+	check();
+	glUniformMatrix4fv(mCopyProgram.texmUniform, 1, 0, reinterpret_cast<float*>( texm.Transposed().M ) );
+	check();
+	glActiveTexture( GL_TEXTURE0 );
+	check();
+	glBindTexture( GL_TEXTURE_2D, mTexture );
+	check();
+	glUniform1i( mCopyProgram.texture0Uniform, 0 );
+	check();
+	glBindBuffer(GL_ARRAY_BUFFER, mVertexBufferQuad);
+	check();
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBufferQuad);
+	check();
+	glVertexAttribPointer(mCopyProgram.positionAttrib, 3, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), 0);
+	check();
+	glVertexAttribPointer(mCopyProgram.inputTexCoordAttrib, 2, GL_FLOAT, GL_FALSE, sizeof(VertexWithUV), (GLvoid*) (sizeof(float) * 3));
+	check();
+	glEnableVertexAttribArray(mCopyProgram.positionAttrib);
+	check();
+	glEnableVertexAttribArray(mCopyProgram.inputTexCoordAttrib);
+	check();
+	glDrawElements(GL_TRIANGLES, sizeof(IndicesQuad)/sizeof(IndicesQuad[0]), GL_UNSIGNED_BYTE, 0);
+	check();
+	finishPass( "spectatorPass" );
+}
+
+// Like the recorded frames, read back straight away (from the target drawSpectator left bound) and 
+// written by the recorder's thread
+void RiftOnThePiApp::readSpectator()
+{
+	OGLES_TRACE_SCOPE("spectatorReadback");
+	unsigned char* buffer = mSpectatorRecorder.acquireBuffer();
+	if ( buffer )
+	{
+		glReadPixels( 0, 0, mSpectatorWidth, mSpectatorHeight, GL_RGBA, GL_UNSIGNED_BYTE, buffer );
+		check();
+		mSpectatorRecorder.submitBuffer( buffer );
+	}
+	glBindFramebuffer(GL_FRAMEBUFFER, mOutputFrameBuffer);
+	check();
+}
+
+void RiftOnThePiApp::startTrace()
+{
+	if ( mTraceFile.empty() || mTraceEndFrame>=0 )
+		return;
+	if ( !Trace::isCompiledIn() )
+	{
+		printf("Tracing isn't compiled in, rebuild with -DENABLE_TRACE=ON\n");
+		return;
+	}
+	if ( Trace::start( mTraceEventsPerThread ) )
+	{
+		mTraceEndFrame = mCounter + mTraceFrameCount;
+		printf("Tracing %d frames into %s\n", mTraceFrameCount, mTraceFile.c_str() );
+	}
+}
+
+void RiftOnThePiApp::writeTrace()
+{
+	mAllocationAuditExcused = true;
+	Trace::stop();
+	Trace::writeChromeJson( mTraceFile );
+	mTraceEndFrame = -1;
+}
+
+void RiftOnThePiApp::setupLatencyTester()
+{
+	mLatencyUtil.SetDevice( NULL );
+	mLatencyTester.Clear();
+	mSimulatedLatencyTester.stop();
+
+	if ( mLatencyTesterMode==DeviceLatencyTester )
+	{
+		mLatencyTester = *mDeviceManager->EnumerateDevices<OVR::LatencyTestDevice>().CreateDevice();
+		if ( mLatencyTester && mLatencyUtil.SetDevice( mLatencyTester ) )
+		{
+			printf("Latency tester found, press its button to start a test\n");
+		}
+		else
+		{
+			printf("No latency tester found\n");
+			mLatencyTester.Clear();
+		}
+	}
+	else if ( mLatencyTesterMode==SimulatedLatencyTesterMode )
+	{
+		unsigned int displayDelay = static_cast<unsigned int>( std::max( mSimulatedDisplayDelay, 0.f ) * 1000.f );
+		unsigned int testInterval = static_cast<unsigned int>( std::max( mSimulatedLatencyTestInterval, 0 ) );
+		mSimulatedLatencyTester.start( displayDelay, testInterval );
+		printf("Simulated latency tester started (display delay %.1fms)\n", mSimulatedDisplayDelay );
+	}
+}
+
+void RiftOnThePiApp::drawLatencyPatch( const OVR::Color& color, const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye )
+{
+	OGLES_TRACE_SCOPE("drawLatencyPatch");
+
+	// The tester sits on one of the lenses, so a square is cleared to the color at the center 
+	// of each lens. It's a scissored clear: no program or geometry needed
+	glBindFramebuffer(GL_FRAMEBUFFER, mOutputFrameBuffer);
+	check();
+	glClearColor( color.R / 255.f, color.G / 255.f, color.B / 255.f, 1.f );
+	check();
+	glEnable(GL_SCISSOR_TEST);
+	check();
+	const OVR::Util::Render::StereoEyeParams* eyes[2] = { &leftEye, &rightEye };
+	for ( int i=0; i<2; ++i )
+	{
+		const OVR::Util::Render::Viewport& VP = eyes[i]->VP;
+		float lensCenterX = VP.x + VP.w * 0.5f * ( 1.f + getEyeDistortionConfig(*eyes[i]).XCenterOffset );
+		float lensCenterY = VP.y + VP.h * 0.5f;
+		int size = VP.w * 2 / 5;
+		glScissor( static_cast<GLint>(lensCenterX) - size/2, static_cast<GLint>(lensCenterY) - size/2, size, size );
+		check();
+		glClear( GL_COLOR_BUFFER_BIT );
+		check();
+	}
+	glDisable(GL_SCISSOR_TEST);
+	check();
+}
+
+void RiftOnThePiApp::reportLatency( const char* results )
+{
+	if ( !results )
+		return;
+
+	// Both testers start their results with "RESULT=<average in ms>", which goes in the benchmark 
+	// statistics of the technique being measured
+	printf("latency (technique %d): %s\n", mStereoRenderTechnique, results );
+	float latency = 0.f;
+	if ( isBenchmarking() && sscanf( results, "RESULT=%f", &latency )==1 && latency>0.f )
+		mBenchmarkStats[mStereoRenderTechnique].latency.add( static_cast<unsigned int>(latency * 1000.f) );
+}
+}
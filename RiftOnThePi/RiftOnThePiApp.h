@@ -23,13 +23,30 @@
 */
 #pragma once
 
+#include <stdio.h>
+#include <vector>
+
 #include "OGLESApplication.h"
+#include "OGLESParameterRegistry.h"
+#include "FrameStats.h"
+#include "TelemetrySampler.h"
+#include "FrameRecorder.h"
+#include "PerformanceHud.h"
+#include "SensorMessageHandler.h"
+#include "SimulatedLatencyTester.h"
+#include "HIDReportReader.h"
+#include "SimulatedTrackerDevice.h"
+#include "StartupProfile.h"
+#include "MetricsServer.h"
+#include "DistortionReference.h"
 
 #include "OVR.h"
 
 namespace OGLESSandbox
 {
 
+class TaskPool;
+
 class RiftOnThePiApp : public Application
 {
 public:
@@ -40,69 +57,418 @@ public:
 													// For benchmark/test purpose only as final image isn't exactly Rift-correct
 		RenderTextureDistortionCorrection,			// For each eye, the scene is rendered in a texture first then on screen with a shader that corrects distortion
 		RenderTextureDistortionAndChromaCorrection,	// For each eye, the scene is rendered in a texture first then on screen with a shader that corrects distortion and chromatic aberration
+		StereoRenderTechniqueCount
 	};
 
 	RiftOnThePiApp();
+	virtual ~RiftOnThePiApp();
+	virtual EGLConfigRequest getEGLConfigRequest( const ApplicationContext& context );
 	virtual bool initialize( const ApplicationContext& context );
 	virtual void draw( const ApplicationContext& context );
+	virtual bool isDone() const;
+	virtual int getExitStatus() const { return mChecksFailed ? 1 : 0; }
 
 private:
+	// What has to be rebuilt when a parameter changes
+	enum ParameterDependency
+	{
+		StereoConfigDependency		= 1 << 0,
+		ShaderProgramsDependency	= 1 << 1,
+		GeometriesDependency		= 1 << 2,
+		TextureDependency			= 1 << 3,
+		BenchmarkDependency			= 1 << 4,
+		TelemetryDependency			= 1 << 5,
+		FrameLogDependency			= 1 << 6,
+		HudDependency				= 1 << 7,
+		TraceDependency				= 1 << 8,
+		LatencyTesterDependency		= 1 << 9,
+		ScissorDependency			= 1 << 10,
+		GLCheckDependency			= 1 << 11,
+		RecordDependency			= 1 << 12,
+		SpectatorDependency			= 1 << 13,
+		MetricsDependency			= 1 << 14,
+		DrawDispatchDependency		= 1 << 15,
+		ConfigFileDependency		= 1 << 16
+	};
+
+	enum LatencyTesterMode
+	{
+		NoLatencyTester,
+		DeviceLatencyTester,						// The Oculus latency tester, a test starts when its button is pressed
+		SimulatedLatencyTesterMode					// See SimulatedLatencyTester
+	};
+
+	// The quad program and its locations, one per technique so that they can all be resident
+	struct QuadProgram
+	{
+		QuadProgram();
+
+		GLuint	program;
+		GLint	texmUniform;
+		GLint	lensCenterUniform;
+		GLint	screenCenterUniform;
+		GLint	scaleUniform;
+		GLint	scaleInUniform;
+		GLint	hmdWarpParamUniform;
+		GLint	chromAbParamUniform;
+		GLint	texture0Uniform;
+		GLint	texture1Uniform;
+		GLint	centerTransformUniform;
+		GLint	centerBoundsUniform;
+		GLint	positionAttrib;
+		GLint	inputTexCoordAttrib;
+	};
+
+	// One of the render targets used in turn, see mRenderTargets
+	struct RenderTarget
+	{
+		RenderTarget();
+
+		GLuint	texture;
+		GLuint	frameBuffer;
+		GLuint	centerTexture;
+		GLuint	centerFrameBuffer;
+	};
+
+	// Frame times of one technique during a benchmark, in microseconds, and the 
+	// telemetry they were measured under
+	struct TechniqueStats
+	{
+		TechniqueStats();
+
+		FrameStats		drawTime;
+		FrameStats		swapTime;
+		FrameStats		frameTime;
+		FrameStats		eyesTime;			// CPU time issuing the passes of both eyes
+		double			temperatureSum;
+		unsigned int	temperatureCount;
+		double			cpuFrequencySum;
+		unsigned int	cpuFrequencyCount;
+		FrameStats		latency;
+	};
+
+	void	registerParameters();
 	void	readParameters( const ApplicationContext& context );
+	void	updateParameters();
+	void	applyParameterChanges( ParameterRegistry::DependencyMask changes );
+	// The device startup runs in order through these states. Failed comes last so that waiting for any state ends on it
+	enum DeviceStartupState
+	{
+		DeviceStartupNotStarted,
+		DeviceStartupRunning,
+		DeviceStartupHMDInfoReady,
+		DeviceStartupDone,
+		DeviceStartupFailed
+	};
+
+	void	startDeviceStartup();
+	static int	deviceStartupFunction( OVR::Thread* thread, void* userData );
+	void	setDeviceStartupState( DeviceStartupState state );
+	DeviceStartupState	waitForDeviceStartup( DeviceStartupState state );
+	bool	isDeviceStartupDone() const;
 	bool	initOculus();
+	bool	openHMD();
+	bool	openSensor();
+	void	applyHMDInfo();
+	void	setupSoftwareGL();
+	void	configureStereo( OVR::Util::Render::StereoConfig& stereoConfig, StereoRenderTechnique technique ) const;
 	void	createShaderPrograms();
+	void	createQuadShaderProgram( StereoRenderTechnique technique );
 	void	createGeometries();
 	void	createTexture();
+	void	createRenderTexture( GLsizei width, GLsizei height, GLuint& texture, GLuint& frameBuffer );
+	void	createEnvironment();
+	void	createFarFieldLayer();
+	void	destroyQuadShaderPrograms();
+	void	destroyQuadGeometry();
+	void	destroyTexture();
+	void	selectRenderTarget( int index );
+	void	finishPass( const char* name );
+	void	destroyFarFieldLayer();
+	void	createSpectator();
+	void	destroySpectator();
+	void	computeEyeScissors();
+	void	computeEyeDistortionParams();
 
-	void	drawForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
-	void	drawBox( const OVR::Matrix4f& projectionMat, const OVR::Matrix4f& viewAdjustMat );
-	void	drawQuad(  const OVR::Util::Render::Viewport& VP, const OVR::Util::Render::DistortionConfig& distortionConfig );
+	bool	isBenchmarking() const { return mBenchmarkFramesPerTechnique>0 && !mBenchmarkTechniqueList.empty(); }
+	bool	isTechniqueResident( StereoRenderTechnique technique ) const;
+	bool	isRenderTextureNeeded() const;
+	void	parseBenchmarkTechniques();
+	void	updateBenchmarkTechnique();
+	void	recordBenchmarkFrame( unsigned int drawTime, unsigned int swapTime, unsigned int eyesTime );
+	void	printBenchmarkReport() const;
+	void	startTelemetry();
+	void	openFrameLog();
+	void	closeFrameLog();
+	void	logFrame( unsigned int drawTime, unsigned int swapTime );
+	void	startRecording();
+	void	startHIDReportReader();
+	void	startMetricsServer();
+	void	publishMetrics( unsigned int time );
+	void	recordFrame();
+	void	drawSpectator( const OVR::Util::Render::StereoEyeParams& eye );
+	void	readSpectator();
+	void	startTrace();
+	void	writeTrace();
+	void	setupLatencyTester();
+	void	drawLatencyPatch( const OVR::Color& color, const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye );
+	void	reportLatency( const char* results );
+
+	// The per-frame passes are specialized on the technique, so that the branches and uniform uploads 
+	// of the other techniques aren't compiled in. DynamicTechnique reads mStereoRenderTechnique instead, 
+	// which is the unspecialized path SpecializedDraw 0 runs, for comparison
+	enum { DynamicTechnique = StereoRenderTechniqueCount };
+	typedef void (RiftOnThePiApp::*DrawEyesFunction)( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye );
+
+	void	selectDrawEyesFunction();
+	template<int Technique> StereoRenderTechnique getTechnique() const;
+	template<int Technique> void	drawEyes( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye );
+	template<int Technique> void	drawForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	template<int Technique> void	drawSceneForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	template<int Technique> void	drawStereoScene( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye );
+	template<int Technique> void	drawQuad( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	void	drawFarFieldLayer( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	void	compositeFarField( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	void	drawBoxes( const OVR::Matrix4f& projectionMat, const OVR::Matrix4f& viewMat, int firstBox, int boxCount );
+	void	drawStereoBoxes( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye, const OVR::Util::Render::Viewport& sceneVP, int firstBox, int boxCount );
+	bool	isFarFieldLayerUsed() const;
+	void	drawCenterForEye( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	// The specialized passes call the specialized versions, the others go by mStereoRenderTechnique
+	bool	isMultiResolutionUsed() const;
+	bool	isDistortionScissorUsed() const;
+	const OVR::Util::Render::Viewport& getEyeScissor( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const;
+	OVR::Util::Render::Viewport getSceneViewport( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const;
+	template<int Technique> bool	isMultiResolutionUsed() const;
+	template<int Technique> bool	isDistortionScissorUsed() const;
+	template<int Technique> const OVR::Util::Render::Viewport& getEyeScissor( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const;
+	template<int Technique> OVR::Util::Render::Viewport getSceneViewport( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const;
+	OVR::Util::Render::Viewport getCenterViewport( const OVR::Util::Render::StereoEyeParams& stereoEyeParam ) const;
+	static OVR::Util::Render::Viewport scaleViewport( const OVR::Util::Render::Viewport& VP, float scale );
+	OVR::Matrix4f getBoxModel() const;
+	OVR::Matrix4f getHeadMatrix() const;
+	static float getProjectionCenterOffset( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	void	drawHud( const OVR::Util::Render::StereoEyeParams& leftEye, const OVR::Util::Render::StereoEyeParams& rightEye );
 	
+	void	validateDistortion();
+	void	auditAllocations();
+	static OVR::Util::Render::DistortionConfig getEyeDistortionConfig( const OVR::Util::Render::StereoEyeParams& stereoEyeParam );
+	static DistortionReference::Program getDistortionProgram( StereoRenderTechnique technique );
+
 	int				mCounter;
 	unsigned int	mLastTime;
 
+	ParameterRegistry		mParameters;
+	ParameterFileWatcher	mParameterFileWatcher;
+	bool					mParametersRead;
+	std::string				mConfigFile;				// Optional parameter file, reloaded whenever it's saved
+
 	StereoRenderTechnique mStereoRenderTechnique;
+	int		mStereoRenderTechniqueParameter;			// Unchecked value of the StereoRenderTechnique parameter
+	bool	mSpecializedDraw;							// Draw with the passes specialized on mStereoRenderTechnique
+	DrawEyesFunction	mDrawEyesFunction;				// Follows mStereoRenderTechnique and mSpecializedDraw (or the benchmark slot)
 	bool	mDistortionScaleEnabled;					// If distortion correction is enabled, indicate whether we enlarge the render target texture and FOV to take the most of the Rift FOV
 	bool	mAnimationEnabled;							// Is the box rotating
 	bool	mUseRiftOrientation;				
+	bool	mBatchedFusionEnabled;					// Queue the sensor samples and integrate them once per frame on the render thread
+	int		mSensorFusionBenchmark;						// Synthetic samples fed to both fusions once started, 0 to skip
+	bool	mSensorFusionBenchmarkDone;
+	bool	mSinglePassStereo;							// Draw the scene of both eyes in a single pass, side by side
+	bool	mMonoFarField;								// Draw the boxes beyond mFarFieldSplitDepth once for both eyes
+	float	mFarFieldSplitDepth;						// In meters
+	int		mEnvironmentBoxCount;						// Boxes laid out in a ring around the viewer
+	float	mEnvironmentDistance;						// Radius of the ring, in meters
+	bool	mMultiResolution;							// Render the lens center and the periphery of the eyes at different densities
+	float	mMultiResolutionCenterFraction;				// Size of the full density region, as a fraction of the eye width and height
+	float	mMultiResolutionPeripheryDensity;			// Density of the rest, relative to the full density
+	bool	mDistortionScissorEnabled;					// Restrict the scene clear and rendering to what the distortion reads
+	int		mRenderTargetCount;							// Number of render targets used in turn
+	bool	mForceFinish;								// Wait for the GPU at the end of each pass
+	int		mGLCheckLevel;								// See GLCheck::Level
+	int		mGLCheckFrameCount;							// Frames since the GL check stats were reset
+	int		mValidateDistortionFrame;					// Index of the frame to compare against the CPU reference distortion (0 means never)
+	float	mValidationMinPSNR;							// Validation fails below this PSNR (in dB)...
+	int		mValidationMaxError;						// ... or above this per-channel error (0 to 255) of the 99.9th percentile pixel
+	bool	mExitAfterChecks;							// Stop once the distortion validation and allocation audit have given their verdict
+	bool	mChecksFailed;								// A check printed FAILED, the process exit status tells it
+	int		mAllocationAuditFrame;						// First frame whose allocations are counted, after the warm-up (0 means never)
+	int		mAllocationAuditFrameCount;					// Number of frames audited
+	bool	mAllocationAuditExcused;					// Resources were rebuilt during the audited frame
+	int		mAllocationAuditFailedFrames;
+	int		mAllocationAuditExcusedFrames;
+
+	int			mBenchmarkFramesPerTechnique;			// When not 0, the techniques of mBenchmarkTechniques take turns every that many frames
+	std::string	mBenchmarkTechniques;					// Comma separated list of techniques to benchmark
+	int			mBenchmarkWarmupFrames;					// Frames not measured after each switch
+	int			mBenchmarkReportInterval;				// In seconds
+	bool		mBenchmarkDrawDispatch;					// Each technique alternates its generic and specialized draw
+	bool		mBenchmarkGenericDraw;					// The current slot draws with the generic passes
+	std::vector<StereoRenderTechnique>	mBenchmarkTechniqueList;
+	unsigned int		mBenchmarkFrame;
+	unsigned int		mBenchmarkLastReportTime;
+	TechniqueStats		mBenchmarkStats[StereoRenderTechniqueCount];
+	TechniqueStats		mBenchmarkGenericStats[StereoRenderTechniqueCount];	// The generic slots of mBenchmarkDrawDispatch
+
+	int			mTelemetryInterval;						// In ms, 0 disables the telemetry sampler
+	std::string	mTelemetrySysRoot;						// Normally /sys and /proc, can point to fake files
+	std::string	mTelemetryProcRoot;
+	std::string	mFrameLog;								// Optional CSV file receiving the times and telemetry of every frame
+	TelemetrySampler			mTelemetrySampler;
+	TelemetrySampler::Sample	mTelemetrySample;		// Latest sample, fetched once per frame
+	FILE*						mFrameLogFile;
+
+	std::string		mRecordFile;							// Y4M (.y4m) or raw RGB file receiving every mRecordInterval-th frame
+	int				mRecordInterval;
+	int				mRecordBufferCount;						// Frames that can wait for the writer thread before the next ones are dropped
+	int				mRecordFrameRate;						// Only written in the Y4M header
+	FrameRecorder	mFrameRecorder;
+	unsigned int	mRecordTimeSum;							// Readback time of the recorded frames since the last print, in microseconds
+	unsigned int	mRecordedFrames;
+
+	bool			mHudEnabled;
+	PerformanceHud	mHud;
+	unsigned int	mPhaseTimes[PerformanceHud::PhaseCount];	// Of the current frame, in microseconds
+	OVR::UInt64		mLastFrameTicks;
+
+	std::string		mTraceFile;								// Chrome trace-event JSON file, written after mTraceFrameCount frames
+	int				mTraceFrameCount;
+	int				mTraceEventsPerThread;
+	int				mTraceEndFrame;							// -1 when not tracing
+
+	int				mLatencyTesterMode;						// See LatencyTesterMode
+	float			mSimulatedDisplayDelay;					// In ms, from the swap to the simulated photo sensor seeing the patch
+	int				mSimulatedLatencyTestInterval;			// In ms, between two simulated tests
+
+	bool			mSimulatedHMD;							// Without a Rift, use the DK1 defaults of the StereoConfig (no sensor)
+	int				mSoftwareGLThreadCount;					// Threads rasterizing the tiles of the software GL, 0 for one per core
+	TaskPool*		mSoftwareGLTaskPool;					// NULL unless the software GL is compiled in
+
+	std::string		mSensorDevice;							// hidraw device read by mHIDReportReader, empty to let LibOVR read the sensor
+	bool			mSimulatedSensorDevice;					// Read canned reports from mSimulatedTrackerDevice instead
+	int				mSimulatedSensorBurst;					// Reports per write of the simulated device
+	HIDReportReader			mHIDReportReader;
+	SimulatedTrackerDevice	mSimulatedTrackerDevice;
+	OVR::UInt64		mSensorAgeSum;							// In microseconds, between the arrival of the latest sample and its use by a frame
+	unsigned int	mSensorAgeCount;
+
+	bool					mParallelStartup;				// Run initOculus() on a thread of its own, while the GL is set up
+	StartupProfile			mStartupProfile;
+	OVR::Ptr<OVR::Thread>	mDeviceStartupThread;
+	mutable OVR::Mutex		mDeviceStartupMutex;
+	OVR::WaitCondition		mDeviceStartupCondition;
+	DeviceStartupState		mDeviceStartupState;			// Guarded by mDeviceStartupMutex
+	bool					mDeviceStartupDone;				// Render thread copy of it: the sensor members can be used once set
+	bool					mStartupReported;
 
 	OVR::Ptr<OVR::DeviceManager>	mDeviceManager;
 	OVR::Ptr<OVR::HMDDevice>		mHMD;
 	OVR::Ptr<OVR::SensorDevice>		mSensor;
 	OVR::SensorFusion*				mSensorFusion;
+	BatchedSensorFusion*			mBatchedSensorFusion;	// Used instead of mSensorFusion when mBatchedFusionEnabled
+	SensorMessageHandler*			mSensorMessageHandler;
+	OVR::Ptr<OVR::LatencyTestDevice>	mLatencyTester;		// Declared after the device manager so that it's released first
+	OVR::Util::LatencyTest			mLatencyUtil;
+	SimulatedLatencyTester			mSimulatedLatencyTester;
+	OVR::HMDInfo					mHMDInfo;
 	OVR::Util::Render::StereoConfig mStereoConfig;
-	unsigned int					mScreenHResolution;
-	unsigned int					mScreenVResolution; 
+	unsigned int					mScreenHResolution;		// Size of the render surface the final image is drawn into. Smaller than 
+	unsigned int					mScreenVResolution;		// the HMD resolution when the runner scales the surface up to the display
+	float							mRenderScale;
+	GLuint							mOutputFrameBuffer;		// Frame buffer of the render surface (see ApplicationContext::frameBuffer)
 
 	float	mBoxAngleX;		// In degrees
 	float	mBoxAngleY;
 	float	mBoxAngleZ;
 
+	// Model matrices of the boxes, farthest first so that they can be drawn without depth buffer.
+	// The first mFarBoxCount ones go in the far field layer when it's used, the last one is the animated box
+	std::vector<OVR::Matrix4f>	mBoxModels;
+	int							mFarBoxCount;
+	OVR::Matrix4f				mHeadMatrix;				// Inverted Rift orientation, read once per frame
+
 	GLuint	mShaderProgramBox;
 	GLuint	mVertexBufferBox;
 	GLuint	mIndexBufferBox;
 
-	GLuint	mShaderProgramQuad;
+	QuadProgram	mQuadPrograms[StereoRenderTechniqueCount];
 	GLuint	mVertexBufferQuad;
 	GLuint	mIndexBufferQuad;
 
+	// The scene of a frame is drawn in the render target following the one of the previous frame, 
+	// so that it doesn't have to wait for the previous distortion pass to be done reading it. 
+	// mTexture, mTextureFrameBuffer, mCenterTexture and mCenterTextureFrameBuffer are those of 
+	// the current one
+	std::vector<RenderTarget>	mRenderTargets;
+	int							mRenderTargetIndex;
+
 	GLuint	mTexture;
 	GLuint	mTextureFrameBuffer;
+	GLsizei	mTextureWidth;
+	GLsizei	mTextureHeight;
+
+	// Full density region around the lens centers when rendering at multiple resolutions (mTexture 
+	// then has the periphery density), laid out side by side like mTexture
+	GLuint	mCenterTexture;
+	GLuint	mCenterTextureFrameBuffer;
+	GLsizei	mCenterTextureWidth;
+	GLsizei	mCenterTextureHeight;
+
+	// Per technique and eye, the texels of mTexture the distortion can read. Empty when unknown
+	OVR::Util::Render::Viewport	mEyeScissors[StereoRenderTechniqueCount][2];
+
+	// Per technique and eye, the uniforms of the distortion pass. They only change with the stereo configuration
+	DistortionParams	mEyeDistortionParams[StereoRenderTechniqueCount][2];
 
 	GLint mBoxProjectionUniform;
 	GLint mBoxModelViewUniform;
 	GLint mBoxPositionAttrib;
 	GLint mBoxColorAttrib;
 
-	GLint	mQuadTexmUniform;
-	GLint	mQuadLensCenterUniform;
-	GLint	mQuadScreenCenterCenterUniform;
-	GLint	mQuadScaleCenterUniform;
-	GLint	mQuadScaleInCenterUniform;
-	GLint	mQuadHmdWarpParamCenterUniform;
-	GLint	mQuadChromAbParamUniform;
-	GLint	mQuadTexture0Uniform;
-	GLint	mQuadPositionAttrib;
-	GLint	mQuadInputTexCoordAttrib;
+	// Single pass stereo version of the box: its vertices are duplicated for each eye
+	GLuint	mShaderProgramStereoBox;
+	GLuint	mVertexBufferStereoBox;
+	GLuint	mIndexBufferStereoBox;
+	GLint	mStereoBoxProjectionUniform;
+	GLint	mStereoBoxModelViewUniform;
+	GLint	mStereoBoxClipTransformUniform;
+	GLint	mStereoBoxPositionAttrib;
+	GLint	mStereoBoxColorAttrib;
+	GLint	mStereoBoxEyeIndexAttrib;
+
+	// Plain textured quad, copying the far field layer into the eyes and the left eye into the spectator view
+	QuadProgram	mCopyProgram;
+
+	// Far field layer: rendered once from the center eye, slightly wider than an eye so that shifting 
+	// it by the projection center offset of either eye still covers the eye
+	GLuint		mFarFieldTexture;
+	GLuint		mFarFieldFrameBuffer;
+	GLsizei		mFarFieldWidth;
+	GLsizei		mFarFieldHeight;
+
+	// Spectator view: the undistorted scene of the left eye, copied from the render texture every 
+	// mSpectatorInterval frames into a target of its own, and recorded
+	int				mSpectatorInterval;						// 0 when there's no spectator view
+	int				mSpectatorWidth;						// The height follows the aspect ratio of the eye
+	std::string		mSpectatorFile;							// Y4M (.y4m) or raw RGB file, required: nothing else shows the view
+	GLuint			mSpectatorTexture;
+	GLuint			mSpectatorFrameBuffer;
+	GLsizei			mSpectatorHeight;
+	FrameRecorder	mSpectatorRecorder;
+	unsigned int	mSpectatorTimeSum;						// Copy passes since the last print, in microseconds
+	unsigned int	mSpectatorReadbackTimeSum;				// Their readbacks, which also wait for the frame without ForceFinish
+	unsigned int	mSpectatorViews;
+	unsigned int	mSpectatorFrames;
+
+	// Metrics server: the render thread fills a snapshot once per second, the server thread 
+	// formats it for whoever connects to mMetricsSocket
+	std::string		mMetricsSocket;							// Unix domain socket path, empty for no server
+	MetricsServer	mMetricsServer;
+	FrameStats		mMetricsFrameTimes;						// Since the last snapshot
+	FrameStats		mMetricsDrawTimes;
+	unsigned int	mMetricsFrameCount;						// Since the start
+	unsigned int	mMetricsDroppedFrameCount;
+	unsigned int	mMetricsSensorSampleCount;				// Integrated by the batched fusion, since the start
+	unsigned int	mMetricsLastSensorSampleCount;			// Total at the last snapshot
+	unsigned int	mMetricsLastTime;						// In ms, 0 before the first snapshot
 };
 
 }
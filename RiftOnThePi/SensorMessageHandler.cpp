@@ -0,0 +1,71 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "SensorMessageHandler.h"
+
+#include "OGLESTrace.h"
+
+namespace OGLESSandbox
+{
+
+SensorMessageHandler::SensorMessageHandler( OVR::SensorFusion* sensorFusion )
+	: OVR::MessageHandler(),
+	  mSensorFusion(sensorFusion),
+	  mBatchedSensorFusion(NULL),
+	  mBodyFrameCount(0)
+{
+}
+
+SensorMessageHandler::SensorMessageHandler( BatchedSensorFusion* batchedSensorFusion )
+	: OVR::MessageHandler(),
+	  mSensorFusion(NULL),
+	  mBatchedSensorFusion(batchedSensorFusion),
+	  mBodyFrameCount(0)
+{
+}
+
+SensorMessageHandler::~SensorMessageHandler()
+{
+	RemoveHandlerFromDevices();
+}
+
+void SensorMessageHandler::OnMessage( const OVR::Message& message )
+{
+	OGLES_TRACE_THREAD_NAME("LibOVR device");
+	OGLES_TRACE_SCOPE("sensorMessage");
+	if ( message.Type!=OVR::Message_BodyFrame )
+		return;
+	const OVR::MessageBodyFrame& bodyFrame = static_cast<const OVR::MessageBodyFrame&>(message);
+	mBodyFrameCount = mBodyFrameCount + 1;
+	if ( mBatchedSensorFusion )
+		mBatchedSensorFusion->addSample( bodyFrame );
+	else
+		mSensorFusion->OnMessage( bodyFrame );
+}
+
+bool SensorMessageHandler::SupportsMessageType( OVR::MessageType type ) const
+{
+	return type==OVR::Message_BodyFrame;
+}
+
+}
@@ -0,0 +1,60 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include "BatchedSensorFusion.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	SensorMessageHandler
+
+	Installed on the sensor device in place of the SensorFusion's own handler: it receives 
+	the sensor messages on the LibOVR device thread and forwards the body frames to the 
+	SensorFusion (which is therefore not attached to the sensor itself). Having this hop 
+	in our code lets the sensor message handling be traced alongside the render thread.
+	Given a BatchedSensorFusion instead, the body frames are only queued for it.
+*/
+class SensorMessageHandler : public OVR::MessageHandler
+{
+public:
+	explicit SensorMessageHandler( OVR::SensorFusion* sensorFusion );
+	explicit SensorMessageHandler( BatchedSensorFusion* batchedSensorFusion );
+	virtual ~SensorMessageHandler();
+
+	virtual void	OnMessage( const OVR::Message& message );
+	virtual bool	SupportsMessageType( OVR::MessageType type ) const;
+
+	unsigned int	getBodyFrameCount() const { return mBodyFrameCount; }		// Read from any thread
+
+private:
+	OVR::SensorFusion*		mSensorFusion;
+	BatchedSensorFusion*	mBatchedSensorFusion;
+	volatile unsigned int	mBodyFrameCount;		// Only written by the device thread
+};
+
+}
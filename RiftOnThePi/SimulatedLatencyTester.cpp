@@ -0,0 +1,147 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "SimulatedLatencyTester.h"
+
+#include <stdio.h>
+
+#include "Kernel/OVR_Timer.h"
+
+namespace OGLESSandbox
+{
+
+SimulatedLatencyTester::SimulatedLatencyTester()
+	: mStarted(false),
+	  mMeasuring(false),
+	  mDisplayDelay(0),
+	  mTestInterval(0),
+	  mNextTestTicks(0),
+	  mFrameTicks(0),
+	  mRequestTicks(0),
+	  mSwapTicks(0),
+	  mSampleIndex(0),
+	  mResultsReady(false)
+{
+	mResults[0] = '\0';
+	for ( int i=0; i<SampleCount; ++i )
+		mSamples[i] = 0;
+}
+
+void SimulatedLatencyTester::start( unsigned int displayDelay, unsigned int testInterval )
+{
+	mStarted = true;
+	mMeasuring = false;
+	mDisplayDelay = displayDelay;
+	mTestInterval = testInterval;
+	mNextTestTicks = OVR::Timer::GetTicks();
+	mResultsReady = false;
+}
+
+void SimulatedLatencyTester::stop()
+{
+	mStarted = false;
+	mMeasuring = false;
+	mResultsReady = false;
+}
+
+void SimulatedLatencyTester::processInputs()
+{
+	if ( !mStarted )
+		return;
+
+	mFrameTicks = OVR::Timer::GetTicks();
+	if ( !mMeasuring )
+	{
+		if ( mFrameTicks>=mNextTestTicks )
+		{
+			mMeasuring = true;
+			mSampleIndex = 0;
+			startSample();
+		}
+		return;
+	}
+
+	// The color becomes visible to the photo sensor mDisplayDelay after the swap
+	if ( mSwapTicks==0 || mFrameTicks<mSwapTicks+mDisplayDelay )
+		return;
+
+	mSamples[mSampleIndex] = static_cast<unsigned int>(mSwapTicks + mDisplayDelay - mRequestTicks);
+	mSampleIndex++;
+	if ( mSampleIndex<SampleCount )
+		startSample();
+	else
+		completeTest();
+}
+
+bool SimulatedLatencyTester::displayScreenColor( OVR::Color& colorToDisplay )
+{
+	if ( !mMeasuring )
+		return false;
+
+	if ( mRequestTicks==0 )
+		mRequestTicks = mFrameTicks;
+	OVR::UByte level = (mSampleIndex%2)==0 ? 255 : 0;
+	colorToDisplay = OVR::Color( level, level, level );
+	return true;
+}
+
+void SimulatedLatencyTester::onSwap( OVR::UInt64 swapTicks, bool colorDisplayed )
+{
+	// Only a frame that really contains the color counts, so a patch that isn't drawn is never seen
+	if ( mMeasuring && colorDisplayed && mRequestTicks!=0 && mSwapTicks==0 )
+		mSwapTicks = swapTicks;
+}
+
+const char* SimulatedLatencyTester::getResultsString()
+{
+	if ( !mResultsReady )
+		return NULL;
+	mResultsReady = false;
+	return mResults;
+}
+
+void SimulatedLatencyTester::startSample()
+{
+	mRequestTicks = 0;
+	mSwapTicks = 0;
+}
+
+void SimulatedLatencyTester::completeTest()
+{
+	double blackToWhite = 0.0;
+	double whiteToBlack = 0.0;
+	for ( int i=0; i<SampleCount; i+=2 )
+	{
+		blackToWhite += mSamples[i];
+		whiteToBlack += mSamples[i+1];
+	}
+	blackToWhite /= (SampleCount/2) * 1000.0;
+	whiteToBlack /= (SampleCount/2) * 1000.0;
+	sprintf( mResults, "RESULT=%.1f [b->w %.1f|w->b %.1f] (simulated)", (blackToWhite + whiteToBlack) / 2.0, blackToWhite, whiteToBlack );
+	mResultsReady = true;
+
+	mMeasuring = false;
+	mNextTestTicks = mFrameTicks + static_cast<OVR::UInt64>(mTestInterval) * 1000;
+}
+
+}
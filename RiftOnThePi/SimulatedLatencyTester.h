@@ -0,0 +1,81 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	SimulatedLatencyTester
+
+	Stands in for the Oculus latency tester so that the measurement pipeline can be 
+	exercised without the hardware. It's driven like OVR::Util::LatencyTest (process the 
+	inputs at the start of the frame, draw the color it asks for, collect the results) 
+	and additionally told when the frame was swapped. The color drawn in a frame is 
+	"seen" a fixed display delay after that frame's swap, and the latency of a sample is 
+	measured from the start of the first frame showing the color. A test alternates 
+	black and white over a few samples and its results string has the same form as the 
+	real one, starting with "RESULT=<average in ms>".
+*/
+class SimulatedLatencyTester
+{
+public:
+	SimulatedLatencyTester();
+
+	// Tests start automatically, the first one right away then every testInterval ms
+	void		start( unsigned int displayDelay, unsigned int testInterval );		// displayDelay in microseconds
+	void		stop();
+	bool		isStarted() const { return mStarted; }
+
+	void		processInputs();
+	bool		displayScreenColor( OVR::Color& colorToDisplay );
+	void		onSwap( OVR::UInt64 swapTicks, bool colorDisplayed );
+	const char*	getResultsString();			// Non NULL once per completed test
+
+private:
+	enum 
+	{
+		SampleCount = 6
+	};
+
+	void		startSample();
+	void		completeTest();
+
+	bool			mStarted;
+	bool			mMeasuring;
+	unsigned int	mDisplayDelay;
+	unsigned int	mTestInterval;
+	OVR::UInt64		mNextTestTicks;
+	OVR::UInt64		mFrameTicks;			// When processInputs() was last called
+	OVR::UInt64		mRequestTicks;			// Start of the first frame showing the color of the current sample, 0 if not shown yet
+	OVR::UInt64		mSwapTicks;				// Swap of that frame, 0 if not swapped yet
+	int				mSampleIndex;
+	unsigned int	mSamples[SampleCount];	// In microseconds, even indices are black to white transitions
+	bool			mResultsReady;
+	char			mResults[128];
+};
+
+}
@@ -0,0 +1,232 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "SimulatedTrackerDevice.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "OGLESTrace.h"
+
+#ifdef __linux__
+	#include <errno.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+namespace OGLESSandbox
+{
+
+SimulatedTrackerDevice::SimulatedTrackerDevice()
+	: mBurstReports(1),
+	  mDroppedReports(0),
+	  mMutex(),
+	  mCondition(),
+	  mQuit(false),
+	  mThreadRunning(false),
+	  mThread()
+{
+	mFds[0] = -1;
+	mFds[1] = -1;
+	memset( mBurst, 0, sizeof(mBurst) );
+
+	// One sample per report, a second of a head turning left and right (whose yaw rate integrates 
+	// to zero over the loop) while the device is otherwise level
+	for ( int i=0; i<CannedReportCount; ++i )
+	{
+		float t = static_cast<float>(i) / CannedReportCount;
+		float acceleration[3] = { 0.f, 9.81f, 0.f };
+		float rotationRate[3] = { 0.f, 1.5f * sinf( 2.f * 3.14159265f * t ), 0.f };
+		encodeReport( acceleration, rotationRate, mReports[i] );
+	}
+}
+
+SimulatedTrackerDevice::~SimulatedTrackerDevice()
+{
+	stop();
+	closePipe();
+}
+
+// Three signed 21 bit values packed big endian in 8 bytes, the reverse of HIDReportReader's unpacking
+static void packSensor( const float* values, unsigned char* buffer )
+{
+	int v[3];
+	for ( int i=0; i<3; ++i )
+		v[i] = static_cast<int>( floorf( values[i] * 10000.f + 0.5f ) ) & 0x1FFFFF;
+	buffer[0] = static_cast<unsigned char>( v[0] >> 13 );
+	buffer[1] = static_cast<unsigned char>( v[0] >> 5 );
+	buffer[2] = static_cast<unsigned char>( ((v[0] & 0x1F) << 3) | (v[1] >> 18) );
+	buffer[3] = static_cast<unsigned char>( v[1] >> 10 );
+	buffer[4] = static_cast<unsigned char>( v[1] >> 2 );
+	buffer[5] = static_cast<unsigned char>( ((v[1] & 0x03) << 6) | (v[2] >> 15) );
+	buffer[6] = static_cast<unsigned char>( v[2] >> 7 );
+	buffer[7] = static_cast<unsigned char>( (v[2] & 0x7F) << 1 );
+}
+
+void SimulatedTrackerDevice::encodeReport( const float* acceleration, const float* rotationRate, unsigned char* report )
+{
+	memset( report, 0, HIDReportReader::ReportSize );
+	report[0] = HIDReportReader::TrackerReportId;
+	report[1] = 1;				// Sample count, the timestamp is set when the report is sent
+	report[6] = 3000 & 0xFF;	// 30 degrees
+	report[7] = 3000 >> 8;
+	packSensor( acceleration, report + 8 );
+	packSensor( rotationRate, report + 16 );
+}
+
+bool SimulatedTrackerDevice::start( int burstReports )
+{
+	stop();
+	closePipe();
+#ifdef __linux__
+	mBurstReports = burstReports<1 ? 1 : (burstReports>MaxBurstReports ? MaxBurstReports : burstReports);
+	mDroppedReports = 0;
+	if ( pipe( mFds )<0 )
+	{
+		printf("SimulatedTrackerDevice: failed to create pipe (%s)\n", strerror(errno) );
+		return false;
+	}
+
+	// Like the device, drop reports rather than wait when nobody reads them
+	int flags = fcntl( mFds[1], F_GETFL );
+	if ( flags<0 || fcntl( mFds[1], F_SETFL, flags | O_NONBLOCK )<0 )
+	{
+		printf("SimulatedTrackerDevice: failed to set pipe up (%s)\n", strerror(errno) );
+		closePipe();
+		return false;
+	}
+
+	mQuit = false;
+	mThreadRunning = true;
+	mThread = *new OVR::Thread( threadFunction, this );
+	if ( !mThread->Start() )
+	{
+		printf("SimulatedTrackerDevice: failed to start thread\n");
+		mThreadRunning = false;
+		mThread.Clear();
+		closePipe();
+		return false;
+	}
+	printf("SimulatedTrackerDevice: a report every millisecond, %d per write\n", mBurstReports );
+	return true;
+#else
+	printf("SimulatedTrackerDevice: only available on Linux\n");
+	return false;
+#endif
+}
+
+void SimulatedTrackerDevice::stop()
+{
+	if ( !isRunning() )
+		return;
+	mMutex.DoLock();
+	mQuit = true;
+	mCondition.NotifyAll();
+	while ( mThreadRunning )
+		mCondition.Wait( &mMutex );
+	mMutex.Unlock();
+	mThread.Clear();
+	if ( mDroppedReports>0 )
+		printf("SimulatedTrackerDevice: %u reports dropped\n", mDroppedReports );
+
+	// The write end is closed now so that the reader sees the end of the stream
+#ifdef __linux__
+	if ( mFds[1]>=0 )
+		close( mFds[1] );
+	mFds[1] = -1;
+#endif
+}
+
+int SimulatedTrackerDevice::takeReadFd()
+{
+	int fd = mFds[0];
+	mFds[0] = -1;
+	return fd;
+}
+
+void SimulatedTrackerDevice::closePipe()
+{
+#ifdef __linux__
+	for ( int i=0; i<2; ++i )
+	{
+		if ( mFds[i]>=0 )
+			close( mFds[i] );
+		mFds[i] = -1;
+	}
+#endif
+}
+
+int SimulatedTrackerDevice::threadFunction( OVR::Thread* /*thread*/, void* userData )
+{
+	SimulatedTrackerDevice* device = static_cast<SimulatedTrackerDevice*>(userData);
+	device->writerLoop();
+	return 0;
+}
+
+void SimulatedTrackerDevice::writerLoop()
+{
+	OGLES_TRACE_THREAD_NAME("Simulated tracker");
+#ifdef __linux__
+	const int reportSize = HIDReportReader::ReportSize;
+	int reportIndex = 0;
+	unsigned int timestamp = 0;
+	OVR::UInt64 nextBurstTicks = OVR::Timer::GetTicks();
+	mMutex.DoLock();
+	while ( !mQuit )
+	{
+		// The next burst is due once its reports have all been sampled, a millisecond apart
+		OVR::UInt64 now = OVR::Timer::GetTicks();
+		nextBurstTicks += mBurstReports * 1000;
+		if ( nextBurstTicks>now )
+			mCondition.Wait( &mMutex, static_cast<unsigned int>( (nextBurstTicks - now + 999) / 1000 ) );
+		if ( mQuit )
+			break;
+		mMutex.Unlock();
+
+		for ( int i=0; i<mBurstReports; ++i )
+		{
+			unsigned char* report = mBurst + i * reportSize;
+			memcpy( report, mReports[reportIndex], reportSize );
+			timestamp = (timestamp + 1) & 0xFFFF;
+			report[2] = static_cast<unsigned char>( timestamp & 0xFF );
+			report[3] = static_cast<unsigned char>( timestamp >> 8 );
+			reportIndex = (reportIndex + 1) % CannedReportCount;
+		}
+		ssize_t size = write( mFds[1], mBurst, mBurstReports * reportSize );
+		if ( size<0 )
+			mDroppedReports += mBurstReports;
+		else if ( size<mBurstReports * reportSize )
+			printf("SimulatedTrackerDevice: partial write\n");		// Can't happen for writes up to PIPE_BUF bytes
+
+		mMutex.DoLock();
+	}
+#else
+	mMutex.DoLock();
+#endif
+	mThreadRunning = false;
+	mCondition.NotifyAll();
+	mMutex.Unlock();
+}
+
+}
@@ -0,0 +1,82 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include "HIDReportReader.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	SimulatedTrackerDevice
+
+	Stands in for the DK1 hidraw device so that HIDReportReader can be exercised without 
+	the hardware. A thread writes canned tracker reports into a pipe, one report per 
+	millisecond, grouped in bursts of a few reports per write (a late device thread or a 
+	busy bus). The reports loop over a second of a head turning left and right, with 
+	gravity along +y, and their timestamps keep increasing. The reader gets the other 
+	end of the pipe. Linux only.
+*/
+class SimulatedTrackerDevice
+{
+public:
+	enum
+	{
+		CannedReportCount = 1000,
+		MaxBurstReports = HIDReportReader::MaxReportsPerRead
+	};
+
+	SimulatedTrackerDevice();
+	~SimulatedTrackerDevice();
+
+	bool		start( int burstReports );
+	void		stop();
+	bool		isRunning() const { return mThread.GetPtr()!=NULL; }
+
+	// The read end of the pipe, to be handed over to the reader (once)
+	int			takeReadFd();
+
+	static void	encodeReport( const float* acceleration, const float* rotationRate, unsigned char* report );
+
+private:
+	static int	threadFunction( OVR::Thread* thread, void* userData );
+	void		writerLoop();
+	void		closePipe();
+
+	int						mBurstReports;
+	int						mFds[2];
+	unsigned char			mReports[CannedReportCount][HIDReportReader::ReportSize];
+	unsigned char			mBurst[MaxBurstReports * HIDReportReader::ReportSize];
+	unsigned int			mDroppedReports;		// Pipe full
+
+	mutable OVR::Mutex		mMutex;
+	OVR::WaitCondition		mCondition;
+	bool					mQuit;
+	bool					mThreadRunning;
+	OVR::Ptr<OVR::Thread>	mThread;
+};
+
+}
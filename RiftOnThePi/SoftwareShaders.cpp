@@ -0,0 +1,294 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "SoftwareShaders.h"
+
+#include <stdlib.h>
+
+namespace OGLESSandbox
+{
+
+// result = m * v, m being a column-major mat4
+static void transform( const float* m, const float v[4], float result[4] )
+{
+	for ( int i=0; i<4; ++i )
+		result[i] = m[i] * v[0] + m[4+i] * v[1] + m[8+i] * v[2] + m[12+i] * v[3];
+}
+
+//
+// BoxVertexShader
+//
+const SoftwareShader::Uniform* BoxVertexShader::getUniforms() const
+{
+	static const Uniform uniforms[] = { { "Projection", 16 }, { "ModelView", 16 }, { NULL, 0 } };
+	return uniforms;
+}
+
+const char* const* BoxVertexShader::getAttributes() const
+{
+	static const char* const attributes[] = { "Position", "SourceColor", NULL };
+	return attributes;
+}
+
+void BoxVertexShader::operator()( const float* const* uniforms, const float attributes[][4], float position[4], float* varyings ) const
+{
+	float modelViewPosition[4];
+	transform( uniforms[1], attributes[0], modelViewPosition );
+	transform( uniforms[0], modelViewPosition, position );
+	for ( int i=0; i<4; ++i )
+		varyings[i] = attributes[1][i];
+}
+
+//
+// BoxFragmentShader
+//
+const SoftwareShader::Uniform* BoxFragmentShader::getUniforms() const
+{
+	static const Uniform uniforms[] = { { NULL, 0 } };
+	return uniforms;
+}
+
+bool BoxFragmentShader::operator()( const float* const* /*uniforms*/, const SoftwareSampler* /*samplers*/, const float* varyings, float color[4] ) const
+{
+	for ( int i=0; i<4; ++i )
+		color[i] = varyings[i];
+	return true;
+}
+
+//
+// StereoBoxVertexShader
+//
+const SoftwareShader::Uniform* StereoBoxVertexShader::getUniforms() const
+{
+	static const Uniform uniforms[] = { { "Projection", 32 }, { "ModelView", 32 }, { "ClipTransform", 4 }, { NULL, 0 } };
+	return uniforms;
+}
+
+const char* const* StereoBoxVertexShader::getAttributes() const
+{
+	static const char* const attributes[] = { "Position", "SourceColor", "EyeIndex", NULL };
+	return attributes;
+}
+
+void StereoBoxVertexShader::operator()( const float* const* uniforms, const float attributes[][4], float position[4], float* varyings ) const
+{
+	int eye = static_cast<int>( attributes[2][0] );
+	float modelViewPosition[4];
+	transform( uniforms[1] + eye*16, attributes[0], modelViewPosition );
+	transform( uniforms[0] + eye*16, modelViewPosition, position );
+	const float* clipTransform = uniforms[2] + eye*2;
+	for ( int i=0; i<4; ++i )
+		varyings[i] = attributes[1][i];
+	varyings[4] = position[3] + position[0];
+	varyings[5] = position[3] - position[0];
+	position[0] = position[0] * clipTransform[0] + position[3] * clipTransform[1];
+}
+
+//
+// StereoBoxFragmentShader
+//
+const SoftwareShader::Uniform* StereoBoxFragmentShader::getUniforms() const
+{
+	static const Uniform uniforms[] = { { NULL, 0 } };
+	return uniforms;
+}
+
+bool StereoBoxFragmentShader::operator()( const float* const* /*uniforms*/, const SoftwareSampler* /*samplers*/, const float* varyings, float color[4] ) const
+{
+	if ( varyings[4]<0.f || varyings[5]<0.f )
+		return false;
+	for ( int i=0; i<4; ++i )
+		color[i] = varyings[i];
+	return true;
+}
+
+//
+// QuadVertexShader
+//
+const SoftwareShader::Uniform* QuadVertexShader::getUniforms() const
+{
+	static const Uniform uniforms[] = { { "Texm", 16 }, { NULL, 0 } };
+	return uniforms;
+}
+
+const char* const* QuadVertexShader::getAttributes() const
+{
+	static const char* const attributes[] = { "Position", "InputTexCoord", NULL };
+	return attributes;
+}
+
+void QuadVertexShader::operator()( const float* const* uniforms, const float attributes[][4], float position[4], float* varyings ) const
+{
+	const float texCoord[4] = { attributes[1][0], attributes[1][1], 0.f, 1.f };
+	float result[4];
+	transform( uniforms[0], texCoord, result );
+	varyings[0] = result[0];
+	varyings[1] = result[1];
+	for ( int i=0; i<4; ++i )
+		position[i] = attributes[0][i];
+}
+
+//
+// QuadFragmentShader
+//
+QuadFragmentShader::QuadFragmentShader( DistortionReference::Program program, bool multiResolution )
+	: mProgram(program),
+	  mMultiResolution(multiResolution),
+	  mCenterTransform(-1),
+	  mCenterBounds(-1),
+	  mLensCenter(-1),
+	  mScreenCenter(-1),
+	  mScale(-1),
+	  mScaleIn(-1),
+	  mHmdWarpParam(-1),
+	  mChromAbParam(-1)
+{
+	int count = 0;
+	Uniform texture0 = { "Texture0", 0 };
+	mUniforms[count++] = texture0;
+	if ( multiResolution )
+	{
+		Uniform texture1 = { "Texture1", 0 };
+		Uniform centerTransform = { "CenterTransform", 4 };
+		Uniform centerBounds = { "CenterBounds", 4 };
+		mUniforms[count++] = texture1;
+		mCenterTransform = count;
+		mUniforms[count++] = centerTransform;
+		mCenterBounds = count;
+		mUniforms[count++] = centerBounds;
+	}
+	if ( program!=DistortionReference::Copy )
+	{
+		Uniform lensCenter = { "LensCenter", 2 };
+		Uniform screenCenter = { "ScreenCenter", 2 };
+		Uniform scale = { "Scale", 2 };
+		Uniform scaleIn = { "ScaleIn", 2 };
+		Uniform hmdWarpParam = { "HmdWarpParam", 4 };
+		mLensCenter = count;
+		mUniforms[count++] = lensCenter;
+		mScreenCenter = count;
+		mUniforms[count++] = screenCenter;
+		mScale = count;
+		mUniforms[count++] = scale;
+		mScaleIn = count;
+		mUniforms[count++] = scaleIn;
+		mHmdWarpParam = count;
+		mUniforms[count++] = hmdWarpParam;
+	}
+	if ( program==DistortionReference::DistortionAndChroma )
+	{
+		Uniform chromAbParam = { "ChromAbParam", 4 };
+		mChromAbParam = count;
+		mUniforms[count++] = chromAbParam;
+	}
+	Uniform end = { NULL, 0 };
+	mUniforms[count++] = end;
+}
+
+// sampleScene() of SceneSamplingString or MultiResolutionSceneSamplingString
+void QuadFragmentShader::sampleScene( const float* const* uniforms, const SoftwareSampler* samplers, const float tc[2], float color[4] ) const
+{
+	if ( mMultiResolution )
+	{
+		const float* centerTransform = uniforms[mCenterTransform];
+		const float* centerBounds = uniforms[mCenterBounds];
+		float ctc[2] = { tc[0] * centerTransform[0] + centerTransform[2], tc[1] * centerTransform[1] + centerTransform[3] };
+		if ( ctc[0]>=centerBounds[0] && ctc[1]>=centerBounds[1] && ctc[0]<=centerBounds[2] && ctc[1]<=centerBounds[3] )
+		{
+			samplers[1].sample( ctc[0], ctc[1], color );
+			return;
+		}
+	}
+	samplers[0].sample( tc[0], tc[1], color );
+}
+
+// The all(equal(clamp(tc, ScreenCenter-vec2(0.25,0.5), ScreenCenter+vec2(0.25,0.5)), tc)) test
+bool QuadFragmentShader::isInScreen( const float* const* uniforms, const float tc[2] ) const
+{
+	const float* screenCenter = uniforms[mScreenCenter];
+	return tc[0]>=screenCenter[0] - 0.25f && tc[0]<=screenCenter[0] + 0.25f &&
+		   tc[1]>=screenCenter[1] - 0.5f && tc[1]<=screenCenter[1] + 0.5f;
+}
+
+bool QuadFragmentShader::operator()( const float* const* uniforms, const SoftwareSampler* samplers, const float* varyings, float color[4] ) const
+{
+	if ( mProgram==DistortionReference::Copy )
+	{
+		sampleScene( uniforms, samplers, varyings, color );
+		return true;
+	}
+
+	const float* lensCenter = uniforms[mLensCenter];
+	const float* scale = uniforms[mScale];
+	const float* scaleIn = uniforms[mScaleIn];
+	const float* hmdWarpParam = uniforms[mHmdWarpParam];
+	float theta[2] = { (varyings[0] - lensCenter[0]) * scaleIn[0], (varyings[1] - lensCenter[1]) * scaleIn[1] };
+	float rSq = theta[0] * theta[0] + theta[1] * theta[1];
+	float warp = hmdWarpParam[0] + hmdWarpParam[1] * rSq + hmdWarpParam[2] * rSq * rSq + hmdWarpParam[3] * rSq * rSq * rSq;
+	float theta1[2] = { theta[0] * warp, theta[1] * warp };
+
+	if ( mProgram==DistortionReference::Distortion )
+	{
+		float tc[2] = { lensCenter[0] + scale[0] * theta1[0], lensCenter[1] + scale[1] * theta1[1] };
+		if ( !isInScreen( uniforms, tc ) )
+		{
+			color[0] = 1.f;
+			color[1] = 0.f;
+			color[2] = 1.f;
+			color[3] = 1.f;
+		}
+		else
+		{
+			sampleScene( uniforms, samplers, tc, color );
+		}
+		return true;
+	}
+
+	const float* chromAbParam = uniforms[mChromAbParam];
+	float blueScale = chromAbParam[2] + chromAbParam[3] * rSq;
+	float tcBlue[2] = { lensCenter[0] + scale[0] * (theta1[0] * blueScale), lensCenter[1] + scale[1] * (theta1[1] * blueScale) };
+	if ( !isInScreen( uniforms, tcBlue ) )
+	{
+		color[0] = 1.f;
+		color[1] = 0.f;
+		color[2] = 1.f;
+		color[3] = 1.f;
+		return true;
+	}
+	float sample[4];
+	sampleScene( uniforms, samplers, tcBlue, sample );
+	float blue = sample[2];
+	float tcGreen[2] = { lensCenter[0] + scale[0] * theta1[0], lensCenter[1] + scale[1] * theta1[1] };
+	sampleScene( uniforms, samplers, tcGreen, sample );
+	float green = sample[1];
+	float redScale = chromAbParam[0] + chromAbParam[1] * rSq;
+	float tcRed[2] = { lensCenter[0] + scale[0] * (theta1[0] * redScale), lensCenter[1] + scale[1] * (theta1[1] * redScale) };
+	sampleScene( uniforms, samplers, tcRed, sample );
+	color[0] = sample[0];
+	color[1] = green;
+	color[2] = blue;
+	color[3] = 1.f;
+	return true;
+}
+
+}
@@ -0,0 +1,119 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OGLESSoftwareGL.h"
+
+#include "DistortionReference.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	SoftwareShaders
+
+	The C++ implementations of the shaders of RiftOnThePiApp.cpp for the software GL 
+	(see SoftwareGL). Each one follows its GLSL source operation for operation, and 
+	RiftOnThePiApp registers it against that source. Matrices are column-major like 
+	the uniforms the GL gets.
+*/
+
+// VertexShaderStringBox
+class BoxVertexShader : public SoftwareVertexShader
+{
+public:
+	virtual const Uniform*		getUniforms() const;
+	virtual const char* const*	getAttributes() const;
+	virtual int					getVaryingCount() const { return 4; }
+	virtual void				operator()( const float* const* uniforms, const float attributes[][4], float position[4], float* varyings ) const;
+};
+
+// FragmentShaderStringBox
+class BoxFragmentShader : public SoftwareFragmentShader
+{
+public:
+	virtual const Uniform*		getUniforms() const;
+	virtual bool				operator()( const float* const* uniforms, const SoftwareSampler* samplers, const float* varyings, float color[4] ) const;
+};
+
+// VertexShaderStringStereoBox
+class StereoBoxVertexShader : public SoftwareVertexShader
+{
+public:
+	virtual const Uniform*		getUniforms() const;
+	virtual const char* const*	getAttributes() const;
+	virtual int					getVaryingCount() const { return 6; }
+	virtual void				operator()( const float* const* uniforms, const float attributes[][4], float position[4], float* varyings ) const;
+};
+
+// FragmentShaderStringStereoBox
+class StereoBoxFragmentShader : public SoftwareFragmentShader
+{
+public:
+	virtual const Uniform*		getUniforms() const;
+	virtual bool				operator()( const float* const* uniforms, const SoftwareSampler* samplers, const float* varyings, float color[4] ) const;
+};
+
+// VertexShaderStringQuad
+class QuadVertexShader : public SoftwareVertexShader
+{
+public:
+	virtual const Uniform*		getUniforms() const;
+	virtual const char* const*	getAttributes() const;
+	virtual int					getVaryingCount() const { return 2; }
+	virtual void				operator()( const float* const* uniforms, const float attributes[][4], float position[4], float* varyings ) const;
+};
+
+// One of the quad fragment shaders (FragmentShader0/1/2StringQuad), prefixed with 
+// SceneSamplingString or MultiResolutionSceneSamplingString
+class QuadFragmentShader : public SoftwareFragmentShader
+{
+public:
+	QuadFragmentShader( DistortionReference::Program program, bool multiResolution );
+
+	virtual const Uniform*		getUniforms() const { return mUniforms; }
+	virtual bool				operator()( const float* const* uniforms, const SoftwareSampler* samplers, const float* varyings, float color[4] ) const;
+
+private:
+	void						sampleScene( const float* const* uniforms, const SoftwareSampler* samplers, const float tc[2], float color[4] ) const;
+	bool						isInScreen( const float* const* uniforms, const float tc[2] ) const;
+
+	enum { MaxUniformCount = 12 };
+
+	DistortionReference::Program	mProgram;
+	bool							mMultiResolution;
+	Uniform							mUniforms[MaxUniformCount];
+
+	// Indices of the uniforms in mUniforms
+	int								mCenterTransform;
+	int								mCenterBounds;
+	int								mLensCenter;
+	int								mScreenCenter;
+	int								mScale;
+	int								mScaleIn;
+	int								mHmdWarpParam;
+	int								mChromAbParam;
+};
+
+}
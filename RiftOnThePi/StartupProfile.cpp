@@ -0,0 +1,124 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "StartupProfile.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace OGLESSandbox
+{
+
+StartupProfile::StartupProfile()
+	: mMutex(),
+	  mOriginTicks( OVR::Timer::GetTicks() )
+{
+	memset( mBeginTicks, 0, sizeof(mBeginTicks) );
+	memset( mEndTicks, 0, sizeof(mEndTicks) );
+}
+
+void StartupProfile::begin( Phase phase )
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	mBeginTicks[phase] = OVR::Timer::GetTicks();
+	mEndTicks[phase] = 0;
+}
+
+void StartupProfile::end( Phase phase )
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	if ( mBeginTicks[phase]!=0 )
+		mEndTicks[phase] = OVR::Timer::GetTicks();
+}
+
+bool StartupProfile::isEnded( Phase phase ) const
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	return mEndTicks[phase]!=0;
+}
+
+double StartupProfile::getDuration( Phase phase ) const
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	if ( mEndTicks[phase]==0 )
+		return -1.0;
+	return (mEndTicks[phase] - mBeginTicks[phase]) / 1000000.0;
+}
+
+double StartupProfile::getElapsedTime() const
+{
+	return (OVR::Timer::GetTicks() - mOriginTicks) / 1000000.0;
+}
+
+void StartupProfile::print() const
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	OVR::UInt64 endTicks = mEndTicks[FirstFramePhase]!=0 ? mEndTicks[FirstFramePhase] : OVR::Timer::GetTicks();
+	double total = (endTicks - mOriginTicks) / 1000.0;
+	printf("startup: %.1fms to the first frame\n", total );
+
+	double phaseSum = 0.0;
+	for ( int i=0; i<PhaseCount; ++i )
+	{
+		Phase phase = static_cast<Phase>(i);
+		printPhaseLocked( phase );
+		if ( mEndTicks[phase]!=0 && phase!=HMDWaitPhase )		// Waiting isn't work that would be done serially
+			phaseSum += (mEndTicks[phase] - mBeginTicks[phase]) / 1000.0;
+	}
+	printf("startup: the phases add up to %.1fms, %.1fms of them overlapped\n", phaseSum, phaseSum>total ? phaseSum - total : 0.0 );
+}
+
+void StartupProfile::printPhase( Phase phase ) const
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	printPhaseLocked( phase );
+}
+
+void StartupProfile::printPhaseLocked( Phase phase ) const
+{
+	if ( mBeginTicks[phase]==0 )
+		printf("  %-20s not run\n", getPhaseName(phase) );
+	else if ( mEndTicks[phase]==0 )
+		printf("  %-20s at %8.1fms, still running\n", getPhaseName(phase), (mBeginTicks[phase] - mOriginTicks) / 1000.0 );
+	else
+		printf("  %-20s at %8.1fms, took %8.1fms\n", getPhaseName(phase), (mBeginTicks[phase] - mOriginTicks) / 1000.0, 
+			(mEndTicks[phase] - mBeginTicks[phase]) / 1000.0 );
+}
+
+const char* StartupProfile::getPhaseName( Phase phase )
+{
+	switch ( phase )
+	{
+		case ParametersPhase:			return "parameters";
+		case EGLSetupPhase:				return "EGL setup";
+		case DeviceEnumerationPhase:	return "device enumeration";
+		case SensorStartupPhase:		return "sensor startup";
+		case ShaderCompilationPhase:	return "shader compilation";
+		case HMDWaitPhase:				return "HMD info wait";
+		case ResourceCreationPhase:		return "resource creation";
+		case FirstFramePhase:			return "first frame";
+		default:						return "?";
+	}
+}
+
+}
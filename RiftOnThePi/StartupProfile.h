@@ -0,0 +1,77 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+namespace OGLESSandbox
+{
+
+/*
+	StartupProfile
+
+	Times the phases of the startup, from the construction of the application to its 
+	first frame. The phases are begun and ended from the thread running them (the render 
+	thread or the device startup thread), possibly overlapping. The report lists when 
+	each one started and how long it took, and how much of their total was overlapped.
+*/
+class StartupProfile
+{
+public:
+	enum Phase
+	{
+		ParametersPhase,
+		EGLSetupPhase,				// Between getEGLConfigRequest() and initialize(), in the runner
+		DeviceEnumerationPhase,		// System, device manager and HMD
+		SensorStartupPhase,
+		ShaderCompilationPhase,		// Along with the geometries, which don't depend on the HMD
+		HMDWaitPhase,				// Render thread waiting for the device enumeration
+		ResourceCreationPhase,		// Stereo config, textures and the rest of initialize()
+		FirstFramePhase,
+		PhaseCount
+	};
+
+	StartupProfile();
+
+	void		begin( Phase phase );
+	void		end( Phase phase );
+	bool		isEnded( Phase phase ) const;
+	double		getDuration( Phase phase ) const;		// In seconds, negative until ended
+	double		getElapsedTime() const;					// In seconds, since the construction
+
+	void		print() const;
+	void		printPhase( Phase phase ) const;
+
+	static const char*	getPhaseName( Phase phase );
+
+private:
+	void		printPhaseLocked( Phase phase ) const;
+
+	mutable OVR::Mutex	mMutex;
+	OVR::UInt64			mOriginTicks;
+	OVR::UInt64			mBeginTicks[PhaseCount];	// 0 until begun
+	OVR::UInt64			mEndTicks[PhaseCount];		// 0 until ended
+};
+
+}
@@ -0,0 +1,153 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "TaskPool.h"
+
+#include "OGLESTrace.h"
+
+namespace OGLESSandbox
+{
+
+TaskPool::TaskPool( int threadCount )
+	: mMutex(),
+	  mWorkCondition(),
+	  mDoneCondition(),
+	  mFunction(NULL),
+	  mUserData(NULL),
+	  mTaskCount(0),
+	  mNextTask(0),
+	  mTasksRemaining(0),
+	  mBatchIndex(0),
+	  mRunningThreads(0),
+	  mQuit(false),
+	  mThreads()
+{
+	if ( threadCount<=0 )
+		threadCount = OVR::Thread::GetCPUCount();
+	
+	// The calling thread is a worker too
+	for ( int i=1; i<threadCount; ++i )
+	{
+		OVR::Ptr<OVR::Thread> thread = *new OVR::Thread( threadFunction, this );
+		if ( !thread->Start() )
+			break;
+		mMutex.DoLock();
+		mRunningThreads++;
+		mMutex.Unlock();
+		mThreads.push_back( thread );
+	}
+}
+
+TaskPool::~TaskPool()
+{
+	mMutex.DoLock();
+	mQuit = true;
+	mWorkCondition.NotifyAll();
+	while ( mRunningThreads>0 )
+		mDoneCondition.Wait( &mMutex );
+	mMutex.Unlock();
+	mThreads.clear();
+}
+
+void TaskPool::run( TaskFunction function, void* userData, int taskCount )
+{
+	if ( !function || taskCount<=0 )
+		return;
+
+	mMutex.DoLock();
+	mFunction = function;
+	mUserData = userData;
+	mTaskCount = taskCount;
+	mNextTask = 0;
+	mTasksRemaining = taskCount;
+	mBatchIndex++;
+	mWorkCondition.NotifyAll();
+	mMutex.Unlock();
+
+	while ( runNextTask() )
+	{
+	}
+
+	mMutex.DoLock();
+	while ( mTasksRemaining>0 )
+		mDoneCondition.Wait( &mMutex );
+	mFunction = NULL;
+	mUserData = NULL;
+	mMutex.Unlock();
+}
+
+int TaskPool::threadFunction( OVR::Thread* /*thread*/, void* userData )
+{
+	TaskPool* pool = static_cast<TaskPool*>(userData);
+	pool->workerLoop();
+	return 0;
+}
+
+void TaskPool::workerLoop()
+{
+	OGLES_TRACE_THREAD_NAME("TaskPool worker");
+	unsigned int lastBatchIndex = 0;
+	mMutex.DoLock();
+	while ( !mQuit )
+	{
+		if ( mBatchIndex==lastBatchIndex || mNextTask>=mTaskCount )
+		{
+			mWorkCondition.Wait( &mMutex );
+			continue;
+		}
+		lastBatchIndex = mBatchIndex;
+		mMutex.Unlock();
+		while ( runNextTask() )
+		{
+		}
+		mMutex.DoLock();
+	}
+	mRunningThreads--;
+	mDoneCondition.NotifyAll();
+	mMutex.Unlock();
+}
+
+bool TaskPool::runNextTask()
+{
+	mMutex.DoLock();
+	if ( !mFunction || mNextTask>=mTaskCount )
+	{
+		mMutex.Unlock();
+		return false;
+	}
+	int taskIndex = mNextTask++;
+	TaskFunction function = mFunction;
+	void* userData = mUserData;
+	mMutex.Unlock();
+
+	function( taskIndex, userData );
+
+	mMutex.DoLock();
+	mTasksRemaining--;
+	if ( mTasksRemaining==0 )
+		mDoneCondition.NotifyAll();
+	mMutex.Unlock();
+	return true;
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+/*
+	TaskPool
+
+	A fixed set of worker threads that execute a batch of independent tasks.
+	The tasks of a batch are pulled one at a time from a shared counter (the work queue)
+	so that uneven tasks get balanced across the cores. The calling thread takes part 
+	in the work and run() only returns once every task of the batch is done.
+*/
+class TaskPool
+{
+public:
+	typedef void (*TaskFunction)( int taskIndex, void* userData );
+
+	// A threadCount of 0 or less uses one thread per CPU core (the calling thread included)
+	explicit TaskPool( int threadCount=0 );
+	~TaskPool();
+
+	int		getThreadCount() const { return static_cast<int>(mThreads.size()) + 1; }
+	void	run( TaskFunction function, void* userData, int taskCount );
+
+private:
+	static int	threadFunction( OVR::Thread* thread, void* userData );
+	void		workerLoop();
+	bool		runNextTask();
+
+	OVR::Mutex			mMutex;
+	OVR::WaitCondition	mWorkCondition;
+	OVR::WaitCondition	mDoneCondition;
+
+	TaskFunction		mFunction;
+	void*				mUserData;
+	int					mTaskCount;
+	int					mNextTask;
+	int					mTasksRemaining;
+	unsigned int		mBatchIndex;
+	int					mRunningThreads;
+	bool				mQuit;
+
+	std::vector< OVR::Ptr<OVR::Thread> > mThreads;
+};
+
+}
@@ -0,0 +1,330 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#include "TelemetrySampler.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "OGLESTrace.h"
+
+#ifdef __linux__
+	#include <dirent.h>
+	#include <unistd.h>
+#endif
+
+namespace OGLESSandbox
+{
+
+TelemetrySampler::Sample::Sample()
+	: time(0),
+	  thermalZoneCount(0),
+	  cpuCount(0),
+	  processCpuUsage(-1.f),
+	  threadCount(0)
+{
+	memset( temperatures, 0, sizeof(temperatures) );
+	memset( cpuFrequencies, 0, sizeof(cpuFrequencies) );
+	memset( threads, 0, sizeof(threads) );
+}
+
+float TelemetrySampler::Sample::getMaxTemperature() const
+{
+	float maxTemperature = -1.f;
+	for ( int i=0; i<thermalZoneCount; ++i )
+	{
+		if ( i==0 || temperatures[i]>maxTemperature )
+			maxTemperature = temperatures[i];
+	}
+	return maxTemperature;
+}
+
+int TelemetrySampler::Sample::getMinCpuFrequency() const
+{
+	int minFrequency = -1;
+	for ( int i=0; i<cpuCount; ++i )
+	{
+		if ( i==0 || cpuFrequencies[i]<minFrequency )
+			minFrequency = cpuFrequencies[i];
+	}
+	return minFrequency;
+}
+
+TelemetrySampler::TelemetrySampler()
+	: mSysRoot(),
+	  mProcRoot(),
+	  mIntervalMs(0),
+	  mThermalZonePaths(),
+	  mCpuFrequencyPaths(),
+	  mProcessStatPath(),
+	  mTaskDirectoryPath(),
+	  mClockTicksPerSecond(100),
+	  mPreviousTime(0),
+	  mPreviousProcessTicks(0),
+	  mPreviousThreadCount(0),
+	  mMutex(),
+	  mCondition(),
+	  mQuit(false),
+	  mThreadRunning(false),
+	  mLatestSample(),
+	  mThread()
+{
+#ifdef __linux__
+	mClockTicksPerSecond = sysconf(_SC_CLK_TCK);
+	if ( mClockTicksPerSecond<=0 )
+		mClockTicksPerSecond = 100;
+#endif
+}
+
+TelemetrySampler::~TelemetrySampler()
+{
+	stop();
+}
+
+bool TelemetrySampler::start( const std::string& sysRoot, const std::string& procRoot, unsigned int intervalMs )
+{
+	stop();
+	if ( intervalMs==0 )
+		return false;
+
+	mSysRoot = sysRoot;
+	mProcRoot = procRoot;
+	mIntervalMs = intervalMs;
+	mPreviousTime = 0;
+	mPreviousProcessTicks = 0;
+	mPreviousThreadCount = 0;
+	mLatestSample = Sample();
+	findSources();
+
+	mQuit = false;
+	mThreadRunning = true;
+	mThread = *new OVR::Thread( threadFunction, this );
+	if ( !mThread->Start() )
+	{
+		printf("TelemetrySampler: failed to start thread\n");
+		mThreadRunning = false;
+		mThread.Clear();
+		return false;
+	}
+	return true;
+}
+
+void TelemetrySampler::stop()
+{
+	if ( !isRunning() )
+		return;
+	mMutex.DoLock();
+	mQuit = true;
+	mCondition.NotifyAll();
+	while ( mThreadRunning )
+		mCondition.Wait( &mMutex );
+	mMutex.Unlock();
+	mThread.Clear();
+}
+
+TelemetrySampler::Sample TelemetrySampler::getLatestSample() const
+{
+	OVR::Mutex::Locker locker( &mMutex );
+	return mLatestSample;
+}
+
+int TelemetrySampler::threadFunction( OVR::Thread* /*thread*/, void* userData )
+{
+	TelemetrySampler* sampler = static_cast<TelemetrySampler*>(userData);
+	sampler->samplerLoop();
+	return 0;
+}
+
+void TelemetrySampler::samplerLoop()
+{
+	OGLES_TRACE_THREAD_NAME("Telemetry");
+	mMutex.DoLock();
+	while ( !mQuit )
+	{
+		mMutex.Unlock();
+		Sample newSample;
+		sample( newSample );
+		mMutex.DoLock();
+		mLatestSample = newSample;
+		if ( !mQuit )
+			mCondition.Wait( &mMutex, mIntervalMs );
+	}
+	mThreadRunning = false;
+	mCondition.NotifyAll();
+	mMutex.Unlock();
+}
+
+void TelemetrySampler::findSources()
+{
+	// The set of zones and CPUs is looked up once, sampling then only opens known files
+	mThermalZonePaths.clear();
+	mCpuFrequencyPaths.clear();
+	char number[16];
+	long value = 0;
+	for ( int i=0; i<MaxThermalZones; ++i )
+	{
+		sprintf( number, "%d", i );
+		std::string path = mSysRoot + "/class/thermal/thermal_zone" + number + "/temp";
+		if ( readLong( path.c_str(), value ) )
+			mThermalZonePaths.push_back( path );
+	}
+	for ( int i=0; i<MaxCpus; ++i )
+	{
+		sprintf( number, "%d", i );
+		std::string path = mSysRoot + "/devices/system/cpu/cpu" + number + "/cpufreq/scaling_cur_freq";
+		if ( readLong( path.c_str(), value ) )
+			mCpuFrequencyPaths.push_back( path );
+	}
+	mProcessStatPath = mProcRoot + "/self/stat";
+	mTaskDirectoryPath = mProcRoot + "/self/task";
+	printf("TelemetrySampler: %d thermal zone(s), %d cpufreq policy(ies), every %dms\n", 
+		static_cast<int>(mThermalZonePaths.size()), static_cast<int>(mCpuFrequencyPaths.size()), mIntervalMs );
+}
+
+void TelemetrySampler::sample( Sample& sample )
+{
+	sample = Sample();
+	OVR::UInt64 now = OVR::Timer::GetTicks();
+	sample.time = OVR::Timer::GetTicksMs();
+
+	long value = 0;
+	for ( size_t i=0; i<mThermalZonePaths.size(); ++i )
+	{
+		if ( readLong( mThermalZonePaths[i].c_str(), value ) )
+			sample.temperatures[sample.thermalZoneCount++] = static_cast<float>(value) / 1000.f;		// Millidegrees
+	}
+	for ( size_t i=0; i<mCpuFrequencyPaths.size(); ++i )
+	{
+		if ( readLong( mCpuFrequencyPaths[i].c_str(), value ) )
+			sample.cpuFrequencies[sample.cpuCount++] = static_cast<int>(value);
+	}
+
+	// CPU usage is the share of the elapsed time spent running, in clock ticks
+	float elapsedTicks = 0.f;
+	if ( mPreviousTime!=0 )
+		elapsedTicks = static_cast<float>( now - mPreviousTime ) / 1000000.f * mClockTicksPerSecond;
+	sampleProcess( sample, elapsedTicks );
+	sampleThreads( sample, elapsedTicks );
+	mPreviousTime = now;
+}
+
+void TelemetrySampler::sampleProcess( Sample& sample, float elapsedTicks )
+{
+	unsigned long ticks = 0;
+	if ( !readStat( mProcessStatPath.c_str(), NULL, ticks ) )
+		return;
+	if ( elapsedTicks>0.f && ticks>=mPreviousProcessTicks )
+		sample.processCpuUsage = static_cast<float>(ticks - mPreviousProcessTicks) / elapsedTicks * 100.f;
+	mPreviousProcessTicks = ticks;
+}
+
+void TelemetrySampler::sampleThreads( Sample& sample, float elapsedTicks )
+{
+#ifdef __linux__
+	DIR* directory = opendir( mTaskDirectoryPath.c_str() );
+	if ( !directory )
+		return;
+
+	ThreadTicks threadTicks[MaxThreads];
+	int count = 0;
+	char path[512];
+	struct dirent* entry = NULL;
+	while ( count<MaxThreads && (entry=readdir(directory))!=NULL )
+	{
+		if ( entry->d_name[0]<'0' || entry->d_name[0]>'9' )
+			continue;
+		snprintf( path, sizeof(path), "%s/%s/stat", mTaskDirectoryPath.c_str(), entry->d_name );
+		
+		ThreadSample& threadSample = sample.threads[count];
+		unsigned long ticks = 0;
+		if ( !readStat( path, threadSample.name, ticks ) )
+			continue;
+		threadSample.id = atoi( entry->d_name );
+		threadSample.cpuUsage = -1.f;
+		for ( int i=0; i<mPreviousThreadCount; ++i )
+		{
+			if ( mPreviousThreadTicks[i].id==threadSample.id )
+			{
+				if ( elapsedTicks>0.f && ticks>=mPreviousThreadTicks[i].ticks )
+					threadSample.cpuUsage = static_cast<float>(ticks - mPreviousThreadTicks[i].ticks) / elapsedTicks * 100.f;
+				break;
+			}
+		}
+		threadTicks[count].id = threadSample.id;
+		threadTicks[count].ticks = ticks;
+		count++;
+	}
+	closedir( directory );
+
+	sample.threadCount = count;
+	memcpy( mPreviousThreadTicks, threadTicks, sizeof(ThreadTicks) * count );
+	mPreviousThreadCount = count;
+#endif
+}
+
+bool TelemetrySampler::readLong( const char* path, long& value )
+{
+	FILE* file = fopen( path, "r" );
+	if ( !file )
+		return false;
+	bool ok = fscanf( file, "%ld", &value )==1;
+	fclose( file );
+	return ok;
+}
+
+bool TelemetrySampler::readStat( const char* path, char* name, unsigned long& ticks )
+{
+	// Format of proc(5) stat files: "pid (name) state ppid ..." where utime and stime are the 14th 
+	// and 15th fields. The name can contain spaces and parentheses, so the last ')' ends it
+	FILE* file = fopen( path, "r" );
+	if ( !file )
+		return false;
+	char line[512];
+	bool ok = fgets( line, sizeof(line), file )!=NULL;
+	fclose( file );
+	if ( !ok )
+		return false;
+
+	const char* nameStart = strchr( line, '(' );
+	const char* nameEnd = strrchr( line, ')' );
+	if ( !nameStart || !nameEnd || nameEnd<nameStart )
+		return false;
+	if ( name )
+	{
+		size_t length = nameEnd - nameStart - 1;
+		if ( length>MaxThreadNameLength-1 )
+			length = MaxThreadNameLength-1;
+		memcpy( name, nameStart+1, length );
+		name[length] = '\0';
+	}
+
+	unsigned long userTime = 0;
+	unsigned long systemTime = 0;
+	if ( sscanf( nameEnd+1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &userTime, &systemTime )!=2 )
+		return false;
+	ticks = userTime + systemTime;
+	return true;
+}
+
+}
@@ -0,0 +1,129 @@
+/*
+	Copyright (C) 2014 Jacques Menuet
+
+	This content is released under the MIT License (http://opensource.org/licenses/MIT)
+	
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in
+	all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+	THE SOFTWARE.
+*/
+#pragma once
+
+#include "OVR.h"
+
+#include <string>
+#include <vector>
+
+namespace OGLESSandbox
+{
+
+/*
+	TelemetrySampler
+
+	A background thread that periodically reads the SoC temperatures (thermal zones), 
+	the current frequency of each CPU (cpufreq) and the CPU time used by the process 
+	and each of its threads (/proc/self/task). The sysfs and procfs roots can be moved 
+	elsewhere so that the sampler can be run against a tree of fake files.
+	A sample is a fixed size record: copying the latest one out is cheap and never allocates.
+*/
+class TelemetrySampler
+{
+public:
+	enum 
+	{
+		MaxThermalZones = 4,
+		MaxCpus = 8,
+		MaxThreads = 16,
+		MaxThreadNameLength = 16
+	};
+
+	struct ThreadSample
+	{
+		int		id;
+		char	name[MaxThreadNameLength];
+		float	cpuUsage;							// Percent of one core since the previous sample
+	};
+
+	struct Sample
+	{
+		Sample();
+
+		float	getMaxTemperature() const;			// -1 when unknown
+		int		getMinCpuFrequency() const;			// -1 when unknown
+
+		unsigned int	time;						// OVR::Timer::GetTicksMs() when taken, 0 if there's no sample yet
+		int				thermalZoneCount;
+		float			temperatures[MaxThermalZones];		// Degrees Celsius
+		int				cpuCount;
+		int				cpuFrequencies[MaxCpus];	// In kHz
+		float			processCpuUsage;			// Percent of one core since the previous sample, -1 when unknown
+		int				threadCount;
+		ThreadSample	threads[MaxThreads];
+	};
+
+	TelemetrySampler();
+	~TelemetrySampler();
+
+	// Starts (or restarts) the sampling thread. The roots are normally "/sys" and "/proc"
+	bool	start( const std::string& sysRoot, const std::string& procRoot, unsigned int intervalMs );
+	void	stop();
+	bool	isRunning() const { return mThread.GetPtr()!=NULL; }
+
+	Sample	getLatestSample() const;
+
+	// Takes a sample on the calling thread, without touching the latest one. 
+	// Only call it while the sampling thread isn't running
+	void	sample( Sample& sample );
+
+private:
+	struct ThreadTicks
+	{
+		int				id;
+		unsigned long	ticks;
+	};
+
+	static int		threadFunction( OVR::Thread* thread, void* userData );
+	void			samplerLoop();
+	void			findSources();
+	void			sampleProcess( Sample& sample, float elapsedTicks );
+	void			sampleThreads( Sample& sample, float elapsedTicks );
+	static bool		readLong( const char* path, long& value );
+	static bool		readStat( const char* path, char* name, unsigned long& ticks );
+
+	std::string					mSysRoot;
+	std::string					mProcRoot;
+	unsigned int				mIntervalMs;
+	std::vector<std::string>	mThermalZonePaths;
+	std::vector<std::string>	mCpuFrequencyPaths;
+	std::string					mProcessStatPath;
+	std::string					mTaskDirectoryPath;
+	long						mClockTicksPerSecond;
+
+	OVR::UInt64					mPreviousTime;
+	unsigned long				mPreviousProcessTicks;
+	ThreadTicks					mPreviousThreadTicks[MaxThreads];
+	int							mPreviousThreadCount;
+
+	mutable OVR::Mutex			mMutex;
+	OVR::WaitCondition			mCondition;
+	bool						mQuit;
+	bool						mThreadRunning;
+	Sample						mLatestSample;
+	OVR::Ptr<OVR::Thread>		mThread;
+};
+
+}